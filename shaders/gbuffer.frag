@@ -0,0 +1,132 @@
+#version 330 core
+
+// Primary visibility for the hybrid path tracer. Each fragment ray-casts the
+// analytic primitive of its instance with the same routines and epsilons as
+// pathtracer.frag, so the G-buffer holds exactly the first hit the tracer
+// would have found.
+
+flat in vec4 vCenterKind;
+flat in vec4 vSizePrimitive;
+flat in vec4 vNormalObject;
+
+layout (location = 0) out vec4 outPosition;    // xyz position, w hit distance
+layout (location = 1) out vec4 outNormalDepth; // xyz normal, w linear depth
+layout (location = 2) out ivec2 outIds;        // primitive id, object id
+
+uniform vec3 u_cameraPos;
+uniform vec3 u_cameraDir;
+uniform vec3 u_cameraUp;
+uniform vec3 u_cameraRight;
+uniform float u_fov;
+uniform vec2 u_resolution;
+uniform vec2 u_jitter;
+uniform float u_near;
+uniform float u_far;
+
+#define KIND_SPHERE 0
+#define KIND_PLANE 1
+#define KIND_CUBE 2
+#define EPSILON 0.0001
+
+bool intersectSphere(vec3 origin, vec3 direction, vec3 center, float radius, out float t) {
+    vec3 oc = origin - center;
+    float a = dot(direction, direction);
+    float b = 2.0 * dot(oc, direction);
+    float c = dot(oc, oc) - radius * radius;
+    float discriminant = b * b - 4.0 * a * c;
+
+    if (discriminant < 0.0) return false;
+
+    float sqrtD = sqrt(discriminant);
+    float t1 = (-b - sqrtD) / (2.0 * a);
+    float t2 = (-b + sqrtD) / (2.0 * a);
+
+    if (t1 > EPSILON) {
+        t = t1;
+        return true;
+    }
+
+    if (t2 > EPSILON) {
+        t = t2;
+        return true;
+    }
+
+    return false;
+}
+
+bool intersectPlane(vec3 origin, vec3 direction, vec3 point, vec3 normal, out float t) {
+    float denom = dot(normal, direction);
+    if (abs(denom) < EPSILON) return false;
+
+    t = dot(point - origin, normal) / denom;
+    return t > EPSILON;
+}
+
+bool intersectCube(vec3 origin, vec3 direction, vec3 center, vec3 size, out float t, out vec3 normal) {
+    vec3 halfSize = size * 0.5;
+    vec3 invDir = 1.0 / direction;
+
+    vec3 t1 = (center - halfSize - origin) * invDir;
+    vec3 t2 = (center + halfSize - origin) * invDir;
+
+    vec3 tmin = min(t1, t2);
+    vec3 tmax = max(t1, t2);
+
+    float tNear = max(max(tmin.x, tmin.y), tmin.z);
+    float tFar = min(min(tmax.x, tmax.y), tmax.z);
+
+    if (tNear > tFar || tFar < 0.0) return false;
+
+    t = tNear > EPSILON ? tNear : tFar;
+
+    vec3 d = origin + direction * t - center;
+    // Face of the dominant axis, relative to the half extents so flat
+    // boxes get the face the point lies on
+    vec3 absD = abs(d) / halfSize;
+
+    if (absD.x > absD.y && absD.x > absD.z) {
+        normal = vec3(sign(d.x), 0.0, 0.0);
+    } else if (absD.y > absD.x && absD.y > absD.z) {
+        normal = vec3(0.0, sign(d.y), 0.0);
+    } else {
+        normal = vec3(0.0, 0.0, sign(d.z));
+    }
+
+    return true;
+}
+
+void main() {
+    // Pinhole camera ray through the jittered pixel, as in pathtracer.frag
+    // without DOF
+    vec2 uv = (2.0 * (gl_FragCoord.xy + u_jitter) - u_resolution) / u_resolution.y;
+    float tanHalfFov = tan(radians(u_fov * 0.5));
+    vec3 direction = normalize(uv.x * tanHalfFov * u_cameraRight + uv.y * tanHalfFov * u_cameraUp + u_cameraDir);
+
+    int kind = int(vCenterKind.w + 0.5);
+    vec3 center = vCenterKind.xyz;
+    float t = 0.0;
+    vec3 normal = vec3(0.0, 1.0, 0.0);
+    bool hit = false;
+
+    if (kind == KIND_SPHERE) {
+        hit = intersectSphere(u_cameraPos, direction, center, vSizePrimitive.x, t);
+        normal = normalize(u_cameraPos + direction * t - center);
+    } else if (kind == KIND_PLANE) {
+        normal = vNormalObject.xyz;
+        hit = intersectPlane(u_cameraPos, direction, center, normal, t);
+    } else if (kind == KIND_CUBE) {
+        hit = intersectCube(u_cameraPos, direction, center, vSizePrimitive.xyz, t, normal);
+    }
+
+    if (!hit) discard;
+
+    float viewDepth = t * dot(direction, u_cameraDir);
+    if (viewDepth < u_near || viewDepth > u_far) discard;
+
+    float ndcDepth = ((u_far + u_near) - 2.0 * u_far * u_near / viewDepth) / (u_far - u_near);
+    gl_FragDepth = clamp(ndcDepth * 0.5 + 0.5, 0.0, 0.999999);
+
+    outPosition = vec4(u_cameraPos + direction * t, t);
+    outNormalDepth = vec4(normal, viewDepth);
+    outIds = ivec2(int(vSizePrimitive.w + 0.5), int(vNormalObject.w + 0.5));
+}
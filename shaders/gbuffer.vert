@@ -0,0 +1,56 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+
+// Per-instance primitive data (see GBufferInstance)
+layout (location = 2) in vec4 iCenterKind;
+layout (location = 3) in vec4 iSizePrimitive;
+layout (location = 4) in vec4 iNormalObject;
+
+flat out vec4 vCenterKind;
+flat out vec4 vSizePrimitive;
+flat out vec4 vNormalObject;
+
+uniform vec3 u_cameraPos;
+uniform vec3 u_cameraDir;
+uniform vec3 u_cameraUp;
+uniform vec3 u_cameraRight;
+uniform float u_fov;
+uniform vec2 u_resolution;
+uniform vec2 u_jitter;
+uniform float u_near;
+uniform float u_far;
+uniform int u_fullscreen;
+
+#define KIND_SPHERE 0
+
+void main() {
+    vCenterKind = iCenterKind;
+    vSizePrimitive = iSizePrimitive;
+    vNormalObject = iNormalObject;
+
+    if (u_fullscreen != 0) {
+        gl_Position = vec4(aPos.xy, 0.0, 1.0);
+        return;
+    }
+
+    // Slightly oversized proxy; the fragment shader finds the exact surface
+    int kind = int(iCenterKind.w + 0.5);
+    vec3 extent = kind == KIND_SPHERE ? vec3(2.0 * iSizePrimitive.x) : iSizePrimitive.xyz;
+    vec3 world = iCenterKind.xyz + aPos * extent * 1.02;
+
+    // Same pinhole model as the path tracer's getCameraRay
+    vec3 d = world - u_cameraPos;
+    float tanHalfFov = tan(radians(u_fov * 0.5));
+    float aspect = u_resolution.x / u_resolution.y;
+    float z = dot(d, u_cameraDir);
+
+    gl_Position = vec4(
+        dot(d, u_cameraRight) / (tanHalfFov * aspect),
+        dot(d, u_cameraUp) / tanHalfFov,
+        z * (u_far + u_near) / (u_far - u_near) - 2.0 * u_far * u_near / (u_far - u_near),
+        z
+    );
+    // Shift the proxy with the fragment shader's rays
+    gl_Position.xy -= 2.0 * u_jitter / u_resolution * z;
+}
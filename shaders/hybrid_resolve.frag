@@ -0,0 +1,28 @@
+#version 330 core
+
+// Averages the hybrid accumulation target (rgb = radiance sum, a = sample
+// count) and tonemaps it exactly like pathtracer.frag.
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D u_accumulation;
+
+void main() {
+    vec4 sum = texture(u_accumulation, TexCoord);
+    vec3 color = sum.a > 0.0 ? sum.rgb / sum.a : vec3(0.0);
+    
+    color *= 0.8;
+    
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+    
+    color = clamp((color * (a * color + b)) / (color * (c * color + d) + e), 0.0, 1.0);
+    color = pow(color, vec3(1.0 / 2.2));
+    color *= 0.95;
+    
+    FragColor = vec4(color, 1.0);
+}
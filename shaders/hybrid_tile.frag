@@ -0,0 +1,14 @@
+#version 330 core
+
+// Adds one CPU-traced tile of radiance to the hybrid accumulation target.
+// Drawn with additive blending over the tile's rectangle only.
+
+out vec4 FragColor;
+
+uniform sampler2D u_tile;
+uniform vec2 u_tileOrigin;  // Lower-left pixel of the tile
+
+void main() {
+    vec3 radiance = texelFetch(u_tile, ivec2(gl_FragCoord.xy - u_tileOrigin), 0).rgb;
+    FragColor = vec4(radiance, 1.0);
+}
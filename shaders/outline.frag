@@ -0,0 +1,46 @@
+#version 330 core
+
+// Screen-space selection outlines. Object ids come from the G-buffer, the
+// selection state of each object from a small lookup texture, so the cost
+// per pixel is fixed regardless of scene or selection size.
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform isampler2D u_ids;            // x = primitive id, y = object id
+uniform usampler2D u_selectionMask;  // per object: 0 none, 1 hovered, 2 selected
+uniform int u_maskWidth;
+uniform int u_maskSize;
+uniform vec3 u_selectedColor;
+uniform vec3 u_hoveredColor;
+
+#define OUTLINE_RADIUS 2
+
+uint selectionAt(ivec2 texel, ivec2 size) {
+    int id = texelFetch(u_ids, clamp(texel, ivec2(0), size - 1), 0).y;
+    if (id < 0 || id >= u_maskSize) return 0u;
+    return texelFetch(u_selectionMask, ivec2(id % u_maskWidth, id / u_maskWidth), 0).r;
+}
+
+void main() {
+    ivec2 size = textureSize(u_ids, 0);
+    ivec2 texel = ivec2(TexCoord * vec2(size));
+
+    uint center = selectionAt(texel, size);
+    uint edge = 0u;
+
+    // Pixels just outside a selected silhouette form the outline
+    for (int radius = 1; radius <= OUTLINE_RADIUS; ++radius) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0) continue;
+                uint neighbour = selectionAt(texel + ivec2(dx, dy) * radius, size);
+                if (neighbour > center) edge = max(edge, neighbour);
+            }
+        }
+    }
+
+    if (edge == 0u) discard;
+
+    FragColor = vec4(edge == 2u ? u_selectedColor : u_hoveredColor, 1.0);
+}
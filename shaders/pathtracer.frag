@@ -12,7 +12,18 @@ uniform vec2 u_resolution;
 
 uniform int u_maxBounces;
 uniform int u_samplesPerPixel;
-uniform float u_time;
+uniform uint u_rngSeed;
+uniform uint u_sampleOffset;  // index of this frame's first sample per pixel
+// Hybrid rendering: write the radiance sum and sample count, untonemapped
+uniform int u_outputRadiance;
+
+// Rasterized primary visibility (see gbuffer.frag)
+uniform int u_useGBuffer;
+uniform sampler2D u_gbufferPosition;
+uniform sampler2D u_gbufferNormal;
+uniform isampler2D u_gbufferIds;
+uniform vec2 u_gbufferSize;
+uniform vec2 u_gbufferJitter;    // Sub-pixel offset the G-buffer was rasterized at
 
 #define MAX_PRIMITIVES 64
 #define PI 3.14159265359
@@ -79,33 +90,32 @@ struct HitInfo {
     vec3 emission;
 };
 
-// Улучшенный RNG
-uint g_seed;
+// Counter-based RNG: pcg4d over (pixel, sample, seed, block), four values
+// per hash. Must stay bit-identical to RandomStream in utils/Random.h.
+uvec4 g_rngKey;
+uint g_rngCounter;
+uvec4 g_rngBlock;
 
-uint hash(uint x) {
-    x += (x << 10u);
-    x ^= (x >> 6u);
-    x += (x << 3u);
-    x ^= (x >> 11u);
-    x += (x << 15u);
-    return x;
+uvec4 pcg4d(uvec4 v) {
+    v = v * 1664525u + 1013904223u;
+    v.x += v.y * v.w; v.y += v.z * v.x; v.z += v.x * v.y; v.w += v.y * v.z;
+    v ^= v >> 16u;
+    v.x += v.y * v.w; v.y += v.z * v.x; v.z += v.x * v.y; v.w += v.y * v.z;
+    return v;
 }
 
-uint hash(uvec2 v) { return hash(v.x ^ hash(v.y)); }
-uint hash(uvec3 v) { return hash(v.x ^ hash(v.y) ^ hash(v.z)); }
-
-float floatConstruct(uint m) {
-    const uint ieeeMantissa = 0x007FFFFFu;
-    const uint ieeeOne = 0x3F800000u;
-    m &= ieeeMantissa;
-    m |= ieeeOne;
-    float f = uintBitsToFloat(m);
-    return f - 1.0;
+void beginSample(uvec2 pixel, uint sampleIndex) {
+    g_rngKey = uvec4((pixel.y << 16u) | (pixel.x & 0xFFFFu), sampleIndex, u_rngSeed, 0u);
+    g_rngCounter = 0u;
 }
 
 float random() {
-    g_seed = hash(g_seed);
-    return floatConstruct(g_seed);
+    if ((g_rngCounter & 3u) == 0u) {
+        g_rngBlock = pcg4d(uvec4(g_rngKey.xyz, g_rngCounter >> 2u));
+    }
+    uint bits = g_rngBlock[g_rngCounter & 3u];
+    g_rngCounter++;
+    return uintBitsToFloat((bits >> 9u) | 0x3F800000u) - 1.0;
 }
 
 vec2 random2() {
@@ -203,7 +213,9 @@ bool intersectCube(Ray ray, Cube cube, out float t, out vec3 normal) {
     
     vec3 hitPoint = ray.origin + ray.direction * t;
     vec3 d = hitPoint - cube.center;
-    vec3 absD = abs(d);
+    // Face of the dominant axis, relative to the half extents so flat
+    // boxes get the face the point lies on
+    vec3 absD = abs(d) / halfSize;
     
     if (absD.x > absD.y && absD.x > absD.z) {
         normal = vec3(sign(d.x), 0.0, 0.0);
@@ -276,6 +288,43 @@ HitInfo intersectScene(Ray ray) {
     return closestHit;
 }
 
+// Material lookup for a primitive id written by the G-buffer pass
+HitInfo primitiveHit(int primitiveId, vec3 point, vec3 normal, float t) {
+    HitInfo hit;
+    hit.hit = true;
+    hit.t = t;
+    hit.point = point;
+    hit.normal = normal;
+    
+    int kind = primitiveId / MAX_PRIMITIVES;
+    int index = primitiveId - kind * MAX_PRIMITIVES;
+    
+    if (kind == 0) {
+        hit.color = u_spheres[index].color;
+        hit.materialType = u_spheres[index].materialType;
+        hit.roughness = u_spheres[index].roughness;
+        hit.ior = u_spheres[index].ior;
+        hit.metalness = u_spheres[index].metalness;
+        hit.emission = u_spheres[index].emission;
+    } else if (kind == 1) {
+        hit.color = u_planes[index].color;
+        hit.materialType = u_planes[index].materialType;
+        hit.roughness = u_planes[index].roughness;
+        hit.ior = 1.5;
+        hit.metalness = u_planes[index].metalness;
+        hit.emission = u_planes[index].emission;
+    } else {
+        hit.color = u_cubes[index].color;
+        hit.materialType = u_cubes[index].materialType;
+        hit.roughness = u_cubes[index].roughness;
+        hit.ior = u_cubes[index].ior;
+        hit.metalness = u_cubes[index].metalness;
+        hit.emission = u_cubes[index].emission;
+    }
+    
+    return hit;
+}
+
 // Более мягкое и темное небо
 vec3 getSkyColor(vec3 direction) {
     // Солнце - менее яркое и более мягкое
@@ -330,8 +379,9 @@ bool scatter(Ray inRay, HitInfo hit, out vec3 attenuation, out Ray scattered) {
     }
     else if (hit.materialType == 2) { // Glass
         float safeIor = clamp(hit.ior, 1.001, 3.0);
-        bool entering = dot(inRay.direction, N) < 0.0;
-        vec3 normal = entering ? N : -N;
+        // N already faces the ray; the side comes from the outward normal
+        bool entering = dot(inRay.direction, hit.normal) < 0.0;
+        vec3 normal = N;
         float eta = entering ? 1.0 / safeIor : safeIor;
         
         vec3 incident = normalize(inRay.direction);
@@ -367,13 +417,13 @@ bool scatter(Ray inRay, HitInfo hit, out vec3 attenuation, out Ray scattered) {
     return false;
 }
 
-// Упрощенный path tracer
-vec3 pathTrace(Ray ray) {
+// Упрощенный path tracer; the first hit may come from the G-buffer
+vec3 pathTrace(Ray ray, bool hasPrimary, HitInfo primary) {
     vec3 radiance = vec3(0.0);
     vec3 throughput = vec3(1.0);
     
     for (int bounce = 0; bounce < u_maxBounces; bounce++) {
-        HitInfo hit = intersectScene(ray);
+        HitInfo hit = (bounce == 0 && hasPrimary) ? primary : intersectScene(ray);
         
         if (!hit.hit) {
             radiance += throughput * getSkyColor(ray.direction);
@@ -441,22 +491,50 @@ Ray getCameraRay(vec2 coords) {
     return Ray(u_cameraPos, rayDir);
 }
 
+// Primary ray and hit for a G-buffer texel; sky texels report no hit
+void gbufferPrimary(vec2 pixel, out Ray ray, out HitInfo hit) {
+    ivec2 texel = clamp(ivec2(pixel), ivec2(0), ivec2(u_gbufferSize) - 1);
+    ivec2 ids = texelFetch(u_gbufferIds, texel, 0).xy;
+    
+    if (ids.x < 0) {
+        vec2 uv = (2.0 * (vec2(texel) + 0.5 + u_gbufferJitter) - u_gbufferSize) / u_gbufferSize.y;
+        float halfHeight = tan(u_fov * 0.5 * PI / 180.0);
+        ray = Ray(u_cameraPos, normalize(uv.x * halfHeight * u_cameraRight +
+                                         uv.y * halfHeight * u_cameraUp + u_cameraDir));
+        hit.hit = false;
+        return;
+    }
+    
+    vec4 position = texelFetch(u_gbufferPosition, texel, 0);
+    vec3 normal = normalize(texelFetch(u_gbufferNormal, texel, 0).xyz);
+    ray = Ray(u_cameraPos, normalize(position.xyz - u_cameraPos));
+    hit = primitiveHit(ids.x, position.xyz, normal, position.w);
+}
+
 void main() {
     vec2 uv = (2.0 * gl_FragCoord.xy - u_resolution) / u_resolution.y;
     
-    // RNG инициализация
     uvec2 pixelCoord = uvec2(gl_FragCoord.xy);
-    uint frameHash = uint(u_time * 60.0);
-    g_seed = hash(uvec3(pixelCoord, frameHash)) | 1u;
     
     vec3 color = vec3(0.0);
     
     for (int sample = 0; sample < u_samplesPerPixel; sample++) {
-        vec2 jitter = (random2() - 0.5) * 0.8 / u_resolution;
-        vec2 coords = uv + jitter;
+        beginSample(pixelCoord, u_sampleOffset + uint(sample));
         
-        Ray ray = getCameraRay(coords);
-        vec3 sampleColor = pathTrace(ray);
+        Ray ray;
+        HitInfo primary;
+        bool hasPrimary = u_useGBuffer != 0;
+        
+        if (hasPrimary) {
+            // Pick a G-buffer texel inside this pixel's footprint
+            vec2 pixel = (gl_FragCoord.xy - 0.5 + random2()) * u_gbufferSize / u_resolution;
+            gbufferPrimary(pixel, ray, primary);
+        } else {
+            vec2 jitter = (random2() - 0.5) * 0.8 / u_resolution;
+            ray = getCameraRay(uv + jitter);
+        }
+        
+        vec3 sampleColor = pathTrace(ray, hasPrimary, primary);
         
         // Защита от артефактов
         if (any(isnan(sampleColor)) || any(isinf(sampleColor))) {
@@ -466,6 +544,11 @@ void main() {
         color += clamp(sampleColor, vec3(0.0), vec3(20.0));
     }
     
+    if (u_outputRadiance != 0) {
+        FragColor = vec4(color, float(u_samplesPerPixel));
+        return;
+    }
+    
     color /= float(u_samplesPerPixel);
     
     // ACES Tonemapping с пониженной экспозицией
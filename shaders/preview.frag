@@ -0,0 +1,155 @@
+#version 330 core
+
+// Preview shading: GGX specular + Lambert diffuse from one shadowed light,
+// ambient from the same sky model the path tracer uses. Tonemapping matches
+// pathtracer.frag so switching modes keeps the overall look.
+
+in vec3 vWorldPos;
+in vec3 vNormal;
+in vec4 vLightClip;
+flat in vec4 vMaterial;
+flat in vec3 vColor;
+flat in vec3 vEmission;
+
+out vec4 FragColor;
+
+uniform int u_kind;
+
+uniform vec3 u_cameraPos;
+uniform vec3 u_cameraDir;
+uniform vec3 u_cameraUp;
+uniform vec3 u_cameraRight;
+uniform float u_fov;
+uniform vec2 u_resolution;
+
+uniform vec3 u_lightPos;
+uniform vec3 u_lightForward;
+uniform vec3 u_lightColor;
+uniform float u_lightRadius;
+uniform int u_lightDirectional;
+uniform sampler2DShadow u_shadowMap;
+
+#define KIND_SKY 3
+#define PI 3.14159265359
+#define INV_PI 0.31830988618
+#define SHADOW_BIAS 0.0005
+
+// Keep in sync with getSkyColor in pathtracer.frag
+vec3 getSkyColor(vec3 direction) {
+    vec3 sunDir = normalize(vec3(0.2, 0.6, 0.4));
+    float sunDot = max(0.0, dot(direction, sunDir));
+    vec3 sunColor = vec3(1.2, 1.0, 0.8) * pow(sunDot, 128.0) * 0.5;
+
+    float t = max(0.0, direction.y);
+    vec3 skyGradient = mix(vec3(0.4, 0.6, 0.8), vec3(0.15, 0.3, 0.6), t);
+
+    float horizonFactor = 1.0 - abs(direction.y);
+    vec3 horizonColor = vec3(0.6, 0.5, 0.4) * horizonFactor * 0.2;
+
+    return (skyGradient + horizonColor + sunColor) * 0.6;
+}
+
+vec3 tonemap(vec3 color) {
+    color *= 0.8;
+
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+
+    color = clamp((color * (a * color + b)) / (color * (c * color + d) + e), 0.0, 1.0);
+    return pow(color, vec3(1.0 / 2.2)) * 0.95;
+}
+
+float distributionGGX(float NdotH, float alpha) {
+    float a2 = alpha * alpha;
+    float denom = NdotH * NdotH * (a2 - 1.0) + 1.0;
+    return a2 / (PI * denom * denom);
+}
+
+float geometrySmith(float NdotV, float NdotL, float alpha) {
+    float k = alpha * 0.5;
+    float gv = NdotV / (NdotV * (1.0 - k) + k);
+    float gl = NdotL / (NdotL * (1.0 - k) + k);
+    return gv * gl;
+}
+
+vec3 fresnelSchlick(float cosTheta, vec3 F0) {
+    return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
+}
+
+float shadowFactor() {
+    if (vLightClip.w <= 0.0) return 1.0;
+
+    vec3 coord = vLightClip.xyz / vLightClip.w * 0.5 + 0.5;
+    if (any(lessThan(coord, vec3(0.0))) || any(greaterThan(coord, vec3(1.0)))) return 1.0;
+
+    // 2x2 hardware-filtered taps
+    vec2 texel = 1.0 / vec2(textureSize(u_shadowMap, 0));
+    float lit = 0.0;
+    lit += texture(u_shadowMap, vec3(coord.xy + vec2(-0.5, -0.5) * texel, coord.z - SHADOW_BIAS));
+    lit += texture(u_shadowMap, vec3(coord.xy + vec2( 0.5, -0.5) * texel, coord.z - SHADOW_BIAS));
+    lit += texture(u_shadowMap, vec3(coord.xy + vec2(-0.5,  0.5) * texel, coord.z - SHADOW_BIAS));
+    lit += texture(u_shadowMap, vec3(coord.xy + vec2( 0.5,  0.5) * texel, coord.z - SHADOW_BIAS));
+    return lit * 0.25;
+}
+
+void main() {
+    if (u_kind == KIND_SKY) {
+        vec2 uv = (2.0 * gl_FragCoord.xy - u_resolution) / u_resolution.y;
+        float halfHeight = tan(radians(u_fov * 0.5));
+        vec3 direction = normalize(uv.x * halfHeight * u_cameraRight + uv.y * halfHeight * u_cameraUp + u_cameraDir);
+        FragColor = vec4(tonemap(getSkyColor(direction)), 1.0);
+        return;
+    }
+
+    float roughness = clamp(vMaterial.x, 0.04, 1.0);
+    float metalness = clamp(vMaterial.y, 0.0, 1.0);
+    int materialType = int(vMaterial.z + 0.5);
+
+    // Diffuse lobe weight per path tracer material: diffuse, metal, glass
+    float diffuseWeight = materialType == 0 ? 1.0 - metalness : (materialType == 1 ? 0.0 : 0.1);
+    vec3 F0 = materialType == 1 ? mix(vec3(0.04), vColor, max(metalness, 0.5)) : mix(vec3(0.04), vColor, metalness);
+    float alpha = roughness * roughness;
+
+    vec3 N = normalize(vNormal);
+    vec3 V = normalize(u_cameraPos - vWorldPos);
+    if (dot(N, V) < 0.0) N = -N;
+    float NdotV = max(dot(N, V), 1e-4);
+
+    // Incident irradiance: the sun is a constant, an emitter is a small sphere
+    vec3 L;
+    vec3 irradiance;
+    if (u_lightDirectional != 0) {
+        L = -u_lightForward;
+        irradiance = u_lightColor;
+    } else {
+        vec3 toLight = u_lightPos - vWorldPos;
+        float distSq = max(dot(toLight, toLight), u_lightRadius * u_lightRadius);
+        L = toLight * inversesqrt(dot(toLight, toLight));
+        irradiance = PI * u_lightColor * (u_lightRadius * u_lightRadius) / distSq;
+    }
+
+    vec3 color = vEmission;
+
+    float NdotL = dot(N, L);
+    if (NdotL > 0.0) {
+        vec3 H = normalize(V + L);
+        float NdotH = max(dot(N, H), 0.0);
+        vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+
+        vec3 specular = distributionGGX(NdotH, alpha) * geometrySmith(NdotV, NdotL, alpha) * F / (4.0 * NdotV * NdotL + 1e-4);
+        vec3 diffuse = (1.0 - F) * diffuseWeight * vColor * INV_PI;
+
+        color += (diffuse + specular) * irradiance * NdotL * shadowFactor();
+    }
+
+    // Sky ambient: irradiance along the normal, radiance along the reflection
+    vec3 Fa = F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(1.0 - NdotV, 5.0);
+    vec3 R = reflect(-V, N);
+    vec3 skySpecular = mix(getSkyColor(R), getSkyColor(N), roughness);
+    color += (1.0 - Fa) * diffuseWeight * vColor * getSkyColor(N) + Fa * skySpecular;
+
+    FragColor = vec4(tonemap(color), 1.0);
+}
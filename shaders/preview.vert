@@ -0,0 +1,119 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+// Per-instance object data (see PreviewInstance)
+layout (location = 2) in vec4 iCenterRoughness;
+layout (location = 3) in vec4 iSizeMetalness;
+layout (location = 4) in vec4 iNormalMaterial;
+layout (location = 5) in vec4 iColorObject;
+layout (location = 6) in vec4 iEmission;
+
+out vec3 vWorldPos;
+out vec3 vNormal;
+out vec4 vLightClip;
+flat out vec4 vMaterial;   // roughness, metalness, material type, object id
+flat out vec3 vColor;
+flat out vec3 vEmission;
+
+uniform int u_kind;
+uniform int u_shadowPass;
+
+uniform vec3 u_cameraPos;
+uniform vec3 u_cameraDir;
+uniform vec3 u_cameraUp;
+uniform vec3 u_cameraRight;
+uniform float u_fov;
+uniform vec2 u_resolution;
+uniform float u_near;
+uniform float u_far;
+
+uniform vec3 u_lightPos;
+uniform vec3 u_lightForward;
+uniform vec3 u_lightRight;
+uniform vec3 u_lightUp;
+uniform float u_lightTanHalfFov;
+uniform float u_lightHalfExtent;
+uniform float u_lightNear;
+uniform float u_lightFar;
+uniform int u_lightDirectional;
+
+#define KIND_SPHERE 0
+#define KIND_PLANE 1
+#define KIND_CUBE 2
+#define KIND_SKY 3
+#define PLANE_EXTENT 400.0
+#define SHADOW_NORMAL_OFFSET 0.03
+
+vec4 lightClip(vec3 world) {
+    vec3 d = world - u_lightPos;
+    float z = dot(d, u_lightForward);
+
+    if (u_lightDirectional != 0) {
+        return vec4(
+            dot(d, u_lightRight) / u_lightHalfExtent,
+            dot(d, u_lightUp) / u_lightHalfExtent,
+            2.0 * (z - u_lightNear) / (u_lightFar - u_lightNear) - 1.0,
+            1.0
+        );
+    }
+
+    return vec4(
+        dot(d, u_lightRight) / u_lightTanHalfFov,
+        dot(d, u_lightUp) / u_lightTanHalfFov,
+        z * (u_lightFar + u_lightNear) / (u_lightFar - u_lightNear) - 2.0 * u_lightFar * u_lightNear / (u_lightFar - u_lightNear),
+        z
+    );
+}
+
+void main() {
+    if (u_kind == KIND_SKY) {
+        gl_Position = vec4(aPos.xy, 0.999999, 1.0);
+        return;
+    }
+
+    vec3 center = iCenterRoughness.xyz;
+    vec3 world;
+    vec3 normal;
+
+    if (u_kind == KIND_SPHERE) {
+        world = center + aPos * iSizeMetalness.x;
+        normal = aNormal;
+    } else if (u_kind == KIND_CUBE) {
+        world = center + aPos * iSizeMetalness.xyz;
+        normal = aNormal;
+    } else {
+        // Planes are infinite in the path tracer; a large quad stands in
+        normal = normalize(iNormalMaterial.xyz);
+        vec3 helper = abs(normal.y) < 0.999 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+        vec3 tangent = normalize(cross(helper, normal));
+        vec3 bitangent = cross(normal, tangent);
+        world = center + (aPos.x * tangent + aPos.z * bitangent) * PLANE_EXTENT;
+    }
+
+    if (u_shadowPass != 0) {
+        gl_Position = lightClip(world);
+        return;
+    }
+
+    vWorldPos = world;
+    vNormal = normal;
+    vLightClip = lightClip(world + normal * SHADOW_NORMAL_OFFSET);
+    vMaterial = vec4(iCenterRoughness.w, iSizeMetalness.w, iNormalMaterial.w, iColorObject.w);
+    vColor = iColorObject.xyz;
+    vEmission = iEmission.xyz;
+
+    // Same pinhole model as the path tracer's getCameraRay
+    vec3 d = world - u_cameraPos;
+    float tanHalfFov = tan(radians(u_fov * 0.5));
+    float aspect = u_resolution.x / u_resolution.y;
+    float z = dot(d, u_cameraDir);
+
+    gl_Position = vec4(
+        dot(d, u_cameraRight) / (tanHalfFov * aspect),
+        dot(d, u_cameraUp) / tanHalfFov,
+        z * (u_far + u_near) / (u_far - u_near) - 2.0 * u_far * u_near / (u_far - u_near),
+        z
+    );
+}
@@ -0,0 +1,6 @@
+#version 330 core
+
+// Depth-only pass for the preview shadow map; preview.vert does the work.
+
+void main() {
+}
@@ -0,0 +1,143 @@
+#version 330 core
+
+// Edge-adaptive spatial upscaler. Reconstructs the low-resolution path traced
+// image at output resolution with a Lanczos-like kernel that is stretched
+// along local edges, then applies contrast-adaptive sharpening.
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D u_input;
+uniform vec2 u_inputSize;
+uniform vec2 u_outputSize;
+uniform float u_sharpness; // 0 = off, 1 = maximum
+
+// Optional full-resolution guide: xyz = normal, w = linear depth (0 = sky)
+uniform int u_useGuide;
+uniform sampler2D u_guide;
+uniform vec2 u_guideSize;
+
+vec3 fetchInput(ivec2 p) {
+    p = clamp(p, ivec2(0), ivec2(u_inputSize) - 1);
+    return texelFetch(u_input, p, 0).rgb;
+}
+
+float luma(vec3 c) {
+    return dot(c, vec3(0.299, 0.587, 0.114));
+}
+
+vec4 fetchGuide(vec2 outputPixel) {
+    ivec2 p = ivec2(outputPixel * u_guideSize / u_outputSize);
+    p = clamp(p, ivec2(0), ivec2(u_guideSize) - 1);
+    return texelFetch(u_guide, p, 0);
+}
+
+// Down-weights taps that lie on a different surface than the output pixel
+float guideWeight(vec4 center, vec4 tap) {
+    bool centerSky = center.w <= 0.0;
+    bool tapSky = tap.w <= 0.0;
+    if (centerSky || tapSky) {
+        return centerSky == tapSky ? 1.0 : 0.02;
+    }
+
+    float depthWeight = exp(-abs(center.w - tap.w) / (0.05 * center.w + 0.001));
+    float normalWeight = pow(max(dot(center.xyz, tap.xyz), 0.0), 8.0);
+    return max(depthWeight * normalWeight, 0.02);
+}
+
+void main() {
+    vec2 outputPixel = gl_FragCoord.xy;
+    vec2 srcPos = outputPixel * u_inputSize / u_outputSize - 0.5;
+    ivec2 base = ivec2(floor(srcPos));
+    vec2 f = srcPos - vec2(base);
+
+    // 4x4 neighbourhood around the sample position
+    vec3 c[16];
+    float l[16];
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            int idx = j * 4 + i;
+            c[idx] = fetchInput(base + ivec2(i - 1, j - 1));
+            l[idx] = luma(c[idx]);
+        }
+    }
+
+    // Bilinearly weighted luma gradient of the inner 2x2 texels
+    // (indices 5, 6, 9, 10) gives the local edge orientation
+    vec4 bw = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+    vec2 g5  = vec2(l[6]  - l[4], l[9]  - l[1]);
+    vec2 g6  = vec2(l[7]  - l[5], l[10] - l[2]);
+    vec2 g9  = vec2(l[10] - l[8], l[13] - l[5]);
+    vec2 g10 = vec2(l[11] - l[9], l[14] - l[6]);
+    vec2 grad = g5 * bw.x + g6 * bw.y + g9 * bw.z + g10 * bw.w;
+
+    // Contrast-aware edge strength: gradients are judged relative to the
+    // local luma range so low-contrast noise does not stretch the kernel
+    float lMin = min(min(l[5], l[6]), min(l[9], l[10]));
+    float lMax = max(max(l[5], l[6]), max(l[9], l[10]));
+    float gradLen = length(grad);
+    float edge = clamp(gradLen / (2.0 * (lMax - lMin) + 0.02), 0.0, 1.0);
+    edge *= edge;
+
+    vec2 across = gradLen > 1e-5 ? grad / gradLen : vec2(1.0, 0.0);
+    vec2 along = vec2(-across.y, across.x);
+
+    // Narrow across edges, wide along them
+    float scaleAcross = 1.0 + edge;
+    float scaleAlong = 1.0 / (1.0 + edge);
+
+    // Kernel lobe: sharper on edges, softer in flat regions
+    float lobe = 0.5 - 0.29 * edge;
+    float clip = 1.0 / lobe;
+
+    vec4 centerGuide = vec4(0.0);
+    if (u_useGuide != 0) {
+        centerGuide = fetchGuide(outputPixel);
+    }
+
+    vec3 sum = vec3(0.0);
+    float weightSum = 0.0;
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            int idx = j * 4 + i;
+            vec2 d = vec2(float(i - 1), float(j - 1)) - f;
+            vec2 r = vec2(dot(d, across) * scaleAcross, dot(d, along) * scaleAlong);
+            float x2 = min(dot(r, r), clip);
+
+            // Polynomial approximation of a windowed Lanczos-2 kernel
+            float window = 25.0 / 16.0 * (0.4 * x2 - 1.0) * (0.4 * x2 - 1.0) - (25.0 / 16.0 - 1.0);
+            float lanczos = (lobe * x2 - 1.0) * (lobe * x2 - 1.0);
+            float w = window * lanczos;
+
+            if (u_useGuide != 0) {
+                vec2 tapPixel = (vec2(base + ivec2(i - 1, j - 1)) + 0.5) * u_outputSize / u_inputSize;
+                w *= guideWeight(centerGuide, fetchGuide(tapPixel));
+            }
+
+            sum += c[idx] * w;
+            weightSum += w;
+        }
+    }
+
+    vec3 minC = min(min(c[5], c[6]), min(c[9], c[10]));
+    vec3 maxC = max(max(c[5], c[6]), max(c[9], c[10]));
+
+    vec3 color = weightSum > 1e-4 ? sum / weightSum : mix(mix(c[5], c[6], f.x), mix(c[9], c[10], f.x), f.y);
+
+    // Deringing: never leave the range of the nearest texels
+    color = clamp(color, minC, maxC);
+
+    // Contrast-adaptive sharpening against the bilinear reconstruction.
+    // Strength falls off where the neighbourhood is already near black or
+    // white so highlights do not clip.
+    if (u_sharpness > 0.0) {
+        vec3 bilinear = mix(mix(c[5], c[6], f.x), mix(c[9], c[10], f.x), f.y);
+        vec3 crossMin = min(minC, min(min(c[1], c[2]), min(c[4], c[7])));
+        vec3 crossMax = max(maxC, max(max(c[1], c[2]), max(c[4], c[7])));
+        vec3 headroom = min(crossMin, 1.0 - crossMax);
+        vec3 amount = sqrt(clamp(headroom / max(crossMax, vec3(1e-4)), 0.0, 1.0));
+        color = clamp(color + (color - bilinear) * amount * (2.0 * u_sharpness), crossMin, crossMax);
+    }
+
+    FragColor = vec4(color, 1.0);
+}
@@ -1,9 +0,0 @@
-#version 330 core
-
-out vec4 FragColor;
-
-uniform vec3 u_color;
-
-void main() {
-    FragColor = vec4(u_color, 1.0);
-}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Input.h"
 #include "Logger.h"
 #include "Time.h"
+#include "JobSystem.h"
 #include "renderer/Renderer.h"
 #include "scene/Scene.h"
 #include "scene/Camera.h"
@@ -14,7 +15,8 @@
 
 Application* Application::s_instance = nullptr;
 
-Application::Application() {
+Application::Application(const Options& options)
+    : m_options(options) {
     s_instance = this;
     init();
 }
@@ -30,9 +32,16 @@ void Application::init() {
     m_window = std::make_unique<Window>(1920, 1080, "MiniGPU Engine - Unreal Style Editor");
 
     Input::init(m_window->handle());
-
+    JobSystem::init();
 
     m_renderer = std::make_unique<Renderer>();
+    if (!m_options.renderWorkers.empty()) {
+        m_renderer->setRenderWorkers(m_options.renderWorkers);
+        m_renderer->setRenderBackend(RenderBackend::Distributed);
+    } else if (!m_options.checkpointPath.empty()) {
+        m_renderer->setCheckpoint(m_options.checkpointPath, m_options.checkpointInterval);
+        m_renderer->setRenderBackend(RenderBackend::Cpu);
+    }
     m_scene = std::make_unique<Scene>();
     m_camera = std::make_unique<Camera>();
     
@@ -43,9 +52,11 @@ void Application::init() {
         LOG_INFO("Shader changed: {}", path);
         m_renderer->reloadShaders();
     });
-    m_scene->createDefaultScene();
-    m_camera->setPosition({5, 5, 5});
-    m_camera->lookAt({0, 0, 0});
+    if (m_options.scenePath.empty() || !m_scene->loadFromDisk(m_options.scenePath)) {
+        m_scene->createDefaultScene();
+    }
+    m_camera->setPosition(m_options.cameraPosition);
+    m_camera->lookAt(m_options.cameraTarget);
     
     // Setup resize callback
     m_window->setResizeCallback([this](int width, int height) {
@@ -82,9 +93,16 @@ void Application::handleEvents() {
     m_window->pollEvents();
     Input::update();
     m_fileWatcher->update();
+    JobSystem::runMainThreadJobs();
 }
 
 void Application::update(float dt) {
+    // Worker utilization is reported over roughly the last second
+    m_jobStatsTimer += dt;
+    if (m_jobStatsTimer >= 1.0f) {
+        JobSystem::resetStats();
+        m_jobStatsTimer = 0.0f;
+    }
 
     m_scene->update(dt);
     m_editor->update(dt);
@@ -108,6 +126,7 @@ void Application::cleanup() {
     m_camera.reset();
     m_scene.reset();
     m_renderer.reset();
+    JobSystem::shutdown();
     m_window.reset();
     
     LOG_INFO("Application cleanup complete");
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "math/Vec3.h"
 #include <memory>
+#include <string>
+#include <vector>
 
 class Window;
 class Renderer;
@@ -11,7 +14,21 @@ class FileWatcher;
 
 class Application {
 public:
-    Application();
+    struct Options {
+        // Non-empty renderWorkers ("host:port") start on the distributed
+        // backend; a checkpoint path starts on the CPU backend, saving there
+        // every checkpointInterval seconds
+        std::vector<std::string> renderWorkers;
+        std::string checkpointPath;
+        float checkpointInterval = 60.0f;
+        // Loaded instead of the default scene. Starting again with the same
+        // scene and camera resumes a checkpoint of them.
+        std::string scenePath;
+        Vec3 cameraPosition{5, 5, 5};
+        Vec3 cameraTarget{0, 0, 0};
+    };
+
+    explicit Application(const Options& options);
     ~Application();
     
     void run();
@@ -32,8 +49,11 @@ private:
     std::unique_ptr<Camera> m_camera;
     std::unique_ptr<FileWatcher> m_fileWatcher;
     
+    Options m_options;
+    
     bool m_running = true;
     float m_lastFrameTime = 0.0f;
+    float m_jobStatsTimer = 0.0f;
     
     static Application* s_instance;
 };
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "CpuFeatures.h"
+
+#if MINIGPU_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+SimdLevel CpuFeatures::getSimdLevel() {
+    static const SimdLevel level = detect();
+    return level;
+}
+
+const char* CpuFeatures::getName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2: return "AVX2";
+        case SimdLevel::Sse:  return "SSE";
+        default:              return "Scalar";
+    }
+}
+
+SimdLevel CpuFeatures::detect() {
+#if MINIGPU_X86 && defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    
+    bool avx2 = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    
+    // XMM and YMM state must both be enabled by the OS
+    bool ymmEnabled = osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+    return avx2 && ymmEnabled ? SimdLevel::Avx2 : SimdLevel::Sse;
+#elif MINIGPU_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? SimdLevel::Avx2 : SimdLevel::Sse;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
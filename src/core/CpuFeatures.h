@@ -0,0 +1,24 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MINIGPU_X86 1
+#else
+#define MINIGPU_X86 0
+#endif
+
+// Vector instruction sets the CPU kernels can dispatch to, widest last
+enum class SimdLevel {
+    Scalar,
+    Sse,    // 4-wide, baseline on x86-64
+    Avx2    // 8-wide
+};
+
+class CpuFeatures {
+public:
+    // Detected once; includes the OS check for saved YMM state
+    static SimdLevel getSimdLevel();
+    static const char* getName(SimdLevel level);
+
+private:
+    static SimdLevel detect();
+};
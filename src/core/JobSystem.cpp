@@ -0,0 +1,364 @@
+#include "JobSystem.h"
+#include "Logger.h"
+#include "NumaTopology.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Task {
+        JobSystem::Job job;
+        JobCounter* counter = nullptr;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        int node = 0;
+
+        std::atomic<uint64_t> jobsExecuted{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> busyNanoseconds{0};
+        // Busy totals at the last two resets, for a utilization window that
+        // never shrinks below one full period
+        uint64_t busyAtReset[2] = {};
+    };
+
+    std::vector<std::unique_ptr<Worker>> s_workers;
+    std::vector<std::thread> s_threads;
+    std::atomic<bool> s_running{false};
+    std::atomic<bool> s_stop{false};
+
+    // Queued but not yet started, across all deques
+    std::atomic<int> s_queued{0};
+    std::atomic<uint32_t> s_nextQueue{0};
+
+    // Worker indices per node, and where each node's round-robin stands
+    std::vector<std::vector<int>> s_nodeWorkers;
+    std::unique_ptr<std::atomic<uint32_t>[]> s_nodeNextQueue;
+    std::mutex s_sleepMutex;
+    std::condition_variable s_wake;
+
+    std::mutex s_mainMutex;
+    std::vector<JobSystem::Job> s_mainJobs;
+
+    // Guarded by s_statsMutex
+    std::mutex s_statsMutex;
+    int64_t s_resetTime[2] = {};
+
+    thread_local int t_workerIndex = -1;
+    // Jobs run from inside wait() nest; only the outermost one counts as busy
+    thread_local int t_depth = 0;
+
+    int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    int pickQueue(int node) {
+        if (node >= 0 && s_nodeWorkers.size() > 1) {
+            node %= static_cast<int>(s_nodeWorkers.size());
+            if (t_workerIndex >= 0 && s_workers[t_workerIndex]->node == node) return t_workerIndex;
+
+            const std::vector<int>& group = s_nodeWorkers[node];
+            return group[s_nodeNextQueue[node].fetch_add(1) % group.size()];
+        }
+
+        int count = static_cast<int>(s_workers.size());
+        return t_workerIndex >= 0 ? t_workerIndex : static_cast<int>(s_nextQueue.fetch_add(1) % count);
+    }
+
+    void push(Task task, int node) {
+        int index = pickQueue(node);
+
+        {
+            std::lock_guard<std::mutex> lock(s_workers[index]->mutex);
+            s_workers[index]->tasks.push_back(std::move(task));
+        }
+        s_queued.fetch_add(1);
+
+        // Taking the sleep mutex orders this with a worker about to wait
+        { std::lock_guard<std::mutex> lock(s_sleepMutex); }
+        s_wake.notify_one();
+    }
+
+    bool pop(int self, Task& task) {
+        if (s_queued.load() == 0) return false;
+        int count = static_cast<int>(s_workers.size());
+
+        if (self >= 0) {
+            Worker& own = *s_workers[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                s_queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        // Victims on the thief's own node first, then the rest
+        int start = self >= 0 ? self + 1 : 0;
+        int node = self >= 0 ? s_workers[self]->node : -1;
+        for (int offset = 0; offset < 2 * count; ++offset) {
+            int victimIndex = (start + offset) % count;
+            if (victimIndex == self) continue;
+            bool sameNode = node < 0 || s_workers[victimIndex]->node == node;
+            if (sameNode != (offset < count)) continue;
+
+            Worker& victim = *s_workers[victimIndex];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                s_queued.fetch_sub(1);
+                if (self >= 0) s_workers[self]->steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void execute(Task& task) {
+        int64_t start = now();
+
+        ++t_depth;
+        try {
+            task.job();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Job threw: {}", e.what());
+        }
+        --t_depth;
+
+        if (t_workerIndex >= 0) {
+            Worker& worker = *s_workers[t_workerIndex];
+            if (t_depth == 0) {
+                worker.busyNanoseconds.fetch_add(static_cast<uint64_t>(now() - start), std::memory_order_relaxed);
+            }
+            worker.jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (task.counter) {
+            task.counter->pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    void workerLoop(int index) {
+        t_workerIndex = index;
+        if (s_nodeWorkers.size() > 1 && !NumaTopology::pinCurrentThread(s_workers[index]->node)) {
+            LOG_WARN("Could not pin worker {} to NUMA node {}", index, s_workers[index]->node);
+        }
+        Task task;
+
+        while (true) {
+            if (pop(index, task)) {
+                execute(task);
+                task = Task{};
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(s_sleepMutex);
+            s_wake.wait(lock, [] { return s_stop.load() || s_queued.load() > 0; });
+            if (s_stop.load() && s_queued.load() == 0) return;
+        }
+    }
+}
+
+void JobSystem::init(int workerCount) {
+    if (s_running) return;
+
+    if (workerCount <= 0) {
+        int hardware = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(1, hardware - 1);
+    }
+
+    // Workers follow the node CPU lists in order, so each node gets a share
+    // proportional to its CPUs
+    std::vector<int> cpuNodes;
+    for (int node = 0; node < NumaTopology::getNodeCount(); ++node) {
+        cpuNodes.insert(cpuNodes.end(), NumaTopology::getNodeCpus(node).size(), node);
+    }
+    if (cpuNodes.empty()) cpuNodes.push_back(0);
+
+    s_stop = false;
+    s_nodeWorkers.assign(cpuNodes.back() + 1, {});
+    for (int i = 0; i < workerCount; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->node = cpuNodes[static_cast<size_t>(i) * cpuNodes.size() / workerCount];
+        s_nodeWorkers[worker->node].push_back(i);
+        s_workers.push_back(std::move(worker));
+    }
+    // Too few workers to give every node one: run as a single group, as
+    // jobs for a node without workers would never start
+    bool everyNode = std::none_of(s_nodeWorkers.begin(), s_nodeWorkers.end(),
+                                  [](const std::vector<int>& group) { return group.empty(); });
+    if (!everyNode) {
+        s_nodeWorkers.assign(1, {});
+        for (int i = 0; i < workerCount; ++i) {
+            s_workers[i]->node = 0;
+            s_nodeWorkers[0].push_back(i);
+        }
+    }
+    s_nodeNextQueue = std::make_unique<std::atomic<uint32_t>[]>(s_nodeWorkers.size());
+    for (int i = 0; i < workerCount; ++i) {
+        s_threads.emplace_back(workerLoop, i);
+    }
+
+    s_resetTime[0] = s_resetTime[1] = now();
+    s_running = true;
+    if (s_nodeWorkers.size() > 1) {
+        LOG_INFO("Job system started with {} workers on {} NUMA nodes", workerCount, s_nodeWorkers.size());
+    } else {
+        LOG_INFO("Job system started with {} workers", workerCount);
+    }
+}
+
+void JobSystem::shutdown() {
+    if (!s_running) return;
+
+    // Jobs still queued run to completion before the workers exit
+    {
+        std::lock_guard<std::mutex> lock(s_sleepMutex);
+        s_stop = true;
+    }
+    s_wake.notify_all();
+
+    for (auto& thread : s_threads) {
+        thread.join();
+    }
+    s_threads.clear();
+    s_workers.clear();
+    s_nodeWorkers.clear();
+    s_running = false;
+
+    runMainThreadJobs();
+    LOG_INFO("Job system stopped");
+}
+
+bool JobSystem::isRunning() {
+    return s_running.load();
+}
+
+int JobSystem::getWorkerCount() {
+    return static_cast<int>(s_workers.size());
+}
+
+int JobSystem::getWorkerIndex() {
+    return t_workerIndex;
+}
+
+int JobSystem::getNodeCount() {
+    return std::max(1, static_cast<int>(s_nodeWorkers.size()));
+}
+
+int JobSystem::getCurrentNode() {
+    return t_workerIndex >= 0 ? s_workers[t_workerIndex]->node : 0;
+}
+
+void JobSystem::run(Job job, JobCounter* counter, int node) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Task task{std::move(job), counter};
+    if (!s_running) {
+        execute(task);
+        return;
+    }
+    push(std::move(task), node);
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    Task task;
+    while (!counter.isDone()) {
+        if (s_running && pop(t_workerIndex, task)) {
+            execute(task);
+            task = Task{};
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body) {
+    int count = end - begin;
+    if (count <= 0) return;
+
+    if (grainSize <= 0) {
+        // A few chunks per worker leaves room to even out uneven chunks
+        int chunks = std::max(1, getWorkerCount() + 1) * 4;
+        grainSize = std::max(1, (count + chunks - 1) / chunks);
+    }
+
+    JobCounter counter;
+    int chunkBegin = begin;
+    while (chunkBegin + grainSize < end) {
+        int chunkEnd = chunkBegin + grainSize;
+        run([&body, chunkBegin, chunkEnd] { body(chunkBegin, chunkEnd); }, &counter);
+        chunkBegin = chunkEnd;
+    }
+
+    // The caller takes the last chunk itself, then helps with the rest
+    body(chunkBegin, end);
+    wait(counter);
+}
+
+void JobSystem::runOnMainThread(Job job) {
+    std::lock_guard<std::mutex> lock(s_mainMutex);
+    s_mainJobs.push_back(std::move(job));
+}
+
+void JobSystem::runMainThreadJobs() {
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(s_mainMutex);
+        jobs.swap(s_mainJobs);
+    }
+
+    for (Job& job : jobs) {
+        try {
+            job();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Main thread job threw: {}", e.what());
+        }
+    }
+}
+
+std::vector<WorkerStats> JobSystem::getStats() {
+    std::lock_guard<std::mutex> lock(s_statsMutex);
+    double elapsed = static_cast<double>(std::max<int64_t>(now() - s_resetTime[0], 1));
+
+    std::vector<WorkerStats> stats;
+    stats.reserve(s_workers.size());
+    for (const auto& worker : s_workers) {
+        uint64_t busy = worker->busyNanoseconds.load(std::memory_order_relaxed) - worker->busyAtReset[0];
+
+        WorkerStats entry;
+        entry.node = worker->node;
+        entry.jobsExecuted = worker->jobsExecuted.load(std::memory_order_relaxed);
+        entry.steals = worker->steals.load(std::memory_order_relaxed);
+        entry.utilization = static_cast<float>(std::min(1.0, busy / elapsed));
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+void JobSystem::resetStats() {
+    std::lock_guard<std::mutex> lock(s_statsMutex);
+    for (auto& worker : s_workers) {
+        worker->jobsExecuted = 0;
+        worker->steals = 0;
+        worker->busyAtReset[0] = worker->busyAtReset[1];
+        worker->busyAtReset[1] = worker->busyNanoseconds.load(std::memory_order_relaxed);
+    }
+    s_resetTime[0] = s_resetTime[1];
+    s_resetTime[1] = now();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Fork-join handle: every job queued against a counter holds it above zero
+// until the job returns. A job may queue children on its own counter and
+// wait on it, nesting as deep as needed.
+struct JobCounter {
+    std::atomic<int> pending{0};
+
+    bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+struct WorkerStats {
+    int node = 0;
+    // Since the last resetStats
+    uint64_t jobsExecuted = 0;
+    uint64_t steals = 0;
+    // Busy fraction of wall time since the reset before last, so the window
+    // always spans at least one full reset period
+    float utilization = 0.0f;
+};
+
+// Shared worker pool sized to the hardware. Each worker owns a deque it
+// pushes and pops at the back, so a job's children run hot in cache on the
+// same core; idle workers steal the oldest job from the front of another's.
+// Jobs queued from outside the pool are dealt round-robin. Waiting threads
+// execute queued jobs instead of blocking.
+//
+// On NUMA machines workers are split into one group per node, in
+// proportion to the node's CPUs, and pinned to that node's CPUs. Jobs may
+// name the node whose memory they work on; idle workers steal from their
+// own node before reaching across the interconnect.
+//
+// GL calls must stay on the main thread: jobs hand that work back through
+// runOnMainThread, which Application drains once per frame.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // One worker per hardware thread besides the main one by default
+    static void init(int workerCount = 0);
+    static void shutdown();
+
+    static bool isRunning();
+    static int getWorkerCount();
+    // Index of the calling pool thread, -1 elsewhere
+    static int getWorkerIndex();
+
+    // NUMA nodes with workers, at least 1
+    static int getNodeCount();
+    // Node of the calling pool thread, 0 elsewhere
+    static int getCurrentNode();
+
+    // Runs inline when the pool is not running. A job given a node is
+    // queued with that node's workers; -1 queues it anywhere.
+    static void run(Job job, JobCounter* counter = nullptr, int node = -1);
+    static void wait(JobCounter& counter);
+
+    // Splits [begin, end) into chunks of grainSize (picked automatically when
+    // 0) and returns once body has run over all of them
+    static void parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body);
+
+    // Main-thread continuations, safe to queue from any thread
+    static void runOnMainThread(Job job);
+    static void runMainThreadJobs();
+
+    static std::vector<WorkerStats> getStats();
+    static void resetStats();
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "JobSystem.h"
+#include <memory>
+#include <mutex>
+
+// Per-NUMA-node copies of read-only data. The first worker on each node to
+// ask copies the source, so the copy's pages are first-touched on that
+// node; node 0 and threads outside the pool read the source itself. The
+// source must outlive this and stay unchanged.
+template <typename T>
+class NodeReplicas {
+public:
+    explicit NodeReplicas(const T& source)
+        : m_source(source),
+          m_nodeCount(JobSystem::getNodeCount()),
+          m_copies(std::make_unique<std::unique_ptr<const T>[]>(m_nodeCount)),
+          m_once(std::make_unique<std::once_flag[]>(m_nodeCount)) {}
+
+    NodeReplicas(const NodeReplicas&) = delete;
+    NodeReplicas& operator=(const NodeReplicas&) = delete;
+
+    // The copy local to the calling thread
+    const T& get() const {
+        int node = JobSystem::getCurrentNode();
+        if (node <= 0 || node >= m_nodeCount) return m_source;
+
+        std::call_once(m_once[node], [&] { m_copies[node] = std::make_unique<const T>(m_source); });
+        return *m_copies[node];
+    }
+
+    const T& getSource() const { return m_source; }
+
+private:
+    const T& m_source;
+    int m_nodeCount;
+    std::unique_ptr<std::unique_ptr<const T>[]> m_copies;
+    std::unique_ptr<std::once_flag[]> m_once;
+};
@@ -0,0 +1,196 @@
+#include "NumaTopology.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    std::atomic<bool> s_hugePages{false};
+
+#ifdef __linux__
+    // From <numaif.h>, which needs libnuma's headers
+    constexpr int MPOL_PREFERRED_MODE = 1;
+    constexpr size_t MAX_NODES = 1024;
+
+    size_t pageSize() {
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+#endif
+}
+
+int NumaTopology::getNodeCount() {
+    return static_cast<int>(getNodes().size());
+}
+
+const std::vector<int>& NumaTopology::getNodeCpus(int node) {
+    return getNodes()[std::clamp(node, 0, getNodeCount() - 1)].cpus;
+}
+
+const std::vector<NumaTopology::Node>& NumaTopology::getNodes() {
+    static const std::vector<Node> nodes = detect();
+    return nodes;
+}
+
+bool NumaTopology::parseCpuList(const char* text, std::vector<int>& cpus) {
+    // Comma-separated CPUs and ranges, such as "0-15,32-47"
+    const char* p = text;
+    while (*p && *p != '\n') {
+        char* end = nullptr;
+        long first = std::strtol(p, &end, 10);
+        if (end == p || first < 0) return false;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first) return false;
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        if (*p == ',') ++p;
+    }
+    return true;
+}
+
+std::vector<NumaTopology::Node> NumaTopology::detect() {
+    std::vector<Node> nodes;
+
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            !std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+
+        std::ifstream file(entry.path() / "cpulist");
+        std::string line;
+        std::getline(file, line);
+
+        Node node;
+        node.id = std::atoi(name.c_str() + 4);
+        if (!parseCpuList(line.c_str(), node.cpus)) {
+            LOG_WARN("Unreadable CPU list for NUMA node {}: '{}'", node.id, line);
+            continue;
+        }
+        if (haveMask) {
+            std::erase_if(node.cpus, [&](int cpu) { return cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed); });
+        }
+        // Memory-only nodes have no CPUs to run workers on
+        if (!node.cpus.empty()) {
+            nodes.push_back(std::move(node));
+        }
+    }
+
+    std::sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) { return a.id < b.id; });
+#endif
+
+    if (nodes.empty()) {
+        nodes.push_back(Node{});
+    }
+    if (nodes.size() > 1) {
+        LOG_INFO("NUMA topology: {} nodes", nodes.size());
+    }
+    return nodes;
+}
+
+bool NumaTopology::pinCurrentThread(int node) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : getNodeCpus(node)) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    if (CPU_COUNT(&set) == 0) return false;
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+void* NumaTopology::allocate(size_t bytes) {
+    if (bytes == 0) return nullptr;
+
+#ifdef __linux__
+    void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) throw std::bad_alloc();
+    if (s_hugePages.load() && bytes >= HUGE_PAGE_SIZE) {
+        madvise(data, bytes, MADV_HUGEPAGE);
+    }
+    return data;
+#else
+    void* data = ::operator new(bytes, std::align_val_t{4096});
+    std::memset(data, 0, bytes);
+    return data;
+#endif
+}
+
+void NumaTopology::deallocate(void* data, size_t bytes) {
+    if (!data) return;
+
+#ifdef __linux__
+    munmap(data, bytes);
+#else
+    (void)bytes;
+    ::operator delete(data, std::align_val_t{4096});
+#endif
+}
+
+void NumaTopology::bindToNode(void* data, size_t bytes, int node) {
+#ifdef __linux__
+    if (getNodeCount() < 2 || bytes == 0) return;
+
+    // Whole pages only; a page shared with the neighbouring range keeps
+    // whichever placement it gets first
+    uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+    uintptr_t end = begin + bytes;
+    size_t page = pageSize();
+    begin = (begin + page - 1) & ~(page - 1);
+    end &= ~(page - 1);
+    if (end <= begin) return;
+
+    int id = getNodes()[std::clamp(node, 0, getNodeCount() - 1)].id;
+    if (id < 0 || static_cast<size_t>(id) >= MAX_NODES) return;
+
+    unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long))] = {};
+    mask[id / (8 * sizeof(unsigned long))] = 1ul << (id % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED_MODE, mask, MAX_NODES, 0) != 0) {
+        LOG_DEBUG("mbind to NUMA node {} failed", id);
+    }
+#else
+    (void)data;
+    (void)bytes;
+    (void)node;
+#endif
+}
+
+void NumaTopology::setHugePagesEnabled(bool enabled) {
+    s_hugePages = enabled;
+}
+
+bool NumaTopology::isHugePagesEnabled() {
+    return s_hugePages.load();
+}
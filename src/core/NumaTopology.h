@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// NUMA nodes this process may run on, read once from
+// /sys/devices/system/node. Nodes are numbered from 0 in the order found
+// and only those with usable CPUs count; without sysfs (or off Linux)
+// everything is one node and the placement calls do nothing.
+class NumaTopology {
+public:
+    static int getNodeCount();
+    // CPUs of node, limited to the process's affinity mask
+    static const std::vector<int>& getNodeCpus(int node);
+
+    // Restricts the calling thread to the CPUs of node
+    static bool pinCurrentThread(int node);
+
+    // Zeroed, page-aligned memory straight from the OS, so its pages are
+    // placed by the policy set with bindToNode or by first touch. Huge
+    // pages are used for buffers of at least HUGE_PAGE_SIZE when enabled.
+    static void* allocate(size_t bytes);
+    static void deallocate(void* data, size_t bytes);
+
+    // Places the untouched whole pages within [data, data + bytes) on node
+    static void bindToNode(void* data, size_t bytes, int node);
+
+    // Off by default: transparent huge pages cut TLB misses on large
+    // accumulation buffers but may hold memory the buffer never touches
+    static void setHugePagesEnabled(bool enabled);
+    static bool isHugePagesEnabled();
+
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+private:
+    struct Node {
+        int id = 0;     // The kernel's node number
+        std::vector<int> cpus;
+    };
+
+    static const std::vector<Node>& getNodes();
+    static std::vector<Node> detect();
+    static bool parseCpuList(const char* text, std::vector<int>& cpus);
+};
@@ -64,9 +64,9 @@ void Editor::updateEditor(float dt) {
     m_selectionManager->update();
     
     if (m_selectionManager->hasSelection()) {
-        Object* selectedObject = m_selectionManager->getSelectedObject();
-        if (selectedObject) {
-            m_transformGizmo->update(*selectedObject, m_camera);
+        Transform* transform = m_scene.getTransform(m_selectionManager->getSelectedObject());
+        if (transform) {
+            m_transformGizmo->update(*transform, m_camera);
         }
     }
     
@@ -74,17 +74,16 @@ void Editor::updateEditor(float dt) {
 }
 
 void Editor::renderEditor() {
-    m_renderer.render(m_scene, m_camera);
+    // The scene itself is traced by the Viewport into its framebuffer, along
+    // with selection outlines; a second full-window pass here would be
+    // hidden behind the dockspace.
     
     if (m_selectionManager->hasSelection() && (m_gizmoActive || m_mode == EditorMode::Edit)) {
-        Object* selectedObject = m_selectionManager->getSelectedObject();
-        if (selectedObject) {
+        if (m_scene.isValid(m_selectionManager->getSelectedObject())) {
             m_transformGizmo->render(m_renderer, m_camera);
         }
     }
     
-    m_selectionManager->renderSelection(m_renderer, m_camera);
-    
     m_gui->render();
 }
 
@@ -181,43 +180,40 @@ void Editor::deactivateGizmo() {
 
 void Editor::createPrimitive(ObjectType type) {
     std::string name;
-    std::unique_ptr<Object> object;
-    
-    // Generate unique name
-    int objectCount = m_scene.getObjectCount();
+    Object object;
     
     switch (type) {
         case ObjectType::Sphere:
-            name = "Sphere_" + std::to_string(objectCount);
-            object = std::make_unique<Object>(name, type);
+            name = m_scene.makeUniqueName("Sphere");
+            object = Object(name, type);
             
             // Set default properties for sphere
-            object->getTransform().position = {0, 1, 0};
-            object->getTransform().scale = {1, 1, 1};
-            object->getMaterial().color = generateRandomColor();
-            object->getMaterial().type = MaterialType::Diffuse;
+            object.getTransform().position = {0, 1, 0};
+            object.getTransform().scale = {1, 1, 1};
+            object.getMaterial().color = generateRandomColor();
+            object.getMaterial().type = MaterialType::Diffuse;
             break;
             
         case ObjectType::Cube:
-            name = "Cube_" + std::to_string(objectCount);
-            object = std::make_unique<Object>(name, type);
+            name = m_scene.makeUniqueName("Cube");
+            object = Object(name, type);
             
             // Set default properties for cube
-            object->getTransform().position = {0, 0.5f, 0};
-            object->getTransform().scale = {1, 1, 1};
-            object->getMaterial().color = generateRandomColor();
-            object->getMaterial().type = MaterialType::Diffuse;
+            object.getTransform().position = {0, 0.5f, 0};
+            object.getTransform().scale = {1, 1, 1};
+            object.getMaterial().color = generateRandomColor();
+            object.getMaterial().type = MaterialType::Diffuse;
             break;
             
         case ObjectType::Plane:
-            name = "Plane_" + std::to_string(objectCount);
-            object = std::make_unique<Object>(name, type);
+            name = m_scene.makeUniqueName("Plane");
+            object = Object(name, type);
             
             // Set default properties for plane
-            object->getTransform().position = {0, 0, 0};
-            object->getTransform().scale = {10, 1, 10};
-            object->getMaterial().color = Vec3{0.8f, 0.8f, 0.8f};
-            object->getMaterial().type = MaterialType::Diffuse;
+            object.getTransform().position = {0, 0, 0};
+            object.getTransform().scale = {10, 1, 10};
+            object.getMaterial().color = Vec3{0.8f, 0.8f, 0.8f};
+            object.getMaterial().type = MaterialType::Diffuse;
             break;
             
         default:
@@ -234,13 +230,12 @@ void Editor::createPrimitive(ObjectType type) {
     
     // Make sure the Y coordinate is reasonable (for planes, keep at 0)
     if (type != ObjectType::Plane) {
-        object->getTransform().position = placementPos;
+        object.getTransform().position = placementPos;
     }
     
     // Add to scene and select it
-    Object* rawPtr = object.get();
-    m_scene.addObject(std::move(object));
-    m_selectionManager->selectObject(rawPtr);
+    ObjectHandle handle = m_scene.addObject(std::move(object));
+    m_selectionManager->selectObject(handle);
     
     // Activate transform gizmo
     m_gizmoActive = true;
@@ -256,19 +251,16 @@ void Editor::deleteSelectedObject() {
         return;
     }
     
-    Object* selectedObject = m_selectionManager->getSelectedObject();
-    if (!selectedObject) {
+    ObjectHandle selectedObject = m_selectionManager->getSelectedObject();
+    const std::string* name = m_scene.getName(selectedObject);
+    if (!name) {
         return;
     }
     
-    std::string objectName = selectedObject->getName();
-    int index = m_scene.getObjectIndex(selectedObject);
-    
-    if (index >= 0) {
-        m_selectionManager->deselectAll();
-        m_scene.removeObject(index);
-        LOG_INFO("Deleted object '{}'", objectName);
-    }
+    std::string objectName = *name;
+    m_selectionManager->deselectAll();
+    m_scene.removeObject(selectedObject);
+    LOG_INFO("Deleted object '{}'", objectName);
 }
 
 void Editor::duplicateSelectedObject() {
@@ -276,30 +268,25 @@ void Editor::duplicateSelectedObject() {
         return;
     }
     
-    Object* selectedObject = m_selectionManager->getSelectedObject();
-    if (!selectedObject) {
+    int index = m_scene.getObjectIndex(m_selectionManager->getSelectedObject());
+    if (index < 0) {
         return;
     }
     
     // Create a new object with the same properties
-    std::string newName = selectedObject->getName() + "_Copy";
-    std::unique_ptr<Object> newObject = std::make_unique<Object>(newName, selectedObject->getType());
-    
-    // Copy transform
-    newObject->getTransform() = selectedObject->getTransform();
+    Object newObject = m_scene.getObject(index);
+    std::string originalName = newObject.getName();
+    std::string newName = originalName + "_Copy";
+    newObject.setName(newName);
     
     // Offset position slightly to avoid overlapping
-    newObject->getTransform().position.x += 2.0f;
-    
-    // Copy material
-    newObject->getMaterial() = selectedObject->getMaterial();
+    newObject.getTransform().position.x += 2.0f;
     
     // Add to scene and select it
-    Object* rawPtr = newObject.get();
-    m_scene.addObject(std::move(newObject));
-    m_selectionManager->selectObject(rawPtr);
+    ObjectHandle handle = m_scene.addObject(std::move(newObject));
+    m_selectionManager->selectObject(handle);
     
-    LOG_INFO("Duplicated object '{}' to '{}'", selectedObject->getName(), newName);
+    LOG_INFO("Duplicated object '{}' to '{}'", originalName, newName);
 }
 
 void Editor::focusOnSelectedObject() {
@@ -307,16 +294,14 @@ void Editor::focusOnSelectedObject() {
         return;
     }
     
-    Object* selectedObject = m_selectionManager->getSelectedObject();
-    if (!selectedObject) {
+    int index = m_scene.getObjectIndex(m_selectionManager->getSelectedObject());
+    if (index < 0) {
         return;
     }
     
-    const Vec3& position = selectedObject->getTransform().position;
-    float radius = selectedObject->getTransform().scale.x;
-    
-    m_editorCamera->focusOnObject(position, radius);
-    LOG_INFO("Focused camera on object '{}'", selectedObject->getName());
+    const Transform& transform = m_scene.getTransforms()[index];
+    m_editorCamera->focusOnObject(transform.position, transform.scale.x);
+    LOG_INFO("Focused camera on object '{}'", m_scene.getName(index));
 }
 
 Vec3 Editor::generateRandomColor() {
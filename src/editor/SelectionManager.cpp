@@ -1,158 +1,146 @@
 #include "SelectionManager.h"
 #include "core/Input.h"
 #include "scene/Scene.h"
-#include "scene/Object.h"
 #include "core/Logger.h"
 #include "scene/Camera.h"
 #include "renderer/Renderer.h"
 #include "math/Ray.h"
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <limits>
 #include <imgui.h>
 
 SelectionManager::SelectionManager(Scene& scene) : m_scene(scene) {
 }
 
 void SelectionManager::update() {
+    // Objects can be removed from anywhere (outliner, inspector, loads);
+    // their handles go stale and are dropped here
+    std::erase_if(m_selectedObjects, [this](ObjectHandle object) { return !m_scene.isValid(object); });
+    if (!m_scene.isValid(m_hoveredObject)) {
+        m_hoveredObject = ObjectHandle{};
+    }
+    
     if (ImGui::GetIO().WantCaptureMouse) {
         return;
     }
 }
 
-void SelectionManager::renderSelection(Renderer& renderer, Camera& camera) {
-    for (Object* object : m_selectedObjects) {
-        if (object) {
-            renderer.renderSelectionOutline(*object, camera);
+void SelectionManager::renderSelection(Renderer& renderer) {
+    std::vector<int> selected;
+    selected.reserve(m_selectedObjects.size());
+    for (ObjectHandle object : m_selectedObjects) {
+        int index = m_scene.getObjectIndex(object);
+        if (index >= 0) {
+            selected.push_back(index);
         }
     }
     
-    if (m_hoveredObject && std::find(m_selectedObjects.begin(), m_selectedObjects.end(), m_hoveredObject) == m_selectedObjects.end()) {
-        renderer.renderHoverOutline(*m_hoveredObject, camera);
+    int hovered = -1;
+    if (std::find(m_selectedObjects.begin(), m_selectedObjects.end(), m_hoveredObject) == m_selectedObjects.end()) {
+        hovered = m_scene.getObjectIndex(m_hoveredObject);
     }
+    
+    renderer.setOutlinedObjects(selected, hovered);
 }
 
-void SelectionManager::selectObject(Object* object) {
-    if (!object) {
-        LOG_WARN("SelectionManager::selectObject called with null object");
+void SelectionManager::selectObject(ObjectHandle object) {
+    const std::string* name = m_scene.getName(object);
+    if (!name) {
+        LOG_WARN("SelectionManager::selectObject called with a stale object handle");
         return;
     }
     
     // First deselect all objects
-    for (Object* obj : m_selectedObjects) {
-        if (obj) {
-            obj->setSelected(false);
-        }
+    for (ObjectHandle obj : m_selectedObjects) {
+        m_scene.setSelected(obj, false);
     }
     
     // Clear list and add new object
     m_selectedObjects.clear();
     m_selectedObjects.push_back(object);
-    object->setSelected(true);
+    m_scene.setSelected(object, true);
     
     // Set selected object in scene (important!)
     m_scene.setSelectedObject(object);
     
-    LOG_INFO("Object '{}' selected", object->getName());
+    LOG_INFO("Object '{}' selected", *name);
 }
 
 void SelectionManager::deselectAll() {
-    for (Object* obj : m_selectedObjects) {
-        if (obj) obj->setSelected(false);
+    for (ObjectHandle obj : m_selectedObjects) {
+        m_scene.setSelected(obj, false);
     }
     
     m_selectedObjects.clear();
-    m_scene.setSelectedObject(nullptr);
+    m_scene.setSelectedObject(ObjectHandle{});
 }
 
-void SelectionManager::addToSelection(Object* object) {
-    if (!object) return;
+void SelectionManager::addToSelection(ObjectHandle object) {
+    if (!m_scene.isValid(object)) return;
     
     auto it = std::find(m_selectedObjects.begin(), m_selectedObjects.end(), object);
     if (it == m_selectedObjects.end()) {
         m_selectedObjects.push_back(object);
-        object->setSelected(true);
+        m_scene.setSelected(object, true);
     }
 }
 
-void SelectionManager::removeFromSelection(Object* object) {
-    if (!object) return;
-    
+void SelectionManager::removeFromSelection(ObjectHandle object) {
     auto it = std::find(m_selectedObjects.begin(), m_selectedObjects.end(), object);
     if (it != m_selectedObjects.end()) {
         m_selectedObjects.erase(it);
-        object->setSelected(false);
+        m_scene.setSelected(object, false);
     }
 }
 
-Object* SelectionManager::getSelectedObject() const {
-    return m_selectedObjects.empty() ? nullptr : m_selectedObjects[0];
+ObjectHandle SelectionManager::getSelectedObject() const {
+    return m_selectedObjects.empty() ? ObjectHandle{} : m_selectedObjects[0];
 }
 
-Object* SelectionManager::pickObject(const Ray& ray) {
-    float closestDistance = std::numeric_limits<float>::max();
-    Object* closestObject = nullptr;
-    
-    const auto& objects = m_scene.getObjects();
-    LOG_DEBUG("Ray picking, checking {} objects", objects.size());
+ObjectHandle SelectionManager::pickObject(const Ray& ray) {
+    RayHit hit;
+    m_scene.intersect({&ray, 1}, {&hit, 1});
+    if (!hit.isHit() || hit.t <= 0.001f) {
+        return ObjectHandle{};
+    }
     
-    for (const auto& obj : objects) {
-        float distance;
-        bool hit = false;
-        
-        Vec3 position = obj->getTransform().position;
-        Vec3 scale = obj->getTransform().scale;
-        
-        switch (obj->getType()) {
-            case ObjectType::Sphere: {
-                float radius = scale.x;
-                hit = rayIntersectSphere(ray, position, radius, distance);
-                break;
-            }
-            case ObjectType::Plane: {
-                Vec3 normal{0, 1, 0};
-                hit = rayIntersectPlane(ray, position, normal, distance);
-                break;
-            }
-            case ObjectType::Cube: {
-                Vec3 halfExtents = scale * 0.5f;
-                Vec3 minBounds = position - halfExtents;
-                Vec3 maxBounds = position + halfExtents;
-                hit = rayIntersectAABB(ray, minBounds, maxBounds, distance);
-                break;
-            }
-        }
-        
-        if (hit && distance < closestDistance && distance > 0.001f) {
-            closestDistance = distance;
-            closestObject = obj.get();
-            LOG_DEBUG("Hit object '{}' at distance {}", obj->getName(), distance);
-        }
+    const std::string* name = m_scene.getName(hit.object);
+    if (!name) {
+        return ObjectHandle{};
     }
     
-    return closestObject;
+    LOG_DEBUG("Hit object '{}' at distance {}", *name, hit.t);
+    return hit.object;
 }
 
 void SelectionManager::handleMousePicking(const Vec2& mousePos, const Camera& camera) {
     Ray ray = camera.screenPointToRay(mousePos);
-    Object* hitObject = pickObject(ray);
-    
-    bool isDoubleClick = Input::isMouseButtonDoubleClicked(GLFW_MOUSE_BUTTON_LEFT);
-    
-    if (hitObject) {
-        LOG_INFO("Ray hit object '{}'", hitObject->getName());
+    applyPick(pickObject(ray), Input::isMouseButtonDoubleClicked(GLFW_MOUSE_BUTTON_LEFT));
+}
+
+void SelectionManager::handlePickedObject(ObjectHandle object, bool isDoubleClick) {
+    // An object removed since it was drawn counts as a miss
+    applyPick(object, isDoubleClick);
+}
+
+void SelectionManager::applyPick(ObjectHandle hitObject, bool isDoubleClick) {
+    int index = m_scene.getObjectIndex(hitObject);
+    if (index >= 0) {
+        const std::string& name = m_scene.getName(index);
+        LOG_INFO("Ray hit object '{}'", name);
         
         if (isDoubleClick) {
-            LOG_INFO("Double click on object '{}'", hitObject->getName());
+            LOG_INFO("Double click on object '{}'", name);
             
             // Always select on double click
             selectObject(hitObject);
             
             // Focus camera on double-clicked object
             if (m_objectFocusCallback) {
-                Vec3 position = hitObject->getTransform().position;
-                float radius = hitObject->getTransform().scale.x;
-                LOG_INFO("Focusing camera on object '{}'", hitObject->getName());
-                m_objectFocusCallback(position, radius);
+                const Transform& transform = m_scene.getTransforms()[index];
+                LOG_INFO("Focusing camera on object '{}'", name);
+                m_objectFocusCallback(transform.position, transform.scale.x);
             }
             
             // Activate transform gizmo (this will be picked up by Editor)
@@ -182,11 +170,12 @@ void SelectionManager::getSelectionBounds(Vec3& minBounds, Vec3& maxBounds) cons
     minBounds = Vec3{std::numeric_limits<float>::max()};
     maxBounds = Vec3{std::numeric_limits<float>::lowest()};
     
-    for (Object* obj : m_selectedObjects) {
-        if (!obj) continue;
+    for (ObjectHandle obj : m_selectedObjects) {
+        int index = m_scene.getObjectIndex(obj);
+        if (index < 0) continue;
         
-        Vec3 pos = obj->getTransform().position;
-        Vec3 scale = obj->getTransform().scale;
+        Vec3 pos = m_scene.getTransforms()[index].position;
+        Vec3 scale = m_scene.getTransforms()[index].scale;
         
         Vec3 objMin = pos - scale * 0.5f;
         Vec3 objMax = pos + scale * 0.5f;
@@ -200,56 +189,3 @@ void SelectionManager::getSelectionBounds(Vec3& minBounds, Vec3& maxBounds) cons
         maxBounds.z = std::max(maxBounds.z, objMax.z);
     }
 }
-
-bool SelectionManager::rayIntersectSphere(const Ray& ray, const Vec3& center, float radius, float& distance) {
-    Vec3 oc = ray.origin - center;
-    float a = dot(ray.direction, ray.direction);
-    float b = 2.0f * dot(oc, ray.direction);
-    float c = dot(oc, oc) - radius * radius;
-    
-    float discriminant = b * b - 4.0f * a * c;
-    if (discriminant < 0) return false;
-    
-    float sqrtD = std::sqrt(discriminant);
-    float t1 = (-b - sqrtD) / (2.0f * a);
-    float t2 = (-b + sqrtD) / (2.0f * a);
-    
-    // Use nearest positive intersection
-    if (t1 > 0.001f) {
-        distance = t1;
-        return true;
-    }
-    
-    if (t2 > 0.001f) {
-        distance = t2;
-        return true;
-    }
-    
-    return false;
-}
-
-bool SelectionManager::rayIntersectPlane(const Ray& ray, const Vec3& point, const Vec3& normal, float& distance) {
-    float denom = dot(normal, ray.direction);
-    if (std::abs(denom) < 0.0001f) return false;
-    
-    distance = dot(point - ray.origin, normal) / denom;
-    return distance > 0.001f;
-}
-
-bool SelectionManager::rayIntersectAABB(const Ray& ray, const Vec3& minBounds, const Vec3& maxBounds, float& distance) {
-    Vec3 invDir = Vec3{1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z};
-    
-    Vec3 t1 = (minBounds - ray.origin) * invDir;
-    Vec3 t2 = (maxBounds - ray.origin) * invDir;
-    
-    Vec3 tMin = Vec3{std::min(t1.x, t2.x), std::min(t1.y, t2.y), std::min(t1.z, t2.z)};
-    Vec3 tMax = Vec3{std::max(t1.x, t2.x), std::max(t1.y, t2.y), std::max(t1.z, t2.z)};
-    
-    float tNear = std::max(std::max(tMin.x, tMin.y), tMin.z);
-    float tFar = std::min(std::min(tMax.x, tMax.y), tMax.z);
-    
-    if (tNear > tFar || tFar < 0) return false;
-    
-    distance = tNear > 0 ? tNear : tFar;
-    return distance > 0.001f;
-}
\ No newline at end of file
@@ -3,12 +3,12 @@
 #include "math/Vec2.h"
 #include "math/Vec3.h"
 #include "math/Ray.h"
+#include "scene/ObjectHandle.h"
 #include <vector>
 #include <memory>
 #include <functional>
 
 class Scene;
-class Object;
 class Camera;
 class Renderer;
 
@@ -17,7 +17,7 @@ using ObjectFocusCallback = std::function<void(const Vec3& position, float radiu
 using GizmoActivateCallback = std::function<void()>;
 
 struct SelectionInfo {
-    Object* object = nullptr;
+    ObjectHandle object;
     float distance = 0.0f;
     Vec3 hitPoint{0, 0, 0};
 };
@@ -28,39 +28,40 @@ public:
     ~SelectionManager() = default;
     
     void update();
-    void renderSelection(Renderer& renderer, Camera& camera);
+    // Hands the current selection to the renderer's outline pass
+    void renderSelection(Renderer& renderer);
     
     // Callback setters
     void setObjectFocusCallback(const ObjectFocusCallback& callback) { m_objectFocusCallback = callback; }
     void setGizmoActivateCallback(const GizmoActivateCallback& callback) { m_activateGizmoCallback = callback; }
     
     // Selection methods
-    void selectObject(Object* object);
+    void selectObject(ObjectHandle object);
     void deselectAll();
-    void addToSelection(Object* object);
-    void removeFromSelection(Object* object);
+    void addToSelection(ObjectHandle object);
+    void removeFromSelection(ObjectHandle object);
     
-    // Queries
+    // Queries. Handles of objects removed since they were selected are
+    // dropped at the next update().
     bool hasSelection() const { return !m_selectedObjects.empty(); }
-    Object* getSelectedObject() const;
-    const std::vector<Object*>& getSelectedObjects() const { return m_selectedObjects; }
+    ObjectHandle getSelectedObject() const;
+    const std::vector<ObjectHandle>& getSelectedObjects() const { return m_selectedObjects; }
     
-    // Mouse picking
-    Object* pickObject(const Ray& ray);
+    // Mouse picking; a null handle for a miss
+    ObjectHandle pickObject(const Ray& ray);
     void handleMousePicking(const Vec2& mousePos, const Camera& camera);
+    // Applies a pick resolved through the renderer's object-id buffer
+    void handlePickedObject(ObjectHandle object, bool isDoubleClick);
     
     // Bounds calculation
     void getSelectionBounds(Vec3& minBounds, Vec3& maxBounds) const;
 
 private:
-    // Ray intersection helpers
-    bool rayIntersectSphere(const Ray& ray, const Vec3& center, float radius, float& distance);
-    bool rayIntersectPlane(const Ray& ray, const Vec3& point, const Vec3& normal, float& distance);
-    bool rayIntersectAABB(const Ray& ray, const Vec3& minBounds, const Vec3& maxBounds, float& distance);
+    void applyPick(ObjectHandle hitObject, bool isDoubleClick);
     
     Scene& m_scene;
-    std::vector<Object*> m_selectedObjects;
-    Object* m_hoveredObject = nullptr;
+    std::vector<ObjectHandle> m_selectedObjects;
+    ObjectHandle m_hoveredObject;
     
     // Callbacks
     ObjectFocusCallback m_objectFocusCallback;
@@ -1,5 +1,5 @@
 #include "TransformGizmo.h"
-#include "scene/Object.h"
+#include "scene/Transform.h"
 #include "scene/Camera.h"
 #include "renderer/Renderer.h"
 #include "core/Input.h"
@@ -10,16 +10,16 @@
 TransformGizmo::TransformGizmo() {
 }
 
-void TransformGizmo::update(Object& object, Camera& camera) {
-    updateGizmoMatrices(object, camera);
-    handleGizmoInteraction(object, camera);
+void TransformGizmo::update(Transform& transform, Camera& camera) {
+    updateGizmoMatrices(transform, camera);
+    handleGizmoInteraction(transform, camera);
 }
 
 void TransformGizmo::render(Renderer& renderer, Camera& camera) {
     // ImGuizmo be rendered in GUI system
 }
 
-void TransformGizmo::handleGizmoInteraction(Object& object, Camera& camera) {
+void TransformGizmo::handleGizmoInteraction(Transform& transform, Camera& camera) {
     ImGuiIO& io = ImGui::GetIO();
     
     ImGuizmo::SetOrthographic(false);
@@ -35,7 +35,6 @@ void TransformGizmo::handleGizmoInteraction(Object& object, Camera& camera) {
     Mat4 proj = camera.getProjectionMatrix(windowSize.x / windowSize.y);
     
     // Object transform matrix
-    Transform& transform = object.getTransform();
     Mat4 model = Mat4::translate(transform.position) * 
                  Mat4::scale(transform.scale);
     
@@ -89,8 +88,7 @@ void TransformGizmo::handleGizmoInteraction(Object& object, Camera& camera) {
     m_isHovered = ImGuizmo::IsOver();
 }
 
-void TransformGizmo::updateGizmoMatrices(const Object& object, const Camera& camera) {
-    const Transform& transform = object.getTransform();
+void TransformGizmo::updateGizmoMatrices(const Transform& transform, const Camera& camera) {
     m_gizmoPosition = transform.position;
     
     float distance = (camera.getPosition() - m_gizmoPosition).length();
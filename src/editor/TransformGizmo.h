@@ -3,7 +3,7 @@
 #include "math/Vec3.h"
 #include "math/Mat4.h"
 
-class Object;
+struct Transform;
 class Camera;
 class Renderer;
 
@@ -23,7 +23,7 @@ public:
     TransformGizmo();
     ~TransformGizmo() = default;
     
-    void update(Object& object, Camera& camera);
+    void update(Transform& transform, Camera& camera);
     void render(Renderer& renderer, Camera& camera);
     
     // Mode and space
@@ -45,8 +45,8 @@ public:
     bool isHovered() const { return m_isHovered; }
 
 private:
-    void handleGizmoInteraction(Object& object, Camera& camera);
-    void updateGizmoMatrices(const Object& object, const Camera& camera);
+    void handleGizmoInteraction(Transform& transform, Camera& camera);
+    void updateGizmoMatrices(const Transform& transform, const Camera& camera);
     
     Vec3 snapVector(const Vec3& value) const;
     float snapFloat(float value) const;
@@ -1,11 +1,12 @@
 #include "ContentBrowser.h"
+#include "scene/Scene.h"
 #include <imgui.h>
 #include <filesystem>
 
 ContentBrowser::ContentBrowser() : m_currentPath("assets") {
 }
 
-void ContentBrowser::show() {
+void ContentBrowser::show(Scene& scene) {
     ImGui::Begin("Content Browser");
     
     showPathBar();
@@ -23,7 +24,7 @@ void ContentBrowser::show() {
         
         // File grid
         ImGui::TableNextColumn();
-        showFileGrid();
+        showFileGrid(scene);
         
         ImGui::EndTable();
     }
@@ -70,7 +71,7 @@ void ContentBrowser::showDirectoryTree() {
     }
 }
 
-void ContentBrowser::showFileGrid() {
+void ContentBrowser::showFileGrid(Scene& scene) {
     ImGui::Text("Files in: %s", m_currentPath.c_str());
     ImGui::Separator();
     
@@ -86,6 +87,9 @@ void ContentBrowser::showFileGrid() {
                     else if (ext == ".png" || ext == ".jpg" || ext == ".jpeg") icon = "🖼️";
                     else if (ext == ".obj" || ext == ".fbx" || ext == ".gltf") icon = "🎲";
                     
+                    bool isScene = ext == ".scene" || ext == ".json";
+                    if (isScene) icon = "🌐";
+                    
                     std::string label = std::string(icon) + " " + filename;
                     
                     if (ImGui::Selectable(label.c_str())) {
@@ -97,7 +101,8 @@ void ContentBrowser::showFileGrid() {
                         ImGui::Text("File: %s", filename.c_str());
                         ImGui::Separator();
                         if (ImGui::MenuItem("Open")) {
-                            // TODO: Open file
+                            // Scenes load in the background and fill in over the next frames
+                            if (isScene) scene.loadFromDiskAsync(entry.path().string());
                         }
                         if (ImGui::MenuItem("Rename")) {
                             // TODO: Rename file
@@ -2,16 +2,18 @@
 
 #include <string>
 
+class Scene;
+
 class ContentBrowser {
 public:
     ContentBrowser();
     ~ContentBrowser() = default;
     
-    void show();
+    void show(Scene& scene);
 
 private:
     void showDirectoryTree();
-    void showFileGrid();
+    void showFileGrid(Scene& scene);
     void showPathBar();
     
     std::string m_currentPath;
@@ -9,8 +9,7 @@
 void DetailsPanel::show(Scene& scene) {
     ImGui::Begin("Details");
     
-    Object* selectedObject = scene.getSelectedObject();
-    if (!selectedObject) {
+    if (!scene.isValid(scene.getSelectedObject())) {
         ImGui::Text("No object selected");
         ImGui::Text("Select an object in the viewport or outliner to see its properties.");
         ImGui::End();
@@ -23,40 +22,39 @@ void DetailsPanel::show(Scene& scene) {
 }
 
 void DetailsPanel::showObjectDetails(Scene& scene) {
-    Object* object = scene.getSelectedObject();
-    if (!object) return;
+    ObjectHandle object = scene.getSelectedObject();
+    int index = scene.getObjectIndex(object);
+    if (index < 0) return;
     
     // Object header
-    ImGui::Text("Object: %s", object->getName().c_str());
+    ImGui::Text("Object: %s", scene.getName(index).c_str());
     ImGui::Separator();
     
     // Object name
     char name[256];
-    std::strncpy(name, object->getName().c_str(), sizeof(name) - 1);
+    std::strncpy(name, scene.getName(index).c_str(), sizeof(name) - 1);
     name[sizeof(name) - 1] = '\0';
     
     if (ImGui::InputText("Name", name, sizeof(name))) {
-        object->setName(std::string(name));
+        scene.setName(object, std::string(name));
     }
     
     // Object type (read-only)
     const char* typeNames[] = {"Sphere", "Plane", "Cube"};
-    int typeIndex = static_cast<int>(object->getType());
+    int typeIndex = static_cast<int>(scene.getTypes()[index]);
     ImGui::Text("Type: %s", typeNames[typeIndex]);
     
     ImGui::Spacing();
     
-    showTransformSection(*object);
+    showTransformSection(*scene.getTransform(object));
     
     ImGui::Spacing();
     
-    showMaterialSection(*object);
+    showMaterialSection(*scene.getMaterial(object));
 }
 
-void DetailsPanel::showTransformSection(Object& object) {
+void DetailsPanel::showTransformSection(Transform& transform) {
     if (ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen)) {
-        Transform& transform = object.getTransform();
-        
         ImGui::Text("Position");
         ImGui::DragFloat3("##Position", transform.position.data(), 0.1f);
         
@@ -81,10 +79,8 @@ void DetailsPanel::showTransformSection(Object& object) {
     }
 }
 
-void DetailsPanel::showMaterialSection(Object& object) {
+void DetailsPanel::showMaterialSection(Material& material) {
     if (ImGui::CollapsingHeader("Material", ImGuiTreeNodeFlags_DefaultOpen)) {
-        Material& material = object.getMaterial();
-        
         // Color picker
         ImGui::ColorEdit3("Color", material.color.data());
         
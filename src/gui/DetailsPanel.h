@@ -11,6 +11,6 @@ public:
 
 private:
     void showObjectDetails(Scene& scene);
-    void showTransformSection(class Object& object);
-    void showMaterialSection(class Object& object);
+    void showTransformSection(struct Transform& transform);
+    void showMaterialSection(struct Material& material);
 };
\ No newline at end of file
@@ -78,12 +78,12 @@ void GUI::update(Scene& scene, Camera& camera, Renderer& renderer) {
     if (m_showViewport) m_viewport->show(scene, camera, renderer);
     if (m_showOutliner) m_sceneOutliner->show(scene);
     if (m_showDetails) m_detailsPanel->show(scene);
-    if (m_showContentBrowser) m_contentBrowser->show();
+    if (m_showContentBrowser) m_contentBrowser->show(scene);
     if (m_showLogger) m_logWindow->show();
     
     // Status bar is always at the bottom
     if (m_showStatusBar) {
-        m_statusBar->show(renderer);
+        m_statusBar->show(scene, renderer);
     }
     
     // Demo window if enabled
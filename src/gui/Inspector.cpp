@@ -25,49 +25,54 @@ void Inspector::showSceneHierarchy(Scene& scene) {
     ImGui::Text("Scene Hierarchy");
     ImGui::Separator();
     
-    auto& objects = scene.getObjects();
-    Object* selectedObject = scene.getSelectedObject();
+    ObjectHandle selectedObject = scene.getSelectedObject();
+    ObjectHandle removed;
     
-    for (int i = 0; i < static_cast<int>(objects.size()); ++i) {
-        auto& obj = objects[i];
+    for (int i = 0; i < scene.getObjectCount(); ++i) {
+        ObjectHandle handle = scene.getHandle(i);
         
         ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
-        if (obj.get() == selectedObject) {
+        if (handle == selectedObject) {
             flags |= ImGuiTreeNodeFlags_Selected;
         }
         
-        ImGui::TreeNodeEx(obj->getName().c_str(), flags);
+        ImGui::TreeNodeEx(scene.getName(i).c_str(), flags);
         
         if (ImGui::IsItemClicked()) {
-            scene.setSelectedObject(obj.get());
+            scene.setSelectedObject(handle);
         }
         
         // Context menu
         if (ImGui::BeginPopupContextItem()) {
             if (ImGui::MenuItem("Delete")) {
-                scene.removeObject(i);
+                removed = handle;
             }
             ImGui::EndPopup();
         }
     }
     
+    // Removal reorders the arrays, so it waits until the list is drawn
+    if (!removed.isNull()) {
+        scene.removeObject(removed);
+    }
+    
     // Add object buttons
     ImGui::Spacing();
     if (ImGui::Button("Add Sphere")) {
-        auto sphere = std::make_unique<Object>("New Sphere", ObjectType::Sphere);
-        sphere->getTransform().position = {0, 1, 0};
+        Object sphere("New Sphere", ObjectType::Sphere);
+        sphere.getTransform().position = {0, 1, 0};
         scene.addObject(std::move(sphere));
     }
     ImGui::SameLine();
     if (ImGui::Button("Add Plane")) {
-        auto plane = std::make_unique<Object>("New Plane", ObjectType::Plane);
-        scene.addObject(std::move(plane));
+        scene.addObject(Object("New Plane", ObjectType::Plane));
     }
 }
 
 void Inspector::showObjectProperties(Scene& scene) {
-    Object* selectedObject = scene.getSelectedObject();
-    if (!selectedObject) {
+    ObjectHandle selectedObject = scene.getSelectedObject();
+    int index = scene.getObjectIndex(selectedObject);
+    if (index < 0) {
         ImGui::Text("No object selected");
         return;
     }
@@ -77,16 +82,16 @@ void Inspector::showObjectProperties(Scene& scene) {
     
     // Object name
     char name[256];
-    std::strncpy(name, selectedObject->getName().c_str(), sizeof(name) - 1);
+    std::strncpy(name, scene.getName(index).c_str(), sizeof(name) - 1);
     name[sizeof(name) - 1] = '\0';
     
     if (ImGui::InputText("Name", name, sizeof(name))) {
-        selectedObject->setName(std::string(name));
+        scene.setName(selectedObject, std::string(name));
     }
     
     // Transform
     if (ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen)) {
-        Transform& transform = selectedObject->getTransform();
+        Transform& transform = *scene.getTransform(selectedObject);
         
         ImGui::DragFloat3("Position", transform.position.data(), 0.1f);
         ImGui::DragFloat3("Rotation", transform.rotation.data(), 1.0f);
@@ -95,7 +100,7 @@ void Inspector::showObjectProperties(Scene& scene) {
     
     // Material
     if (ImGui::CollapsingHeader("Material", ImGuiTreeNodeFlags_DefaultOpen)) {
-        Material& material = selectedObject->getMaterial();
+        Material& material = *scene.getMaterial(selectedObject);
         
         ImGui::ColorEdit3("Color", material.color.data());
         
@@ -32,68 +32,82 @@ void SceneOutliner::show(Scene& scene) {
 }
 
 void SceneOutliner::showObjectHierarchy(Scene& scene) {
-    auto& objects = scene.getObjects();
-    Object* selectedObject = scene.getSelectedObject();
+    ObjectHandle selectedObject = scene.getSelectedObject();
+    ObjectHandle removed;
     
     // Scene root
     if (ImGui::TreeNodeEx("Scene", ImGuiTreeNodeFlags_DefaultOpen)) {
         
-        for (int i = 0; i < static_cast<int>(objects.size()); ++i) {
-            auto& obj = objects[i];
+        // Only the visible rows are built, so large or still-loading scenes
+        // cost the same per frame as small ones
+        ImGuiListClipper clipper;
+        clipper.Begin(scene.getObjectCount());
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd && i < scene.getObjectCount(); ++i) {
+                ObjectHandle handle = scene.getHandle(i);
+                const std::string& name = scene.getName(i);
             
-            ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_Leaf | 
-                                     ImGuiTreeNodeFlags_NoTreePushOnOpen |
-                                     ImGuiTreeNodeFlags_SpanFullWidth;
+                ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_Leaf | 
+                                         ImGuiTreeNodeFlags_NoTreePushOnOpen |
+                                         ImGuiTreeNodeFlags_SpanFullWidth;
             
-            if (obj.get() == selectedObject) {
-                flags |= ImGuiTreeNodeFlags_Selected;
-            }
+                if (handle == selectedObject) {
+                    flags |= ImGuiTreeNodeFlags_Selected;
+                }
             
-            const char* icon = "○"; // Default
-            switch (obj->getType()) {
-                case ObjectType::Sphere: icon = "●"; break;
-                case ObjectType::Plane: icon = "▭"; break;
-                case ObjectType::Cube: icon = "■"; break;
-            }
+                const char* icon = "○"; // Default
+                switch (scene.getTypes()[i]) {
+                    case ObjectType::Sphere: icon = "●"; break;
+                    case ObjectType::Plane: icon = "▭"; break;
+                    case ObjectType::Cube: icon = "■"; break;
+                }
             
-            std::string label = std::string(icon) + " " + obj->getName() + "##" + std::to_string(i);
-            ImGui::TreeNodeEx(label.c_str(), flags);
+                std::string label = std::string(icon) + " " + name + "##" + std::to_string(handle.slot);
+                ImGui::TreeNodeEx(label.c_str(), flags);
             
-            if (ImGui::IsItemClicked()) {
-                scene.setSelectedObject(obj.get());
-            }
+                if (ImGui::IsItemClicked()) {
+                    scene.setSelectedObject(handle);
+                }
             
-            // Drag and drop (future feature)
-            if (ImGui::BeginDragDropSource()) {
-                ImGui::SetDragDropPayload("SCENE_OBJECT", &i, sizeof(int));
-                ImGui::Text("Moving %s", obj->getName().c_str());
-                ImGui::EndDragDropSource();
-            }
+                // Drag and drop (future feature)
+                if (ImGui::BeginDragDropSource()) {
+                    ImGui::SetDragDropPayload("SCENE_OBJECT", &handle, sizeof(ObjectHandle));
+                    ImGui::Text("Moving %s", name.c_str());
+                    ImGui::EndDragDropSource();
+                }
             
-            // ИСПРАВИТЬ ЭТОТ POPUP - добавить уникальный ID:
-            std::string popupId = "ObjectContext##" + std::to_string(i);
-            if (ImGui::BeginPopupContextItem(popupId.c_str())) {
-                ImGui::Text("Object: %s", obj->getName().c_str());
-                ImGui::Separator();
+                // ИСПРАВИТЬ ЭТОТ POPUP - добавить уникальный ID:
+                std::string popupId = "ObjectContext##" + std::to_string(handle.slot);
+                if (ImGui::BeginPopupContextItem(popupId.c_str())) {
+                    ImGui::Text("Object: %s", name.c_str());
+                    ImGui::Separator();
                 
-                if (ImGui::MenuItem("Rename")) {
-                    // TODO: Implement rename dialog
-                }
+                    if (ImGui::MenuItem("Rename")) {
+                        // TODO: Implement rename dialog
+                    }
                 
-                if (ImGui::MenuItem("Duplicate")) {
-                    // TODO: Implement object duplication
-                }
+                    if (ImGui::MenuItem("Duplicate")) {
+                        // TODO: Implement object duplication
+                    }
                 
-                if (ImGui::MenuItem("Delete", "Del")) {
-                    scene.removeObject(i);
-                }
+                    if (ImGui::MenuItem("Delete", "Del")) {
+                        removed = handle;
+                    }
                 
-                ImGui::EndPopup();
+                    ImGui::EndPopup();
+                }
             }
         }
+        clipper.End();
         
         ImGui::TreePop();
     }
+    
+    // Removal moves the last object into the gap, so it waits until the
+    // rows are built
+    if (!removed.isNull()) {
+        scene.removeObject(removed);
+    }
 }
 
 void SceneOutliner::showContextMenu(Scene& scene) {
@@ -101,26 +115,26 @@ void SceneOutliner::showContextMenu(Scene& scene) {
     if (ImGui::BeginPopupContextWindow("SceneOutlinerContext", ImGuiPopupFlags_MouseButtonRight | ImGuiPopupFlags_NoOpenOverItems)) {
         if (ImGui::BeginMenu("Create")) {
             if (ImGui::MenuItem("Sphere")) {
-                auto sphere = std::make_unique<Object>("Sphere", ObjectType::Sphere);
-                sphere->getTransform().position = {0, 1, 0};
-                sphere->getMaterial().color = {0.7f, 0.3f, 0.3f};
+                Object sphere("Sphere", ObjectType::Sphere);
+                sphere.getTransform().position = {0, 1, 0};
+                sphere.getMaterial().color = {0.7f, 0.3f, 0.3f};
                 scene.addObject(std::move(sphere));
                 LOG_INFO("Created new sphere");
             }
             
             if (ImGui::MenuItem("Cube")) {
-                auto cube = std::make_unique<Object>("Cube", ObjectType::Cube);
-                cube->getTransform().position = {0, 0.5f, 0};
-                cube->getMaterial().color = {0.3f, 0.7f, 0.3f};
+                Object cube("Cube", ObjectType::Cube);
+                cube.getTransform().position = {0, 0.5f, 0};
+                cube.getMaterial().color = {0.3f, 0.7f, 0.3f};
                 scene.addObject(std::move(cube));
                 LOG_INFO("Created new cube");
             }
             
             if (ImGui::MenuItem("Plane")) {
-                auto plane = std::make_unique<Object>("Plane", ObjectType::Plane);
-                plane->getTransform().position = {0, 0, 0};
-                plane->getTransform().scale = {10, 1, 10};
-                plane->getMaterial().color = {0.5f, 0.5f, 0.5f};
+                Object plane("Plane", ObjectType::Plane);
+                plane.getTransform().position = {0, 0, 0};
+                plane.getTransform().scale = {10, 1, 10};
+                plane.getMaterial().color = {0.5f, 0.5f, 0.5f};
                 scene.addObject(std::move(plane));
                 LOG_INFO("Created new plane");
             }
@@ -144,31 +158,31 @@ void SceneOutliner::handleObjectCreation(Scene& scene) {
         ImGui::Separator();
         
         if (ImGui::Selectable("Sphere")) {
-            auto sphere = std::make_unique<Object>("New Sphere", ObjectType::Sphere);
-            sphere->getTransform().position = {0, 1, 0};
-            sphere->getMaterial().type = MaterialType::Diffuse;
-            sphere->getMaterial().color = {0.7f, 0.3f, 0.3f};
+            Object sphere("New Sphere", ObjectType::Sphere);
+            sphere.getTransform().position = {0, 1, 0};
+            sphere.getMaterial().type = MaterialType::Diffuse;
+            sphere.getMaterial().color = {0.7f, 0.3f, 0.3f};
             scene.addObject(std::move(sphere));
             m_showCreateMenu = false;
             LOG_INFO("Created sphere from menu");
         }
         
         if (ImGui::Selectable("Cube")) {
-            auto cube = std::make_unique<Object>("New Cube", ObjectType::Cube);
-            cube->getTransform().position = {0, 0.5f, 0};
-            cube->getMaterial().type = MaterialType::Diffuse;
-            cube->getMaterial().color = {0.3f, 0.7f, 0.3f};
+            Object cube("New Cube", ObjectType::Cube);
+            cube.getTransform().position = {0, 0.5f, 0};
+            cube.getMaterial().type = MaterialType::Diffuse;
+            cube.getMaterial().color = {0.3f, 0.7f, 0.3f};
             scene.addObject(std::move(cube));
             m_showCreateMenu = false;
             LOG_INFO("Created cube from menu");
         }
         
         if (ImGui::Selectable("Plane")) {
-            auto plane = std::make_unique<Object>("New Plane", ObjectType::Plane);
-            plane->getTransform().position = {0, 0, 0};
-            plane->getTransform().scale = {5, 1, 5};
-            plane->getMaterial().type = MaterialType::Diffuse;
-            plane->getMaterial().color = {0.8f, 0.8f, 0.8f};
+            Object plane("New Plane", ObjectType::Plane);
+            plane.getTransform().position = {0, 0, 0};
+            plane.getTransform().scale = {5, 1, 5};
+            plane.getMaterial().type = MaterialType::Diffuse;
+            plane.getMaterial().color = {0.8f, 0.8f, 0.8f};
             scene.addObject(std::move(plane));
             m_showCreateMenu = false;
             LOG_INFO("Created plane from menu");
@@ -1,14 +1,22 @@
 #include "StatusBar.h"
 #include "renderer/Renderer.h"
+#include "renderer/CpuPathTracer.h"
+#include "renderer/HybridRenderer.h"
+#include "renderer/DistributedRenderer.h"
+#include "scene/Scene.h"
+#include "scene/SceneLoader.h"
 #include "core/Time.h"
+#include "core/JobSystem.h"
 
 #include <imgui.h>
 
-void StatusBar::show(const Renderer& renderer) {
+void StatusBar::show(Scene& scene, const Renderer& renderer) {
     ImGuiWindowFlags flags = ImGuiWindowFlags_NoCollapse | 
                             ImGuiWindowFlags_NoScrollbar;
     
     if (ImGui::Begin("StatusBar", nullptr, flags)) {
+        showSceneLoad(scene);
+        
         ImGui::Text("FPS: %.1f (%.3fms)", 
                     Time::getFPS(), 
                     1000.0f / Time::getFPS());
@@ -33,6 +41,78 @@ void StatusBar::show(const Renderer& renderer) {
                     renderer.getSamplesPerPixel(), 
                     renderer.getMaxBounces());
         
+        ImGui::SameLine();
+        ImGui::Text("|"); 
+        ImGui::SameLine();
+        
+        const CpuPathTracer* cpuTracer = renderer.getCpuPathTracer();
+        if (renderer.getRenderBackend() == RenderBackend::Cpu && cpuTracer) {
+            float utilization = 0.0f;
+            uint64_t steals = 0;
+            std::vector<WorkerStats> workers = JobSystem::getStats();
+            for (const WorkerStats& worker : workers) {
+                utilization += worker.utilization;
+                steals += worker.steals;
+            }
+            if (!workers.empty()) utilization /= static_cast<float>(workers.size());
+            
+            ImGui::Text("CPU %s: %d spp, %d workers %.0f%% busy, %llu steals",
+                        CpuFeatures::getName(cpuTracer->getSimdLevel()),
+                        cpuTracer->getCompletedPasses(),
+                        static_cast<int>(workers.size()),
+                        utilization * 100.0f,
+                        static_cast<unsigned long long>(steals));
+            if (cpuTracer->isRadianceCacheEnabled()) {
+                ImGui::SameLine();
+                ImGui::Text("| Cache: %d cells", cpuTracer->getRadianceCacheCells());
+            }
+            if (int photons = cpuTracer->getCausticPhotonCount()) {
+                ImGui::SameLine();
+                ImGui::Text("| Caustics: %d photons, r %.3f", photons, cpuTracer->getCausticRadius());
+            }
+            if (cpuTracer->isPathGuidingEnabled()) {
+                ImGui::SameLine();
+                ImGui::Text("| Guide: iteration %d, %.1f MB", cpuTracer->getPathGuideIteration(),
+                            cpuTracer->getPathGuideMemory() / (1024.0 * 1024.0));
+            }
+        } else if (renderer.getRenderBackend() == RenderBackend::Hybrid && renderer.getHybridRenderer()) {
+            const HybridRenderer* hybrid = renderer.getHybridRenderer();
+            ImGui::Text("Hybrid: %d spp, GPU %.0f%% (%.0f tiles/s), CPU %.0f tiles/s",
+                        hybrid->getCompletedPasses(),
+                        hybrid->getGpuShare() * 100.0f,
+                        hybrid->getGpuTileRate(),
+                        hybrid->getCpuTileRate());
+        } else if (renderer.getRenderBackend() == RenderBackend::Distributed && renderer.getDistributedRenderer()) {
+            const DistributedRenderer* distributed = renderer.getDistributedRenderer();
+            int threads = 0;
+            std::vector<DistributedRenderer::WorkerStatus> workers = distributed->getWorkerStatus();
+            for (const auto& worker : workers) {
+                if (worker.connected) threads += worker.threads;
+            }
+            
+            ImGui::Text("Distributed: %d spp, %d/%d workers (%d threads), %.0f tiles/s, %d lost",
+                        distributed->getCompletedPasses(),
+                        distributed->getConnectedWorkers(),
+                        static_cast<int>(workers.size()),
+                        threads,
+                        distributed->getTileRate(),
+                        distributed->getLostWorkers());
+        } else {
+            ImGui::Text("Trace: %.2fms", renderer.getPathTraceTime());
+        }
+        
+        const FrameBudgetGovernor& governor = renderer.getGovernor();
+        if (governor.isEnabled() && renderer.isGovernable()) {
+            ImGui::SameLine();
+            ImGui::Text("|"); 
+            ImGui::SameLine();
+            
+            ImGui::TextColored(ImVec4(0.4f, 0.8f, 1.0f, 1.0f), "Auto %.1f/%.1fms: %s",
+                               governor.getSmoothedPassTime(),
+                               governor.getTargetFrameTime(),
+                               governor.getLastDecision().c_str());
+        }
+        
         ImGui::SameLine();
         float width = ImGui::GetWindowWidth();
         float textWidth = 200.0f; 
@@ -42,4 +122,21 @@ void StatusBar::show(const Renderer& renderer) {
         }
     }
     ImGui::End();
-}
\ No newline at end of file
+}
+
+void StatusBar::showSceneLoad(Scene& scene) {
+    if (!scene.isLoading()) return;
+    
+    const SceneLoader* loader = scene.getLoader();
+    ImGui::Text("Loading %s: %zu objects", loader->getPath().c_str(), loader->getLoadedCount());
+    ImGui::SameLine();
+    ImGui::ProgressBar(loader->getProgress(), ImVec2(160.0f, 0.0f));
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Cancel")) {
+        scene.cancelLoad();
+    }
+    
+    ImGui::SameLine();
+    ImGui::Text("|");
+    ImGui::SameLine();
+}
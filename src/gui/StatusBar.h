@@ -1,11 +1,15 @@
 #pragma once
 
 class Renderer;
+class Scene;
 
 class StatusBar {
 public:
     StatusBar() = default;
     ~StatusBar() = default;
     
-    void show(const Renderer& renderer);
+    void show(Scene& scene, const Renderer& renderer);
+
+private:
+    void showSceneLoad(Scene& scene);
 };
\ No newline at end of file
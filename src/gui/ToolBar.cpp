@@ -92,6 +92,23 @@ void ToolBar::showTransformTools() {
 }
 
 void ToolBar::showRenderSettings(Renderer& renderer) {
+    FrameBudgetGovernor& governor = renderer.getGovernor();
+    bool governable = renderer.isGovernable();
+    bool autoMode = governor.isEnabled() && governable;
+    
+    // GPU tracer or the CPU reference tracer
+    // Order matches RenderBackend
+    const char* backends[] = { "GPU", "CPU", "Hybrid", "Distributed" };
+    int backend = static_cast<int>(renderer.getRenderBackend());
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::Combo("Backend", &backend, backends, IM_ARRAYSIZE(backends))) {
+        renderer.setRenderBackend(static_cast<RenderBackend>(backend));
+    }
+    ImGui::SameLine();
+    
+    // Manual settings are driven by the governor while auto mode is on
+    ImGui::BeginDisabled(autoMode);
+    
     // Samples per pixel
     int spp = renderer.getSamplesPerPixel();
     ImGui::SetNextItemWidth(80);
@@ -119,6 +136,72 @@ void ToolBar::showRenderSettings(Renderer& renderer) {
         renderer.setSamplesPerPixel(32);
         renderer.setMaxBounces(12);
     }
+    
+    ImGui::EndDisabled();
+    
+    // Render resolution
+    ImGui::SameLine();
+    float renderScale = renderer.getRenderScale();
+    ImGui::SetNextItemWidth(80);
+    if (ImGui::SliderFloat("Scale", &renderScale, 0.25f, 1.0f, "%.2fx")) {
+        renderer.setRenderScale(renderScale);
+    }
+    
+    if (renderer.getRenderScale() < 1.0f) {
+        ImGui::SameLine();
+        float sharpness = renderer.getSharpness();
+        ImGui::SetNextItemWidth(60);
+        if (ImGui::SliderFloat("Sharpen", &sharpness, 0.0f, 1.0f, "%.2f")) {
+            renderer.setSharpness(sharpness);
+        }
+    }
+    
+    if (renderer.getRenderBackend() == RenderBackend::Cpu) {
+        ImGui::SameLine();
+        bool radianceCache = renderer.getRadianceCache();
+        if (ImGui::Checkbox("Radiance cache", &radianceCache)) {
+            renderer.setRadianceCache(radianceCache);
+        }
+        ImGui::SameLine();
+        bool caustics = renderer.getCaustics();
+        if (ImGui::Checkbox("Caustics", &caustics)) {
+            renderer.setCaustics(caustics);
+        }
+        ImGui::SameLine();
+        bool pathGuiding = renderer.getPathGuiding();
+        if (ImGui::Checkbox("Path guiding", &pathGuiding)) {
+            renderer.setPathGuiding(pathGuiding);
+        }
+    }
+    
+    // Hybrid primary visibility
+    ImGui::SameLine();
+    bool rasterPrimary = renderer.getRasterPrimaryVisibility();
+    if (ImGui::Checkbox("Raster 1st hit", &rasterPrimary)) {
+        renderer.setRasterPrimaryVisibility(rasterPrimary);
+    }
+    
+    // Frame-time budget; only GPU passes are timed, so elsewhere it is
+    // kept as set but greyed out
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!governable);
+    if (ImGui::Checkbox(governable ? "Auto" : "Auto (GPU only)", &autoMode)) {
+        if (autoMode) {
+            // Current depth becomes the ceiling the governor restores up to
+            governor.setBounceCeiling(renderer.getMaxBounces());
+        }
+        governor.setEnabled(autoMode);
+    }
+    ImGui::EndDisabled();
+    
+    if (autoMode) {
+        ImGui::SameLine();
+        float targetMs = governor.getTargetFrameTime();
+        ImGui::SetNextItemWidth(80);
+        if (ImGui::DragFloat("Target", &targetMs, 0.5f, 4.0f, 100.0f, "%.1f ms")) {
+            governor.setTargetFrameTime(targetMs);
+        }
+    }
 }
 
 void ToolBar::showCameraControls(Camera& camera) {
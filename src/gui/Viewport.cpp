@@ -41,8 +41,10 @@ void Viewport::show(Scene& scene, Camera& camera, Renderer& renderer) {
             ImVec2 viewportPos = ImGui::GetCursorScreenPos();
             m_viewportPos = Vec2{viewportPos.x, viewportPos.y};
             
+            resolvePendingPick(renderer);
+            
             if (m_isFocused || m_isHovered) {
-                handleInput(scene, camera);
+                handleInput(scene, camera, renderer);
             }
             
             renderViewportContent(scene, camera, renderer);
@@ -58,6 +60,7 @@ void Viewport::show(Scene& scene, Camera& camera, Renderer& renderer) {
             }
             
             renderOverlays(scene, camera, renderer);
+            renderModeSelector(renderer);
         }
     }
     ImGui::End();
@@ -68,7 +71,7 @@ void Viewport::onResize(int width, int height) {
     // Handled in show() method
 }
 
-void Viewport::handleInput(Scene& scene, Camera& camera) {
+void Viewport::handleInput(Scene& scene, Camera& camera, Renderer& renderer) {
     ImGuiIO& io = ImGui::GetIO();
     
     // Если ImGui захватил ввод, игнорируем его для viewport
@@ -98,14 +101,31 @@ void Viewport::handleInput(Scene& scene, Camera& camera) {
             LOG_INFO("Viewport: Single click detected at ({}, {})", viewportMousePos.x, viewportMousePos.y);
         }
         
-        // В любом случае отправляем событие в SelectionManager
+        // Pick through the object-id buffer; ray casting is the fallback
         if (!ImGuizmo::IsOver()) {
-            m_editor.getSelection().handleMousePicking(viewportMousePos, camera);
+            if (renderer.requestPick(viewportMousePos)) {
+                m_pickPending = true;
+                m_pickDoubleClick = Input::isMouseButtonDoubleClicked(GLFW_MOUSE_BUTTON_LEFT);
+            } else {
+                m_editor.getSelection().handleMousePicking(viewportMousePos, camera);
+            }
         }
     }
 }
 
+void Viewport::resolvePendingPick(Renderer& renderer) {
+    if (!m_pickPending) return;
+    
+    ObjectHandle object;
+    if (renderer.pollPick(object)) {
+        m_pickPending = false;
+        m_editor.getSelection().handlePickedObject(object, m_pickDoubleClick);
+    }
+}
+
 void Viewport::renderViewportContent(Scene& scene, Camera& camera, Renderer& renderer) {
+    m_editor.getSelection().renderSelection(renderer);
+    
     m_framebuffer->bind();
     
     glViewport(0, 0, static_cast<int>(m_viewportSize.x), static_cast<int>(m_viewportSize.y));
@@ -148,9 +168,21 @@ void Viewport::renderGizmos(Scene& scene, Camera& camera) {
     ImGuizmo::SetRect(m_viewportPos.x, m_viewportPos.y, m_viewportSize.x, m_viewportSize.y);
     
     if (m_editor.getSelection().hasSelection()) {
-        Object* selectedObject = m_editor.getSelection().getSelectedObject();
-        if (selectedObject) {
-            m_editor.getGizmo().update(*selectedObject, camera);
+        Transform* transform = scene.getTransform(m_editor.getSelection().getSelectedObject());
+        if (transform) {
+            m_editor.getGizmo().update(*transform, camera);
         }
     }
+}
+
+void Viewport::renderModeSelector(Renderer& renderer) {
+    ImGui::SetCursorScreenPos(ImVec2(m_viewportPos.x + 8, m_viewportPos.y + 8));
+    
+    const char* modes[] = {"Path Traced", "Preview"};
+    int mode = static_cast<int>(renderer.getRenderMode());
+    ImGui::SetNextItemWidth(110);
+    if (ImGui::Combo("##RenderMode", &mode, modes, IM_ARRAYSIZE(modes))) {
+        renderer.setRenderMode(static_cast<RenderMode>(mode));
+        LOG_INFO("Viewport render mode: {}", modes[mode]);
+    }
 }
\ No newline at end of file
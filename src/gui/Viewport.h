@@ -23,10 +23,12 @@ public:
     Vec2 getSize() const { return m_viewportSize; }
 
 private:
-    void handleInput(Scene& scene, Camera& camera);
+    void handleInput(Scene& scene, Camera& camera, Renderer& renderer);
+    void resolvePendingPick(Renderer& renderer);
     void renderViewportContent(Scene& scene, Camera& camera, Renderer& renderer);
     void renderOverlays(Scene& scene, Camera& camera, Renderer& renderer);
     void renderGizmos(Scene& scene, Camera& camera);
+    void renderModeSelector(Renderer& renderer);
     
     Editor& m_editor;
     std::unique_ptr<Framebuffer> m_framebuffer;
@@ -37,4 +39,8 @@ private:
     bool m_isFocused = false;
     bool m_isHovered = false;
     bool m_firstFrame = true;
+    
+    // Click waiting for its object-id readback
+    bool m_pickPending = false;
+    bool m_pickDoubleClick = false;
 };
\ No newline at end of file
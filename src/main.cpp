@@ -1,13 +1,113 @@
 #include "core/Application.h"
 #include "core/Logger.h"
+#include "core/NumaTopology.h"
+#include "math/MathBenchmark.h"
+#include "renderer/RenderCheckpoint.h"
+#include "renderer/RenderProtocol.h"
+#include "renderer/RenderWorker.h"
+#include "utils/Socket.h"
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
-int main() {
+namespace {
+    // "x,y,z"
+    bool parseVec3(const char* text, Vec3& value) {
+        return std::sscanf(text, "%f,%f,%f", &value.x, &value.y, &value.z) == 3;
+    }
+}
+
+int main(int argc, char** argv) {
     try {
         Logger::init();
+        
+        Application::Options options;
+        int workerThreads = 0;
+        for (int i = 1; i < argc; ++i) {
+            if (std::string_view(argv[i]) == "--worker-threads" && i + 1 < argc) {
+                workerThreads = std::atoi(argv[i + 1]);
+            }
+            // Transparent huge pages for large CPU render buffers
+            if (std::string_view(argv[i]) == "--huge-pages") {
+                NumaTopology::setHugePagesEnabled(true);
+            }
+        }
+        
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg(argv[i]);
+            if (arg == "--bench-math") {
+                MathBenchmark::run();
+                return 0;
+            }
+            
+            // --merge-checkpoints out in1 in2 ...: sums renders of one view
+            // made with different seeds or on different machines
+            if (arg == "--merge-checkpoints" && i + 2 < argc) {
+                RenderCheckpoint merged;
+                if (!merged.load(argv[i + 2])) {
+                    LOG_ERROR("Cannot read checkpoint '{}'", argv[i + 2]);
+                    return -1;
+                }
+                for (int j = i + 3; j < argc; ++j) {
+                    RenderCheckpoint other;
+                    if (!other.load(argv[j]) || !merged.merge(other)) {
+                        LOG_ERROR("Cannot merge checkpoint '{}'", argv[j]);
+                        return -1;
+                    }
+                }
+                return merged.save(argv[i + 1]) ? 0 : -1;
+            }
+            
+            // --render-worker [[address:]port] [--worker-threads n]: headless tile server
+            if (arg == "--render-worker") {
+                std::string address = "127.0.0.1";
+                uint16_t port = RenderProtocol::DEFAULT_PORT;
+                if (i + 1 < argc && argv[i + 1][0] != '-' &&
+                    !Socket::parseEndpoint(argv[i + 1], address, port)) {
+                    LOG_ERROR("Invalid render worker address: {}", argv[i + 1]);
+                    return -1;
+                }
+                return RenderWorker::run(address, port, workerThreads);
+            }
+            
+            // --connect-workers host:port,host:port,...
+            if (arg == "--connect-workers" && i + 1 < argc) {
+                std::stringstream list(argv[++i]);
+                std::string endpoint;
+                while (std::getline(list, endpoint, ',')) {
+                    if (!endpoint.empty()) options.renderWorkers.push_back(endpoint);
+                }
+            }
+            
+            // --checkpoint path [--checkpoint-interval seconds]: resumable CPU render
+            if (arg == "--checkpoint" && i + 1 < argc) {
+                options.checkpointPath = argv[++i];
+            }
+            if (arg == "--checkpoint-interval" && i + 1 < argc) {
+                options.checkpointInterval = static_cast<float>(std::atof(argv[++i]));
+            }
+            
+            // --scene path [--camera x,y,z] [--look-at x,y,z]: the view to
+            // open with, so a checkpointed render can be resumed
+            if (arg == "--scene" && i + 1 < argc) {
+                options.scenePath = argv[++i];
+            }
+            if ((arg == "--camera" || arg == "--look-at") && i + 1 < argc) {
+                Vec3& value = arg == "--camera" ? options.cameraPosition : options.cameraTarget;
+                if (!parseVec3(argv[++i], value)) {
+                    LOG_ERROR("Expected x,y,z after {}, got '{}'", arg, argv[i]);
+                    return -1;
+                }
+            }
+        }
+        
         LOG_INFO("Starting MiniGPU Engine...");
         
-        Application app;
+        Application app(options);
         app.run();
         
         LOG_INFO("Engine shutdown complete.");
@@ -18,4 +118,4 @@ int main() {
     }
     
     return 0;
-}
\ No newline at end of file
+}
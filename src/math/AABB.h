@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Vec3.h"
+
+struct AABB {
+    Vec3 min;
+    Vec3 max;
+    
+    Vec3 center() const { return (min + max) * 0.5f; }
+    Vec3 extent() const { return (max - min) * 0.5f; }
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Vec3.h"
+#include "Vec4.h"
+#include "Simd.h"
 #include <cmath>
 
 struct Mat4 {
@@ -23,19 +25,90 @@ struct Mat4 {
     float* data() { return m; }
     const float* data() const { return m; }
     
+    // result[i][j] = sum over k of m[i][k] * other[k][j], one row at a time
     Mat4 operator*(const Mat4& other) const {
+        Simd::float4 row0 = Simd::load(other.m);
+        Simd::float4 row1 = Simd::load(other.m + 4);
+        Simd::float4 row2 = Simd::load(other.m + 8);
+        Simd::float4 row3 = Simd::load(other.m + 12);
+        
         Mat4 result;
         for (int i = 0; i < 4; ++i) {
-            for (int j = 0; j < 4; ++j) {
-                result.m[i * 4 + j] = 0;
-                for (int k = 0; k < 4; ++k) {
-                    result.m[i * 4 + j] += m[i * 4 + k] * other.m[k * 4 + j];
-                }
-            }
+            const float* a = m + i * 4;
+            Simd::float4 r = Simd::mul(Simd::splat(a[0]), row0);
+            r = Simd::madd(r, Simd::splat(a[1]), row1);
+            r = Simd::madd(r, Simd::splat(a[2]), row2);
+            r = Simd::madd(r, Simd::splat(a[3]), row3);
+            Simd::store(result.m + i * 4, r);
         }
         return result;
     }
     
+    // Column-major matrix times column vector
+    Vec4 operator*(const Vec4& v) const {
+        Simd::float4 r = Simd::mul(Simd::load(m), Simd::splat(v.x));
+        r = Simd::madd(r, Simd::load(m + 4), Simd::splat(v.y));
+        r = Simd::madd(r, Simd::load(m + 8), Simd::splat(v.z));
+        r = Simd::madd(r, Simd::load(m + 12), Simd::splat(v.w));
+        return Vec4::from(r);
+    }
+    
+    Vec3 transformPoint(const Vec3& p) const {
+        Simd::float4 r = Simd::madd(Simd::load(m + 12), Simd::load(m), Simd::splat(p.x));
+        r = Simd::madd(r, Simd::load(m + 4), Simd::splat(p.y));
+        r = Simd::madd(r, Simd::load(m + 8), Simd::splat(p.z));
+        Vec3 result;
+        Simd::store3(result.data(), r);
+        return result;
+    }
+    
+    Vec3 transformDirection(const Vec3& d) const {
+        Simd::float4 r = Simd::mul(Simd::load(m), Simd::splat(d.x));
+        r = Simd::madd(r, Simd::load(m + 4), Simd::splat(d.y));
+        r = Simd::madd(r, Simd::load(m + 8), Simd::splat(d.z));
+        Vec3 result;
+        Simd::store3(result.data(), r);
+        return result;
+    }
+    
+    // Inverse of a rotation/scale/shear plus translation matrix (bottom row
+    // 0 0 0 1): the 3x3 part is inverted through cross products and the
+    // translation is brought back through it. Much cheaper than inverse().
+    Mat4 affineInverse() const {
+        Simd::float4 c0 = Simd::set(m[0], m[1], m[2], 0.0f);
+        Simd::float4 c1 = Simd::set(m[4], m[5], m[6], 0.0f);
+        Simd::float4 c2 = Simd::set(m[8], m[9], m[10], 0.0f);
+        
+        // Rows of the inverse 3x3, before dividing by the determinant
+        Simd::float4 r0 = Simd::cross3(c1, c2);
+        Simd::float4 r1 = Simd::cross3(c2, c0);
+        Simd::float4 r2 = Simd::cross3(c0, c1);
+        
+        float det = Simd::dot3(c0, r0);
+        if (std::abs(det) < 1e-6f) {
+            return Mat4(1.0f);
+        }
+        
+        Simd::float4 invDet = Simd::splat(1.0f / det);
+        r0 = Simd::mul(r0, invDet);
+        r1 = Simd::mul(r1, invDet);
+        r2 = Simd::mul(r2, invDet);
+        Simd::float4 r3 = Simd::zero();
+        Simd::transpose(r0, r1, r2, r3);
+        
+        Simd::float4 t = Simd::mul(r0, Simd::splat(m[12]));
+        t = Simd::madd(t, r1, Simd::splat(m[13]));
+        t = Simd::madd(t, r2, Simd::splat(m[14]));
+        t = Simd::sub(Simd::set(0.0f, 0.0f, 0.0f, 1.0f), t);
+        
+        Mat4 result;
+        Simd::store(result.m, r0);
+        Simd::store(result.m + 4, r1);
+        Simd::store(result.m + 8, r2);
+        Simd::store(result.m + 12, t);
+        return result;
+    }
+    
     // Matrix inversion using adjugate method
     Mat4 inverse() const {
         // Calculate cofactors and determinant
@@ -97,12 +170,17 @@ struct Mat4 {
     
     // Create a transposed version of the matrix
     Mat4 transpose() const {
+        Simd::float4 r0 = Simd::load(m);
+        Simd::float4 r1 = Simd::load(m + 4);
+        Simd::float4 r2 = Simd::load(m + 8);
+        Simd::float4 r3 = Simd::load(m + 12);
+        Simd::transpose(r0, r1, r2, r3);
+        
         Mat4 result;
-        for (int i = 0; i < 4; i++) {
-            for (int j = 0; j < 4; j++) {
-                result.m[i * 4 + j] = m[j * 4 + i];
-            }
-        }
+        Simd::store(result.m, r0);
+        Simd::store(result.m + 4, r1);
+        Simd::store(result.m + 8, r2);
+        Simd::store(result.m + 12, r3);
         return result;
     }
     
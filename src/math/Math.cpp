@@ -1,2 +1,72 @@
 #include "Math.h"
+#include "Simd.h"
 
+#include <cassert>
+
+namespace Math {
+    void transformPoints(const Mat4& matrix, std::span<const Vec3> points, std::span<Vec3> out) {
+        assert(out.size() >= points.size());
+        
+        const Simd::float4 c0 = Simd::load(matrix.m);
+        const Simd::float4 c1 = Simd::load(matrix.m + 4);
+        const Simd::float4 c2 = Simd::load(matrix.m + 8);
+        const Simd::float4 c3 = Simd::load(matrix.m + 12);
+        
+        for (size_t i = 0; i < points.size(); ++i) {
+            const Vec3& p = points[i];
+            Simd::float4 r = Simd::madd(c3, c0, Simd::splat(p.x));
+            r = Simd::madd(r, c1, Simd::splat(p.y));
+            r = Simd::madd(r, c2, Simd::splat(p.z));
+            Simd::store3(out[i].data(), r);
+        }
+    }
+    
+    void transformDirections(const Mat4& matrix, std::span<const Vec3> directions, std::span<Vec3> out) {
+        assert(out.size() >= directions.size());
+        
+        const Simd::float4 c0 = Simd::load(matrix.m);
+        const Simd::float4 c1 = Simd::load(matrix.m + 4);
+        const Simd::float4 c2 = Simd::load(matrix.m + 8);
+        
+        for (size_t i = 0; i < directions.size(); ++i) {
+            const Vec3& d = directions[i];
+            Simd::float4 r = Simd::mul(c0, Simd::splat(d.x));
+            r = Simd::madd(r, c1, Simd::splat(d.y));
+            r = Simd::madd(r, c2, Simd::splat(d.z));
+            Simd::store3(out[i].data(), r);
+        }
+    }
+    
+    void transformAABBs(const Mat4& matrix, std::span<const AABB> boxes, std::span<AABB> out) {
+        assert(out.size() >= boxes.size());
+        
+        const Simd::float4 c0 = Simd::load(matrix.m);
+        const Simd::float4 c1 = Simd::load(matrix.m + 4);
+        const Simd::float4 c2 = Simd::load(matrix.m + 8);
+        const Simd::float4 c3 = Simd::load(matrix.m + 12);
+        const Simd::float4 a0 = Simd::abs(c0);
+        const Simd::float4 a1 = Simd::abs(c1);
+        const Simd::float4 a2 = Simd::abs(c2);
+        const Simd::float4 half = Simd::splat(0.5f);
+        
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const AABB& box = boxes[i];
+            Simd::float4 lo = Simd::set(box.min.x, box.min.y, box.min.z, 0.0f);
+            Simd::float4 hi = Simd::set(box.max.x, box.max.y, box.max.z, 0.0f);
+            Simd::float4 center = Simd::mul(Simd::add(lo, hi), half);
+            Simd::float4 extent = Simd::mul(Simd::sub(hi, lo), half);
+            
+            // Center moves as a point; extent grows by |M| (Arvo)
+            Simd::float4 newCenter = Simd::madd(c3, c0, Simd::splatX(center));
+            newCenter = Simd::madd(newCenter, c1, Simd::splatY(center));
+            newCenter = Simd::madd(newCenter, c2, Simd::splatZ(center));
+            
+            Simd::float4 newExtent = Simd::mul(a0, Simd::splatX(extent));
+            newExtent = Simd::madd(newExtent, a1, Simd::splatY(extent));
+            newExtent = Simd::madd(newExtent, a2, Simd::splatZ(extent));
+            
+            Simd::store3(out[i].min.data(), Simd::sub(newCenter, newExtent));
+            Simd::store3(out[i].max.data(), Simd::add(newCenter, newExtent));
+        }
+    }
+}
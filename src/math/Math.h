@@ -3,6 +3,8 @@
 #include "Vec3.h"
 #include "Vec2.h"
 #include "Mat4.h"
+#include "AABB.h"
+#include <span>
 
 namespace Math {
     constexpr float PI = 3.14159265358979323846f;
@@ -24,4 +26,11 @@ namespace Math {
     inline float lerp(float a, float b, float t) {
         return a + (b - a) * t;
     }
-}
\ No newline at end of file
+    
+    // Batch transforms by one matrix; out must be at least as long as the
+    // input and may be the same span
+    void transformPoints(const Mat4& matrix, std::span<const Vec3> points, std::span<Vec3> out);
+    void transformDirections(const Mat4& matrix, std::span<const Vec3> directions, std::span<Vec3> out);
+    // Tight world bounds of transformed boxes (center/extent form)
+    void transformAABBs(const Mat4& matrix, std::span<const AABB> boxes, std::span<AABB> out);
+}
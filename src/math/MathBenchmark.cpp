@@ -0,0 +1,205 @@
+#include "MathBenchmark.h"
+#include "Math.h"
+#include "core/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+    // The scalar implementations the SIMD kernels replaced, kept as baselines
+    Mat4 scalarMultiply(const Mat4& a, const Mat4& b) {
+        Mat4 result;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                result.m[i * 4 + j] = 0;
+                for (int k = 0; k < 4; ++k) {
+                    result.m[i * 4 + j] += a.m[i * 4 + k] * b.m[k * 4 + j];
+                }
+            }
+        }
+        return result;
+    }
+
+    Mat4 scalarTranspose(const Mat4& a) {
+        Mat4 result;
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++) {
+                result.m[i * 4 + j] = a.m[j * 4 + i];
+            }
+        }
+        return result;
+    }
+
+    Vec3 scalarTransformPoint(const Mat4& a, const Vec3& p) {
+        return {
+            a.m[0] * p.x + a.m[4] * p.y + a.m[8] * p.z + a.m[12],
+            a.m[1] * p.x + a.m[5] * p.y + a.m[9] * p.z + a.m[13],
+            a.m[2] * p.x + a.m[6] * p.y + a.m[10] * p.z + a.m[14]
+        };
+    }
+
+    // Transforms all eight corners, the usual way of doing it without Arvo's method
+    AABB scalarTransformAABB(const Mat4& a, const AABB& box) {
+        AABB result{Vec3{INFINITY}, Vec3{-INFINITY}};
+        for (int corner = 0; corner < 8; ++corner) {
+            Vec3 p{corner & 1 ? box.max.x : box.min.x,
+                   corner & 2 ? box.max.y : box.min.y,
+                   corner & 4 ? box.max.z : box.min.z};
+            Vec3 t = scalarTransformPoint(a, p);
+            result.min = Vec3{std::min(result.min.x, t.x), std::min(result.min.y, t.y), std::min(result.min.z, t.z)};
+            result.max = Vec3{std::max(result.max.x, t.x), std::max(result.max.y, t.y), std::max(result.max.z, t.z)};
+        }
+        return result;
+    }
+
+    float maxDifference(const float* a, const float* b, int count) {
+        float difference = 0.0f;
+        for (int i = 0; i < count; ++i) {
+            difference = std::max(difference, std::abs(a[i] - b[i]));
+        }
+        return difference;
+    }
+
+    template <typename Fn>
+    double nanosecondsPerOp(int operations, Fn&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / operations;
+    }
+
+    void report(const char* name, double scalarNs, double simdNs, float error) {
+        LOG_INFO("{:<22} scalar {:7.2f} ns  simd {:7.2f} ns  x{:.2f}  max error {:.2e}",
+                 name, scalarNs, simdNs, scalarNs / simdNs, error);
+    }
+
+    // Keeps results observable so the loops are not optimized away
+    volatile float g_sink = 0.0f;
+}
+
+void MathBenchmark::run(int iterations) {
+    LOG_INFO("Math benchmark: {} iterations per kernel", iterations);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> angle(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> coord(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+    // Random affine transforms built the way Transform does
+    const int matrixCount = 64;
+    std::vector<Mat4> matrices;
+    for (int i = 0; i < matrixCount; ++i) {
+        Mat4 rotation = Mat4::rotateX(angle(rng)) * Mat4::rotateY(angle(rng)) * Mat4::rotateZ(angle(rng));
+        matrices.push_back(Mat4::translate(Vec3{coord(rng), coord(rng), coord(rng)}) * rotation *
+                           Mat4::scale(Vec3{scale(rng), scale(rng), scale(rng)}));
+    }
+
+    // Multiply
+    {
+        Mat4 scalarAcc, simdAcc;
+        double scalarNs = nanosecondsPerOp(iterations, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                scalarAcc = scalarMultiply(matrices[i % matrixCount], matrices[(i + 1) % matrixCount]);
+                g_sink = g_sink + scalarAcc.m[i & 15];
+            }
+        });
+        double simdNs = nanosecondsPerOp(iterations, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                simdAcc = matrices[i % matrixCount] * matrices[(i + 1) % matrixCount];
+                g_sink = g_sink + simdAcc.m[i & 15];
+            }
+        });
+        report("Mat4 multiply", scalarNs, simdNs, maxDifference(scalarAcc.m, simdAcc.m, 16));
+    }
+
+    // Inverse: general cofactor expansion against the affine path
+    {
+        Mat4 scalarInv, simdInv;
+        double scalarNs = nanosecondsPerOp(iterations, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                scalarInv = matrices[i % matrixCount].inverse();
+                g_sink = g_sink + scalarInv.m[i & 15];
+            }
+        });
+        double simdNs = nanosecondsPerOp(iterations, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                simdInv = matrices[i % matrixCount].affineInverse();
+                g_sink = g_sink + simdInv.m[i & 15];
+            }
+        });
+        report("Mat4 inverse (affine)", scalarNs, simdNs, maxDifference(scalarInv.m, simdInv.m, 16));
+    }
+
+    // Transpose
+    {
+        Mat4 scalarT, simdT;
+        double scalarNs = nanosecondsPerOp(iterations, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                scalarT = scalarTranspose(matrices[i % matrixCount]);
+                g_sink = g_sink + scalarT.m[i & 15];
+            }
+        });
+        double simdNs = nanosecondsPerOp(iterations, [&] {
+            for (int i = 0; i < iterations; ++i) {
+                simdT = matrices[i % matrixCount].transpose();
+                g_sink = g_sink + simdT.m[i & 15];
+            }
+        });
+        report("Mat4 transpose", scalarNs, simdNs, maxDifference(scalarT.m, simdT.m, 16));
+    }
+
+    // Batch point transform
+    {
+        const int pointCount = 4096;
+        std::vector<Vec3> points(pointCount), scalarOut(pointCount), simdOut(pointCount);
+        for (Vec3& p : points) p = Vec3{coord(rng), coord(rng), coord(rng)};
+
+        int batches = std::max(1, iterations / pointCount);
+        const Mat4& matrix = matrices[0];
+        double scalarNs = nanosecondsPerOp(batches * pointCount, [&] {
+            for (int b = 0; b < batches; ++b) {
+                for (int i = 0; i < pointCount; ++i) scalarOut[i] = scalarTransformPoint(matrix, points[i]);
+                g_sink = g_sink + scalarOut[b % pointCount].x;
+            }
+        });
+        double simdNs = nanosecondsPerOp(batches * pointCount, [&] {
+            for (int b = 0; b < batches; ++b) {
+                Math::transformPoints(matrix, points, simdOut);
+                g_sink = g_sink + simdOut[b % pointCount].x;
+            }
+        });
+        report("transformPoints", scalarNs, simdNs,
+               maxDifference(scalarOut.data()->data(), simdOut.data()->data(), pointCount * 3));
+    }
+
+    // Batch AABB transform
+    {
+        const int boxCount = 4096;
+        std::vector<AABB> boxes(boxCount), scalarOut(boxCount), simdOut(boxCount);
+        for (AABB& box : boxes) {
+            Vec3 c{coord(rng), coord(rng), coord(rng)};
+            Vec3 e{scale(rng), scale(rng), scale(rng)};
+            box = AABB{c - e, c + e};
+        }
+
+        int batches = std::max(1, iterations / boxCount);
+        const Mat4& matrix = matrices[1];
+        double scalarNs = nanosecondsPerOp(batches * boxCount, [&] {
+            for (int b = 0; b < batches; ++b) {
+                for (int i = 0; i < boxCount; ++i) scalarOut[i] = scalarTransformAABB(matrix, boxes[i]);
+                g_sink = g_sink + scalarOut[b % boxCount].min.x;
+            }
+        });
+        double simdNs = nanosecondsPerOp(batches * boxCount, [&] {
+            for (int b = 0; b < batches; ++b) {
+                Math::transformAABBs(matrix, boxes, simdOut);
+                g_sink = g_sink + simdOut[b % boxCount].min.x;
+            }
+        });
+        report("transformAABBs", scalarNs, simdNs,
+               maxDifference(scalarOut.data()->min.data(), simdOut.data()->min.data(), boxCount * 6));
+    }
+}
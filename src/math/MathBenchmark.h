@@ -0,0 +1,8 @@
+#pragma once
+
+// Times the SIMD math kernels against their scalar equivalents and logs
+// ns/op and the largest difference between the two results
+class MathBenchmark {
+public:
+    static void run(int iterations = 1000000);
+};
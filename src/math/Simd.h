@@ -0,0 +1,156 @@
+#pragma once
+
+// Thin 4-wide float wrapper over SSE, NEON or plain scalars, picked at
+// compile time. SSE2 is part of x86-64 and NEON of AArch64, so no runtime
+// dispatch is needed at this width.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MINIGPU_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MINIGPU_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define MINIGPU_SIMD_SCALAR 1
+#endif
+
+namespace Simd {
+
+#if defined(MINIGPU_SIMD_SSE)
+
+    using float4 = __m128;
+
+    inline float4 load(const float* p) { return _mm_loadu_ps(p); }
+    inline float4 loadAligned(const float* p) { return _mm_load_ps(p); }
+    inline void store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+    inline void storeAligned(float* p, float4 v) { _mm_store_ps(p, v); }
+    inline void store3(float* p, float4 v) {
+        _mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+        _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+    }
+
+    inline float4 set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+    inline float4 splat(float s) { return _mm_set1_ps(s); }
+    inline float4 zero() { return _mm_setzero_ps(); }
+
+    inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+    inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+    inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+    inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+    inline float4 min(float4 a, float4 b) { return _mm_min_ps(a, b); }
+    inline float4 max(float4 a, float4 b) { return _mm_max_ps(a, b); }
+    inline float4 abs(float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+    inline float4 splatX(float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+    inline float4 splatY(float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+    inline float4 splatZ(float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+    inline float4 splatW(float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+    inline float4 yzxw(float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1)); }
+    inline float getX(float4 v) { return _mm_cvtss_f32(v); }
+
+    inline void transpose(float4& r0, float4& r1, float4& r2, float4& r3) {
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    }
+
+#elif defined(MINIGPU_SIMD_NEON)
+
+    using float4 = float32x4_t;
+
+    inline float4 load(const float* p) { return vld1q_f32(p); }
+    inline float4 loadAligned(const float* p) { return vld1q_f32(p); }
+    inline void store(float* p, float4 v) { vst1q_f32(p, v); }
+    inline void storeAligned(float* p, float4 v) { vst1q_f32(p, v); }
+    inline void store3(float* p, float4 v) {
+        vst1_f32(p, vget_low_f32(v));
+        vst1q_lane_f32(p + 2, v, 2);
+    }
+
+    inline float4 set(float x, float y, float z, float w) {
+        const float values[4] = {x, y, z, w};
+        return vld1q_f32(values);
+    }
+    inline float4 splat(float s) { return vdupq_n_f32(s); }
+    inline float4 zero() { return vdupq_n_f32(0.0f); }
+
+    inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+    inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+    inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+    inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+    inline float4 min(float4 a, float4 b) { return vminq_f32(a, b); }
+    inline float4 max(float4 a, float4 b) { return vmaxq_f32(a, b); }
+    inline float4 abs(float4 a) { return vabsq_f32(a); }
+
+    inline float4 splatX(float4 v) { return vdupq_laneq_f32(v, 0); }
+    inline float4 splatY(float4 v) { return vdupq_laneq_f32(v, 1); }
+    inline float4 splatZ(float4 v) { return vdupq_laneq_f32(v, 2); }
+    inline float4 splatW(float4 v) { return vdupq_laneq_f32(v, 3); }
+    inline float4 yzxw(float4 v) {
+        float32x4_t yzwx = vextq_f32(v, v, 1);
+        return vcombine_f32(vget_low_f32(yzwx), vrev64_f32(vget_high_f32(yzwx)));
+    }
+    inline float getX(float4 v) { return vgetq_lane_f32(v, 0); }
+
+    inline void transpose(float4& r0, float4& r1, float4& r2, float4& r3) {
+        float32x4x2_t t01 = vtrnq_f32(r0, r1);
+        float32x4x2_t t23 = vtrnq_f32(r2, r3);
+        r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+        r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+        r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+    }
+
+#else
+
+    struct float4 {
+        float v[4];
+    };
+
+    inline float4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+    inline float4 loadAligned(const float* p) { return load(p); }
+    inline void store(float* p, float4 a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+    inline void storeAligned(float* p, float4 a) { store(p, a); }
+    inline void store3(float* p, float4 a) { for (int i = 0; i < 3; ++i) p[i] = a.v[i]; }
+
+    inline float4 set(float x, float y, float z, float w) { return {{x, y, z, w}}; }
+    inline float4 splat(float s) { return {{s, s, s, s}}; }
+    inline float4 zero() { return splat(0.0f); }
+
+    inline float4 add(float4 a, float4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+    inline float4 sub(float4 a, float4 b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+    inline float4 mul(float4 a, float4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+    inline float4 div(float4 a, float4 b) { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+    inline float4 min(float4 a, float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+    inline float4 max(float4 a, float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+    inline float4 abs(float4 a) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i]; return a; }
+
+    inline float4 splatX(float4 a) { return splat(a.v[0]); }
+    inline float4 splatY(float4 a) { return splat(a.v[1]); }
+    inline float4 splatZ(float4 a) { return splat(a.v[2]); }
+    inline float4 splatW(float4 a) { return splat(a.v[3]); }
+    inline float4 yzxw(float4 a) { return {{a.v[1], a.v[2], a.v[0], a.v[3]}}; }
+    inline float getX(float4 a) { return a.v[0]; }
+
+    inline void transpose(float4& r0, float4& r1, float4& r2, float4& r3) {
+        float4 c0{{r0.v[0], r1.v[0], r2.v[0], r3.v[0]}};
+        float4 c1{{r0.v[1], r1.v[1], r2.v[1], r3.v[1]}};
+        float4 c2{{r0.v[2], r1.v[2], r2.v[2], r3.v[2]}};
+        float4 c3{{r0.v[3], r1.v[3], r2.v[3], r3.v[3]}};
+        r0 = c0; r1 = c1; r2 = c2; r3 = c3;
+    }
+
+#endif
+
+    // a + b * c
+    inline float4 madd(float4 a, float4 b, float4 c) { return add(a, mul(b, c)); }
+
+    // xyz cross product; w ends up 0 when both inputs have equal w
+    inline float4 cross3(float4 a, float4 b) {
+        return yzxw(sub(mul(a, yzxw(b)), mul(yzxw(a), b)));
+    }
+
+    // xyz dot product
+    inline float dot3(float4 a, float4 b) {
+        float4 p = mul(a, b);
+        return getX(add(add(p, yzxw(p)), yzxw(yzxw(p))));
+    }
+}
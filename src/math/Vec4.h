@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Vec3.h"
+#include "Simd.h"
+
+// Four-component vector aligned for SIMD loads; w is 1 for points and 0
+// for directions
+struct alignas(16) Vec4 {
+    float x, y, z, w;
+    
+    Vec4() : x(0), y(0), z(0), w(0) {}
+    Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    Vec4(const Vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+    explicit Vec4(float s) : x(s), y(s), z(s), w(s) {}
+    
+    Simd::float4 load() const { return Simd::loadAligned(&x); }
+    static Vec4 from(Simd::float4 v) {
+        Vec4 result;
+        Simd::storeAligned(&result.x, v);
+        return result;
+    }
+    
+    Vec4 operator+(const Vec4& v) const { return from(Simd::add(load(), v.load())); }
+    Vec4 operator-(const Vec4& v) const { return from(Simd::sub(load(), v.load())); }
+    Vec4 operator*(const Vec4& v) const { return from(Simd::mul(load(), v.load())); }
+    Vec4 operator*(float s) const { return from(Simd::mul(load(), Simd::splat(s))); }
+    Vec4 operator/(float s) const { return from(Simd::div(load(), Simd::splat(s))); }
+    Vec4 operator-() const { return from(Simd::sub(Simd::zero(), load())); }
+    
+    Vec4& operator+=(const Vec4& v) { return *this = *this + v; }
+    Vec4& operator-=(const Vec4& v) { return *this = *this - v; }
+    Vec4& operator*=(float s) { return *this = *this * s; }
+    
+    Vec3 xyz() const { return {x, y, z}; }
+    
+    float* data() { return &x; }
+    const float* data() const { return &x; }
+    
+    float& operator[](int index) { return (&x)[index]; }
+    const float& operator[](int index) const { return (&x)[index]; }
+};
+
+inline Vec4 operator*(float s, const Vec4& v) {
+    return v * s;
+}
+
+inline float dot(const Vec4& a, const Vec4& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
@@ -0,0 +1,972 @@
+#include "CpuPathTracer.h"
+#include "MaterialKernels.h"
+#include "PacketIntersector.h"
+#include "scene/Camera.h"
+#include "scene/CompiledScene.h"
+#include "math/Ray.h"
+#include "core/Logger.h"
+#include "core/JobSystem.h"
+#include "utils/Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Constants and routines mirror pathtracer.frag; keep the two in sync
+    constexpr float PI = 3.14159265359f;
+    constexpr float TWO_PI = 6.28318530718f;
+    constexpr float EPSILON = CompiledScene::EPSILON;
+    constexpr float MAX_FLOAT = PacketIntersector::MAX_DISTANCE;
+
+    using Material = CompiledScene::Material;
+
+    using Rng = RandomStream;
+    using MaterialSampling::hemisphereBasis;
+    using MaterialSampling::sampleCosineWeightedHemisphere;
+
+    HitInfo makeHit(const CompiledScene& scene, const Ray& ray, const SceneHit& sceneHit) {
+        HitInfo hit;
+        if (sceneHit.kind == PrimitiveKind::None) return hit;
+
+        hit.hit = true;
+        hit.t = sceneHit.t;
+        hit.point = ray.at(sceneHit.t);
+        hit.normal = scene.getNormal(sceneHit, hit.point);
+        hit.material = &scene.getMaterial(sceneHit);
+        hit.kind = sceneHit.kind;
+        // The shader gives planes a fixed IOR
+        hit.ior = sceneHit.kind == PrimitiveKind::Plane ? 1.5f : hit.material->ior;
+        return hit;
+    }
+
+    HitInfo intersectScene(const CompiledScene& scene, const Ray& ray) {
+        SceneHit sceneHit;
+        scene.intersect(ray.origin, ray.direction, MAX_FLOAT, sceneHit);
+        return makeHit(scene, ray, sceneHit);
+    }
+
+    Vec3 getSkyColor(const Vec3& direction) {
+        const Vec3 sunDir = Vec3{0.2f, 0.6f, 0.4f}.normalized();
+        float sunDot = std::max(0.0f, dot(direction, sunDir));
+        Vec3 sunColor = Vec3{1.2f, 1.0f, 0.8f} * (std::pow(sunDot, 128.0f) * 0.5f);
+
+        float t = std::max(0.0f, direction.y);
+        Vec3 skyGradient = Vec3{0.4f, 0.6f, 0.8f} * (1.0f - t) + Vec3{0.15f, 0.3f, 0.6f} * t;
+
+        float horizonFactor = 1.0f - std::abs(direction.y);
+        Vec3 horizonColor = Vec3{0.6f, 0.5f, 0.4f} * (horizonFactor * 0.2f);
+
+        return (skyGradient + horizonColor + sunColor) * 0.6f;
+    }
+
+    Vec3 clampVec(const Vec3& v, float lo, float hi) {
+        return Vec3{std::clamp(v.x, lo, hi), std::clamp(v.y, lo, hi), std::clamp(v.z, lo, hi)};
+    }
+
+    // Share of guided diffuse bounces that sample the cosine lobe, which
+    // keeps every direction the guide has not learned reachable
+    constexpr float GUIDE_BSDF_FRACTION = 0.5f;
+
+    // Diffuse scattering that draws from the guide's learned incident light
+    // or the cosine lobe, each half the time, weighted by the mixture pdf.
+    // pdf is the mixture density of the chosen direction.
+    bool scatterGuided(const PathGuide::DirectionTree& guide, const Ray& inRay, const HitInfo& hit, Rng& rng,
+                       Vec3& attenuation, Ray& scattered, float& pdf) {
+        Vec3 N = hit.normal.normalized();
+        if (dot(N, inRay.direction) > 0.0f) {
+            N = -N;
+        }
+
+        Vec3 L;
+        float guidePdf = 0.0f;
+        if (rng.next() < GUIDE_BSDF_FRACTION) {
+            L = sampleCosineWeightedHemisphere(N, rng);
+            guidePdf = guide.pdf(L);
+        } else {
+            float u1 = rng.next();
+            float u2 = rng.next();
+            L = guide.sample(u1, u2, guidePdf);
+        }
+
+        // Guided directions below the surface carry nothing
+        float cosTheta = dot(N, L);
+        if (cosTheta <= 0.0f) return false;
+
+        pdf = GUIDE_BSDF_FRACTION * cosTheta / PI + (1.0f - GUIDE_BSDF_FRACTION) * guidePdf;
+        attenuation = hit.material->color * (0.8f * cosTheta / (PI * pdf));
+        scattered = Ray(hit.point + N * (EPSILON * 2.0f), L);
+        return true;
+    }
+
+    float luminance(const Vec3& c) {
+        return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+    }
+
+    // One pixel sample in eight traces in full to train the radiance cache.
+    // A fixed hash rather than the pixel's stream keeps that in step with
+    // the shader.
+    bool isTrainingSample(uint32_t x, uint32_t y, uint32_t sampleIndex) {
+        uint32_t h = (x * 0x8da6b343u) ^ (y * 0xd8163841u) ^ (sampleIndex * 0xcb1ab31fu);
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        return (h & 7u) == 0;
+    }
+
+    constexpr int MAX_CACHE_VERTICES = 16;
+    constexpr int MAX_GUIDE_VERTICES = 16;
+    constexpr int MAX_PHOTON_BOUNCES = 8;
+    // Photons per parallel chunk, each with its own random stream
+    constexpr int PHOTON_CHUNK = 1024;
+    constexpr float MAX_CACHED_RADIANCE = 20.0f;
+
+    // Radiance and throughput of a training path as it reached a diffuse vertex
+    struct CacheVertex {
+        uint64_t key;
+        Vec3 radiance;
+        Vec3 throughput;
+    };
+
+    // A diffuse vertex as its path left it, for the path guide
+    struct GuideVertex {
+        Vec3 position;
+        Vec3 direction;
+        float pdf;
+        Vec3 radiance;
+        Vec3 throughput;    // Of the outgoing ray, before Russian roulette
+    };
+
+    // Gathered radiance past each vertex over the throughput that left it
+    // estimates the incident radiance along the direction taken
+    Vec3 incidentRadiance(const Vec3& gathered, const Vec3& throughput) {
+        return Vec3{gathered.x / std::max(throughput.x, 1e-4f),
+                    gathered.y / std::max(throughput.y, 1e-4f),
+                    gathered.z / std::max(throughput.z, 1e-4f)};
+    }
+
+    bool isEmissive(const Material& material) {
+        return dot(material.emission, material.emission) > 0.0f;
+    }
+
+    // Paths traced together, a bounce at a time, so each bounce's hits can
+    // be intersected in packets and shaded in bins of one material
+    constexpr int WAVEFRONT_SIZE = 64;
+    // Bin after the material types for guided diffuse bounces
+    constexpr int GUIDED_BIN = MaterialKernels::COUNT;
+
+    // Everything a path carries between bounces besides its ray
+    struct PathState {
+        Vec3 radiance{0.0f};
+        Vec3 throughput{1.0f};
+        CacheVertex vertices[MAX_CACHE_VERTICES];
+        int vertexCount = 0;
+        GuideVertex guideVertices[MAX_GUIDE_VERTICES];
+        int guideVertexCount = 0;
+        const PathGuide::DirectionTree* guideLeaf = nullptr;
+        float pdf = 0.0f;
+
+        bool training = false;
+        // Diffuse vertex seen, then at least one specular one since
+        bool afterDiffuse = false;
+        bool causticChain = false;
+        // Guided bounces lower the throughput on purpose where the guide is
+        // dense, so the shader's low-throughput cutoffs would bias them
+        bool wasGuided = false;
+
+        // Leaves the vertex arrays alone, which only the counts make valid
+        void start(bool isTraining) {
+            radiance = Vec3{0.0f};
+            throughput = Vec3{1.0f};
+            vertexCount = 0;
+            guideVertexCount = 0;
+            guideLeaf = nullptr;
+            pdf = 0.0f;
+            training = isTraining;
+            afterDiffuse = false;
+            causticChain = false;
+            wasGuided = false;
+        }
+    };
+
+    // Paths in flight, with the per-bounce arrays the kernels work on
+    struct Wavefront {
+        int count = 0;
+        PathState paths[WAVEFRONT_SIZE];
+        Ray rays[WAVEFRONT_SIZE];
+        Rng rngs[WAVEFRONT_SIZE];
+        HitInfo hits[WAVEFRONT_SIZE];
+        Vec3 attenuation[WAVEFRONT_SIZE];
+        Ray scattered[WAVEFRONT_SIZE];
+        bool alive[WAVEFRONT_SIZE];
+    };
+
+    // Closest hits of the listed paths' rays, a packet at a time
+    void intersectPaths(const CompiledScene& scene, const PacketIntersector& intersector, Wavefront& wave,
+                        const int* paths, int count) {
+        RayPacket packet;
+        PacketHits hits;
+        for (int first = 0; first < count; first += RayPacket::MAX_WIDTH) {
+            packet.count = std::min(RayPacket::MAX_WIDTH, count - first);
+            for (int lane = 0; lane < packet.count; ++lane) {
+                const Ray& ray = wave.rays[paths[first + lane]];
+                packet.set(lane, ray.origin, ray.direction, MAX_FLOAT);
+            }
+
+            intersector.intersect(packet, scene, hits);
+
+            for (int lane = 0; lane < packet.count; ++lane) {
+                int path = paths[first + lane];
+                SceneHit sceneHit;
+                sceneHit.t = hits.t[lane];
+                sceneHit.kind = hits.kind[lane];
+                sceneHit.index = hits.index[lane];
+                wave.hits[path] = makeHit(scene, wave.rays[path], sceneHit);
+            }
+        }
+    }
+
+    // Adds what a path finds at its hit before scattering and returns the
+    // bin to scatter it in, or -1 when the path ends here.
+    //
+    // With a radiance cache, training paths record their diffuse vertices
+    // and the others stop at the first cached diffuse vertex past the camera
+    // hit. With a caustic photon map, diffuse vertices add the photons'
+    // radiance, and light that reaches a diffuse vertex from a sphere or
+    // cube emitter through specular bounces is skipped as the photons carry it.
+    // With a path guide, diffuse vertices sample it.
+    int shadeHit(PathState& path, const Ray& ray, const HitInfo& hit, int bounce,
+                 const CpuPathTracer::TraceCaches* caches) {
+        const RadianceCache::Grid* cache = caches ? caches->radiance : nullptr;
+        const PhotonMap* caustics = caches ? caches->caustics : nullptr;
+        const PathGuide::Tree* guide = caches ? caches->guide : nullptr;
+
+        if (!hit.hit) {
+            path.radiance += path.throughput * getSkyColor(ray.direction);
+            return -1;
+        }
+
+        bool diffuse = MaterialKernels::isDiffuse(hit.material->type);
+        Vec3 facing = dot(hit.normal, ray.direction) > 0.0f ? -hit.normal : hit.normal;
+
+        // Emitters stay out of the cache: their cells would hold emission
+        // that caustic paths must not count
+        if (cache && diffuse && !isEmissive(*hit.material)) {
+            Vec3 cached;
+            if (path.training) {
+                if (path.vertexCount < MAX_CACHE_VERTICES) {
+                    path.vertices[path.vertexCount++] = {cache->makeKey(hit.point, facing), path.radiance,
+                                                         path.throughput};
+                }
+            } else if (bounce > 0 && cache->lookup(hit.point, facing, cached)) {
+                path.radiance += path.throughput * cached;
+                return -1;
+            }
+        }
+
+        bool photonEmitter = caustics && path.causticChain && hit.kind != PrimitiveKind::Plane;
+        if (!photonEmitter && (bounce == 0 || path.wasGuided || dot(path.throughput, path.throughput) > 0.01f)) {
+            path.radiance += path.throughput * hit.material->emission;
+        }
+
+        if (caustics && diffuse) {
+            path.radiance += path.throughput * hit.material->color * (0.8f / PI) * caustics->estimate(hit.point, facing);
+        }
+        if (diffuse) {
+            path.afterDiffuse = true;
+            path.causticChain = false;
+        } else {
+            path.causticChain = path.afterDiffuse;
+        }
+
+        path.guideLeaf = guide && diffuse ? guide->findLeaf(hit.point) : nullptr;
+        if (path.guideLeaf) return GUIDED_BIN;
+        return MaterialKernels::isKnown(hit.material->type) ? hit.material->type : -1;
+    }
+
+    // Applies a scattered bounce to the path; false when it ends here
+    bool continuePath(PathState& path, Ray& ray, const HitInfo& hit, const Vec3& attenuation, const Ray& scattered,
+                      int bounce, Rng& rng, bool recordGuide) {
+        bool guided = path.guideLeaf != nullptr;
+        path.wasGuided = path.wasGuided || guided;
+
+        if (recordGuide && MaterialKernels::isDiffuse(hit.material->type) &&
+            path.guideVertexCount < MAX_GUIDE_VERTICES) {
+            float pdf = guided ? path.pdf : std::abs(dot(hit.normal, scattered.direction)) / PI;
+            path.guideVertices[path.guideVertexCount++] = {hit.point, scattered.direction, pdf, path.radiance,
+                                                           path.throughput * clampVec(attenuation, 0.0f, 2.0f)};
+        }
+
+        // Russian roulette
+        if (bounce > 2) {
+            float maxComponent = std::max(std::max(path.throughput.x, path.throughput.y), path.throughput.z);
+            float rrProbability = std::min(maxComponent * 0.8f, 0.9f);
+            if (rng.next() > rrProbability) {
+                return false;
+            }
+            path.throughput = path.throughput / rrProbability;
+        }
+
+        path.throughput = path.throughput * clampVec(attenuation, 0.0f, 2.0f);
+        ray = scattered;
+
+        return path.wasGuided || dot(path.throughput, path.throughput) >= 0.001f;
+    }
+
+    // Hands what a finished path learned to the caches and returns its sample
+    Vec3 finishPath(const PathState& path, const CpuPathTracer::TraceCaches* caches) {
+        // What the path gathered past each vertex, divided by the throughput
+        // that reached it, is that vertex's outgoing radiance
+        for (int i = 0; i < path.vertexCount; ++i) {
+            const CacheVertex& vertex = path.vertices[i];
+            Vec3 outgoing = incidentRadiance(path.radiance - vertex.radiance, vertex.throughput);
+            if (std::isfinite(outgoing.x) && std::isfinite(outgoing.y) && std::isfinite(outgoing.z)) {
+                caches->radianceSamples->push_back({vertex.key, clampVec(outgoing, 0.0f, MAX_CACHED_RADIANCE)});
+            }
+        }
+
+        for (int i = 0; i < path.guideVertexCount; ++i) {
+            const GuideVertex& vertex = path.guideVertices[i];
+            float weight = luminance(incidentRadiance(path.radiance - vertex.radiance, vertex.throughput)) / vertex.pdf;
+            if (std::isfinite(weight) && vertex.pdf > 0.0f) {
+                caches->guideSamples->push_back({vertex.position, vertex.direction, std::max(weight, 0.0f)});
+            }
+        }
+
+        return clampVec(path.radiance, 0.0f, 50.0f);
+    }
+
+    // Traces every path of the wavefront from its camera ray. Each bounce
+    // intersects the live rays in packets, shades their hits, then counting-
+    // sorts them by material so every bin runs one specialized kernel. A
+    // path draws from its own stream in the same order as when traced alone.
+    void traceWavefront(const CompiledScene& scene, const PacketIntersector& intersector, int maxBounces,
+                        const CpuPathTracer::TraceCaches* caches, Wavefront& wave) {
+        constexpr int BIN_COUNT = MaterialKernels::COUNT + 1;
+        bool recordGuide = caches && caches->guideSamples;
+        const ScatterBatch batch{wave.rays, wave.hits, wave.rngs, wave.attenuation, wave.scattered, wave.alive};
+
+        int live[WAVEFRONT_SIZE];
+        int liveCount = wave.count;
+        for (int i = 0; i < wave.count; ++i) live[i] = i;
+
+        int bin[WAVEFRONT_SIZE];
+        int binned[WAVEFRONT_SIZE];
+
+        for (int bounce = 0; bounce < maxBounces && liveCount > 0; ++bounce) {
+            intersectPaths(scene, intersector, wave, live, liveCount);
+
+            int binStart[BIN_COUNT + 1] = {};
+            for (int i = 0; i < liveCount; ++i) {
+                int path = live[i];
+                bin[path] = shadeHit(wave.paths[path], wave.rays[path], wave.hits[path], bounce, caches);
+                wave.alive[path] = false;
+                if (bin[path] >= 0) ++binStart[bin[path] + 1];
+            }
+            for (int b = 0; b < BIN_COUNT; ++b) binStart[b + 1] += binStart[b];
+
+            int binFill[BIN_COUNT];
+            std::copy(binStart, binStart + BIN_COUNT, binFill);
+            for (int i = 0; i < liveCount; ++i) {
+                int path = live[i];
+                if (bin[path] >= 0) binned[binFill[bin[path]]++] = path;
+            }
+
+            for (int b = 0; b < MaterialKernels::COUNT; ++b) {
+                MaterialKernels::Types::scatterBins[b](binned + binStart[b], binStart[b + 1] - binStart[b], batch);
+            }
+            for (int i = binStart[GUIDED_BIN]; i < binStart[GUIDED_BIN + 1]; ++i) {
+                int path = binned[i];
+                wave.alive[path] = scatterGuided(*wave.paths[path].guideLeaf, wave.rays[path], wave.hits[path],
+                                                 wave.rngs[path], wave.attenuation[path], wave.scattered[path],
+                                                 wave.paths[path].pdf);
+            }
+
+            int nextCount = 0;
+            for (int i = 0; i < liveCount; ++i) {
+                int path = live[i];
+                if (wave.alive[path] &&
+                    continuePath(wave.paths[path], wave.rays[path], wave.hits[path], wave.attenuation[path],
+                                 wave.scattered[path], bounce, wave.rngs[path], recordGuide)) {
+                    live[nextCount++] = path;
+                }
+            }
+            liveCount = nextCount;
+        }
+    }
+
+    // Emissive sphere or cube photons start from, with its share of them
+    struct PhotonEmitter {
+        PrimitiveKind kind;
+        Vec3 center;
+        Vec3 extent;        // Radius in x for spheres, half extents for cubes
+        Vec3 emission;
+        float area;
+        float cdf;          // Cumulative probability, by emitted power
+    };
+
+    // Bounding sphere of a specular sphere or cube photons are aimed at
+    struct PhotonTarget {
+        Vec3 center;
+        float radius;
+    };
+
+    void gatherPhotonSources(const CompiledScene& scene, std::vector<PhotonEmitter>& emitters,
+                             std::vector<PhotonTarget>& targets) {
+        const auto& materials = scene.getMaterials();
+
+        const auto& spheres = scene.getSpheres();
+        for (size_t i = 0; i < spheres.size(); ++i) {
+            const Material& material = materials[spheres.material[i]];
+            Vec3 center{spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]};
+            float radius = spheres.radius[i];
+            if (!MaterialKernels::isDiffuse(material.type)) {
+                targets.push_back({center, radius});
+            } else if (isEmissive(material)) {
+                emitters.push_back({PrimitiveKind::Sphere, center, Vec3{radius}, material.emission,
+                                    4.0f * PI * radius * radius, 0.0f});
+            }
+        }
+
+        const auto& boxes = scene.getBoxes();
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const Material& material = materials[boxes.material[i]];
+            Vec3 center{boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]};
+            Vec3 extent{boxes.halfExtentX[i], boxes.halfExtentY[i], boxes.halfExtentZ[i]};
+            if (!MaterialKernels::isDiffuse(material.type)) {
+                targets.push_back({center, extent.length()});
+            } else if (isEmissive(material)) {
+                float area = 8.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+                emitters.push_back({PrimitiveKind::Cube, center, extent, material.emission, area, 0.0f});
+            }
+        }
+
+        float total = 0.0f;
+        for (PhotonEmitter& emitter : emitters) {
+            total += (emitter.emission.x + emitter.emission.y + emitter.emission.z) * emitter.area;
+            emitter.cdf = total;
+        }
+        for (PhotonEmitter& emitter : emitters) {
+            emitter.cdf /= total;
+        }
+    }
+
+    // Solid angle of a target seen from a point; the whole sphere from inside
+    float coneSolidAngle(const PhotonTarget& target, const Vec3& from, Vec3& axis, float& cosMax) {
+        Vec3 toCenter = target.center - from;
+        float distance = toCenter.length();
+        if (distance <= target.radius) {
+            cosMax = -1.0f;
+            axis = Vec3{0, 1, 0};
+            return 4.0f * PI;
+        }
+        axis = toCenter / distance;
+        float sinMax = target.radius / distance;
+        cosMax = std::sqrt(std::max(0.0f, 1.0f - sinMax * sinMax));
+        return TWO_PI * (1.0f - cosMax);
+    }
+
+    // Samples a photon leaving an emitter towards a randomly chosen target.
+    // Directions are drawn from the mixture of all targets' cones, so its
+    // density covers overlapping cones; the power carries the rest of the
+    // emitted flux estimate.
+    bool emitPhoton(const std::vector<PhotonEmitter>& emitters, const std::vector<PhotonTarget>& targets,
+                    int photonCount, Rng& rng, Ray& ray, Vec3& power) {
+        float pick = rng.next();
+        size_t index = 0;
+        while (index + 1 < emitters.size() && emitters[index].cdf < pick) ++index;
+        const PhotonEmitter& emitter = emitters[index];
+        float probability = emitter.cdf - (index > 0 ? emitters[index - 1].cdf : 0.0f);
+
+        Vec3 point, normal;
+        if (emitter.kind == PrimitiveKind::Sphere) {
+            float z = 1.0f - 2.0f * rng.next();
+            float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            float phi = TWO_PI * rng.next();
+            normal = Vec3{r * std::cos(phi), r * std::sin(phi), z};
+            point = emitter.center + normal * emitter.extent.x;
+        } else {
+            // Face by area, then a uniform point on it
+            Vec3 e = emitter.extent;
+            float faceAreas[3] = {e.y * e.z, e.z * e.x, e.x * e.y};
+            float u = rng.next() * (faceAreas[0] + faceAreas[1] + faceAreas[2]);
+            int axis = u < faceAreas[0] ? 0 : (u < faceAreas[0] + faceAreas[1] ? 1 : 2);
+            float side = rng.next() < 0.5f ? -1.0f : 1.0f;
+            Vec3 offset{(2.0f * rng.next() - 1.0f) * e.x, (2.0f * rng.next() - 1.0f) * e.y,
+                        (2.0f * rng.next() - 1.0f) * e.z};
+            offset[axis] = side * e[axis];
+            normal = Vec3{0.0f};
+            normal[axis] = side;
+            point = emitter.center + offset;
+        }
+
+        const PhotonTarget& target = targets[std::min(static_cast<size_t>(rng.next() * targets.size()),
+                                                      targets.size() - 1)];
+        Vec3 axis;
+        float cosMax;
+        coneSolidAngle(target, point, axis, cosMax);
+        float cosTheta = 1.0f - rng.next() * (1.0f - cosMax);
+        float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+        Vec3 direction = hemisphereBasis(axis, cosTheta, sinTheta, TWO_PI * rng.next()).normalized();
+
+        float cosEmit = dot(normal, direction);
+        if (cosEmit <= 0.0f) return false;
+
+        float density = 0.0f;
+        for (const PhotonTarget& other : targets) {
+            Vec3 otherAxis;
+            float otherCosMax;
+            float solidAngle = coneSolidAngle(other, point, otherAxis, otherCosMax);
+            if (dot(direction, otherAxis) >= otherCosMax) {
+                density += 1.0f / solidAngle;
+            }
+        }
+        density /= static_cast<float>(targets.size());
+
+        power = emitter.emission * (cosEmit * emitter.area / (probability * density * photonCount));
+        ray = Ray(point + normal * (EPSILON * 2.0f), direction);
+        return true;
+    }
+
+    // Follows a photon through specular and glass surfaces and stores it at
+    // the first diffuse surface after at least one of them
+    void tracePhoton(const CompiledScene& scene, Ray ray, Vec3 power, Rng& rng,
+                     std::vector<PhotonMap::Photon>& photons) {
+        bool specular = false;
+        for (int bounce = 0; bounce < MAX_PHOTON_BOUNCES; ++bounce) {
+            HitInfo hit = intersectScene(scene, ray);
+            if (!hit.hit) return;
+
+            if (MaterialKernels::isDiffuse(hit.material->type)) {
+                if (specular) photons.push_back({hit.point, power, ray.direction});
+                return;
+            }
+
+            Vec3 attenuation;
+            Ray scattered;
+            if (!MaterialKernels::scatter(ray, hit, rng, attenuation, scattered)) return;
+
+            power = power * clampVec(attenuation, 0.0f, 2.0f);
+            ray = scattered;
+            specular = true;
+        }
+    }
+
+    uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        // FNV-1a
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+}
+
+CpuPathTracer::CpuPathTracer() {
+    LOG_INFO("CPU path tracer running on {} job workers", JobSystem::getWorkerCount());
+}
+
+CpuPathTracer::~CpuPathTracer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    // Queued tiles see m_stop and return at once
+    JobSystem::wait(m_jobs);
+}
+
+CpuPathTracer::View CpuPathTracer::makeView(const Camera& camera, int maxBounces, int width, int height) {
+    View view;
+    view.position = camera.getPosition();
+    view.direction = camera.getDirection();
+    view.up = camera.getUp();
+    view.right = camera.getRight();
+    view.fov = camera.getFov();
+    view.maxBounces = maxBounces;
+    view.width = std::max(width, 1);
+    view.height = std::max(height, 1);
+    view.seed = Random::getSeed();
+    return view;
+}
+
+void CpuPathTracer::update(const CompiledScene& scene, const Camera& camera, int maxBounces, int width, int height) {
+    View view = makeView(camera, maxBounces, width, height);
+    bool useCache = m_cacheEnabled.load();
+    bool useCaustics = m_causticsEnabled.load();
+    bool useGuiding = m_guidingEnabled.load();
+
+    bool sameScene = false;
+    uint64_t sceneHash = 0;
+    {
+        // Exact comparison; any change at all restarts accumulation
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sameScene = m_frame && m_frame->scene.getRevision() == scene.getRevision();
+        if (sameScene && m_frame->useCache == useCache && m_frame->useCaustics == useCaustics &&
+            m_frame->useGuiding == useGuiding && std::memcmp(&m_frame->view, &view, sizeof(View)) == 0) {
+            return;
+        }
+        if (sameScene) sceneHash = m_frame->sceneHash;
+    }
+
+    auto frame = std::make_shared<Frame>();
+    frame->view = view;
+    frame->scene = scene;
+    frame->useCache = useCache;
+    frame->useCaustics = useCaustics;
+    frame->useGuiding = useGuiding;
+
+    // Runs with other seeds add independent samples, so the seed stays out.
+    // The scene counts by content, so a reloaded scene matches its own
+    // checkpoints whatever order its objects arrived in.
+    frame->sceneHash = sameScene ? sceneHash : scene.getContentHash();
+    View unseeded = view;
+    unseeded.seed = 0;
+    bool flags[] = {useCache, useCaustics, useGuiding};
+    uint64_t hash = hashBytes(0xcbf29ce484222325ull, &frame->sceneHash, sizeof(frame->sceneHash));
+    hash = hashBytes(hash, &unseeded, sizeof(unseeded));
+    frame->viewHash = hashBytes(hash, flags, sizeof(flags));
+
+    restart(std::move(frame));
+}
+
+void CpuPathTracer::saveCheckpoint(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_checkpointPath = path;
+}
+
+bool CpuPathTracer::resume(const RenderCheckpoint& checkpoint) {
+    auto frame = std::make_shared<Frame>();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_frame || m_frame->viewHash != checkpoint.viewHash || checkpoint.tileSize != TILE_SIZE ||
+            checkpoint.width != m_frame->view.width || checkpoint.height != m_frame->view.height ||
+            checkpoint.tileSamples.size() != static_cast<size_t>(m_image.getTileCount()) ||
+            checkpoint.accumulation.size() != static_cast<size_t>(checkpoint.width) * checkpoint.height) {
+            return false;
+        }
+
+        // A frame of its own, so tiles queued before see a new generation
+        frame->view = m_frame->view;
+        frame->scene = m_frame->scene;
+        frame->useCache = m_frame->useCache;
+        frame->useCaustics = m_frame->useCaustics;
+        frame->useGuiding = m_frame->useGuiding;
+        frame->sceneHash = m_frame->sceneHash;
+        frame->viewHash = m_frame->viewHash;
+    }
+
+    restart(std::move(frame), &checkpoint);
+    return true;
+}
+
+void CpuPathTracer::restart(std::shared_ptr<Frame> frame, const RenderCheckpoint* checkpoint) {
+    int tileCount = 0;
+    uint64_t generation = 0;
+    uint32_t firstSample = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Cached light near edited objects is stale; camera moves keep it all.
+        // Under the lock, so no tile of the old frame can add samples after.
+        if (m_frame && m_frame->scene.getRevision() != frame->scene.getRevision()) {
+            std::vector<AABB> changed;
+            if (frame->scene.getChangedBounds(m_frame->scene, changed)) {
+                m_radianceCache.invalidate(changed);
+            } else {
+                m_radianceCache.clear();
+            }
+            // The guide's tree follows the old geometry throughout
+            m_pathGuide.clear();
+        }
+
+        frame->generation = m_frame ? m_frame->generation + 1 : 1;
+        frame->tilesX = (frame->view.width + TILE_SIZE - 1) / TILE_SIZE;
+        frame->tilesY = (frame->view.height + TILE_SIZE - 1) / TILE_SIZE;
+
+        m_image.reset(frame->view.width, frame->view.height, TILE_SIZE, JobSystem::getNodeCount());
+        m_tilesRemaining = frame->tilesX * frame->tilesY;
+        m_pass = 0;
+        m_firstSample = 0;
+        m_resumedSegments.clear();
+
+        // Continue past the checkpoint's sample indices for this seed, so no
+        // path is traced twice
+        if (checkpoint) {
+            m_image.restore(checkpoint->accumulation.data(), checkpoint->tileSamples);
+            const std::vector<int>& samples = checkpoint->tileSamples;
+            m_pass = samples.empty() ? 0 : *std::min_element(samples.begin(), samples.end());
+            m_firstSample = checkpoint->getNextSample(frame->view.seed);
+            m_resumedSegments = checkpoint->segments;
+        }
+        m_completedPasses = m_pass;
+
+        tileCount = m_tilesRemaining;
+        generation = frame->generation;
+        firstSample = m_firstSample;
+        m_frame = std::move(frame);
+    }
+
+    // Tiles still queued for the old frame are skipped by their generation
+    queuePass(tileCount, static_cast<int>(firstSample), generation);
+}
+
+void CpuPathTracer::queuePass(int tileCount, int pass, uint64_t generation) {
+    JobSystem::run([this, tileCount, pass, generation] { preparePass(tileCount, pass, generation); }, &m_jobs);
+}
+
+void CpuPathTracer::preparePass(int tileCount, int pass, uint64_t generation) {
+    std::shared_ptr<const Frame> frame;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return;
+        frame = m_frame;
+    }
+    if (!frame || frame->generation != generation) return;
+
+    // Fresh photons and a smaller radius every pass
+    std::shared_ptr<const PhotonMap> caustics;
+    if (frame->useCaustics) {
+        caustics = traceCaustics(frame->scene, frame->view.seed, pass, PHOTONS_PER_PASS,
+                                 PhotonMap::radiusForPass(CAUSTIC_RADIUS, pass));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop || m_frame->generation != generation) return;
+        // Tiles of the previous pass are all committed by now
+        m_caustics = std::move(caustics);
+    }
+
+    // Each tile runs on the node holding its rows of the image
+    int nodeCount = JobSystem::getNodeCount();
+    for (int tile = 0; tile < tileCount; ++tile) {
+        TileJob job{tile, pass, generation};
+        int node = ProgressiveImage::getBandNode(tile / frame->tilesX, frame->tilesY, nodeCount);
+        JobSystem::run([this, job] { runTile(job); }, &m_jobs, node);
+    }
+}
+
+std::shared_ptr<const PhotonMap> CpuPathTracer::traceCaustics(const CompiledScene& scene, uint32_t seed, int pass,
+                                                              int photonCount, float radius) {
+    std::vector<PhotonEmitter> emitters;
+    std::vector<PhotonTarget> targets;
+    gatherPhotonSources(scene, emitters, targets);
+    if (emitters.empty() || targets.empty()) return nullptr;
+
+    int chunkCount = (photonCount + PHOTON_CHUNK - 1) / PHOTON_CHUNK;
+    std::vector<std::vector<PhotonMap::Photon>> chunks(chunkCount);
+
+    // One stream per chunk, in the photon row so pixel and editor streams
+    // never share its keys
+    JobSystem::parallelFor(0, chunkCount, 1, [&](int begin, int end) {
+        for (int chunk = begin; chunk < end; ++chunk) {
+            Rng rng(static_cast<uint32_t>(chunk), Rng::PHOTON_ROW, static_cast<uint32_t>(pass), seed);
+            int count = std::min(PHOTON_CHUNK, photonCount - chunk * PHOTON_CHUNK);
+            for (int i = 0; i < count; ++i) {
+                Ray ray;
+                Vec3 power;
+                if (emitPhoton(emitters, targets, photonCount, rng, ray, power)) {
+                    tracePhoton(scene, ray, power, rng, chunks[chunk]);
+                }
+            }
+        }
+    });
+
+    std::vector<PhotonMap::Photon> photons;
+    for (const auto& chunk : chunks) {
+        photons.insert(photons.end(), chunk.begin(), chunk.end());
+    }
+    return std::make_shared<const PhotonMap>(std::move(photons), radius);
+}
+
+int CpuPathTracer::getCausticPhotonCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_caustics ? static_cast<int>(m_caustics->size()) : 0;
+}
+
+float CpuPathTracer::getCausticRadius() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_caustics ? m_caustics->getRadius() : 0.0f;
+}
+
+void CpuPathTracer::runTile(const TileJob& job) {
+    std::shared_ptr<const Frame> frame;
+    std::shared_ptr<const PhotonMap> caustics;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return;
+        frame = m_frame;
+        caustics = m_caustics;
+    }
+    if (!frame || frame->generation != job.generation) return;
+
+    thread_local std::vector<Vec3> radiance(TILE_SIZE * TILE_SIZE);
+    thread_local std::vector<RadianceCache::Sample> cacheSamples;
+    thread_local std::vector<PathGuide::Sample> guideSamples;
+    cacheSamples.clear();
+    guideSamples.clear();
+
+    // Lookups see the cache as of the end of the previous pass
+    std::shared_ptr<const RadianceCache::Grid> grid;
+    TraceCaches caches;
+    if (frame->useCache) {
+        grid = m_radianceCache.getGrid();
+        caches.radiance = grid.get();
+        caches.radianceSamples = &cacheSamples;
+    }
+    caches.caustics = caustics.get();
+
+    // Guided by the tree of the last finished iteration, training the next
+    std::shared_ptr<const PathGuide::Tree> guide;
+    if (frame->useGuiding) {
+        guide = m_pathGuide.getTree();
+        caches.guide = guide.get();
+        caches.guideSamples = &guideSamples;
+    }
+
+    int x0 = (job.tile % frame->tilesX) * TILE_SIZE;
+    int y0 = (job.tile / frame->tilesX) * TILE_SIZE;
+    int x1 = std::min(x0 + TILE_SIZE, frame->view.width);
+    int y1 = std::min(y0 + TILE_SIZE, frame->view.height);
+    traceRect(frame->view, frame->sceneReplicas.get(), m_simdLevel.load(), x0, y0, x1, y1,
+              static_cast<uint32_t>(job.pass), radiance.data(), TILE_SIZE, &caches);
+    commitTile(*frame, job, radiance, cacheSamples, guideSamples);
+}
+
+void CpuPathTracer::traceRect(const View& view, const CompiledScene& scene, SimdLevel level,
+                              int x0, int y0, int x1, int y1, uint32_t sampleIndex, Vec3* radiance, int stride,
+                              const TraceCaches* caches) {
+    float halfHeight = std::tan(view.fov * 0.5f * PI / 180.0f);
+    const float aperture = 0.03f;
+    const float focusDistance = 10.0f;
+
+    // Pixels are traced a wavefront at a time in row order; primary rays are
+    // coherent within a tile, so their packets hit the same primitives
+    PacketIntersector intersector(level);
+    // Reused across calls on each thread; too large to build per tile
+    thread_local Wavefront wave;
+    int rectWidth = x1 - x0;
+    int pixelCount = rectWidth * (y1 - y0);
+
+    for (int first = 0; first < pixelCount; first += WAVEFRONT_SIZE) {
+        wave.count = std::min(WAVEFRONT_SIZE, pixelCount - first);
+
+        for (int i = 0; i < wave.count; ++i) {
+            int x = x0 + (first + i) % rectWidth;
+            int y = y0 + (first + i) / rectWidth;
+
+            // Same stream as the shader's for this pixel and sample
+            Rng& rng = wave.rngs[i];
+            rng = Rng(static_cast<uint32_t>(x), static_cast<uint32_t>(y), sampleIndex, view.seed);
+
+            float u = (2.0f * (x + 0.5f) - view.width) / view.height;
+            float v = (2.0f * (y + 0.5f) - view.height) / view.height;
+            float jitterX = (rng.next() - 0.5f) * 0.8f / view.width;
+            float jitterY = (rng.next() - 0.5f) * 0.8f / view.height;
+
+            Vec3 rayDir = (view.right * ((u + jitterX) * halfHeight) +
+                           view.up * ((v + jitterY) * halfHeight) + view.direction).normalized();
+
+            // Thin-lens depth of field as in getCameraRay
+            float rdX = aperture * (rng.next() - 0.5f) * 2.0f;
+            float rdY = aperture * (rng.next() - 0.5f) * 2.0f;
+            Vec3 origin = view.position + view.right * rdX + view.up * rdY;
+            Vec3 focusPoint = view.position + rayDir * focusDistance;
+
+            wave.rays[i] = Ray(origin, (focusPoint - origin).normalized());
+            wave.paths[i].start(caches && caches->radiance &&
+                                isTrainingSample(static_cast<uint32_t>(x), static_cast<uint32_t>(y), sampleIndex));
+        }
+
+        traceWavefront(scene, intersector, view.maxBounces, caches, wave);
+
+        // In pixel order, so the caches see samples in a fixed order
+        for (int i = 0; i < wave.count; ++i) {
+            int x = (first + i) % rectWidth;
+            int y = (first + i) / rectWidth;
+
+            Vec3 sample = finishPath(wave.paths[i], caches);
+            if (!std::isfinite(sample.x) || !std::isfinite(sample.y) || !std::isfinite(sample.z)) {
+                sample = Vec3{0.0f};
+            }
+
+            radiance[y * stride + x] = clampVec(sample, 0.0f, 20.0f);
+        }
+    }
+}
+
+void CpuPathTracer::commitTile(const Frame& frame, const TileJob& job, const std::vector<Vec3>& radiance,
+                               const std::vector<RadianceCache::Sample>& cacheSamples,
+                               const std::vector<PathGuide::Sample>& guideSamples) {
+    int nextPassTiles = 0;
+    bool passDone = false;
+    std::shared_ptr<RenderCheckpoint> checkpoint;
+    std::string checkpointPath;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop || !m_frame || m_frame->generation != job.generation) return;
+
+        m_image.addTile(job.tile, radiance.data(), TILE_SIZE);
+        if (!cacheSamples.empty()) {
+            m_radianceCache.addSamples(cacheSamples);
+        }
+        if (!guideSamples.empty()) {
+            m_pathGuide.addSamples(guideSamples);
+        }
+
+        // The last tile of a pass queues the next one
+        if (--m_tilesRemaining == 0) {
+            passDone = true;
+            m_completedPasses = ++m_pass;
+            if (m_pass < MAX_PASSES) {
+                m_tilesRemaining = frame.tilesX * frame.tilesY;
+                nextPassTiles = m_tilesRemaining;
+            }
+
+            // Every tile holds the same passes now; the copy is written on a job
+            if (!m_checkpointPath.empty() && !m_checkpointWriting.exchange(true)) {
+                checkpoint = std::make_shared<RenderCheckpoint>();
+                checkpoint->viewHash = frame.viewHash;
+                checkpoint->width = m_image.getWidth();
+                checkpoint->height = m_image.getHeight();
+                checkpoint->tileSize = TILE_SIZE;
+                checkpoint->segments = m_resumedSegments;
+                checkpoint->segments.push_back({frame.view.seed, m_firstSample,
+                                                static_cast<uint32_t>(job.pass + 1) - m_firstSample});
+                checkpoint->tileSamples = m_image.getTileSamples();
+                checkpoint->accumulation.assign(m_image.getAccumulation(),
+                                                m_image.getAccumulation() + static_cast<size_t>(m_image.getWidth()) *
+                                                                            m_image.getHeight());
+                checkpointPath = std::move(m_checkpointPath);
+                m_checkpointPath.clear();
+            }
+        }
+    }
+
+    // The next pass reads what this one trained
+    if (passDone && frame.useCache) {
+        m_radianceCache.publish();
+    }
+    if (passDone && frame.useGuiding) {
+        m_pathGuide.finishPass();
+    }
+    if (nextPassTiles > 0) {
+        queuePass(nextPassTiles, job.pass + 1, job.generation);
+    }
+    // Queued last, so this worker writes it before popping the new pass
+    if (checkpoint) {
+        JobSystem::run([this, checkpoint, checkpointPath] {
+            if (checkpoint->save(checkpointPath)) {
+                LOG_INFO("Checkpoint of {} samples per pixel saved to '{}'", checkpoint->tileSamples.front(),
+                         checkpointPath);
+            }
+            m_checkpointWriting = false;
+        }, &m_jobs);
+    }
+}
+
+void CpuPathTracer::present(unsigned int targetFramebuffer, int targetWidth, int targetHeight) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_frame) return;
+    m_image.present(targetFramebuffer, targetWidth, targetHeight);
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "PathGuide.h"
+#include "PhotonMap.h"
+#include "ProgressiveImage.h"
+#include "RadianceCache.h"
+#include "RenderCheckpoint.h"
+#include "core/CpuFeatures.h"
+#include "core/JobSystem.h"
+#include "core/NodeReplicas.h"
+#include "scene/CompiledScene.h"
+#include "math/Vec3.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Camera;
+
+// CPU port of pathtracer.frag: the same camera model, intersection
+// routines, materials, sky and random number stream, so its converged image
+// matches the GPU one statistically. Tiles are traced progressively, one
+// sample per pixel per pass, as JobSystem jobs, and accumulated in HDR.
+class CpuPathTracer {
+public:
+    CpuPathTracer();
+    ~CpuPathTracer();
+
+    // Restarts accumulation whenever the scene, camera, bounce count,
+    // resolution or Random seed differ from the image being refined
+    void update(const CompiledScene& scene, const Camera& camera, int maxBounces, int width, int height);
+
+    // Uploads finished tiles and blits the image into the target framebuffer
+    void present(unsigned int targetFramebuffer, int targetWidth, int targetHeight);
+
+    int getCompletedPasses() const { return m_completedPasses.load(); }
+
+    // Saves the image to path when the current pass completes, writing it
+    // on a job; ignored while the previous save is still being written
+    void saveCheckpoint(const std::string& path);
+    // Replaces the image with the checkpoint's and continues from there,
+    // when it is of the current frame's view
+    bool resume(const RenderCheckpoint& checkpoint);
+
+    // Instruction set for primary-ray packets; every level gives identical
+    // hits, so switching does not restart accumulation
+    void setSimdLevel(SimdLevel level) { m_simdLevel = std::min(level, CpuFeatures::getSimdLevel()); }
+    SimdLevel getSimdLevel() const { return m_simdLevel.load(); }
+
+    // Ends paths at cached diffuse radiance after the first bounce; toggling
+    // restarts accumulation, while the cache itself is kept
+    void setRadianceCacheEnabled(bool enabled) { m_cacheEnabled = enabled; }
+    bool isRadianceCacheEnabled() const { return m_cacheEnabled.load(); }
+    int getRadianceCacheCells() const { return m_radianceCache.getGrid()->getCellCount(); }
+
+    // Traces caustic photons before every pass and reads them at diffuse
+    // hits; toggling restarts accumulation
+    void setCausticsEnabled(bool enabled) { m_causticsEnabled = enabled; }
+    bool isCausticsEnabled() const { return m_causticsEnabled.load(); }
+    // Of the current pass; zero when off or the scene has no caustics
+    int getCausticPhotonCount() const;
+    float getCausticRadius() const;
+
+    // Samples diffuse bounces from a guide learned from earlier passes;
+    // toggling restarts accumulation, while guide updates keep it going
+    void setPathGuidingEnabled(bool enabled) { m_guidingEnabled = enabled; }
+    bool isPathGuidingEnabled() const { return m_guidingEnabled.load(); }
+    int getPathGuideIteration() const { return m_pathGuide.getIteration(); }
+    size_t getPathGuideMemory() const { return m_pathGuide.getMemoryUsage(); }
+
+    static constexpr int TILE_SIZE = 32;
+    static constexpr int MAX_PASSES = 4096;
+    static constexpr int PHOTONS_PER_PASS = 1 << 16;
+    // Caustic lookup radius of the first pass, in world units
+    static constexpr float CAUSTIC_RADIUS = 0.1f;
+
+    // Camera and settings a frame is traced with
+    struct View {
+        Vec3 position;
+        Vec3 direction;
+        Vec3 up;
+        Vec3 right;
+        float fov = 45.0f;
+        int maxBounces = 8;
+        int width = 0;
+        int height = 0;
+        uint32_t seed = 0;
+    };
+
+    static View makeView(const Camera& camera, int maxBounces, int width, int height);
+
+    // Per-pass state a traced rect reads, and the samples it trains; null
+    // members are skipped
+    struct TraceCaches {
+        const RadianceCache::Grid* radiance = nullptr;
+        std::vector<RadianceCache::Sample>* radianceSamples = nullptr;
+        const PhotonMap* caustics = nullptr;
+        const PathGuide::Tree* guide = nullptr;
+        std::vector<PathGuide::Sample>* guideSamples = nullptr;
+    };
+
+    // Caustic photons for one pass: emitted from the scene's emissive
+    // spheres and cubes towards its specular ones. Null when the scene lacks
+    // either.
+    static std::shared_ptr<const PhotonMap> traceCaustics(const CompiledScene& scene, uint32_t seed, int pass,
+                                                          int photonCount, float radius);
+
+    // Traces sample sampleIndex of every pixel in [x0, x1) x [y0, y1) into
+    // radiance, row by row with the given stride. Stateless and thread-safe;
+    // also used by the hybrid CPU+GPU renderer and render workers.
+    static void traceRect(const View& view, const CompiledScene& scene, SimdLevel level,
+                          int x0, int y0, int x1, int y1, uint32_t sampleIndex, Vec3* radiance, int stride,
+                          const TraceCaches* caches = nullptr);
+
+private:
+    // One unit of work: a screen tile for one pass of one frame
+    struct TileJob {
+        int tile = 0;
+        int pass = 0;
+        uint64_t generation = 0;
+    };
+
+    // Immutable snapshot the workers trace against
+    struct Frame {
+        View view;
+        CompiledScene scene;
+        // Tiles trace the copy on their own NUMA node
+        NodeReplicas<CompiledScene> sceneReplicas{scene};
+        uint64_t generation = 0;
+        int tilesX = 0;
+        int tilesY = 0;
+        bool useCache = false;
+        bool useCaustics = false;
+        bool useGuiding = false;
+        // Scene content alone, kept across camera moves, and everything
+        // checkpoints must agree on
+        uint64_t sceneHash = 0;
+        uint64_t viewHash = 0;
+    };
+
+    // Starts accumulating frame, from checkpoint's image when given
+    void restart(std::shared_ptr<Frame> frame, const RenderCheckpoint* checkpoint = nullptr);
+    void queuePass(int tileCount, int pass, uint64_t generation);
+    // Traces the pass's photons, then queues its tiles
+    void preparePass(int tileCount, int pass, uint64_t generation);
+    void runTile(const TileJob& job);
+    void commitTile(const Frame& frame, const TileJob& job, const std::vector<Vec3>& radiance,
+                    const std::vector<RadianceCache::Sample>& cacheSamples,
+                    const std::vector<PathGuide::Sample>& guideSamples);
+
+    // Every queued tile, so shutdown can wait for them
+    JobCounter m_jobs;
+
+    mutable std::mutex m_mutex;
+    bool m_stop = false;
+
+    // Guarded by m_mutex
+    std::shared_ptr<const Frame> m_frame;
+    std::shared_ptr<const PhotonMap> m_caustics;
+    ProgressiveImage m_image;
+    int m_tilesRemaining = 0;
+    int m_pass = 0;
+    // Sample index of the frame's first pass, past those of a resumed
+    // checkpoint, and the samples that checkpoint held
+    uint32_t m_firstSample = 0;
+    std::vector<RenderCheckpoint::Segment> m_resumedSegments;
+    std::string m_checkpointPath;
+
+    std::atomic<bool> m_checkpointWriting{false};
+
+    RadianceCache m_radianceCache;
+    std::atomic<bool> m_cacheEnabled{false};
+    std::atomic<bool> m_causticsEnabled{false};
+
+    PathGuide m_pathGuide;
+    std::atomic<bool> m_guidingEnabled{false};
+
+    std::atomic<int> m_completedPasses{0};
+    std::atomic<SimdLevel> m_simdLevel{CpuFeatures::getSimdLevel()};
+};
@@ -0,0 +1,298 @@
+#include "DistributedRenderer.h"
+#include "RenderProtocol.h"
+#include "scene/Camera.h"
+#include "core/Logger.h"
+#include "utils/Socket.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+    double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // How long a connection thread waits for results before refilling
+    constexpr int POLL_INTERVAL_MS = 5;
+}
+
+DistributedRenderer::DistributedRenderer(const std::vector<std::string>& endpoints) {
+    m_rateTime = now();
+
+    for (const std::string& endpoint : endpoints) {
+        auto connection = std::make_unique<Connection>();
+        connection->endpoint = endpoint;
+        connection->host = "127.0.0.1";
+        connection->port = RenderProtocol::DEFAULT_PORT;
+        if (!Socket::parseEndpoint(endpoint, connection->host, connection->port)) {
+            LOG_ERROR("Invalid render worker endpoint: {}", endpoint);
+            continue;
+        }
+        connection->status.endpoint = endpoint;
+        m_connections.push_back(std::move(connection));
+    }
+
+    for (auto& connection : m_connections) {
+        Connection* target = connection.get();
+        connection->thread = std::thread([this, target] { runConnection(*target); });
+    }
+
+    LOG_INFO("Distributed renderer coordinating {} render workers", m_connections.size());
+}
+
+DistributedRenderer::~DistributedRenderer() {
+    m_stop = true;
+    for (auto& connection : m_connections) {
+        connection->thread.join();
+    }
+}
+
+void DistributedRenderer::update(const CompiledScene& scene, const Camera& camera, int maxBounces, int width, int height) {
+    View view = CpuPathTracer::makeView(camera, maxBounces, width, height);
+
+    {
+        // Exact comparison; any change at all restarts accumulation
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_frame && m_sceneRevision == scene.getRevision() &&
+            std::memcmp(&m_frame->view, &view, sizeof(View)) == 0) {
+            return;
+        }
+    }
+
+    auto frame = std::make_shared<Frame>();
+    frame->view = view;
+    frame->tilesX = (view.width + TILE_SIZE - 1) / TILE_SIZE;
+    frame->tileCount = frame->tilesX * ((view.height + TILE_SIZE - 1) / TILE_SIZE);
+    frame->itemCount = static_cast<int64_t>(frame->tileCount) * MAX_PASSES;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    frame->generation = m_frame ? m_frame->generation + 1 : 1;
+
+    RenderProtocol::FrameHeader header;
+    header.generation = frame->generation;
+    frame->message.resize(sizeof(header) + sizeof(View));
+    std::memcpy(frame->message.data(), &header, sizeof(header));
+    std::memcpy(frame->message.data() + sizeof(header), &view, sizeof(View));
+    scene.serialize(frame->message);
+
+    m_frame = std::move(frame);
+    m_sceneRevision = scene.getRevision();
+    m_nextItem = 0;
+    m_retryItems.clear();
+    m_completedItems = 0;
+    m_image.reset(view.width, view.height, TILE_SIZE);
+}
+
+void DistributedRenderer::present(unsigned int targetFramebuffer, int targetWidth, int targetHeight) {
+    int64_t completed = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_image.present(targetFramebuffer, targetWidth, targetHeight);
+        completed = m_completedItems;
+    }
+
+    // Over about a second; a restart counts as zero rather than negative
+    double time = now();
+    if (time - m_rateTime >= 1.0) {
+        float rate = static_cast<float>((completed - m_rateItems) / (time - m_rateTime));
+        m_tileRate = rate > 0.0f ? rate : 0.0f;
+        m_rateItems = completed;
+        m_rateTime = time;
+    }
+}
+
+std::vector<DistributedRenderer::WorkerStatus> DistributedRenderer::getWorkerStatus() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<WorkerStatus> status;
+    for (const auto& connection : m_connections) {
+        status.push_back(connection->status);
+    }
+    return status;
+}
+
+int DistributedRenderer::getConnectedWorkers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(std::count_if(m_connections.begin(), m_connections.end(),
+                                          [](const auto& connection) { return connection->status.connected; }));
+}
+
+int DistributedRenderer::getCompletedPasses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_frame) return 0;
+    return static_cast<int>(m_completedItems / m_frame->tileCount);
+}
+
+bool DistributedRenderer::takeItem(int64_t& item) {
+    if (!m_frame) return false;
+
+    if (!m_retryItems.empty()) {
+        item = m_retryItems.front();
+        m_retryItems.pop_front();
+        return true;
+    }
+    if (m_nextItem >= m_frame->itemCount) return false;
+    item = m_nextItem++;
+    return true;
+}
+
+void DistributedRenderer::runConnection(Connection& connection) {
+    bool announced = false;
+
+    while (!m_stop) {
+        Socket socket = Socket::connect(connection.host, connection.port);
+
+        RenderProtocol::MessageType type;
+        std::vector<uint8_t> payload;
+        RenderProtocol::Hello hello;
+        bool handshake = false;
+        if (socket.isValid()) {
+            // Bounds every blocking receive, including a message cut off halfway
+            socket.setReceiveTimeout(RESPONSE_TIMEOUT_MS);
+            handshake = RenderProtocol::receive(socket, type, payload) &&
+                        type == RenderProtocol::MessageType::Hello && payload.size() == sizeof(hello);
+            if (handshake) {
+                std::memcpy(&hello, payload.data(), sizeof(hello));
+                handshake = hello.version == RenderProtocol::VERSION && hello.threadCount > 0;
+            }
+        }
+
+        if (!handshake) {
+            if (!announced) {
+                LOG_WARN("Render worker {} unavailable, retrying", connection.endpoint);
+                announced = true;
+            }
+            for (int waited = 0; waited < RECONNECT_DELAY_MS && !m_stop; waited += 50) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            continue;
+        }
+
+        int threads = static_cast<int>(hello.threadCount);
+        LOG_INFO("Render worker {} connected with {} threads", connection.endpoint, threads);
+        announced = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            connection.status.connected = true;
+            connection.status.threads = threads;
+        }
+
+        uint64_t generation = 0;
+        std::vector<Request> pending;
+        serve(connection, socket, threads, generation, pending);
+        requeue(generation, pending);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            connection.status.connected = false;
+        }
+        if (!m_stop) {
+            m_lostWorkers.fetch_add(1);
+            LOG_WARN("Lost render worker {}; {} tiles requeued", connection.endpoint, pending.size());
+        }
+    }
+}
+
+void DistributedRenderer::serve(Connection& connection, Socket& socket, int threads,
+                                uint64_t& generation, std::vector<Request>& pending) {
+    // Enough requests queued on the worker to cover the round trip
+    size_t window = static_cast<size_t>(threads) * 2;
+    std::vector<RenderProtocol::TileRequest> requests;
+
+    while (!m_stop) {
+        std::shared_ptr<const Frame> frame;
+        requests.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            frame = m_frame;
+            if (frame && frame->generation != generation) {
+                // Requests of the old frame are dropped on both sides
+                pending.clear();
+            }
+
+            int64_t item = 0;
+            double time = now();
+            while (frame && pending.size() < window && takeItem(item)) {
+                pending.push_back({item, time});
+
+                int tile = static_cast<int>(item % frame->tileCount);
+                RenderProtocol::TileRequest request;
+                request.generation = frame->generation;
+                request.item = item;
+                request.sampleIndex = static_cast<uint32_t>(item / frame->tileCount);
+                m_image.getTileRect(tile, request.x0, request.y0, request.x1, request.y1);
+                requests.push_back(request);
+            }
+        }
+
+        if (frame && frame->generation != generation) {
+            if (!RenderProtocol::send(socket, RenderProtocol::MessageType::Frame,
+                                      frame->message.data(), frame->message.size())) {
+                return;
+            }
+            generation = frame->generation;
+        }
+
+        for (const auto& request : requests) {
+            if (!RenderProtocol::send(socket, RenderProtocol::MessageType::TileRequest, &request, sizeof(request))) {
+                return;
+            }
+        }
+
+        if (socket.waitReadable(POLL_INTERVAL_MS)) {
+            if (!receiveResult(connection, socket, generation, pending)) return;
+        } else if (!pending.empty() && now() - pending.front().sentTime > RESPONSE_TIMEOUT_MS / 1000.0) {
+            LOG_WARN("Render worker {} stopped responding", connection.endpoint);
+            return;
+        }
+    }
+}
+
+bool DistributedRenderer::receiveResult(Connection& connection, Socket& socket, uint64_t generation,
+                                        std::vector<Request>& pending) {
+    RenderProtocol::MessageType type;
+    std::vector<uint8_t> payload;
+    RenderProtocol::TileResult result;
+    if (!RenderProtocol::receive(socket, type, payload) ||
+        type != RenderProtocol::MessageType::TileResult || payload.size() < sizeof(result)) {
+        return false;
+    }
+    std::memcpy(&result, payload.data(), sizeof(result));
+
+    // Late results of a replaced frame
+    if (result.generation != generation) return true;
+
+    size_t pixelCount = static_cast<size_t>(std::max(result.width, 0)) * std::max(result.height, 0);
+    if (payload.size() != sizeof(result) + pixelCount * sizeof(Vec3)) return false;
+
+    auto request = std::find_if(pending.begin(), pending.end(),
+                                [&](const Request& entry) { return entry.item == result.item; });
+    if (request == pending.end()) return true;
+
+    std::vector<Vec3> radiance(pixelCount);
+    std::memcpy(radiance.data(), payload.data() + sizeof(result), pixelCount * sizeof(Vec3));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_frame || m_frame->generation != generation) return true;
+
+    int tile = static_cast<int>(result.item % m_frame->tileCount);
+    int x0, y0, x1, y1;
+    m_image.getTileRect(tile, x0, y0, x1, y1);
+    if (result.width != x1 - x0 || result.height != y1 - y0) return false;
+
+    pending.erase(request);
+    m_image.addTile(tile, radiance.data(), result.width);
+    ++m_completedItems;
+    ++connection.status.tilesReceived;
+    return true;
+}
+
+void DistributedRenderer::requeue(uint64_t generation, const std::vector<Request>& pending) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_frame || m_frame->generation != generation) return;
+
+    // Ahead of new items, so the image stays even across tiles
+    for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+        m_retryItems.push_front(it->item);
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "CpuPathTracer.h"
+#include "ProgressiveImage.h"
+#include "scene/CompiledScene.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Camera;
+class Socket;
+
+// Coordinator for render-worker processes (see RenderWorker). Work items
+// are (tile, sample) pairs in the same order as the hybrid renderer. Each
+// worker connection keeps about two requests per worker thread in flight
+// and pulls the next item as soon as one returns, so faster workers take
+// more of the frame. Items in flight on a worker that disconnects or stops
+// answering go back to the queue, and the connection keeps retrying.
+class DistributedRenderer {
+public:
+    // Endpoints are "host:port"
+    explicit DistributedRenderer(const std::vector<std::string>& endpoints);
+    ~DistributedRenderer();
+
+    // Restarts accumulation whenever the scene, camera, bounce count,
+    // resolution or Random seed differ from the image being refined
+    void update(const CompiledScene& scene, const Camera& camera, int maxBounces, int width, int height);
+
+    // Uploads returned tiles and blits the image into the target framebuffer
+    void present(unsigned int targetFramebuffer, int targetWidth, int targetHeight);
+
+    struct WorkerStatus {
+        std::string endpoint;
+        bool connected = false;
+        int threads = 0;
+        int64_t tilesReceived = 0;
+    };
+
+    std::vector<WorkerStatus> getWorkerStatus() const;
+    int getConnectedWorkers() const;
+    int getLostWorkers() const { return m_lostWorkers.load(); }
+    int getCompletedPasses() const;
+    float getTileRate() const { return m_tileRate; }  // tiles per second, all workers
+
+    static constexpr int TILE_SIZE = CpuPathTracer::TILE_SIZE;
+    static constexpr int MAX_PASSES = CpuPathTracer::MAX_PASSES;
+
+    // A worker with requests pending this long is dropped
+    static constexpr int RESPONSE_TIMEOUT_MS = 10000;
+    static constexpr int RECONNECT_DELAY_MS = 1000;
+
+private:
+    using View = CpuPathTracer::View;
+
+    // Immutable snapshot shared with the connection threads
+    struct Frame {
+        View view;
+        uint64_t generation = 0;
+        int tilesX = 0;
+        int tileCount = 0;
+        int64_t itemCount = 0;
+        // Frame message payload sent to every worker
+        std::vector<uint8_t> message;
+    };
+
+    struct Connection {
+        std::string endpoint;
+        std::string host;
+        uint16_t port = 0;
+        std::thread thread;
+
+        // Guarded by m_mutex
+        WorkerStatus status;
+    };
+
+    struct Request {
+        int64_t item = 0;
+        double sentTime = 0.0;
+    };
+
+    void runConnection(Connection& connection);
+    // Returns when the worker is lost or the renderer shuts down, leaving
+    // the requests still in flight in pending
+    void serve(Connection& connection, Socket& socket, int threads,
+               uint64_t& generation, std::vector<Request>& pending);
+    bool receiveResult(Connection& connection, Socket& socket, uint64_t generation, std::vector<Request>& pending);
+    void requeue(uint64_t generation, const std::vector<Request>& pending);
+
+    // Next item of the current frame, retried items first; m_mutex must be held
+    bool takeItem(int64_t& item);
+
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    std::atomic<bool> m_stop{false};
+    std::atomic<int> m_lostWorkers{0};
+
+    mutable std::mutex m_mutex;
+
+    // Guarded by m_mutex
+    std::shared_ptr<const Frame> m_frame;
+    uint64_t m_sceneRevision = 0;
+    int64_t m_nextItem = 0;
+    std::deque<int64_t> m_retryItems;
+    int64_t m_completedItems = 0;
+    ProgressiveImage m_image;
+
+    // Main thread only
+    float m_tileRate = 0.0f;
+    double m_rateTime = 0.0;
+    int64_t m_rateItems = 0;
+};
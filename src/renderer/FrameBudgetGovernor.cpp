@@ -0,0 +1,81 @@
+#include "FrameBudgetGovernor.h"
+#include "core/Logger.h"
+
+#include <algorithm>
+#include <format>
+
+void FrameBudgetGovernor::setEnabled(bool enabled) {
+    if (m_enabled == enabled) return;
+
+    m_enabled = enabled;
+    resetMeasurements();
+    m_lastDecision = enabled ? "Measuring" : "Idle";
+
+    LOG_INFO("Frame budget governor {} (target {:.1f} ms)", enabled ? "enabled" : "disabled", m_targetMs);
+}
+
+void FrameBudgetGovernor::setTargetFrameTime(float ms) {
+    m_targetMs = std::max(1.0f, ms);
+    resetMeasurements();
+}
+
+bool FrameBudgetGovernor::update(float passTimeMs, int& samplesPerPixel, int& maxBounces) {
+    if (!m_enabled || passTimeMs <= 0.0f) return false;
+
+    // Exponential smoothing to ride out single-frame spikes
+    if (m_sampleCount == 0) {
+        m_smoothedMs = passTimeMs;
+    } else {
+        m_smoothedMs += (passTimeMs - m_smoothedMs) * 0.2f;
+    }
+    m_sampleCount++;
+
+    // Give the last change time to show up in the measurements
+    if (m_sampleCount < m_settleSamples) return false;
+
+    float ratio = m_smoothedMs / m_targetMs;
+    int spp = samplesPerPixel;
+    int bounces = maxBounces;
+
+    if (ratio > m_upperBand) {
+        // Over budget: drop samples first, bounces only as a last resort.
+        // Pass time scales roughly linearly with SPP.
+        if (spp > MIN_SPP) {
+            spp = std::clamp(static_cast<int>(spp / ratio * 0.95f), MIN_SPP, spp - 1);
+            m_lastDecision = std::format("Over budget, SPP -> {}", spp);
+        } else if (bounces > MIN_BOUNCES) {
+            bounces--;
+            m_lastDecision = std::format("Over budget, bounces -> {}", bounces);
+        } else {
+            m_lastDecision = "Over budget at minimum quality";
+            return false;
+        }
+    } else if (ratio < m_lowerBand) {
+        // Headroom: restore bounce depth first, then spend the rest on samples
+        if (bounces < m_bounceCeiling) {
+            bounces++;
+            m_lastDecision = std::format("Headroom, bounces -> {}", bounces);
+        } else if (spp < MAX_SPP) {
+            spp = std::clamp(static_cast<int>(spp / ratio * 0.9f), spp + 1, MAX_SPP);
+            m_lastDecision = std::format("Headroom, SPP -> {}", spp);
+        } else {
+            m_lastDecision = "Under budget at maximum quality";
+            return false;
+        }
+    } else {
+        m_lastDecision = "Holding";
+        return false;
+    }
+
+    LOG_DEBUG("Governor: {:.2f} ms vs {:.2f} ms target, SPP {} -> {}, bounces {} -> {}",
+              m_smoothedMs, m_targetMs, samplesPerPixel, spp, maxBounces, bounces);
+
+    samplesPerPixel = spp;
+    maxBounces = bounces;
+    resetMeasurements();
+    return true;
+}
+
+void FrameBudgetGovernor::resetMeasurements() {
+    m_sampleCount = 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+
+// Keeps the path-trace pass inside a frame-time budget by trading samples
+// per pixel and bounce depth. Fed with measured GPU pass times.
+class FrameBudgetGovernor {
+public:
+    FrameBudgetGovernor() = default;
+    ~FrameBudgetGovernor() = default;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+    void setTargetFrameTime(float ms);
+    float getTargetFrameTime() const { return m_targetMs; }
+
+    // Bounce depth the governor restores up to when there is headroom
+    void setBounceCeiling(int bounces) { m_bounceCeiling = bounces; }
+    int getBounceCeiling() const { return m_bounceCeiling; }
+
+    // Feed one measured pass time. Adjusts the settings in place and
+    // returns true when they changed.
+    bool update(float passTimeMs, int& samplesPerPixel, int& maxBounces);
+
+    // Status
+    float getSmoothedPassTime() const { return m_smoothedMs; }
+    const std::string& getLastDecision() const { return m_lastDecision; }
+
+    static constexpr int MIN_SPP = 1;
+    static constexpr int MAX_SPP = 64;
+    static constexpr int MIN_BOUNCES = 2;
+    static constexpr int MAX_BOUNCES = 16;
+
+private:
+    void resetMeasurements();
+
+    bool m_enabled = false;
+    float m_targetMs = 16.6f;
+    int m_bounceCeiling = 8;
+
+    // Hysteresis band around the target; no changes while inside it
+    float m_upperBand = 1.05f;
+    float m_lowerBand = 0.75f;
+
+    // Measurements
+    float m_smoothedMs = 0.0f;
+    int m_sampleCount = 0;
+    int m_settleSamples = 8;
+
+    std::string m_lastDecision = "Idle";
+};
@@ -0,0 +1,275 @@
+#include "GBufferPass.h"
+#include "scene/Camera.h"
+#include "core/Logger.h"
+#include "utils/ResourceManager.h"
+
+#include <glad/glad.h>
+
+GBufferPass::GBufferPass() {
+    createGeometry();
+    reloadShader();
+}
+
+GBufferPass::~GBufferPass() {
+    deleteTargets();
+
+    if (m_boxVAO) {
+        glDeleteVertexArrays(1, &m_boxVAO);
+        glDeleteBuffers(1, &m_boxVBO);
+    }
+    if (m_quadVAO) {
+        glDeleteVertexArrays(1, &m_quadVAO);
+        glDeleteBuffers(1, &m_quadVBO);
+    }
+    if (m_instanceVBO) {
+        glDeleteBuffers(1, &m_instanceVBO);
+    }
+    if (m_readbackPBO) {
+        glDeleteBuffers(1, &m_readbackPBO);
+    }
+    if (m_readbackFence) {
+        glDeleteSync(static_cast<GLsync>(m_readbackFence));
+    }
+}
+
+void GBufferPass::reloadShader() {
+    m_shader = ResourceManager::instance().loadShader(
+        "gbuffer", "shaders/gbuffer.vert", "shaders/gbuffer.frag");
+
+    if (!m_shader || !m_shader->isValid()) {
+        LOG_WARN("G-buffer shader failed to load - rasterized primary visibility disabled");
+        m_shader = nullptr;
+    }
+}
+
+void GBufferPass::createGeometry() {
+    // Unit box proxy, two triangles per face
+    float box[] = {
+        -0.5f, -0.5f, -0.5f,   0.5f,  0.5f, -0.5f,   0.5f, -0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,  -0.5f, -0.5f, -0.5f,  -0.5f,  0.5f, -0.5f,
+        -0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,  -0.5f,  0.5f,  0.5f,  -0.5f, -0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,  -0.5f,  0.5f, -0.5f,  -0.5f, -0.5f, -0.5f,
+        -0.5f, -0.5f, -0.5f,  -0.5f, -0.5f,  0.5f,  -0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,   0.5f, -0.5f, -0.5f,   0.5f,  0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,   0.5f,  0.5f,  0.5f,   0.5f, -0.5f,  0.5f,
+        -0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,  -0.5f, -0.5f,  0.5f,  -0.5f, -0.5f, -0.5f,
+        -0.5f,  0.5f, -0.5f,   0.5f,  0.5f,  0.5f,   0.5f,  0.5f, -0.5f,
+         0.5f,  0.5f,  0.5f,  -0.5f,  0.5f, -0.5f,  -0.5f,  0.5f,  0.5f
+    };
+
+    // Fullscreen quad in clip space for infinite planes
+    float quad[] = {
+        -1.0f, -1.0f, 0.0f,   1.0f, -1.0f, 0.0f,   1.0f,  1.0f, 0.0f,
+        -1.0f, -1.0f, 0.0f,   1.0f,  1.0f, 0.0f,  -1.0f,  1.0f, 0.0f
+    };
+
+    glGenBuffers(1, &m_instanceVBO);
+
+    glGenBuffers(1, &m_readbackPBO);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackPBO);
+    glBufferData(GL_PIXEL_PACK_BUFFER, 2 * sizeof(GLint), nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glGenVertexArrays(1, &m_boxVAO);
+    glGenBuffers(1, &m_boxVBO);
+    glBindVertexArray(m_boxVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_boxVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(box), box, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glGenVertexArrays(1, &m_quadVAO);
+    glGenBuffers(1, &m_quadVBO);
+    glBindVertexArray(m_quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindVertexArray(0);
+}
+
+void GBufferPass::createTargets() {
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+    auto createTarget = [this](unsigned int& texture, GLint internalFormat, GLenum format, GLenum type, GLenum attachment) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_width, m_height, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
+    };
+
+    createTarget(m_positionTexture, GL_RGBA32F, GL_RGBA, GL_FLOAT, GL_COLOR_ATTACHMENT0);
+    createTarget(m_normalDepthTexture, GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_COLOR_ATTACHMENT1);
+    createTarget(m_idTexture, GL_RG32I, GL_RG_INTEGER, GL_INT, GL_COLOR_ATTACHMENT2);
+    createTarget(m_depthTexture, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, GL_DEPTH_ATTACHMENT);
+
+    GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+    glDrawBuffers(3, drawBuffers);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_ERROR("G-buffer framebuffer is not complete!");
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    LOG_DEBUG("G-buffer created: {}x{}", m_width, m_height);
+}
+
+void GBufferPass::deleteTargets() {
+    unsigned int textures[] = {m_positionTexture, m_normalDepthTexture, m_idTexture, m_depthTexture};
+    for (unsigned int texture : textures) {
+        if (texture) glDeleteTextures(1, &texture);
+    }
+    m_positionTexture = m_normalDepthTexture = m_idTexture = m_depthTexture = 0;
+
+    if (m_framebuffer) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        m_framebuffer = 0;
+    }
+}
+
+void GBufferPass::bindInstanceAttributes(size_t firstInstance) {
+    const GLsizei stride = sizeof(GBufferInstance);
+    const size_t base = firstInstance * sizeof(GBufferInstance);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    for (int i = 0; i < 3; ++i) {
+        GLuint location = 2 + i;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + i * 4 * sizeof(float)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+void GBufferPass::uploadInstances(const std::vector<GBufferInstance>& volumes,
+                                  const std::vector<GBufferInstance>& planes) {
+    size_t count = volumes.size() + planes.size();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if (count > m_instanceCapacity) {
+        m_instanceCapacity = count * 2;
+        glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(GBufferInstance), nullptr, GL_DYNAMIC_DRAW);
+    }
+
+    if (!volumes.empty()) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, volumes.size() * sizeof(GBufferInstance), volumes.data());
+    }
+    if (!planes.empty()) {
+        glBufferSubData(GL_ARRAY_BUFFER, volumes.size() * sizeof(GBufferInstance),
+                        planes.size() * sizeof(GBufferInstance), planes.data());
+    }
+}
+
+void GBufferPass::render(const std::vector<GBufferInstance>& volumes,
+                         const std::vector<GBufferInstance>& planes,
+                         const Camera& camera, int width, int height,
+                         const Vec2& jitter) {
+    if (!m_shader) return;
+
+    if (!m_framebuffer || width != m_width || height != m_height) {
+        deleteTargets();
+        m_width = width;
+        m_height = height;
+        createTargets();
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_width, m_height);
+
+    // Sky: zero position/normal/depth, -1 ids
+    const float zero[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const int noHit[] = {-1, -1, 0, 0};
+    const float farDepth = 1.0f;
+    glClearBufferfv(GL_COLOR, 0, zero);
+    glClearBufferfv(GL_COLOR, 1, zero);
+    glClearBufferiv(GL_COLOR, 2, noHit);
+    glClearBufferfv(GL_DEPTH, 0, &farDepth);
+
+    uploadInstances(volumes, planes);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+
+    m_shader->use();
+    m_shader->setVec3("u_cameraPos", camera.getPosition());
+    m_shader->setVec3("u_cameraDir", camera.getDirection());
+    m_shader->setVec3("u_cameraUp", camera.getUp());
+    m_shader->setVec3("u_cameraRight", camera.getRight());
+    m_shader->setFloat("u_fov", camera.getFov());
+    m_shader->setVec2("u_resolution", Vec2{static_cast<float>(m_width), static_cast<float>(m_height)});
+    m_shader->setVec2("u_jitter", jitter);
+    m_shader->setFloat("u_near", NEAR_PLANE);
+    m_shader->setFloat("u_far", FAR_PLANE);
+
+    // Spheres and cubes: proxy boxes, back faces included so the camera
+    // may sit inside a primitive
+    if (!volumes.empty()) {
+        m_shader->setInt("u_fullscreen", 0);
+        glBindVertexArray(m_boxVAO);
+        bindInstanceAttributes(0);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, static_cast<GLsizei>(volumes.size()));
+    }
+
+    // Planes are infinite in the path tracer, so they cover the screen
+    if (!planes.empty()) {
+        m_shader->setInt("u_fullscreen", 1);
+        glBindVertexArray(m_quadVAO);
+        bindInstanceAttributes(volumes.size());
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(planes.size()));
+    }
+
+    glBindVertexArray(0);
+    m_shader->unuse();
+}
+
+void GBufferPass::requestIdReadback(int x, int y) {
+    if (!m_framebuffer || x < 0 || y < 0 || x >= m_width || y >= m_height) return;
+
+    // A newer request supersedes one still in flight
+    if (m_readbackFence) {
+        glDeleteSync(static_cast<GLsync>(m_readbackFence));
+        m_readbackFence = nullptr;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT2);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackPBO);
+    glReadPixels(x, y, 1, 1, GL_RG_INTEGER, GL_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool GBufferPass::pollIdReadback(int& primitiveId, int& objectId) {
+    if (!m_readbackFence) return false;
+
+    GLsync fence = static_cast<GLsync>(m_readbackFence);
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+
+    glDeleteSync(fence);
+    m_readbackFence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readbackPBO);
+    const GLint* ids = static_cast<const GLint*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 2 * sizeof(GLint), GL_MAP_READ_BIT));
+    bool mapped = ids != nullptr;
+    if (mapped) {
+        primitiveId = ids[0];
+        objectId = ids[1];
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return mapped;
+}
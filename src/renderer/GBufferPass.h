@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Shader.h"
+#include <memory>
+#include <vector>
+
+class Camera;
+
+// Per-primitive data for the G-buffer pass. Spheres and cubes are drawn as
+// instanced proxy boxes, planes as fullscreen quads; the fragment shader
+// ray-casts the analytic primitive so hits match the path tracer exactly.
+struct GBufferInstance {
+    float center[3];
+    float kind;         // ObjectType value
+    float size[3];      // Sphere: radius in x; Cube: edge lengths
+    float primitiveId;  // Index into the path tracer's primitive arrays
+    float normal[3];    // Planes only
+    float objectId;     // Index of the owning scene object
+};
+
+class GBufferPass {
+public:
+    GBufferPass();
+    ~GBufferPass();
+
+    bool isValid() const { return m_shader != nullptr; }
+    void reloadShader();
+
+    // Rasterizes primary visibility at the given resolution into the G-buffer,
+    // through points offset from the pixel centers by jitter (in pixels).
+    // Leaves the G-buffer bound; callers restore their own target.
+    void render(const std::vector<GBufferInstance>& volumes,
+                const std::vector<GBufferInstance>& planes,
+                const Camera& camera, int width, int height,
+                const Vec2& jitter = Vec2{0.0f, 0.0f});
+
+    // xyz = world position, w = hit distance along the camera ray
+    unsigned int getPositionTexture() const { return m_positionTexture; }
+    // xyz = world normal, w = linear view depth (0 for sky)
+    unsigned int getNormalDepthTexture() const { return m_normalDepthTexture; }
+    // x = primitive id, y = object id (-1 for sky)
+    unsigned int getIdTexture() const { return m_idTexture; }
+
+    // Reads one id texel back through a PBO without stalling; the result is
+    // available from pollIdReadback a frame or two later
+    void requestIdReadback(int x, int y);
+    bool pollIdReadback(int& primitiveId, int& objectId);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    static constexpr float NEAR_PLANE = 0.05f;
+    static constexpr float FAR_PLANE = 1000.0f;
+
+private:
+    void createGeometry();
+    void createTargets();
+    void deleteTargets();
+    void bindInstanceAttributes(size_t firstInstance);
+    void uploadInstances(const std::vector<GBufferInstance>& volumes,
+                         const std::vector<GBufferInstance>& planes);
+
+    std::shared_ptr<Shader> m_shader;
+
+    // Render targets
+    unsigned int m_framebuffer = 0;
+    unsigned int m_positionTexture = 0;
+    unsigned int m_normalDepthTexture = 0;
+    unsigned int m_idTexture = 0;
+    unsigned int m_depthTexture = 0;
+    int m_width = 0, m_height = 0;
+
+    // Proxy geometry
+    unsigned int m_boxVAO = 0, m_boxVBO = 0;
+    unsigned int m_quadVAO = 0, m_quadVBO = 0;
+    unsigned int m_instanceVBO = 0;
+    size_t m_instanceCapacity = 0;
+
+    // Id readback
+    unsigned int m_readbackPBO = 0;
+    void* m_readbackFence = nullptr;
+};
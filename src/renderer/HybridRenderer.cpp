@@ -0,0 +1,367 @@
+#include "HybridRenderer.h"
+#include "scene/Camera.h"
+#include "core/Logger.h"
+#include "utils/ResourceManager.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+    double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+HybridRenderer::HybridRenderer() {
+    reloadShaders();
+    glGenQueries(TIMER_QUERY_COUNT, m_timerQueries);
+    m_cpuRateTime = now();
+
+    LOG_INFO("Hybrid renderer sharing tiles with {} CPU job workers", JobSystem::getWorkerCount());
+}
+
+HybridRenderer::~HybridRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    // Running jobs see m_stop and stop requeueing themselves
+    JobSystem::wait(m_jobs);
+
+    deleteTargets();
+    if (m_timerQueries[0]) {
+        glDeleteQueries(TIMER_QUERY_COUNT, m_timerQueries);
+    }
+}
+
+void HybridRenderer::reloadShaders() {
+    m_tileShader = ResourceManager::instance().loadShader(
+        "hybrid_tile", "shaders/upscale.vert", "shaders/hybrid_tile.frag");
+    if (!m_tileShader || !m_tileShader->isValid()) {
+        LOG_WARN("Hybrid tile shader failed to load - hybrid rendering disabled");
+        m_tileShader = nullptr;
+    }
+
+    m_resolveShader = ResourceManager::instance().loadShader(
+        "hybrid_resolve", "shaders/upscale.vert", "shaders/hybrid_resolve.frag");
+    if (!m_resolveShader || !m_resolveShader->isValid()) {
+        LOG_WARN("Hybrid resolve shader failed to load - hybrid rendering disabled");
+        m_resolveShader = nullptr;
+    }
+}
+
+void HybridRenderer::update(const CompiledScene& scene, const Camera& camera, int maxBounces, int width, int height) {
+    View view = CpuPathTracer::makeView(camera, maxBounces, width, height);
+
+    {
+        // Exact comparison; any change at all restarts accumulation
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_frame && m_frame->scene.getRevision() == scene.getRevision() &&
+            std::memcmp(&m_frame->view, &view, sizeof(View)) == 0) {
+            return;
+        }
+    }
+
+    auto frame = std::make_shared<Frame>();
+    frame->view = view;
+    frame->scene = scene;
+    frame->tilesX = (view.width + TILE_SIZE - 1) / TILE_SIZE;
+    frame->tilesY = (view.height + TILE_SIZE - 1) / TILE_SIZE;
+    frame->itemCount = static_cast<int64_t>(frame->tilesX) * frame->tilesY * MAX_PASSES;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        frame->generation = m_frame ? m_frame->generation + 1 : 1;
+        m_frame = std::move(frame);
+        m_nextItem = 0;
+        // Tiles traced for the old frame are dropped when added
+    }
+
+    m_gpuItems = 0;
+    m_cpuItems = 0;
+    startCpuJobs();
+}
+
+int HybridRenderer::takeItems(int count, int64_t& first) {
+    if (!m_frame) return 0;
+    first = m_nextItem;
+    int taken = static_cast<int>(std::min<int64_t>(count, m_frame->itemCount - m_nextItem));
+    m_nextItem += taken;
+    return taken;
+}
+
+void HybridRenderer::startCpuJobs() {
+    // One self-requeueing job per worker keeps every core pulling items
+    int missing = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        missing = std::max(0, JobSystem::getWorkerCount() - m_cpuJobsRunning);
+        m_cpuJobsRunning += missing;
+    }
+
+    for (int i = 0; i < missing; ++i) {
+        JobSystem::run([this] { runCpuItem(); }, &m_jobs);
+    }
+}
+
+void HybridRenderer::runCpuItem() {
+    std::shared_ptr<const Frame> frame;
+    int64_t item = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop || takeItems(1, item) == 0) {
+            m_cpuJobsRunning--;
+            return;
+        }
+        frame = m_frame;
+    }
+
+    int tileCount = frame->tilesX * frame->tilesY;
+    CpuTile result;
+    result.generation = frame->generation;
+    result.tile = static_cast<int>(item % tileCount);
+    result.radiance.resize(TILE_SIZE * TILE_SIZE);
+
+    int x0, y0, x1, y1;
+    tileRect(*frame, result.tile, x0, y0, x1, y1);
+    CpuPathTracer::traceRect(frame->view, frame->sceneReplicas.get(), CpuFeatures::getSimdLevel(), x0, y0, x1, y1,
+                             static_cast<uint32_t>(item / tileCount), result.radiance.data(), TILE_SIZE);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) {
+            m_cpuJobsRunning--;
+            return;
+        }
+        if (m_frame && m_frame->generation == result.generation) {
+            m_cpuResults.push_back(std::move(result));
+        }
+    }
+
+    JobSystem::run([this] { runCpuItem(); }, &m_jobs);
+}
+
+void HybridRenderer::tileRect(const Frame& frame, int tile, int& x0, int& y0, int& x1, int& y1) const {
+    x0 = (tile % frame.tilesX) * TILE_SIZE;
+    y0 = (tile / frame.tilesX) * TILE_SIZE;
+    x1 = std::min(x0 + TILE_SIZE, frame.view.width);
+    y1 = std::min(y0 + TILE_SIZE, frame.view.height);
+}
+
+void HybridRenderer::createTargets(int width, int height) {
+    deleteTargets();
+
+    glGenTextures(1, &m_accumulation);
+    glBindTexture(GL_TEXTURE_2D, m_accumulation);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+    // Float targets are not filterable everywhere
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenTextures(1, &m_tileTexture);
+    glBindTexture(GL_TEXTURE_2D, m_tileTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, TILE_SIZE, TILE_SIZE, 0, GL_RGB, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_accumulation, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_ERROR("Hybrid accumulation framebuffer is incomplete");
+    }
+
+    m_width = width;
+    m_height = height;
+    m_clearedGeneration = 0;
+}
+
+void HybridRenderer::deleteTargets() {
+    if (m_framebuffer) glDeleteFramebuffers(1, &m_framebuffer);
+    if (m_accumulation) glDeleteTextures(1, &m_accumulation);
+    if (m_tileTexture) glDeleteTextures(1, &m_tileTexture);
+    m_framebuffer = m_accumulation = m_tileTexture = 0;
+    m_width = m_height = 0;
+}
+
+void HybridRenderer::render(Shader& pathTracer, unsigned int quadVAO, unsigned int targetFramebuffer,
+                            int targetWidth, int targetHeight) {
+    std::shared_ptr<const Frame> frame;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        frame = m_frame;
+    }
+    if (!frame || !isValid()) return;
+
+    if (!m_framebuffer || frame->view.width != m_width || frame->view.height != m_height) {
+        createTargets(frame->view.width, frame->view.height);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_width, m_height);
+    if (m_clearedGeneration != frame->generation) {
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        m_clearedGeneration = frame->generation;
+    }
+
+    // Both devices add radiance and sample counts
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_SCISSOR_TEST);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    collectGpuTimings();
+    traceGpuBatch(pathTracer, quadVAO);
+    addCpuTiles(quadVAO);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_SCISSOR_TEST);
+
+    resolve(quadVAO, targetFramebuffer, targetWidth, targetHeight);
+    glEnable(GL_DEPTH_TEST);
+
+    // A restart can find every job finished, so make sure they are running
+    startCpuJobs();
+}
+
+void HybridRenderer::traceGpuBatch(Shader& pathTracer, unsigned int quadVAO) {
+    // Size the batch from measured throughput; a few tiles until timings arrive
+    int batch = m_gpuTileRate > 0.0f ? static_cast<int>(m_gpuTileRate * m_gpuBudget) : 4;
+    batch = std::clamp(batch, 1, 4096);
+
+    std::shared_ptr<const Frame> frame;
+    int64_t first = 0;
+    int taken = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        taken = takeItems(batch, first);
+        frame = m_frame;
+    }
+    if (taken == 0) return;
+
+    bool timed = m_timerQueries[0] && m_timerPending < TIMER_QUERY_COUNT;
+    if (timed) {
+        glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_timerWriteIndex]);
+    }
+
+    pathTracer.use();
+    pathTracer.setInt("u_outputRadiance", 1);
+    pathTracer.setInt("u_samplesPerPixel", 1);
+    pathTracer.setInt("u_useGBuffer", 0);
+    pathTracer.setVec2("u_resolution", Vec2{static_cast<float>(m_width), static_cast<float>(m_height)});
+
+    int tileCount = frame->tilesX * frame->tilesY;
+    glBindVertexArray(quadVAO);
+    for (int64_t item = first; item < first + taken; ++item) {
+        int x0, y0, x1, y1;
+        tileRect(*frame, static_cast<int>(item % tileCount), x0, y0, x1, y1);
+        glScissor(x0, y0, x1 - x0, y1 - y0);
+        pathTracer.setUint("u_sampleOffset", static_cast<uint32_t>(item / tileCount));
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    glBindVertexArray(0);
+
+    pathTracer.setInt("u_outputRadiance", 0);
+    pathTracer.unuse();
+
+    if (timed) {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_timerTiles[m_timerWriteIndex] = taken;
+        m_timerWriteIndex = (m_timerWriteIndex + 1) % TIMER_QUERY_COUNT;
+        m_timerPending++;
+    }
+    m_gpuItems += taken;
+}
+
+void HybridRenderer::addCpuTiles(unsigned int quadVAO) {
+    std::vector<CpuTile> tiles;
+    std::shared_ptr<const Frame> frame;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        tiles.swap(m_cpuResults);
+        frame = m_frame;
+    }
+
+    m_tileShader->use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_tileTexture);
+    m_tileShader->setInt("u_tile", 0);
+    glBindVertexArray(quadVAO);
+
+    for (const CpuTile& tile : tiles) {
+        if (tile.generation != frame->generation) continue;
+
+        int x0, y0, x1, y1;
+        tileRect(*frame, tile.tile, x0, y0, x1, y1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, TILE_SIZE, TILE_SIZE, GL_RGB, GL_FLOAT, tile.radiance.data());
+        glScissor(x0, y0, x1 - x0, y1 - y0);
+
+        m_tileShader->setVec2("u_tileOrigin", Vec2{static_cast<float>(x0), static_cast<float>(y0)});
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        m_cpuItems++;
+    }
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_tileShader->unuse();
+
+    // Smoothed over about a second
+    double time = now();
+    if (time - m_cpuRateTime >= 1.0) {
+        float rate = static_cast<float>((m_cpuItems - m_cpuRateItems) / (time - m_cpuRateTime));
+        m_cpuTileRate = rate > 0.0f ? rate : 0.0f;
+        m_cpuRateItems = m_cpuItems;
+        m_cpuRateTime = time;
+    }
+}
+
+void HybridRenderer::resolve(unsigned int quadVAO, unsigned int targetFramebuffer, int targetWidth, int targetHeight) {
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glViewport(0, 0, targetWidth, targetHeight);
+
+    m_resolveShader->use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_accumulation);
+    m_resolveShader->setInt("u_accumulation", 0);
+
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_resolveShader->unuse();
+}
+
+void HybridRenderer::collectGpuTimings() {
+    while (m_timerPending > 0) {
+        int oldest = (m_timerWriteIndex - m_timerPending + TIMER_QUERY_COUNT) % TIMER_QUERY_COUNT;
+
+        GLint available = 0;
+        glGetQueryObjectiv(m_timerQueries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(m_timerQueries[oldest], GL_QUERY_RESULT, &elapsedNs);
+        m_timerPending--;
+
+        float milliseconds = std::max(static_cast<float>(elapsedNs) / 1.0e6f, 0.01f);
+        float rate = m_timerTiles[oldest] / milliseconds;
+        m_gpuTileRate = m_gpuTileRate > 0.0f ? m_gpuTileRate * 0.8f + rate * 0.2f : rate;
+    }
+}
+
+int HybridRenderer::getCompletedPasses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_frame) return 0;
+    return static_cast<int>((m_gpuItems + m_cpuItems) / (m_frame->tilesX * m_frame->tilesY));
+}
+
+float HybridRenderer::getGpuShare() const {
+    int64_t total = m_gpuItems + m_cpuItems;
+    return total > 0 ? static_cast<float>(m_gpuItems) / total : 0.0f;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "CpuPathTracer.h"
+#include "Shader.h"
+#include "core/JobSystem.h"
+#include "core/NodeReplicas.h"
+#include "scene/CompiledScene.h"
+#include "math/Vec3.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Camera;
+
+// Splits path tracing of one image between the fragment shader and the CPU
+// tracer. Work items are (tile, sample) pairs handed out in order from one
+// shared queue: CPU jobs take one item at a time, and each frame the GPU
+// takes a batch sized from its measured throughput to fill its time budget,
+// so the split follows whichever device is faster on the current scene.
+// Both devices add into one RGBA32F target of radiance sums (rgb) and sample
+// counts (a), and draw identical random streams per pixel sample.
+class HybridRenderer {
+public:
+    HybridRenderer();
+    ~HybridRenderer();
+
+    bool isValid() const { return m_tileShader && m_resolveShader; }
+    void reloadShaders();
+
+    // Restarts accumulation whenever the scene, camera, bounce count,
+    // resolution or Random seed differ from the image being refined
+    void update(const CompiledScene& scene, const Camera& camera, int maxBounces, int width, int height);
+
+    // Traces this frame's GPU batch with the path tracer shader, whose camera
+    // and scene uniforms the caller has already set, adds the tiles the CPU
+    // finished, and resolves the image into the target framebuffer
+    void render(Shader& pathTracer, unsigned int quadVAO, unsigned int targetFramebuffer,
+                int targetWidth, int targetHeight);
+
+    // GPU time per frame the batch size aims for
+    void setGpuBudget(float milliseconds) { m_gpuBudget = milliseconds; }
+    float getGpuBudget() const { return m_gpuBudget; }
+
+    int getCompletedPasses() const;
+    // Fraction of the traced tiles the GPU took
+    float getGpuShare() const;
+    float getGpuTileRate() const { return m_gpuTileRate * 1000.0f; }  // tiles per second
+    float getCpuTileRate() const { return m_cpuTileRate; }           // tiles per second
+
+    static constexpr int TILE_SIZE = CpuPathTracer::TILE_SIZE;
+    static constexpr int MAX_PASSES = CpuPathTracer::MAX_PASSES;
+
+private:
+    using View = CpuPathTracer::View;
+
+    // Immutable snapshot the CPU jobs trace against
+    struct Frame {
+        View view;
+        CompiledScene scene;
+        // CPU jobs trace the copy on their own NUMA node
+        NodeReplicas<CompiledScene> sceneReplicas{scene};
+        uint64_t generation = 0;
+        int tilesX = 0;
+        int tilesY = 0;
+        int64_t itemCount = 0;
+    };
+
+    struct CpuTile {
+        uint64_t generation = 0;
+        int tile = 0;
+        std::vector<Vec3> radiance;
+    };
+
+    // Takes up to count items of the current frame; m_mutex must be held
+    int takeItems(int count, int64_t& first);
+
+    void startCpuJobs();
+    void runCpuItem();
+
+    void createTargets(int width, int height);
+    void deleteTargets();
+    void traceGpuBatch(Shader& pathTracer, unsigned int quadVAO);
+    void addCpuTiles(unsigned int quadVAO);
+    void resolve(unsigned int quadVAO, unsigned int targetFramebuffer, int targetWidth, int targetHeight);
+    void collectGpuTimings();
+
+    void tileRect(const Frame& frame, int tile, int& x0, int& y0, int& x1, int& y1) const;
+
+    std::shared_ptr<Shader> m_tileShader;
+    std::shared_ptr<Shader> m_resolveShader;
+
+    // Every queued CPU job, so shutdown can wait for them
+    JobCounter m_jobs;
+
+    mutable std::mutex m_mutex;
+    bool m_stop = false;
+
+    // Guarded by m_mutex
+    std::shared_ptr<const Frame> m_frame;
+    int64_t m_nextItem = 0;
+    std::vector<CpuTile> m_cpuResults;
+    int m_cpuJobsRunning = 0;
+
+    // Items added to the accumulation target, main thread only
+    int64_t m_gpuItems = 0;
+    int64_t m_cpuItems = 0;
+
+    // GL objects, main thread only
+    unsigned int m_framebuffer = 0;
+    unsigned int m_accumulation = 0;
+    unsigned int m_tileTexture = 0;
+    int m_width = 0, m_height = 0;
+    uint64_t m_clearedGeneration = 0;
+
+    // GPU throughput from timer queries, ring-buffered with their batch sizes
+    static constexpr int TIMER_QUERY_COUNT = 4;
+    unsigned int m_timerQueries[TIMER_QUERY_COUNT] = {};
+    int m_timerTiles[TIMER_QUERY_COUNT] = {};
+    int m_timerWriteIndex = 0;
+    int m_timerPending = 0;
+
+    float m_gpuBudget = 12.0f;
+    float m_gpuTileRate = 0.0f;    // tiles per millisecond, smoothed
+    float m_cpuTileRate = 0.0f;
+    double m_cpuRateTime = 0.0;
+    int64_t m_cpuRateItems = 0;
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "scene/CompiledScene.h"
+#include "scene/Material.h"
+#include "math/Ray.h"
+#include "math/Vec3.h"
+#include "utils/Random.h"
+#include <algorithm>
+#include <cmath>
+
+// A ray's closest hit as the CPU tracer shades it
+struct HitInfo {
+    bool hit = false;
+    float t = 1e20f;
+    Vec3 point;
+    Vec3 normal;
+    const CompiledScene::Material* material = nullptr;
+    float ior = 1.5f;
+    PrimitiveKind kind = PrimitiveKind::None;
+};
+
+// Sampling routines shared by the kernels and the tracer; they mirror
+// pathtracer.frag, keep the two in sync
+namespace MaterialSampling {
+    constexpr float PI = 3.14159265359f;
+    constexpr float TWO_PI = 6.28318530718f;
+    constexpr float EPSILON = CompiledScene::EPSILON;
+
+    inline Vec3 refract(const Vec3& incident, const Vec3& normal, float eta) {
+        float cosI = dot(normal, incident);
+        float k = 1.0f - eta * eta * (1.0f - cosI * cosI);
+        if (k < 0.0f) return Vec3{0.0f};
+        return incident * eta - normal * (eta * cosI + std::sqrt(k));
+    }
+
+    inline Vec3 hemisphereBasis(const Vec3& w, float cosTheta, float sinTheta, float phi) {
+        Vec3 u = cross(std::abs(w.x) > 0.1f ? Vec3{0, 1, 0} : Vec3{1, 0, 0}, w).normalized();
+        Vec3 v = cross(w, u);
+        return w * cosTheta + u * (sinTheta * std::cos(phi)) + v * (sinTheta * std::sin(phi));
+    }
+
+    inline Vec3 sampleCosineWeightedHemisphere(const Vec3& normal, RandomStream& rng) {
+        float r1 = rng.next();
+        float r2 = rng.next();
+        return hemisphereBasis(normal, std::sqrt(r1), std::sqrt(1.0f - r1), TWO_PI * r2);
+    }
+
+    inline Vec3 sampleHemisphere(const Vec3& normal, RandomStream& rng) {
+        float r1 = rng.next();
+        float r2 = rng.next();
+        return hemisphereBasis(normal, std::sqrt(1.0f - r1), std::sqrt(r1), TWO_PI * r2);
+    }
+
+    // Shading normal turned towards the incoming ray
+    inline Vec3 facingNormal(const Ray& inRay, const HitInfo& hit) {
+        Vec3 N = hit.normal.normalized();
+        return dot(N, -inRay.direction.normalized()) < 0.0f ? -N : N;
+    }
+}
+
+// Scattering of one MaterialType, chosen at compile time. Each
+// specialization provides
+//   static constexpr bool DIFFUSE  - caches, photons and the guide act on it
+//   static bool scatter(inRay, hit, rng, attenuation, scattered)
+// which returns false when the path ends. To add a material, specialize
+// this and append its type to MaterialKernels::Types; the tracer dispatches
+// through the table and needs no change.
+template <MaterialType TYPE>
+struct MaterialKernel;
+
+template <>
+struct MaterialKernel<MaterialType::Diffuse> {
+    static constexpr bool DIFFUSE = true;
+
+    static bool scatter(const Ray& inRay, const HitInfo& hit, RandomStream& rng, Vec3& attenuation, Ray& scattered) {
+        using namespace MaterialSampling;
+        Vec3 N = facingNormal(inRay, hit);
+        Vec3 L = sampleCosineWeightedHemisphere(N, rng);
+        scattered = Ray(hit.point + N * (EPSILON * 2.0f), L);
+        attenuation = hit.material->color * 0.8f;
+        return dot(N, L) > 0.0f;
+    }
+};
+
+template <>
+struct MaterialKernel<MaterialType::Metal> {
+    static constexpr bool DIFFUSE = false;
+
+    static bool scatter(const Ray& inRay, const HitInfo& hit, RandomStream& rng, Vec3& attenuation, Ray& scattered) {
+        using namespace MaterialSampling;
+        const CompiledScene::Material& material = *hit.material;
+        Vec3 N = facingNormal(inRay, hit);
+        float safeRoughness = std::clamp(material.roughness, 0.02f, 1.0f);
+
+        Vec3 reflected = reflect(inRay.direction.normalized(), N);
+        Vec3 fuzz = sampleHemisphere(N, rng) * (safeRoughness * 0.5f);
+        Vec3 L = (reflected + fuzz).normalized();
+        if (dot(N, L) <= 0.0f) return false;
+
+        scattered = Ray(hit.point + N * (EPSILON * 2.0f), L);
+
+        float metallic = std::clamp(material.metalness, 0.0f, 1.0f);
+        Vec3 baseReflection = Vec3{0.04f} * (1.0f - metallic) + material.color * metallic;
+        attenuation = baseReflection * 0.9f;
+        return true;
+    }
+};
+
+template <>
+struct MaterialKernel<MaterialType::Dielectric> {
+    static constexpr bool DIFFUSE = false;
+
+    static bool scatter(const Ray& inRay, const HitInfo& hit, RandomStream& rng, Vec3& attenuation, Ray& scattered) {
+        using namespace MaterialSampling;
+        float safeIor = std::clamp(hit.ior, 1.001f, 3.0f);
+        // N already faces the ray; the side comes from the outward normal
+        bool entering = dot(inRay.direction, hit.normal) < 0.0f;
+        Vec3 normal = facingNormal(inRay, hit);
+        float eta = entering ? 1.0f / safeIor : safeIor;
+
+        Vec3 incident = inRay.direction.normalized();
+        Vec3 refracted = refract(incident, normal, eta);
+
+        if (refracted.length() > 0.5f) {
+            float cosTheta = std::abs(dot(incident, normal));
+            float r0 = (1.0f - safeIor) / (1.0f + safeIor);
+            r0 *= r0;
+            float fresnel = r0 + (1.0f - r0) * std::pow(1.0f - cosTheta, 5.0f);
+
+            if (rng.next() < fresnel) {
+                scattered = Ray(hit.point + normal * (EPSILON * 2.0f), reflect(incident, normal));
+            } else {
+                scattered = Ray(hit.point - normal * (EPSILON * 2.0f), refracted.normalized());
+            }
+
+            attenuation = Vec3{0.95f};
+            return true;
+        }
+
+        scattered = Ray(hit.point + normal * (EPSILON * 2.0f), reflect(incident, normal));
+        attenuation = Vec3{0.98f};
+        return true;
+    }
+};
+
+// Per-path arrays a bin of hits is scattered from and into
+struct ScatterBatch {
+    const Ray* rays;
+    const HitInfo* hits;
+    RandomStream* rngs;
+    Vec3* attenuation;
+    Ray* scattered;
+    bool* alive;
+};
+
+// Scatters the paths listed in items, all hitting material TYPE, with that
+// type's kernel inlined into the loop
+template <MaterialType TYPE>
+void scatterBin(const int* items, int count, const ScatterBatch& batch) {
+    for (int i = 0; i < count; ++i) {
+        int path = items[i];
+        batch.alive[path] = MaterialKernel<TYPE>::scatter(batch.rays[path], batch.hits[path], batch.rngs[path],
+                                                          batch.attenuation[path], batch.scattered[path]);
+    }
+}
+
+// Dispatch tables over a list of material types, indexed by type
+template <MaterialType... TYPES>
+struct MaterialTable {
+    using ScatterFunction = bool (*)(const Ray&, const HitInfo&, RandomStream&, Vec3&, Ray&);
+    using BinFunction = void (*)(const int*, int, const ScatterBatch&);
+
+    static constexpr int COUNT = sizeof...(TYPES);
+    static constexpr bool diffuse[] = {MaterialKernel<TYPES>::DIFFUSE...};
+    static constexpr ScatterFunction scatter[] = {&MaterialKernel<TYPES>::scatter...};
+    static constexpr BinFunction scatterBins[] = {&scatterBin<TYPES>...};
+
+    static constexpr bool isInEnumOrder() {
+        int index = 0;
+        return ((static_cast<int>(TYPES) == index++) && ...);
+    }
+    static_assert(isInEnumOrder(), "material kernels must be listed in MaterialType order");
+};
+
+namespace MaterialKernels {
+    // Every type the CPU tracer shades, in enum order
+    using Types = MaterialTable<MaterialType::Diffuse, MaterialType::Metal, MaterialType::Dielectric>;
+
+    constexpr int COUNT = Types::COUNT;
+
+    // Compiled materials store their type as an int; unknown types are
+    // neither diffuse nor scatter
+    inline bool isKnown(int type) { return type >= 0 && type < COUNT; }
+    inline bool isDiffuse(int type) { return isKnown(type) && Types::diffuse[type]; }
+
+    // One hit through the table, for callers without a batch to bin
+    inline bool scatter(const Ray& inRay, const HitInfo& hit, RandomStream& rng, Vec3& attenuation, Ray& scattered) {
+        int type = hit.material->type;
+        return isKnown(type) && Types::scatter[type](inRay, hit, rng, attenuation, scattered);
+    }
+}
@@ -0,0 +1,376 @@
+#include "PacketIntersector.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if MINIGPU_X86
+#include <immintrin.h>
+#endif
+
+#if MINIGPU_X86 && (defined(__GNUC__) || defined(__clang__))
+#define MINIGPU_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MINIGPU_TARGET_AVX2
+#endif
+
+namespace {
+    constexpr float EPSILON = CompiledScene::EPSILON;
+
+    // Lane result: kind in the high byte, primitive index below, -1 for a miss
+    int encodeHit(PrimitiveKind kind, size_t index) {
+        return (static_cast<int>(kind) << 24) | static_cast<int>(index);
+    }
+
+    void decodeHits(const int* ids, PacketHits& hits) {
+        for (int lane = 0; lane < RayPacket::MAX_WIDTH; ++lane) {
+            if (ids[lane] < 0) {
+                hits.kind[lane] = PrimitiveKind::None;
+                hits.index[lane] = -1;
+            } else {
+                hits.kind[lane] = static_cast<PrimitiveKind>(ids[lane] >> 24);
+                hits.index[lane] = ids[lane] & 0xFFFFFF;
+            }
+        }
+    }
+
+    void intersectScalar(const RayPacket& packet, const CompiledScene& scene, const PrimitiveRange& range,
+                         float* bestT, int* bestId) {
+        for (int lane = 0; lane < packet.count; ++lane) {
+            Vec3 origin{packet.originX[lane], packet.originY[lane], packet.originZ[lane]};
+            Vec3 direction{packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]};
+
+            SceneHit hit;
+            hit.t = bestT[lane];
+            scene.intersect(origin, direction, range, hit);
+            if (hit.kind != PrimitiveKind::None) {
+                bestT[lane] = hit.t;
+                bestId[lane] = encodeHit(hit.kind, static_cast<size_t>(hit.index));
+            }
+        }
+    }
+
+    bool allBlocked(const RayPacket& packet, const int* ids) {
+        for (int lane = 0; lane < packet.count; ++lane) {
+            if (ids[lane] < 0) return false;
+        }
+        return true;
+    }
+
+#if MINIGPU_X86
+    // The vector kernels repeat CompiledScene::intersect operation for operation
+    // (including std::min/std::max operand order) so both paths agree bit for bit
+
+    __m128 select4(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // Four lanes starting at offset. ANY_HIT stops once every live lane has
+    // a hit, which is then not necessarily the closest.
+    template <bool ANY_HIT>
+    void intersectSse(const RayPacket& packet, int offset, const CompiledScene& scene, const PrimitiveRange& range,
+                      float* bestT, int* bestId) {
+        const __m128 ox = _mm_load_ps(packet.originX + offset);
+        const __m128 oy = _mm_load_ps(packet.originY + offset);
+        const __m128 oz = _mm_load_ps(packet.originZ + offset);
+        const __m128 dx = _mm_load_ps(packet.directionX + offset);
+        const __m128 dy = _mm_load_ps(packet.directionY + offset);
+        const __m128 dz = _mm_load_ps(packet.directionZ + offset);
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 four = _mm_set1_ps(4.0f);
+        const __m128 eps = _mm_set1_ps(EPSILON);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+
+        const __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        const __m128 twoA = _mm_mul_ps(two, a);
+        const __m128 fourA = _mm_mul_ps(four, a);
+        const __m128 invX = _mm_div_ps(one, dx);
+        const __m128 invY = _mm_div_ps(one, dy);
+        const __m128 invZ = _mm_div_ps(one, dz);
+
+        __m128 best = _mm_load_ps(bestT + offset);
+        __m128 id = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bestId + offset)));
+
+        // Misses hold -1, so the sign bits mark the lanes still open
+        const int laneMask = (1 << std::clamp(packet.count - offset, 0, 4)) - 1;
+        bool done = false;
+
+        const CompiledScene::Spheres& spheres = scene.getSpheres();
+        for (size_t i = range.sphereBegin; i < range.sphereEnd && !done; ++i) {
+            __m128 ocx = _mm_sub_ps(ox, _mm_set1_ps(spheres.centerX[i]));
+            __m128 ocy = _mm_sub_ps(oy, _mm_set1_ps(spheres.centerY[i]));
+            __m128 ocz = _mm_sub_ps(oz, _mm_set1_ps(spheres.centerZ[i]));
+
+            __m128 b = _mm_mul_ps(two, _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, dx), _mm_mul_ps(ocy, dy)), _mm_mul_ps(ocz, dz)));
+            __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)), _mm_mul_ps(ocz, ocz)),
+                                  _mm_set1_ps(spheres.radius[i] * spheres.radius[i]));
+            __m128 discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(fourA, c));
+
+            __m128 sqrtD = _mm_sqrt_ps(discriminant);
+            __m128 negB = _mm_xor_ps(b, signMask);
+            __m128 t1 = _mm_div_ps(_mm_sub_ps(negB, sqrtD), twoA);
+            __m128 t2 = _mm_div_ps(_mm_add_ps(negB, sqrtD), twoA);
+            __m128 t1Valid = _mm_cmpgt_ps(t1, eps);
+            __m128 t2Valid = _mm_cmpgt_ps(t2, eps);
+
+            __m128 t = select4(t1Valid, t1, t2);
+            __m128 hit = _mm_and_ps(_mm_cmpnlt_ps(discriminant, zero), _mm_or_ps(t1Valid, t2Valid));
+            hit = _mm_and_ps(hit, _mm_cmplt_ps(t, best));
+
+            best = select4(hit, t, best);
+            id = select4(hit, _mm_castsi128_ps(_mm_set1_epi32(encodeHit(PrimitiveKind::Sphere, i))), id);
+            if constexpr (ANY_HIT) done = (_mm_movemask_ps(id) & laneMask) == 0;
+        }
+
+        const CompiledScene::Planes& planes = scene.getPlanes();
+        for (size_t i = range.planeBegin; i < range.planeEnd && !done; ++i) {
+            __m128 nx = _mm_set1_ps(planes.normalX[i]);
+            __m128 ny = _mm_set1_ps(planes.normalY[i]);
+            __m128 nz = _mm_set1_ps(planes.normalZ[i]);
+
+            __m128 denom = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, dx), _mm_mul_ps(ny, dy)), _mm_mul_ps(nz, dz));
+            __m128 px = _mm_sub_ps(_mm_set1_ps(planes.pointX[i]), ox);
+            __m128 py = _mm_sub_ps(_mm_set1_ps(planes.pointY[i]), oy);
+            __m128 pz = _mm_sub_ps(_mm_set1_ps(planes.pointZ[i]), oz);
+            __m128 t = _mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, nx), _mm_mul_ps(py, ny)), _mm_mul_ps(pz, nz)), denom);
+
+            __m128 hit = _mm_and_ps(_mm_cmpnlt_ps(_mm_andnot_ps(signMask, denom), eps), _mm_cmpgt_ps(t, eps));
+            hit = _mm_and_ps(hit, _mm_cmplt_ps(t, best));
+
+            best = select4(hit, t, best);
+            id = select4(hit, _mm_castsi128_ps(_mm_set1_epi32(encodeHit(PrimitiveKind::Plane, i))), id);
+            if constexpr (ANY_HIT) done = (_mm_movemask_ps(id) & laneMask) == 0;
+        }
+
+        const CompiledScene::Boxes& boxes = scene.getBoxes();
+        for (size_t i = range.boxBegin; i < range.boxEnd && !done; ++i) {
+            Vec3 center{boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]};
+            Vec3 halfExtent{boxes.halfExtentX[i], boxes.halfExtentY[i], boxes.halfExtentZ[i]};
+            Vec3 minBounds = center - halfExtent;
+            Vec3 maxBounds = center + halfExtent;
+
+            __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(minBounds.x), ox), invX);
+            __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(minBounds.y), oy), invY);
+            __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(minBounds.z), oz), invZ);
+            __m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(maxBounds.x), ox), invX);
+            __m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(maxBounds.y), oy), invY);
+            __m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(maxBounds.z), oz), invZ);
+
+            // std::min(a, b) == _mm_min_ps(b, a), likewise for max
+            __m128 tNear = _mm_max_ps(_mm_min_ps(t2z, t1z), _mm_max_ps(_mm_min_ps(t2y, t1y), _mm_min_ps(t2x, t1x)));
+            __m128 tFar = _mm_min_ps(_mm_max_ps(t2z, t1z), _mm_min_ps(_mm_max_ps(t2y, t1y), _mm_max_ps(t2x, t1x)));
+
+            __m128 miss = _mm_or_ps(_mm_cmpgt_ps(tNear, tFar), _mm_cmplt_ps(tFar, zero));
+            __m128 t = select4(_mm_cmpgt_ps(tNear, eps), tNear, tFar);
+            __m128 hit = _mm_andnot_ps(miss, _mm_cmplt_ps(t, best));
+
+            best = select4(hit, t, best);
+            id = select4(hit, _mm_castsi128_ps(_mm_set1_epi32(encodeHit(PrimitiveKind::Cube, i))), id);
+            if constexpr (ANY_HIT) done = (_mm_movemask_ps(id) & laneMask) == 0;
+        }
+
+        _mm_store_ps(bestT + offset, best);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bestId + offset), _mm_castps_si128(id));
+    }
+
+    template <bool ANY_HIT>
+    MINIGPU_TARGET_AVX2
+    void intersectAvx2(const RayPacket& packet, const CompiledScene& scene, const PrimitiveRange& range,
+                       float* bestT, int* bestId) {
+        const __m256 ox = _mm256_load_ps(packet.originX);
+        const __m256 oy = _mm256_load_ps(packet.originY);
+        const __m256 oz = _mm256_load_ps(packet.originZ);
+        const __m256 dx = _mm256_load_ps(packet.directionX);
+        const __m256 dy = _mm256_load_ps(packet.directionY);
+        const __m256 dz = _mm256_load_ps(packet.directionZ);
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 four = _mm256_set1_ps(4.0f);
+        const __m256 eps = _mm256_set1_ps(EPSILON);
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+        const __m256 a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        const __m256 twoA = _mm256_mul_ps(two, a);
+        const __m256 fourA = _mm256_mul_ps(four, a);
+        const __m256 invX = _mm256_div_ps(one, dx);
+        const __m256 invY = _mm256_div_ps(one, dy);
+        const __m256 invZ = _mm256_div_ps(one, dz);
+
+        __m256 best = _mm256_load_ps(bestT);
+        __m256 id = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bestId)));
+
+        const int laneMask = (1 << packet.count) - 1;
+        bool done = false;
+
+        const CompiledScene::Spheres& spheres = scene.getSpheres();
+        for (size_t i = range.sphereBegin; i < range.sphereEnd && !done; ++i) {
+            __m256 ocx = _mm256_sub_ps(ox, _mm256_set1_ps(spheres.centerX[i]));
+            __m256 ocy = _mm256_sub_ps(oy, _mm256_set1_ps(spheres.centerY[i]));
+            __m256 ocz = _mm256_sub_ps(oz, _mm256_set1_ps(spheres.centerZ[i]));
+
+            __m256 b = _mm256_mul_ps(two, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, dx), _mm256_mul_ps(ocy, dy)), _mm256_mul_ps(ocz, dz)));
+            __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, ocx), _mm256_mul_ps(ocy, ocy)), _mm256_mul_ps(ocz, ocz)),
+                                     _mm256_set1_ps(spheres.radius[i] * spheres.radius[i]));
+            __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(fourA, c));
+
+            __m256 sqrtD = _mm256_sqrt_ps(discriminant);
+            __m256 negB = _mm256_xor_ps(b, signMask);
+            __m256 t1 = _mm256_div_ps(_mm256_sub_ps(negB, sqrtD), twoA);
+            __m256 t2 = _mm256_div_ps(_mm256_add_ps(negB, sqrtD), twoA);
+            __m256 t1Valid = _mm256_cmp_ps(t1, eps, _CMP_GT_OQ);
+            __m256 t2Valid = _mm256_cmp_ps(t2, eps, _CMP_GT_OQ);
+
+            __m256 t = _mm256_blendv_ps(t2, t1, t1Valid);
+            __m256 hit = _mm256_and_ps(_mm256_cmp_ps(discriminant, zero, _CMP_NLT_UQ), _mm256_or_ps(t1Valid, t2Valid));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, best, _CMP_LT_OQ));
+
+            best = _mm256_blendv_ps(best, t, hit);
+            id = _mm256_blendv_ps(id, _mm256_castsi256_ps(_mm256_set1_epi32(encodeHit(PrimitiveKind::Sphere, i))), hit);
+            if constexpr (ANY_HIT) done = (_mm256_movemask_ps(id) & laneMask) == 0;
+        }
+
+        const CompiledScene::Planes& planes = scene.getPlanes();
+        for (size_t i = range.planeBegin; i < range.planeEnd && !done; ++i) {
+            __m256 nx = _mm256_set1_ps(planes.normalX[i]);
+            __m256 ny = _mm256_set1_ps(planes.normalY[i]);
+            __m256 nz = _mm256_set1_ps(planes.normalZ[i]);
+
+            __m256 denom = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, dx), _mm256_mul_ps(ny, dy)), _mm256_mul_ps(nz, dz));
+            __m256 px = _mm256_sub_ps(_mm256_set1_ps(planes.pointX[i]), ox);
+            __m256 py = _mm256_sub_ps(_mm256_set1_ps(planes.pointY[i]), oy);
+            __m256 pz = _mm256_sub_ps(_mm256_set1_ps(planes.pointZ[i]), oz);
+            __m256 t = _mm256_div_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, nx), _mm256_mul_ps(py, ny)), _mm256_mul_ps(pz, nz)), denom);
+
+            __m256 hit = _mm256_and_ps(_mm256_cmp_ps(_mm256_andnot_ps(signMask, denom), eps, _CMP_NLT_UQ),
+                                       _mm256_cmp_ps(t, eps, _CMP_GT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, best, _CMP_LT_OQ));
+
+            best = _mm256_blendv_ps(best, t, hit);
+            id = _mm256_blendv_ps(id, _mm256_castsi256_ps(_mm256_set1_epi32(encodeHit(PrimitiveKind::Plane, i))), hit);
+            if constexpr (ANY_HIT) done = (_mm256_movemask_ps(id) & laneMask) == 0;
+        }
+
+        const CompiledScene::Boxes& boxes = scene.getBoxes();
+        for (size_t i = range.boxBegin; i < range.boxEnd && !done; ++i) {
+            Vec3 center{boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]};
+            Vec3 halfExtent{boxes.halfExtentX[i], boxes.halfExtentY[i], boxes.halfExtentZ[i]};
+            Vec3 minBounds = center - halfExtent;
+            Vec3 maxBounds = center + halfExtent;
+
+            __m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(minBounds.x), ox), invX);
+            __m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(minBounds.y), oy), invY);
+            __m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(minBounds.z), oz), invZ);
+            __m256 t2x = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(maxBounds.x), ox), invX);
+            __m256 t2y = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(maxBounds.y), oy), invY);
+            __m256 t2z = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(maxBounds.z), oz), invZ);
+
+            __m256 tNear = _mm256_max_ps(_mm256_min_ps(t2z, t1z), _mm256_max_ps(_mm256_min_ps(t2y, t1y), _mm256_min_ps(t2x, t1x)));
+            __m256 tFar = _mm256_min_ps(_mm256_max_ps(t2z, t1z), _mm256_min_ps(_mm256_max_ps(t2y, t1y), _mm256_max_ps(t2x, t1x)));
+
+            __m256 miss = _mm256_or_ps(_mm256_cmp_ps(tNear, tFar, _CMP_GT_OQ), _mm256_cmp_ps(tFar, zero, _CMP_LT_OQ));
+            __m256 t = _mm256_blendv_ps(tFar, tNear, _mm256_cmp_ps(tNear, eps, _CMP_GT_OQ));
+            __m256 hit = _mm256_andnot_ps(miss, _mm256_cmp_ps(t, best, _CMP_LT_OQ));
+
+            best = _mm256_blendv_ps(best, t, hit);
+            id = _mm256_blendv_ps(id, _mm256_castsi256_ps(_mm256_set1_epi32(encodeHit(PrimitiveKind::Cube, i))), hit);
+            if constexpr (ANY_HIT) done = (_mm256_movemask_ps(id) & laneMask) == 0;
+        }
+
+        _mm256_store_ps(bestT, best);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(bestId), _mm256_castps_si256(id));
+    }
+#endif
+}
+
+void RayPacket::set(int lane, const Vec3& origin, const Vec3& direction, float maxDistance) {
+    originX[lane] = origin.x;
+    originY[lane] = origin.y;
+    originZ[lane] = origin.z;
+    directionX[lane] = direction.x;
+    directionY[lane] = direction.y;
+    directionZ[lane] = direction.z;
+    tMax[lane] = maxDistance;
+}
+
+PacketIntersector::PacketIntersector(SimdLevel level)
+    : m_level(std::min(level, CpuFeatures::getSimdLevel())) {
+}
+
+void PacketIntersector::intersect(const RayPacket& packet, const CompiledScene& scene, PacketHits& hits) const {
+    alignas(32) int ids[RayPacket::MAX_WIDTH];
+    std::copy(packet.tMax, packet.tMax + RayPacket::MAX_WIDTH, hits.t);
+    std::fill(ids, ids + RayPacket::MAX_WIDTH, -1);
+
+    trace<false>(packet, scene, hits.t, ids);
+    decodeHits(ids, hits);
+}
+
+void PacketIntersector::occluded(const RayPacket& packet, const CompiledScene& scene, bool* occluded) const {
+    alignas(32) float t[RayPacket::MAX_WIDTH];
+    alignas(32) int ids[RayPacket::MAX_WIDTH];
+    std::copy(packet.tMax, packet.tMax + RayPacket::MAX_WIDTH, t);
+    std::fill(ids, ids + RayPacket::MAX_WIDTH, -1);
+
+    trace<true>(packet, scene, t, ids);
+    for (int lane = 0; lane < RayPacket::MAX_WIDTH; ++lane) {
+        occluded[lane] = ids[lane] >= 0;
+    }
+}
+
+template <bool ANY_HIT>
+void PacketIntersector::trace(const RayPacket& packet, const CompiledScene& scene, float* bestT, int* bestId) const {
+    // Same order as CompiledScene::intersect: unindexed primitives first
+    traceRange<ANY_HIT>(packet, scene, scene.getUnindexedRange(), bestT, bestId);
+    if (ANY_HIT && allBlocked(packet, bestId)) return;
+
+    Vec3 origins[RayPacket::MAX_WIDTH];
+    Vec3 invDirections[RayPacket::MAX_WIDTH];
+    for (int lane = 0; lane < packet.count; ++lane) {
+        origins[lane] = Vec3{packet.originX[lane], packet.originY[lane], packet.originZ[lane]};
+        invDirections[lane] = Vec3{1.0f / packet.directionX[lane], 1.0f / packet.directionY[lane],
+                                   1.0f / packet.directionZ[lane]};
+    }
+
+    // A node is entered when any open lane passes through it, and its
+    // leaves are tested against all lanes at once
+    Vec3 direction{packet.directionX[0], packet.directionY[0], packet.directionZ[0]};
+    scene.traverse(direction,
+                   [&](const AABB& bounds) {
+                       for (int lane = 0; lane < packet.count; ++lane) {
+                           if (ANY_HIT && bestId[lane] >= 0) continue;
+                           if (CompiledScene::entersBounds(bounds, origins[lane], invDirections[lane], bestT[lane])) {
+                               return true;
+                           }
+                       }
+                       return false;
+                   },
+                   [&](const CompiledScene::BvhNode& leaf) {
+                       traceRange<ANY_HIT>(packet, scene, CompiledScene::getLeafRange(leaf), bestT, bestId);
+                       return !(ANY_HIT && allBlocked(packet, bestId));
+                   });
+}
+
+template <bool ANY_HIT>
+void PacketIntersector::traceRange(const RayPacket& packet, const CompiledScene& scene, const PrimitiveRange& range,
+                                   float* bestT, int* bestId) const {
+    switch (m_level) {
+#if MINIGPU_X86
+        case SimdLevel::Avx2:
+            intersectAvx2<ANY_HIT>(packet, scene, range, bestT, bestId);
+            break;
+        case SimdLevel::Sse:
+            intersectSse<ANY_HIT>(packet, 0, scene, range, bestT, bestId);
+            if (packet.count > 4) {
+                intersectSse<ANY_HIT>(packet, 4, scene, range, bestT, bestId);
+            }
+            break;
+#endif
+        default:
+            intersectScalar(packet, scene, range, bestT, bestId);
+            break;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/CpuFeatures.h"
+#include "scene/CompiledScene.h"
+#include "math/Vec3.h"
+
+// Up to eight rays in structure-of-arrays layout. Lanes past count are
+// traced but their results are meaningless.
+struct RayPacket {
+    static constexpr int MAX_WIDTH = 8;
+
+    alignas(32) float originX[MAX_WIDTH] = {};
+    alignas(32) float originY[MAX_WIDTH] = {};
+    alignas(32) float originZ[MAX_WIDTH] = {};
+    alignas(32) float directionX[MAX_WIDTH] = {};
+    alignas(32) float directionY[MAX_WIDTH] = {};
+    alignas(32) float directionZ[MAX_WIDTH] = {};
+    alignas(32) float tMax[MAX_WIDTH] = {};
+    int count = 0;
+
+    void set(int lane, const Vec3& origin, const Vec3& direction, float maxDistance);
+};
+
+// Closest hit per lane
+struct PacketHits {
+    alignas(32) float t[RayPacket::MAX_WIDTH];
+    PrimitiveKind kind[RayPacket::MAX_WIDTH];
+    int index[RayPacket::MAX_WIDTH];
+};
+
+// Closest-hit queries for coherent ray packets against a compiled scene.
+// The packet walks the scene's hierarchy together, and each primitive of a
+// leaf is broadcast and tested against all lanes at once. Every level visits
+// primitives in the same order, so all give identical hits; they match
+// CompiledScene::intersect, which incoherent rays use, but for exact ties
+// between primitives the two may visit in another order.
+class PacketIntersector {
+public:
+    // Requests above what the CPU supports fall back to the best available
+    explicit PacketIntersector(SimdLevel level = CpuFeatures::getSimdLevel());
+
+    SimdLevel getLevel() const { return m_level; }
+
+    void intersect(const RayPacket& packet, const CompiledScene& scene, PacketHits& hits) const;
+    // Whether anything lies within each lane's tMax; stops testing once all
+    // lanes are blocked. Writes MAX_WIDTH entries.
+    void occluded(const RayPacket& packet, const CompiledScene& scene, bool* occluded) const;
+
+    static constexpr float MAX_DISTANCE = 1e20f;
+
+private:
+    template <bool ANY_HIT>
+    void trace(const RayPacket& packet, const CompiledScene& scene, float* bestT, int* bestId) const;
+    template <bool ANY_HIT>
+    void traceRange(const RayPacket& packet, const CompiledScene& scene, const PrimitiveRange& range,
+                    float* bestT, int* bestId) const;
+
+    SimdLevel m_level;
+};
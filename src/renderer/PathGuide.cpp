@@ -0,0 +1,294 @@
+#include "PathGuide.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float PI = 3.14159265359f;
+    constexpr float ONE_MINUS_EPSILON = 0.99999994f;
+    constexpr uint32_t NO_NODE = ~0u;
+
+    uint32_t leafIndex(const AABB& bounds, const std::vector<PathGuide::SpatialNode>& nodes, const Vec3& position) {
+        Vec3 lo = bounds.min, hi = bounds.max;
+        uint32_t index = 0;
+        while (nodes[index].axis >= 0) {
+            int axis = nodes[index].axis;
+            float mid = 0.5f * (lo[axis] + hi[axis]);
+            if (position[axis] < mid) {
+                hi[axis] = mid;
+                index = nodes[index].child[0];
+            } else {
+                lo[axis] = mid;
+                index = nodes[index].child[1];
+            }
+        }
+        return nodes[index].leaf;
+    }
+
+    // Copies the structure of src below srcIndex, or of a uniform node
+    // holding sum when srcIndex is NO_NODE, subdividing quadrants with a
+    // large share of total. The copy's sums are zero.
+    void refineNode(const PathGuide::DirectionTree& src, uint32_t srcIndex, float sum, uint32_t dstIndex,
+                    int depth, float total, PathGuide::DirectionTree& dst) {
+        for (int q = 0; q < 4; ++q) {
+            float quadrantSum = srcIndex != NO_NODE ? src.nodes[srcIndex].sum[q] : sum * 0.25f;
+            if (depth >= PathGuide::MAX_QUAD_DEPTH || quadrantSum <= total * PathGuide::SUBDIVIDE_FRACTION) {
+                continue;
+            }
+
+            uint32_t child = static_cast<uint32_t>(dst.nodes.size());
+            dst.nodes.emplace_back();
+            dst.nodes[dstIndex].child[q] = child;
+
+            uint32_t srcChild = srcIndex != NO_NODE ? src.nodes[srcIndex].child[q] : 0;
+            refineNode(src, srcChild ? srcChild : NO_NODE, quadrantSum, child, depth + 1, total, dst);
+        }
+    }
+}
+
+float PathGuide::DirectionTree::total() const {
+    const QuadNode& root = nodes[0];
+    return root.sum[0] + root.sum[1] + root.sum[2] + root.sum[3];
+}
+
+const PathGuide::DirectionTree* PathGuide::Tree::findLeaf(const Vec3& position) const {
+    const DirectionTree& leaf = m_leaves[leafIndex(m_bounds, m_nodes, position)];
+    return leaf.total() > 0.0f ? &leaf : nullptr;
+}
+
+Vec3 PathGuide::DirectionTree::sample(float u1, float u2, float& pdf) const {
+    // Pick a column by its share, then a quadrant within it, reusing the
+    // rescaled random numbers at every level
+    float x = u1, y = u2;
+    float originX = 0.0f, originY = 0.0f, size = 1.0f;
+    float density = 1.0f;
+    uint32_t index = 0;
+
+    while (true) {
+        const QuadNode& node = nodes[index];
+        float sum = node.sum[0] + node.sum[1] + node.sum[2] + node.sum[3];
+        if (sum <= 0.0f) break;
+
+        float left = (node.sum[0] + node.sum[2]) / sum;
+        int xBit = x < left ? 0 : 1;
+        x = xBit == 0 ? x / left : (x - left) / (1.0f - left);
+
+        float column = node.sum[xBit] + node.sum[xBit + 2];
+        float bottom = node.sum[xBit] / column;
+        int yBit = y < bottom ? 0 : 1;
+        y = yBit == 0 ? y / bottom : (y - bottom) / (1.0f - bottom);
+
+        x = std::clamp(x, 0.0f, ONE_MINUS_EPSILON);
+        y = std::clamp(y, 0.0f, ONE_MINUS_EPSILON);
+
+        int quadrant = xBit | (yBit << 1);
+        density *= 4.0f * node.sum[quadrant] / sum;
+        size *= 0.5f;
+        originX += xBit * size;
+        originY += yBit * size;
+
+        if (!node.child[quadrant]) break;
+        index = node.child[quadrant];
+    }
+
+    pdf = density / (4.0f * PI);
+    return squareToDirection(originX + x * size, originY + y * size);
+}
+
+float PathGuide::DirectionTree::pdf(const Vec3& direction) const {
+    float x, y;
+    directionToSquare(direction, x, y);
+
+    float density = 1.0f;
+    uint32_t index = 0;
+    while (true) {
+        const QuadNode& node = nodes[index];
+        float sum = node.sum[0] + node.sum[1] + node.sum[2] + node.sum[3];
+        if (sum <= 0.0f) break;
+
+        int xBit = x < 0.5f ? 0 : 1;
+        int yBit = y < 0.5f ? 0 : 1;
+        int quadrant = xBit | (yBit << 1);
+        density *= 4.0f * node.sum[quadrant] / sum;
+
+        x = std::min(2.0f * x - xBit, ONE_MINUS_EPSILON);
+        y = std::min(2.0f * y - yBit, ONE_MINUS_EPSILON);
+        if (!node.child[quadrant]) break;
+        index = node.child[quadrant];
+    }
+    return density / (4.0f * PI);
+}
+
+size_t PathGuide::Tree::getMemoryUsage() const {
+    size_t bytes = m_nodes.capacity() * sizeof(SpatialNode) + m_leaves.capacity() * sizeof(DirectionTree);
+    for (const DirectionTree& leaf : m_leaves) {
+        bytes += leaf.nodes.capacity() * sizeof(QuadNode);
+    }
+    return bytes;
+}
+
+Vec3 PathGuide::squareToDirection(float u, float v) {
+    float z = 2.0f * u - 1.0f;
+    float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    float phi = 2.0f * PI * v;
+    return Vec3{r * std::cos(phi), r * std::sin(phi), z};
+}
+
+void PathGuide::directionToSquare(const Vec3& direction, float& u, float& v) {
+    float phi = std::atan2(direction.y, direction.x);
+    if (phi < 0.0f) phi += 2.0f * PI;
+    u = std::clamp(0.5f * (direction.z + 1.0f), 0.0f, ONE_MINUS_EPSILON);
+    v = std::clamp(phi / (2.0f * PI), 0.0f, ONE_MINUS_EPSILON);
+}
+
+PathGuide::PathGuide() = default;
+
+std::shared_ptr<const PathGuide::Tree> PathGuide::getTree() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_published;
+}
+
+void PathGuide::addSamples(const std::vector<Sample>& samples) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Sample& sample : samples) {
+        splat(sample);
+    }
+}
+
+void PathGuide::splat(const Sample& sample) {
+    // The first iteration has a single leaf and learns the bounds for the
+    // spatial splits that follow
+    if (m_iteration == 0) {
+        if (!m_hasSampleBounds) {
+            m_sampleBounds = AABB{sample.position, sample.position};
+            m_hasSampleBounds = true;
+        }
+        m_sampleBounds.min = Vec3{std::min(m_sampleBounds.min.x, sample.position.x),
+                                  std::min(m_sampleBounds.min.y, sample.position.y),
+                                  std::min(m_sampleBounds.min.z, sample.position.z)};
+        m_sampleBounds.max = Vec3{std::max(m_sampleBounds.max.x, sample.position.x),
+                                  std::max(m_sampleBounds.max.y, sample.position.y),
+                                  std::max(m_sampleBounds.max.z, sample.position.z)};
+    }
+
+    DirectionTree& leaf = m_building.m_leaves[leafIndex(m_building.m_bounds, m_building.m_nodes, sample.position)];
+    leaf.sampleCount += 1.0f;
+
+    float x, y;
+    directionToSquare(sample.direction, x, y);
+    uint32_t index = 0;
+    while (true) {
+        int xBit = x < 0.5f ? 0 : 1;
+        int yBit = y < 0.5f ? 0 : 1;
+        int quadrant = xBit | (yBit << 1);
+        QuadNode& node = leaf.nodes[index];
+        node.sum[quadrant] += sample.weight;
+
+        if (!node.child[quadrant]) break;
+        index = node.child[quadrant];
+        x = std::min(2.0f * x - xBit, ONE_MINUS_EPSILON);
+        y = std::min(2.0f * y - yBit, ONE_MINUS_EPSILON);
+    }
+}
+
+void PathGuide::finishPass() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_passesLeft > 0) return;
+
+    // Nothing to learn the bounds from yet
+    if (m_iteration == 0 && !m_hasSampleBounds) {
+        m_passesLeft = 1;
+        return;
+    }
+
+    if (m_iteration == 0) {
+        // A cube around the vertices seen, so splits cycle through even halves
+        Vec3 center = m_sampleBounds.center();
+        Vec3 extent = m_sampleBounds.extent();
+        float half = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-3f)) * 1.01f;
+        m_building.m_bounds = AABB{center - Vec3{half}, center + Vec3{half}};
+    }
+
+    m_published = std::make_shared<const Tree>(m_building);
+
+    refineSpatial();
+    for (DirectionTree& leaf : m_building.m_leaves) {
+        leaf = refineDirections(leaf);
+    }
+
+    ++m_iteration;
+    m_passesLeft = std::min(1 << std::min(m_iteration, 30), MAX_ITERATION_PASSES);
+}
+
+void PathGuide::refineSpatial() {
+    // Denser leaves split in more iterations as their sample counts grow
+    float passes = static_cast<float>(std::min(1 << std::min(m_iteration, 30), MAX_ITERATION_PASSES));
+    float threshold = SPLIT_SAMPLES * std::sqrt(passes);
+
+    std::vector<std::pair<uint32_t, int>> stack{{0u, 0}};
+    while (!stack.empty()) {
+        auto [index, depth] = stack.back();
+        stack.pop_back();
+
+        SpatialNode node = m_building.m_nodes[index];
+        if (node.axis >= 0) {
+            stack.push_back({node.child[0], depth + 1});
+            stack.push_back({node.child[1], depth + 1});
+            continue;
+        }
+
+        if (m_building.m_leaves[node.leaf].sampleCount <= threshold ||
+            static_cast<int>(m_building.m_leaves.size()) >= MAX_SPATIAL_LEAVES) {
+            continue;
+        }
+
+        // Both halves start from the parent's directions with half its samples
+        DirectionTree half = m_building.m_leaves[node.leaf];
+        half.sampleCount *= 0.5f;
+        m_building.m_leaves[node.leaf] = half;
+        m_building.m_leaves.push_back(half);
+
+        uint32_t first = static_cast<uint32_t>(m_building.m_nodes.size());
+        SpatialNode lower, upper;
+        lower.leaf = node.leaf;
+        upper.leaf = static_cast<uint32_t>(m_building.m_leaves.size() - 1);
+        m_building.m_nodes.push_back(lower);
+        m_building.m_nodes.push_back(upper);
+
+        SpatialNode& split = m_building.m_nodes[index];
+        split.axis = depth % 3;
+        split.child[0] = first;
+        split.child[1] = first + 1;
+
+        stack.push_back({first, depth + 1});
+        stack.push_back({first + 1, depth + 1});
+    }
+}
+
+PathGuide::DirectionTree PathGuide::refineDirections(const DirectionTree& source) {
+    DirectionTree refined;
+    float total = source.total();
+    if (total > 0.0f) {
+        refineNode(source, 0, total, 0, 1, total, refined);
+    }
+    return refined;
+}
+
+void PathGuide::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_building = Tree{};
+    m_published.reset();
+    m_hasSampleBounds = false;
+    m_iteration = 0;
+    m_passesLeft = 1;
+}
+
+int PathGuide::getIteration() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_iteration;
+}
+
+size_t PathGuide::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_building.getMemoryUsage() + (m_published ? m_published->getMemoryUsage() : 0);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "math/AABB.h"
+#include "math/Vec3.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Online path guiding with a spatial-directional tree (after Müller et al.,
+// "Practical Path Guiding"). A binary tree splits the scene along cycling
+// axes; each leaf holds a quadtree over directions, in the area-preserving
+// cylindrical mapping, whose nodes sum the incident radiance paths saw.
+//
+// Training runs in iterations of doubling length. Paths record what they
+// find at diffuse vertices into a building tree; when an iteration ends, it
+// becomes the immutable tree paths sample from, and a copy refined where
+// the samples were dense starts the next iteration empty. Sampling from the
+// guide changes only the noise, so the image keeps accumulating throughout.
+class PathGuide {
+public:
+    // Quadtree over the unit square of mapped directions. child[i] is 0 for
+    // a leaf quadrant; quadrant i covers x half (i & 1), y half (i >> 1).
+    struct QuadNode {
+        float sum[4] = {};
+        uint32_t child[4] = {};
+    };
+
+    struct DirectionTree {
+        std::vector<QuadNode> nodes = std::vector<QuadNode>(1);
+        float sampleCount = 0.0f;
+
+        float total() const;
+        // Draws a direction and returns its solid angle density; the tree
+        // must have a positive total
+        Vec3 sample(float u1, float u2, float& pdf) const;
+        float pdf(const Vec3& direction) const;
+    };
+
+    // Splits its box in half along axis; leaves index a direction tree
+    struct SpatialNode {
+        int axis = -1;              // -1 for a leaf
+        uint32_t child[2] = {};
+        uint32_t leaf = 0;
+    };
+
+    class Tree {
+    public:
+        // Directions learned around position; null where nothing was
+        const DirectionTree* findLeaf(const Vec3& position) const;
+
+        int getLeafCount() const { return static_cast<int>(m_leaves.size()); }
+        size_t getMemoryUsage() const;
+
+    private:
+        friend class PathGuide;
+
+        AABB m_bounds{Vec3{-1.0f}, Vec3{1.0f}};
+        std::vector<SpatialNode> m_nodes = std::vector<SpatialNode>(1);
+        std::vector<DirectionTree> m_leaves = std::vector<DirectionTree>(1);
+    };
+
+    // One diffuse vertex of a traced path: the direction it continued in and
+    // the luminance of incident radiance found there, over the mixture pdf
+    struct Sample {
+        Vec3 position;
+        Vec3 direction;
+        float weight = 0.0f;
+    };
+
+    PathGuide();
+
+    // Null until the first iteration has finished
+    std::shared_ptr<const Tree> getTree() const;
+
+    // Thread-safe; splats into the building tree
+    void addSamples(const std::vector<Sample>& samples);
+    // Counts a finished pass; the last one of an iteration publishes the
+    // building tree and starts the next iteration
+    void finishPass();
+    void clear();
+
+    int getIteration() const;
+    // Bytes held by the sampling and building trees together
+    size_t getMemoryUsage() const;
+
+    // Iteration k spans 2^k passes, up to this many
+    static constexpr int MAX_ITERATION_PASSES = 32;
+    // A spatial leaf splits once it saw this many samples times sqrt(2^k)
+    static constexpr float SPLIT_SAMPLES = 4000.0f;
+    static constexpr int MAX_SPATIAL_LEAVES = 1 << 12;
+    // Quadrants holding more than this share of a leaf's energy subdivide
+    static constexpr float SUBDIVIDE_FRACTION = 0.01f;
+    static constexpr int MAX_QUAD_DEPTH = 16;
+
+    // Cylindrical mapping between unit directions and the unit square
+    static Vec3 squareToDirection(float u, float v);
+    static void directionToSquare(const Vec3& direction, float& u, float& v);
+
+private:
+    void splat(const Sample& sample);
+    void refineSpatial();
+    static DirectionTree refineDirections(const DirectionTree& source);
+
+    mutable std::mutex m_mutex;
+
+    // Guarded by m_mutex
+    Tree m_building;
+    std::shared_ptr<const Tree> m_published;
+    AABB m_sampleBounds;
+    bool m_hasSampleBounds = false;
+    int m_iteration = 0;
+    int m_passesLeft = 1;
+};
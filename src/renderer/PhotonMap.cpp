@@ -0,0 +1,94 @@
+#include "PhotonMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float PI = 3.14159265359f;
+}
+
+PhotonMap::PhotonMap(std::vector<Photon> photons, float radius)
+    : m_radius(radius), m_cellSize(2.0f * radius) {
+    // About two buckets per photon keeps unrelated cells from sharing one
+    uint32_t buckets = 1;
+    while (buckets < photons.size() * 2) buckets <<= 1;
+    m_bucketMask = buckets - 1;
+
+    // Counting sort by bucket
+    std::vector<uint32_t> bucketOfPhoton(photons.size());
+    m_bucketStart.assign(buckets + 1, 0);
+    for (size_t i = 0; i < photons.size(); ++i) {
+        int64_t cell[3];
+        cellOf(photons[i].position, cell);
+        bucketOfPhoton[i] = bucketOf(cell);
+        m_bucketStart[bucketOfPhoton[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < buckets; ++b) {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    m_photons.resize(photons.size());
+    std::vector<uint32_t> cursor(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (size_t i = 0; i < photons.size(); ++i) {
+        m_photons[cursor[bucketOfPhoton[i]]++] = photons[i];
+    }
+}
+
+void PhotonMap::cellOf(const Vec3& position, int64_t cell[3]) const {
+    cell[0] = static_cast<int64_t>(std::floor(position.x / m_cellSize));
+    cell[1] = static_cast<int64_t>(std::floor(position.y / m_cellSize));
+    cell[2] = static_cast<int64_t>(std::floor(position.z / m_cellSize));
+}
+
+uint32_t PhotonMap::bucketOf(const int64_t cell[3]) const {
+    uint64_t h = static_cast<uint64_t>(cell[0]) * 73856093u ^
+                 static_cast<uint64_t>(cell[1]) * 19349663u ^
+                 static_cast<uint64_t>(cell[2]) * 83492791u;
+    h ^= h >> 29;
+    return static_cast<uint32_t>(h) & m_bucketMask;
+}
+
+Vec3 PhotonMap::estimate(const Vec3& position, const Vec3& normal) const {
+    if (m_photons.empty()) return Vec3{0.0f};
+
+    // The cells the lookup sphere overlaps: at most two along each axis
+    int64_t lo[3], hi[3];
+    cellOf(position - Vec3{m_radius}, lo);
+    cellOf(position + Vec3{m_radius}, hi);
+
+    float radiusSquared = m_radius * m_radius;
+    Vec3 flux{0.0f};
+    uint32_t visited[8];
+    int visitedCount = 0;
+
+    for (int64_t x = lo[0]; x <= hi[0]; ++x) {
+        for (int64_t y = lo[1]; y <= hi[1]; ++y) {
+            for (int64_t z = lo[2]; z <= hi[2]; ++z) {
+                int64_t cell[3] = {x, y, z};
+                uint32_t bucket = bucketOf(cell);
+
+                // Cells sharing a bucket must not count its photons twice
+                if (std::find(visited, visited + visitedCount, bucket) != visited + visitedCount) continue;
+                visited[visitedCount++] = bucket;
+
+                for (uint32_t i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i) {
+                    const Photon& photon = m_photons[i];
+                    Vec3 offset = photon.position - position;
+                    if (dot(offset, offset) > radiusSquared) continue;
+                    if (dot(photon.direction, normal) >= 0.0f) continue;
+                    flux += photon.power;
+                }
+            }
+        }
+    }
+
+    return flux / (PI * radiusSquared);
+}
+
+float PhotonMap::radiusForPass(float initialRadius, int pass) {
+    float radiusSquared = initialRadius * initialRadius;
+    for (int i = 1; i <= pass; ++i) {
+        radiusSquared *= (i + ALPHA) / (i + 1.0f);
+    }
+    return std::sqrt(radiusSquared);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "math/Vec3.h"
+#include <cstdint>
+#include <vector>
+
+// Caustic photons of one pass in a hash grid of cells twice the lookup
+// radius, so a lookup visits at most eight cells. Photons arrive from the
+// CPU path tracer, which traces them from emitters through specular and
+// glass surfaces to the first diffuse surface they reach.
+class PhotonMap {
+public:
+    struct Photon {
+        Vec3 position;
+        Vec3 power;
+        Vec3 direction;     // Of travel, into the surface
+    };
+
+    PhotonMap(std::vector<Photon> photons, float radius);
+
+    // Flux per unit area arriving at a surface with this facing normal,
+    // from the photons within the radius; times the BRDF gives radiance
+    Vec3 estimate(const Vec3& position, const Vec3& normal) const;
+
+    size_t size() const { return m_photons.size(); }
+    float getRadius() const { return m_radius; }
+
+    // Progressive photon mapping radius for a pass: the squared radius
+    // shrinks by (i + alpha) / (i + 1) per pass, so bias vanishes while the
+    // photons per lookup keep growing
+    static float radiusForPass(float initialRadius, int pass);
+    static constexpr float ALPHA = 2.0f / 3.0f;
+
+private:
+    void cellOf(const Vec3& position, int64_t cell[3]) const;
+    uint32_t bucketOf(const int64_t cell[3]) const;
+
+    std::vector<Photon> m_photons;      // Sorted by bucket
+    std::vector<uint32_t> m_bucketStart;
+    uint32_t m_bucketMask = 0;
+    float m_radius = 0.0f;
+    float m_cellSize = 1.0f;
+};
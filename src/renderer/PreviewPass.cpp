@@ -0,0 +1,406 @@
+#include "PreviewPass.h"
+#include "scene/Camera.h"
+#include "scene/Object.h"
+#include "core/Logger.h"
+#include "utils/ResourceManager.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Same sun as getSkyColor in the shaders
+    const Vec3 SUN_DIRECTION = Vec3{0.2f, 0.6f, 0.4f}.normalized();
+    const Vec3 SUN_IRRADIANCE{3.0f, 2.5f, 2.0f};
+
+    constexpr int KIND_SKY = 3;
+    constexpr int SPHERE_SEGMENTS = 24;
+    constexpr int SPHERE_RINGS = 16;
+
+    float luminance(const float rgb[3]) {
+        return 0.2126f * rgb[0] + 0.7152f * rgb[1] + 0.0722f * rgb[2];
+    }
+}
+
+PreviewPass::PreviewPass() {
+    createMeshes();
+    createShadowMap();
+    reloadShaders();
+}
+
+PreviewPass::~PreviewPass() {
+    deleteMesh(m_sphereMesh);
+    deleteMesh(m_cubeMesh);
+    deleteMesh(m_planeMesh);
+    deleteMesh(m_skyMesh);
+
+    if (m_instanceVBO) glDeleteBuffers(1, &m_instanceVBO);
+    if (m_shadowMap) glDeleteTextures(1, &m_shadowMap);
+    if (m_shadowFramebuffer) glDeleteFramebuffers(1, &m_shadowFramebuffer);
+}
+
+void PreviewPass::reloadShaders() {
+    m_shader = ResourceManager::instance().loadShader(
+        "preview", "shaders/preview.vert", "shaders/preview.frag");
+
+    if (!m_shader || !m_shader->isValid()) {
+        LOG_WARN("Preview shader failed to load - preview mode disabled");
+        m_shader = nullptr;
+    }
+
+    m_shadowShader = ResourceManager::instance().loadShader(
+        "preview_shadow", "shaders/preview.vert", "shaders/preview_shadow.frag");
+
+    if (!m_shadowShader || !m_shadowShader->isValid()) {
+        LOG_WARN("Preview shadow shader failed to load - preview shadows disabled");
+        m_shadowShader = nullptr;
+    }
+
+    m_shadowDirty = true;
+}
+
+void PreviewPass::createMeshes() {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+
+    // Unit sphere; the normal is the position
+    for (int ring = 0; ring <= SPHERE_RINGS; ++ring) {
+        float phi = static_cast<float>(M_PI) * ring / SPHERE_RINGS;
+        for (int segment = 0; segment <= SPHERE_SEGMENTS; ++segment) {
+            float theta = 2.0f * static_cast<float>(M_PI) * segment / SPHERE_SEGMENTS;
+            float x = std::sin(phi) * std::cos(theta);
+            float y = std::cos(phi);
+            float z = std::sin(phi) * std::sin(theta);
+            vertices.insert(vertices.end(), {x, y, z, x, y, z});
+        }
+    }
+    for (int ring = 0; ring < SPHERE_RINGS; ++ring) {
+        for (int segment = 0; segment < SPHERE_SEGMENTS; ++segment) {
+            unsigned int a = ring * (SPHERE_SEGMENTS + 1) + segment;
+            unsigned int b = a + SPHERE_SEGMENTS + 1;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+    createMesh(m_sphereMesh, vertices, indices);
+
+    // Unit cube, four vertices per face for flat normals
+    vertices.clear();
+    indices.clear();
+    const float faces[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (int face = 0; face < 6; ++face) {
+        Vec3 n{faces[face][0], faces[face][1], faces[face][2]};
+        Vec3 u = std::abs(n.y) > 0.5f ? Vec3{1, 0, 0} : Vec3{0, 1, 0};
+        Vec3 v = cross(n, u);
+        unsigned int base = static_cast<unsigned int>(vertices.size() / 6);
+        const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+        for (const auto& corner : corners) {
+            Vec3 p = (n + u * corner[0] + v * corner[1]) * 0.5f;
+            vertices.insert(vertices.end(), {p.x, p.y, p.z, n.x, n.y, n.z});
+        }
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+    createMesh(m_cubeMesh, vertices, indices);
+
+    // Unit quad in XZ; the shader orients and stretches it
+    vertices = {
+        -0.5f, 0.0f, -0.5f,  0.0f, 1.0f, 0.0f,
+         0.5f, 0.0f, -0.5f,  0.0f, 1.0f, 0.0f,
+         0.5f, 0.0f,  0.5f,  0.0f, 1.0f, 0.0f,
+        -0.5f, 0.0f,  0.5f,  0.0f, 1.0f, 0.0f
+    };
+    indices = {0, 1, 2, 0, 2, 3};
+    createMesh(m_planeMesh, vertices, indices);
+
+    // Fullscreen quad in clip space for the sky
+    vertices = {
+        -1.0f, -1.0f, 0.0f,  0.0f, 0.0f, 1.0f,
+         1.0f, -1.0f, 0.0f,  0.0f, 0.0f, 1.0f,
+         1.0f,  1.0f, 0.0f,  0.0f, 0.0f, 1.0f,
+        -1.0f,  1.0f, 0.0f,  0.0f, 0.0f, 1.0f
+    };
+    createMesh(m_skyMesh, vertices, indices);
+
+    glGenBuffers(1, &m_instanceVBO);
+    glBindVertexArray(0);
+}
+
+void PreviewPass::createMesh(Mesh& mesh, const std::vector<float>& vertices, const std::vector<unsigned int>& indices) {
+    glGenVertexArrays(1, &mesh.vao);
+    glGenBuffers(1, &mesh.vbo);
+    glGenBuffers(1, &mesh.ibo);
+
+    glBindVertexArray(mesh.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    mesh.indexCount = static_cast<int>(indices.size());
+}
+
+void PreviewPass::deleteMesh(Mesh& mesh) {
+    if (mesh.vao) glDeleteVertexArrays(1, &mesh.vao);
+    if (mesh.vbo) glDeleteBuffers(1, &mesh.vbo);
+    if (mesh.ibo) glDeleteBuffers(1, &mesh.ibo);
+    mesh = Mesh{};
+}
+
+void PreviewPass::createShadowMap() {
+    glGenTextures(1, &m_shadowMap);
+    glBindTexture(GL_TEXTURE_2D, m_shadowMap);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    glGenFramebuffers(1, &m_shadowFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_shadowFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_shadowMap, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_ERROR("Preview shadow framebuffer is not complete!");
+    }
+
+    // Fully lit until the first shadow pass runs
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void PreviewPass::uploadInstances(const std::vector<PreviewInstance>& spheres,
+                                  const std::vector<PreviewInstance>& cubes,
+                                  const std::vector<PreviewInstance>& planes) {
+    m_instances.clear();
+    m_instances.insert(m_instances.end(), spheres.begin(), spheres.end());
+    m_instances.insert(m_instances.end(), cubes.begin(), cubes.end());
+    m_instances.insert(m_instances.end(), planes.begin(), planes.end());
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if (m_instances.size() > m_instanceCapacity) {
+        m_instanceCapacity = m_instances.size() * 2;
+        glBufferData(GL_ARRAY_BUFFER, m_instanceCapacity * sizeof(PreviewInstance), nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (!m_instances.empty()) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_instances.size() * sizeof(PreviewInstance), m_instances.data());
+    }
+
+    // Spheres and cubes cast shadows; the shadow map only changes with them
+    size_t casterCount = spheres.size() + cubes.size();
+    if (casterCount != m_shadowCasters.size() ||
+        (casterCount > 0 && std::memcmp(m_shadowCasters.data(), m_instances.data(),
+                                        casterCount * sizeof(PreviewInstance)) != 0)) {
+        m_shadowCasters.assign(m_instances.begin(), m_instances.begin() + casterCount);
+        m_shadowDirty = true;
+    }
+}
+
+void PreviewPass::updateLight(const std::vector<PreviewInstance>& spheres,
+                              const std::vector<PreviewInstance>& cubes) {
+    // Bounds of the shadow casters frame the shadow map
+    Vec3 boundsMin{1e20f}, boundsMax{-1e20f};
+    const PreviewInstance* brightest = nullptr;
+    float brightestPower = 0.0f;
+    float brightestRadius = 0.0f;
+
+    auto visit = [&](const PreviewInstance& instance, bool sphere) {
+        Vec3 center{instance.center[0], instance.center[1], instance.center[2]};
+        Vec3 halfSize = sphere ? Vec3{instance.size[0]}
+                               : Vec3{instance.size[0], instance.size[1], instance.size[2]} * 0.5f;
+        for (int axis = 0; axis < 3; ++axis) {
+            boundsMin[axis] = std::min(boundsMin[axis], center[axis] - halfSize[axis]);
+            boundsMax[axis] = std::max(boundsMax[axis], center[axis] + halfSize[axis]);
+        }
+
+        float radius = sphere ? instance.size[0] : halfSize.length();
+        float power = luminance(instance.emission) * radius * radius;
+        if (power > brightestPower) {
+            brightestPower = power;
+            brightest = &instance;
+            brightestRadius = radius;
+        }
+    };
+    for (const auto& instance : spheres) visit(instance, true);
+    for (const auto& instance : cubes) visit(instance, false);
+
+    Vec3 center{0.0f};
+    float radius = 10.0f;
+    if (!spheres.empty() || !cubes.empty()) {
+        center = (boundsMin + boundsMax) * 0.5f;
+        radius = std::max((boundsMax - boundsMin).length() * 0.5f, 1.0f);
+    }
+
+    Light light;
+    if (brightest) {
+        light.directional = false;
+        light.position = Vec3{brightest->center[0], brightest->center[1], brightest->center[2]};
+        light.color = Vec3{brightest->emission[0], brightest->emission[1], brightest->emission[2]};
+        light.radius = brightestRadius;
+
+        Vec3 toCenter = center - light.position;
+        float distance = toCenter.length();
+        light.forward = distance > 0.001f ? toCenter / distance : Vec3{0.0f, -1.0f, 0.0f};
+        light.tanHalfFov = std::clamp(radius / std::max(distance, 0.001f), 0.35f, 3.7f);
+        // Start past the emitter so it does not shadow everything
+        light.nearPlane = brightestRadius * 1.05f + 0.01f;
+        light.farPlane = distance + radius * 2.0f + 1.0f;
+    } else {
+        light.directional = true;
+        light.forward = -SUN_DIRECTION;
+        light.color = SUN_IRRADIANCE;
+        light.position = center + SUN_DIRECTION * (radius * 2.0f + 1.0f);
+        light.halfExtent = radius * 1.1f;
+        light.nearPlane = 0.01f;
+        light.farPlane = radius * 4.0f + 2.0f;
+    }
+
+    Vec3 worldUp = std::abs(light.forward.y) > 0.99f ? Vec3{0.0f, 0.0f, 1.0f} : Vec3{0.0f, 1.0f, 0.0f};
+    light.right = cross(light.forward, worldUp).normalized();
+    light.up = cross(light.right, light.forward);
+
+    m_light = light;
+}
+
+void PreviewPass::drawInstances(Shader& shader, Mesh& mesh, int kind, size_t firstInstance, size_t count) {
+    if (count == 0) return;
+
+    const GLsizei stride = sizeof(PreviewInstance);
+    const size_t base = firstInstance * sizeof(PreviewInstance);
+
+    glBindVertexArray(mesh.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    for (int i = 0; i < 5; ++i) {
+        GLuint location = 2 + i;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + i * 4 * sizeof(float)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+
+    shader.setInt("u_kind", kind);
+    glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, static_cast<GLsizei>(count));
+    m_drawCalls++;
+}
+
+void PreviewPass::setCameraUniforms(Shader& shader, const Camera& camera, int width, int height) {
+    shader.setVec3("u_cameraPos", camera.getPosition());
+    shader.setVec3("u_cameraDir", camera.getDirection());
+    shader.setVec3("u_cameraUp", camera.getUp());
+    shader.setVec3("u_cameraRight", camera.getRight());
+    shader.setFloat("u_fov", camera.getFov());
+    shader.setVec2("u_resolution", Vec2{static_cast<float>(width), static_cast<float>(height)});
+    shader.setFloat("u_near", NEAR_PLANE);
+    shader.setFloat("u_far", FAR_PLANE);
+}
+
+void PreviewPass::setLightUniforms(Shader& shader) {
+    shader.setVec3("u_lightPos", m_light.position);
+    shader.setVec3("u_lightForward", m_light.forward);
+    shader.setVec3("u_lightRight", m_light.right);
+    shader.setVec3("u_lightUp", m_light.up);
+    shader.setVec3("u_lightColor", m_light.color);
+    shader.setFloat("u_lightRadius", m_light.radius);
+    shader.setFloat("u_lightTanHalfFov", m_light.tanHalfFov);
+    shader.setFloat("u_lightHalfExtent", m_light.halfExtent);
+    shader.setFloat("u_lightNear", m_light.nearPlane);
+    shader.setFloat("u_lightFar", m_light.farPlane);
+    shader.setInt("u_lightDirectional", m_light.directional ? 1 : 0);
+}
+
+void PreviewPass::renderShadowMap(size_t sphereCount, size_t cubeCount) {
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_shadowFramebuffer);
+    glViewport(0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    m_shadowShader->use();
+    m_shadowShader->setInt("u_shadowPass", 1);
+    setLightUniforms(*m_shadowShader);
+    drawInstances(*m_shadowShader, m_sphereMesh, static_cast<int>(ObjectType::Sphere), 0, sphereCount);
+    drawInstances(*m_shadowShader, m_cubeMesh, static_cast<int>(ObjectType::Cube), sphereCount, cubeCount);
+    m_shadowShader->unuse();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void PreviewPass::renderBackground(const Camera& camera, int width, int height) {
+    if (!m_shader) return;
+
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_BLEND);
+
+    m_shader->use();
+    setCameraUniforms(*m_shader, camera, width, height);
+    m_shader->setInt("u_kind", KIND_SKY);
+
+    glBindVertexArray(m_skyMesh.vao);
+    glDrawElements(GL_TRIANGLES, m_skyMesh.indexCount, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+
+    m_shader->unuse();
+
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void PreviewPass::render(const std::vector<PreviewInstance>& spheres,
+                         const std::vector<PreviewInstance>& cubes,
+                         const std::vector<PreviewInstance>& planes,
+                         const Camera& camera, int width, int height) {
+    m_drawCalls = 0;
+    if (!m_shader) return;
+
+    uploadInstances(spheres, cubes, planes);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+
+    if (m_shadowDirty) {
+        updateLight(spheres, cubes);
+        if (m_shadowShader) {
+            renderShadowMap(spheres.size(), cubes.size());
+        }
+        m_shadowDirty = false;
+    }
+
+    m_shader->use();
+    m_shader->setInt("u_shadowPass", 0);
+    setCameraUniforms(*m_shader, camera, width, height);
+    setLightUniforms(*m_shader);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_shadowMap);
+    m_shader->setInt("u_shadowMap", 0);
+
+    size_t sphereCount = spheres.size();
+    size_t cubeCount = cubes.size();
+    drawInstances(*m_shader, m_sphereMesh, static_cast<int>(ObjectType::Sphere), 0, sphereCount);
+    drawInstances(*m_shader, m_cubeMesh, static_cast<int>(ObjectType::Cube), sphereCount, cubeCount);
+    drawInstances(*m_shader, m_planeMesh, static_cast<int>(ObjectType::Plane), sphereCount + cubeCount, planes.size());
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_shader->unuse();
+
+    glEnable(GL_BLEND);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Shader.h"
+#include "math/Vec3.h"
+#include <memory>
+#include <vector>
+
+class Camera;
+
+// Per-object data for the preview rasterizer. Layout matches the instance
+// attributes in preview.vert (five vec4s).
+struct PreviewInstance {
+    float center[3];
+    float roughness;
+    float size[3];      // Sphere: radius in x; Cube: edge lengths
+    float metalness;
+    float normal[3];    // Planes only
+    float materialType;
+    float color[3];
+    float objectId;
+    float emission[3];
+    float padding;
+};
+
+// Fast rasterized view of the scene for layout work: instanced meshes with
+// a GGX shader, one shadow map and ambient from the path tracer's sky model.
+class PreviewPass {
+public:
+    PreviewPass();
+    ~PreviewPass();
+
+    bool isValid() const { return m_shader != nullptr; }
+    void reloadShaders();
+
+    // Sky background; drawn first so the grid can go on top of it
+    void renderBackground(const Camera& camera, int width, int height);
+
+    // Draws the instances into the currently bound framebuffer
+    void render(const std::vector<PreviewInstance>& spheres,
+                const std::vector<PreviewInstance>& cubes,
+                const std::vector<PreviewInstance>& planes,
+                const Camera& camera, int width, int height);
+
+    int getDrawCalls() const { return m_drawCalls; }
+
+    static constexpr int SHADOW_MAP_SIZE = 2048;
+    static constexpr float NEAR_PLANE = 0.05f;
+    static constexpr float FAR_PLANE = 1000.0f;
+
+private:
+    struct Mesh {
+        unsigned int vao = 0, vbo = 0, ibo = 0;
+        int indexCount = 0;
+    };
+
+    // Shadow-casting light: the brightest emissive object, or the sun
+    struct Light {
+        Vec3 position;
+        Vec3 forward;
+        Vec3 right;
+        Vec3 up;
+        Vec3 color;
+        float radius = 0.0f;        // Emitter size, 0 for the sun
+        float tanHalfFov = 1.0f;    // Perspective shadow frustum
+        float halfExtent = 10.0f;   // Orthographic shadow frustum
+        float nearPlane = 0.05f;
+        float farPlane = 100.0f;
+        bool directional = true;
+    };
+
+    void createMeshes();
+    void createMesh(Mesh& mesh, const std::vector<float>& vertices, const std::vector<unsigned int>& indices);
+    void deleteMesh(Mesh& mesh);
+    void createShadowMap();
+
+    void uploadInstances(const std::vector<PreviewInstance>& spheres,
+                         const std::vector<PreviewInstance>& cubes,
+                         const std::vector<PreviewInstance>& planes);
+    void updateLight(const std::vector<PreviewInstance>& spheres,
+                     const std::vector<PreviewInstance>& cubes);
+    void renderShadowMap(size_t sphereCount, size_t cubeCount);
+    void drawInstances(Shader& shader, Mesh& mesh, int kind, size_t firstInstance, size_t count);
+    void setCameraUniforms(Shader& shader, const Camera& camera, int width, int height);
+    void setLightUniforms(Shader& shader);
+
+    std::shared_ptr<Shader> m_shader;
+    std::shared_ptr<Shader> m_shadowShader;
+
+    Mesh m_sphereMesh;
+    Mesh m_cubeMesh;
+    Mesh m_planeMesh;
+    Mesh m_skyMesh;
+
+    unsigned int m_instanceVBO = 0;
+    size_t m_instanceCapacity = 0;
+    std::vector<PreviewInstance> m_instances;
+
+    // Shadow map is only redrawn when the casters change
+    unsigned int m_shadowFramebuffer = 0;
+    unsigned int m_shadowMap = 0;
+    std::vector<PreviewInstance> m_shadowCasters;
+    bool m_shadowDirty = true;
+
+    Light m_light;
+    int m_drawCalls = 0;
+};
@@ -0,0 +1,121 @@
+#include "ProgressiveImage.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+ProgressiveImage::~ProgressiveImage() {
+    if (m_texture) glDeleteTextures(1, &m_texture);
+    if (m_readFramebuffer) glDeleteFramebuffers(1, &m_readFramebuffer);
+}
+
+void ProgressiveImage::reset(int width, int height, int tileSize, int nodeCount) {
+    m_width = std::max(width, 1);
+    m_height = std::max(height, 1);
+    m_tileSize = std::max(tileSize, 1);
+    m_tilesX = (m_width + m_tileSize - 1) / m_tileSize;
+    m_tilesY = (m_height + m_tileSize - 1) / m_tileSize;
+
+    size_t pixelCount = static_cast<size_t>(m_width) * m_height;
+    bool placed = m_accumulation.size() == pixelCount && m_nodeCount == nodeCount;
+    m_nodeCount = std::max(nodeCount, 1);
+    if (!placed) {
+        // Fresh pages, so the bands land on their nodes at first touch
+        m_accumulation = NumaBuffer<Vec3>{};
+        m_accumulation.reset(pixelCount);
+        for (int tileY = 0; tileY < m_tilesY && m_nodeCount > 1; ++tileY) {
+            int y0 = tileY * m_tileSize;
+            int y1 = std::min(y0 + m_tileSize, m_height);
+            m_accumulation.bindToNode(static_cast<size_t>(y0) * m_width, static_cast<size_t>(y1 - y0) * m_width,
+                                      getBandNode(tileY, m_tilesY, m_nodeCount));
+        }
+    } else {
+        m_accumulation.reset(pixelCount);
+    }
+    m_display.resize(pixelCount);
+    m_tileSamples.assign(m_tilesX * m_tilesY, 0);
+}
+
+void ProgressiveImage::getTileRect(int tile, int& x0, int& y0, int& x1, int& y1) const {
+    x0 = (tile % m_tilesX) * m_tileSize;
+    y0 = (tile / m_tilesX) * m_tileSize;
+    x1 = std::min(x0 + m_tileSize, m_width);
+    y1 = std::min(y0 + m_tileSize, m_height);
+}
+
+int ProgressiveImage::addTile(int tile, const Vec3* radiance, int stride) {
+    int x0, y0, x1, y1;
+    getTileRect(tile, x0, y0, x1, y1);
+
+    int samples = ++m_tileSamples[tile];
+    float invSamples = 1.0f / samples;
+
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            size_t pixel = static_cast<size_t>(y) * m_width + x;
+            m_accumulation[pixel] += radiance[(y - y0) * stride + (x - x0)];
+            m_display[pixel] = tonemap(m_accumulation[pixel] * invSamples);
+        }
+    }
+    m_displayDirty = true;
+    return samples;
+}
+
+void ProgressiveImage::restore(const Vec3* accumulation, const std::vector<int>& tileSamples) {
+    std::copy(accumulation, accumulation + m_accumulation.size(), m_accumulation.data());
+    m_tileSamples = tileSamples;
+
+    for (int tile = 0; tile < getTileCount(); ++tile) {
+        int x0, y0, x1, y1;
+        getTileRect(tile, x0, y0, x1, y1);
+        float invSamples = m_tileSamples[tile] > 0 ? 1.0f / m_tileSamples[tile] : 0.0f;
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                size_t pixel = static_cast<size_t>(y) * m_width + x;
+                m_display[pixel] = tonemap(m_accumulation[pixel] * invSamples);
+            }
+        }
+    }
+    m_displayDirty = true;
+}
+
+void ProgressiveImage::present(unsigned int targetFramebuffer, int targetWidth, int targetHeight) {
+    if (m_display.empty()) return;
+
+    if (!m_texture || m_width != m_textureWidth || m_height != m_textureHeight) {
+        if (!m_texture) glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        m_textureWidth = m_width;
+        m_textureHeight = m_height;
+        m_displayDirty = true;
+
+        if (!m_readFramebuffer) glGenFramebuffers(1, &m_readFramebuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFramebuffer);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+    }
+
+    if (m_displayDirty) {
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, m_display.data());
+        m_displayDirty = false;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFramebuffer);
+    glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, targetWidth, targetHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+}
+
+uint32_t ProgressiveImage::tonemap(const Vec3& hdr) {
+    auto channel = [](float c) {
+        c *= 0.8f;
+        c = std::clamp((c * (2.51f * c + 0.03f)) / (c * (2.43f * c + 0.59f) + 0.14f), 0.0f, 1.0f);
+        c = std::pow(c, 1.0f / 2.2f) * 0.95f;
+        return static_cast<uint32_t>(c * 255.0f + 0.5f);
+    };
+    return channel(hdr.x) | (channel(hdr.y) << 8) | (channel(hdr.z) << 16) | 0xFF000000u;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "math/Vec3.h"
+#include "utils/NumaBuffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// HDR accumulation of tiled sample passes plus the tonemapped 8-bit copy
+// shown on screen. Tiles collect samples independently, so passes may
+// arrive out of order. Not synchronized: owners guard it with their own
+// lock, and present() must run on the main thread.
+class ProgressiveImage {
+public:
+    ProgressiveImage() = default;
+    ~ProgressiveImage();
+    ProgressiveImage(const ProgressiveImage&) = delete;
+    ProgressiveImage& operator=(const ProgressiveImage&) = delete;
+
+    // With several NUMA nodes, the accumulation rows are split into one
+    // band of tile rows per node and each band's memory placed on its node
+    void reset(int width, int height, int tileSize, int nodeCount = 1);
+
+    // Adds one sample for every pixel of the tile; radiance holds its rows
+    // with the given stride. Returns the tile's sample count.
+    int addTile(int tile, const Vec3* radiance, int stride);
+
+    // Radiance sums and per-tile sample counts, for checkpoints. restore
+    // takes both for an image of the current size.
+    const Vec3* getAccumulation() const { return m_accumulation.data(); }
+    const std::vector<int>& getTileSamples() const { return m_tileSamples; }
+    void restore(const Vec3* accumulation, const std::vector<int>& tileSamples);
+
+    // Uploads what changed and blits the image over the target framebuffer
+    void present(unsigned int targetFramebuffer, int targetWidth, int targetHeight);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getTilesX() const { return m_tilesX; }
+    int getTileCount() const { return static_cast<int>(m_tileSamples.size()); }
+    void getTileRect(int tile, int& x0, int& y0, int& x1, int& y1) const;
+    // Node whose memory holds the tile's accumulation
+    int getTileNode(int tile) const { return getBandNode(tile / m_tilesX, m_tilesY, m_nodeCount); }
+    static int getBandNode(int tileY, int tilesY, int nodeCount) { return tileY * nodeCount / std::max(tilesY, 1); }
+
+    // Same ACES curve, exposure and gamma as pathtracer.frag
+    static uint32_t tonemap(const Vec3& hdr);
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    int m_tileSize = 1;
+    int m_tilesX = 0;
+    int m_tilesY = 0;
+    int m_nodeCount = 1;
+
+    NumaBuffer<Vec3> m_accumulation;
+    std::vector<int> m_tileSamples;
+    std::vector<uint32_t> m_display;
+    bool m_displayDirty = false;
+
+    // GL objects
+    unsigned int m_texture = 0;
+    unsigned int m_readFramebuffer = 0;
+    int m_textureWidth = 0;
+    int m_textureHeight = 0;
+};
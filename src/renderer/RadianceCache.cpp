@@ -0,0 +1,170 @@
+#include "RadianceCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr int COORDINATE_BITS = 20;
+    constexpr int64_t COORDINATE_BIAS = int64_t{1} << (COORDINATE_BITS - 1);
+    constexpr uint64_t COORDINATE_MASK = (uint64_t{1} << COORDINATE_BITS) - 1;
+    constexpr uint64_t VALID_BIT = uint64_t{1} << 63;
+
+    uint64_t quantize(float coordinate, float cellSize) {
+        int64_t cell = static_cast<int64_t>(std::floor(coordinate / cellSize)) + COORDINATE_BIAS;
+        return static_cast<uint64_t>(std::clamp<int64_t>(cell, 0, COORDINATE_MASK));
+    }
+
+    // Dominant axis and its sign
+    uint64_t quantizeNormal(const Vec3& n) {
+        float ax = std::abs(n.x), ay = std::abs(n.y), az = std::abs(n.z);
+        if (ax >= ay && ax >= az) return n.x >= 0.0f ? 0 : 1;
+        if (ay >= az) return n.y >= 0.0f ? 2 : 3;
+        return n.z >= 0.0f ? 4 : 5;
+    }
+
+    uint64_t cellKey(const Vec3& position, const Vec3& normal, float cellSize) {
+        return quantize(position.x, cellSize) |
+               (quantize(position.y, cellSize) << COORDINATE_BITS) |
+               (quantize(position.z, cellSize) << (2 * COORDINATE_BITS)) |
+               (quantizeNormal(normal) << (3 * COORDINATE_BITS)) | VALID_BIT;
+    }
+
+    // Lower corner of the cell a key names
+    Vec3 cellOrigin(uint64_t key, float cellSize) {
+        auto axis = [&](int shift) {
+            int64_t cell = static_cast<int64_t>((key >> shift) & COORDINATE_MASK) - COORDINATE_BIAS;
+            return static_cast<float>(cell) * cellSize;
+        };
+        return Vec3{axis(0), axis(COORDINATE_BITS), axis(2 * COORDINATE_BITS)};
+    }
+}
+
+size_t RadianceCache::slotFor(uint64_t key) {
+    // 64-bit finalizer from MurmurHash3
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return static_cast<size_t>(key) & (CAPACITY - 1);
+}
+
+bool RadianceCache::Grid::lookup(const Vec3& position, const Vec3& normal, Vec3& radiance) const {
+    uint64_t key = cellKey(position, normal, m_cellSize);
+    size_t slot = slotFor(key);
+
+    // The whole window is searched: invalidation leaves holes in it
+    for (int probe = 0; probe < PROBE_LENGTH; ++probe) {
+        const Cell& cell = m_cells[(slot + probe) & (CAPACITY - 1)];
+        if (cell.key == key) {
+            if (cell.sampleCount < MIN_SAMPLES) return false;
+            radiance = cell.radiance;
+            return true;
+        }
+    }
+    return false;
+}
+
+RadianceCache::RadianceCache(float cellSize) {
+    m_grid = std::make_shared<Grid>();
+    m_grid->m_cellSize = cellSize;
+    m_grid->m_cells.resize(CAPACITY);
+    m_published = std::make_shared<Grid>(*m_grid);
+}
+
+std::shared_ptr<const RadianceCache::Grid> RadianceCache::getGrid() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_published;
+}
+
+uint64_t RadianceCache::Grid::makeKey(const Vec3& position, const Vec3& normal) const {
+    return cellKey(position, normal, m_cellSize);
+}
+
+void RadianceCache::addSamples(const std::vector<Sample>& samples) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.insert(m_pending.end(), samples.begin(), samples.end());
+}
+
+void RadianceCache::publish() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_pass;
+
+    // Samples of one cell are averaged first, then blended in at once
+    std::sort(m_pending.begin(), m_pending.end(),
+              [](const Sample& a, const Sample& b) { return a.key < b.key; });
+
+    Grid& grid = *m_grid;
+    for (size_t begin = 0; begin < m_pending.size();) {
+        uint64_t key = m_pending[begin].key;
+        Vec3 sum{0.0f};
+        size_t end = begin;
+        for (; end < m_pending.size() && m_pending[end].key == key; ++end) {
+            sum += m_pending[end].radiance;
+        }
+        float count = static_cast<float>(end - begin);
+        begin = end;
+
+        // Find the cell, or take an empty one or the stalest in the probe window
+        size_t slot = slotFor(key);
+        Cell* target = nullptr;
+        for (int probe = 0; probe < PROBE_LENGTH; ++probe) {
+            Cell& cell = grid.m_cells[(slot + probe) & (CAPACITY - 1)];
+            if (cell.key == key) {
+                target = &cell;
+                break;
+            }
+            if (!target || (target->key != 0 && (cell.key == 0 || cell.lastUpdate < target->lastUpdate))) {
+                target = &cell;
+            }
+        }
+
+        if (target->key != key) {
+            if (target->key == 0) grid.m_cellCount++;
+            *target = Cell{};
+            target->key = key;
+        }
+
+        float history = std::min(target->sampleCount + count, MAX_HISTORY);
+        float weight = std::min(count / history, 1.0f);
+        target->radiance += (sum / count - target->radiance) * weight;
+        target->sampleCount = history;
+        target->lastUpdate = m_pass;
+    }
+    m_pending.clear();
+
+    m_published = std::make_shared<Grid>(grid);
+}
+
+void RadianceCache::invalidate(const std::vector<AABB>& bounds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Grid& grid = *m_grid;
+    float size = grid.m_cellSize;
+
+    for (Cell& cell : grid.m_cells) {
+        if (cell.key == 0) continue;
+
+        Vec3 lo = cellOrigin(cell.key, size);
+        Vec3 hi = lo + Vec3{size};
+        for (const AABB& box : bounds) {
+            if (hi.x >= box.min.x - INVALIDATION_MARGIN && lo.x <= box.max.x + INVALIDATION_MARGIN &&
+                hi.y >= box.min.y - INVALIDATION_MARGIN && lo.y <= box.max.y + INVALIDATION_MARGIN &&
+                hi.z >= box.min.z - INVALIDATION_MARGIN && lo.z <= box.max.z + INVALIDATION_MARGIN) {
+                cell = Cell{};
+                grid.m_cellCount--;
+                break;
+            }
+        }
+    }
+
+    m_pending.clear();
+    m_published = std::make_shared<Grid>(grid);
+}
+
+void RadianceCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::fill(m_grid->m_cells.begin(), m_grid->m_cells.end(), Cell{});
+    m_grid->m_cellCount = 0;
+    m_pending.clear();
+    m_published = std::make_shared<Grid>(*m_grid);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "math/AABB.h"
+#include "math/Vec3.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// World-space hash grid of outgoing radiance at diffuse surfaces, keyed by
+// quantized position and facing normal. A fraction of paths trace in full
+// and record the radiance they found at each diffuse vertex; the rest stop
+// at their first diffuse hit after the camera bounce and read the cell
+// instead. Samples are blended into the cells once per pass with a capped
+// history, so the cache follows lighting changes and outlives camera moves.
+//
+// Lookups go to an immutable grid published at the end of each pass, so
+// tracing threads never wait on updates.
+class RadianceCache {
+public:
+    struct Cell {
+        uint64_t key = 0;           // 0 when empty
+        Vec3 radiance{0.0f};
+        float sampleCount = 0.0f;
+        uint32_t lastUpdate = 0;    // Pass of the last blend, for eviction
+    };
+
+    class Grid {
+    public:
+        // Cells with too few samples are treated as missing
+        bool lookup(const Vec3& position, const Vec3& normal, Vec3& radiance) const;
+        uint64_t makeKey(const Vec3& position, const Vec3& normal) const;
+        int getCellCount() const { return m_cellCount; }
+
+    private:
+        friend class RadianceCache;
+
+        std::vector<Cell> m_cells;
+        float m_cellSize = 0.25f;
+        int m_cellCount = 0;
+    };
+
+    struct Sample {
+        uint64_t key = 0;
+        Vec3 radiance;
+    };
+
+    explicit RadianceCache(float cellSize = 0.25f);
+
+    std::shared_ptr<const Grid> getGrid() const;
+
+    // Thread-safe; takes effect at the next publish
+    void addSamples(const std::vector<Sample>& samples);
+    // Blends the samples added since the last call and publishes the result
+    void publish();
+
+    // Drops cells inside the boxes grown by a margin, or every cell
+    void invalidate(const std::vector<AABB>& bounds);
+    void clear();
+
+    static constexpr int CAPACITY = 1 << 17;
+    static constexpr int PROBE_LENGTH = 8;
+    static constexpr float MIN_SAMPLES = 8.0f;
+    // Samples remembered per cell; older ones fade out as new ones blend in
+    static constexpr float MAX_HISTORY = 64.0f;
+    // Distance around an edited object whose cells are dropped
+    static constexpr float INVALIDATION_MARGIN = 1.0f;
+
+private:
+    static size_t slotFor(uint64_t key);
+
+    mutable std::mutex m_mutex;
+
+    // Guarded by m_mutex
+    std::shared_ptr<Grid> m_grid;
+    std::shared_ptr<const Grid> m_published;
+    std::vector<Sample> m_pending;
+    uint32_t m_pass = 0;
+};
@@ -0,0 +1,162 @@
+#include "RenderCheckpoint.h"
+#include "core/Logger.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t viewHash;
+        int32_t width;
+        int32_t height;
+        int32_t tileSize;
+        uint32_t segmentCount;
+        uint32_t tileCount;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(Vec3) == 3 * sizeof(float), "radiance is stored as packed RGB floats");
+
+    template <typename T>
+    bool readArray(std::ifstream& file, std::vector<T>& values, size_t count) {
+        values.resize(count);
+        file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(count * sizeof(T)));
+        return static_cast<bool>(file);
+    }
+
+    template <typename T>
+    void writeArray(std::ofstream& file, const std::vector<T>& values) {
+        file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    int64_t tileCountFor(int64_t width, int64_t height, int64_t tileSize) {
+        if (width <= 0 || height <= 0 || tileSize <= 0) return -1;
+        return ((width + tileSize - 1) / tileSize) * ((height + tileSize - 1) / tileSize);
+    }
+
+    // Takes count elements of elementSize from remaining bytes; false if
+    // they do not fit
+    bool consume(uint64_t& remaining, uint64_t count, size_t elementSize) {
+        if (count > remaining / elementSize) return false;
+        remaining -= count * elementSize;
+        return true;
+    }
+
+    bool overlaps(const RenderCheckpoint::Segment& a, const RenderCheckpoint::Segment& b) {
+        return a.seed == b.seed && a.firstSample < b.firstSample + b.sampleCount &&
+               b.firstSample < a.firstSample + a.sampleCount;
+    }
+}
+
+uint32_t RenderCheckpoint::getNextSample(uint32_t seed) const {
+    uint32_t next = 0;
+    for (const Segment& segment : segments) {
+        if (segment.seed == seed) {
+            next = std::max(next, segment.firstSample + segment.sampleCount);
+        }
+    }
+    return next;
+}
+
+bool RenderCheckpoint::save(const std::string& path) const {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            LOG_ERROR("Cannot write checkpoint '{}'", temporary);
+            return false;
+        }
+
+        FileHeader header{MAGIC, VERSION, viewHash, width, height, tileSize,
+                          static_cast<uint32_t>(segments.size()), static_cast<uint32_t>(tileSamples.size()), 0};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeArray(file, segments);
+        writeArray(file, tileSamples);
+        writeArray(file, accumulation);
+        if (!file.flush()) {
+            LOG_ERROR("Failed writing checkpoint '{}'", temporary);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        LOG_ERROR("Cannot replace checkpoint '{}': {}", path, error.message());
+        return false;
+    }
+    return true;
+}
+
+bool RenderCheckpoint::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    FileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != MAGIC || header.version != VERSION ||
+        tileCountFor(header.width, header.height, header.tileSize) != header.tileCount) {
+        LOG_WARN("'{}' is not a checkpoint of this build", path);
+        return false;
+    }
+
+    // The counts must account for the file exactly before anything is
+    // sized by them, so a corrupt header cannot ask for a huge allocation
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(path, error);
+    uint64_t remaining = error ? 0 : fileSize - std::min<uint64_t>(fileSize, sizeof(header));
+    uint64_t pixelCount = static_cast<uint64_t>(header.width) * static_cast<uint64_t>(header.height);
+    if (error || !consume(remaining, header.segmentCount, sizeof(Segment)) ||
+        !consume(remaining, header.tileCount, sizeof(int)) || !consume(remaining, pixelCount, sizeof(Vec3)) ||
+        remaining != 0) {
+        LOG_WARN("Checkpoint '{}' is truncated or malformed", path);
+        return false;
+    }
+
+    RenderCheckpoint loaded;
+    loaded.viewHash = header.viewHash;
+    loaded.width = header.width;
+    loaded.height = header.height;
+    loaded.tileSize = header.tileSize;
+    if (!readArray(file, loaded.segments, header.segmentCount) ||
+        !readArray(file, loaded.tileSamples, header.tileCount) ||
+        !readArray(file, loaded.accumulation, pixelCount)) {
+        LOG_WARN("Checkpoint '{}' is truncated", path);
+        return false;
+    }
+
+    *this = std::move(loaded);
+    return true;
+}
+
+bool RenderCheckpoint::merge(const RenderCheckpoint& other) {
+    if (other.viewHash != viewHash || other.width != width || other.height != height ||
+        other.tileSize != tileSize || other.accumulation.size() != accumulation.size() ||
+        other.tileSamples.size() != tileSamples.size()) {
+        LOG_WARN("Checkpoints of different views cannot be merged");
+        return false;
+    }
+
+    // Repeated samples would count the same paths twice
+    for (const Segment& a : segments) {
+        for (const Segment& b : other.segments) {
+            if (overlaps(a, b)) {
+                LOG_WARN("Checkpoints share samples {}..{} of seed {}", std::max(a.firstSample, b.firstSample),
+                         std::min(a.firstSample + a.sampleCount, b.firstSample + b.sampleCount) - 1, a.seed);
+                return false;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < accumulation.size(); ++i) {
+        accumulation[i] += other.accumulation[i];
+    }
+    for (size_t i = 0; i < tileSamples.size(); ++i) {
+        tileSamples[i] += other.tileSamples[i];
+    }
+    segments.insert(segments.end(), other.segments.begin(), other.segments.end());
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "math/Vec3.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Saved state of a progressive CPU render: radiance sums, samples per tile
+// (every pixel of a tile has the same count) and which sample indices of
+// which random seeds went into them. Files are host byte order, like the
+// render protocol, so only builds of the same layout exchange them. The
+// path guide and radiance cache are not saved, so a resumed render follows
+// an uninterrupted one exactly only with both off; otherwise they are
+// learned again from the resumed samples on.
+struct RenderCheckpoint {
+    // Sample indices [firstSample, firstSample + sampleCount) drawn with seed
+    struct Segment {
+        uint32_t seed = 0;
+        uint32_t firstSample = 0;
+        uint32_t sampleCount = 0;
+    };
+
+    // Scene, camera, resolution and estimator settings, but not the seed,
+    // so independent runs of one view share it
+    uint64_t viewHash = 0;
+    int width = 0;
+    int height = 0;
+    int tileSize = 0;
+    std::vector<Segment> segments;
+    std::vector<int> tileSamples;
+    std::vector<Vec3> accumulation;
+
+    // Next sample index to draw with seed, past every segment using it
+    uint32_t getNextSample(uint32_t seed) const;
+
+    // Written to a temporary file and renamed over path, so a crash
+    // mid-write leaves the previous checkpoint intact
+    bool save(const std::string& path) const;
+    // False, leaving this unchanged, when the file is missing or malformed
+    bool load(const std::string& path);
+
+    // Adds other's samples to these. Fails unless both are of the same view
+    // and no sample index of a seed was drawn by both.
+    bool merge(const RenderCheckpoint& other);
+
+    static constexpr uint32_t MAGIC = 0x4B434752;   // "RGCK"
+    static constexpr uint32_t VERSION = 2;
+};
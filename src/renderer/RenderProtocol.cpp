@@ -0,0 +1,29 @@
+#include "RenderProtocol.h"
+
+#include <cstring>
+
+namespace RenderProtocol {
+    bool send(Socket& socket, MessageType type, const void* payload, size_t size,
+              const void* extra, size_t extraSize) {
+        if (size + extraSize > MAX_PAYLOAD) return false;
+
+        // One buffer keeps the message in a single write for small messages
+        std::vector<uint8_t> buffer(sizeof(MessageHeader) + size + extraSize);
+        MessageHeader header{type, static_cast<uint32_t>(size + extraSize)};
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        if (size) std::memcpy(buffer.data() + sizeof(header), payload, size);
+        if (extraSize) std::memcpy(buffer.data() + sizeof(header) + size, extra, extraSize);
+
+        return socket.sendAll(buffer.data(), buffer.size());
+    }
+
+    bool receive(Socket& socket, MessageType& type, std::vector<uint8_t>& payload) {
+        MessageHeader header{};
+        if (!socket.receiveAll(&header, sizeof(header))) return false;
+        if (header.size > MAX_PAYLOAD) return false;
+
+        type = header.type;
+        payload.resize(header.size);
+        return header.size == 0 || socket.receiveAll(payload.data(), header.size);
+    }
+}
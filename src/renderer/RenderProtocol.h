@@ -0,0 +1,61 @@
+#pragma once
+
+#include "utils/Socket.h"
+#include <cstdint>
+#include <vector>
+
+// Messages between the distributed renderer and its worker processes. Each
+// is a MessageHeader followed by size payload bytes. Fields are raw structs
+// in host byte order: coordinator and workers run the same build on one
+// machine.
+//
+//   worker -> coordinator   Hello, then TileResult per finished request
+//   coordinator -> worker   Frame when the image restarts, TileRequest
+namespace RenderProtocol {
+    constexpr uint32_t VERSION = 3;
+    constexpr uint16_t DEFAULT_PORT = 47300;
+    constexpr uint32_t MAX_PAYLOAD = 256u << 20;
+
+    enum class MessageType : uint32_t {
+        Hello = 1,
+        Frame,
+        TileRequest,
+        TileResult
+    };
+
+    struct MessageHeader {
+        MessageType type;
+        uint32_t size;
+    };
+
+    struct Hello {
+        uint32_t version = VERSION;
+        uint32_t threadCount = 0;
+    };
+
+    // Followed by CpuPathTracer::View and the CompiledScene::serialize bytes
+    struct FrameHeader {
+        uint64_t generation = 0;
+    };
+
+    struct TileRequest {
+        uint64_t generation = 0;
+        int64_t item = 0;
+        int32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+        uint32_t sampleIndex = 0;
+        uint32_t reserved = 0;
+    };
+
+    // Followed by width * height RGB radiance floats, row by row
+    struct TileResult {
+        uint64_t generation = 0;
+        int64_t item = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+    };
+
+    // Sends the header and both payload parts as one message
+    bool send(Socket& socket, MessageType type, const void* payload, size_t size,
+              const void* extra = nullptr, size_t extraSize = 0);
+    bool receive(Socket& socket, MessageType& type, std::vector<uint8_t>& payload);
+}
@@ -0,0 +1,164 @@
+#include "RenderWorker.h"
+#include "CpuPathTracer.h"
+#include "RenderProtocol.h"
+#include "core/CpuFeatures.h"
+#include "core/JobSystem.h"
+#include "core/Logger.h"
+#include "core/NodeReplicas.h"
+#include "scene/CompiledScene.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct Frame {
+        CpuPathTracer::View view;
+        CompiledScene scene;
+        // Tiles trace the copy on their own NUMA node
+        NodeReplicas<CompiledScene> sceneReplicas{scene};
+        uint64_t generation = 0;
+    };
+
+    // State of one coordinator connection, shared with its tile jobs
+    struct Session {
+        Socket socket;
+        std::mutex sendMutex;
+        std::atomic<bool> closed{false};
+        std::atomic<uint64_t> generation{0};
+        JobCounter jobs;
+        int64_t tilesTraced = 0;
+    };
+
+    std::shared_ptr<Frame> readFrame(const std::vector<uint8_t>& payload) {
+        using RenderProtocol::FrameHeader;
+        constexpr size_t prefix = sizeof(FrameHeader) + sizeof(CpuPathTracer::View);
+        if (payload.size() < prefix) return nullptr;
+
+        auto frame = std::make_shared<Frame>();
+        FrameHeader header;
+        std::memcpy(&header, payload.data(), sizeof(header));
+        std::memcpy(&frame->view, payload.data() + sizeof(header), sizeof(frame->view));
+        frame->generation = header.generation;
+
+        const CpuPathTracer::View& view = frame->view;
+        if (view.width <= 0 || view.height <= 0 || view.maxBounces < 0) return nullptr;
+        if (!frame->scene.deserialize(payload.data() + prefix, payload.size() - prefix)) return nullptr;
+        return frame;
+    }
+
+    bool validRequest(const Frame& frame, const RenderProtocol::TileRequest& request) {
+        return request.generation == frame.generation &&
+               request.x0 >= 0 && request.y0 >= 0 &&
+               request.x0 < request.x1 && request.y0 < request.y1 &&
+               request.x1 <= frame.view.width && request.y1 <= frame.view.height;
+    }
+
+    void traceTile(Session& session, std::shared_ptr<const Frame> frame, RenderProtocol::TileRequest request) {
+        // Requests of a replaced frame are skipped; the coordinator has discarded them
+        if (session.closed.load() || session.generation.load() != request.generation) return;
+
+        int width = request.x1 - request.x0;
+        int height = request.y1 - request.y0;
+        std::vector<Vec3> radiance(static_cast<size_t>(width) * height);
+        CpuPathTracer::traceRect(frame->view, frame->sceneReplicas.get(), CpuFeatures::getSimdLevel(),
+                                 request.x0, request.y0, request.x1, request.y1,
+                                 request.sampleIndex, radiance.data(), width);
+
+        RenderProtocol::TileResult result;
+        result.generation = request.generation;
+        result.item = request.item;
+        result.width = width;
+        result.height = height;
+
+        static_assert(sizeof(Vec3) == 3 * sizeof(float), "tiles are sent as packed RGB floats");
+        std::lock_guard<std::mutex> lock(session.sendMutex);
+        if (session.closed.load()) return;
+        if (!RenderProtocol::send(session.socket, RenderProtocol::MessageType::TileResult, &result, sizeof(result),
+                                  radiance.data(), radiance.size() * sizeof(Vec3))) {
+            session.closed = true;
+            session.socket.shutdown();
+            return;
+        }
+        ++session.tilesTraced;
+    }
+
+    void serve(Session& session) {
+        RenderProtocol::Hello hello;
+        hello.threadCount = static_cast<uint32_t>(JobSystem::getWorkerCount());
+        {
+            std::lock_guard<std::mutex> lock(session.sendMutex);
+            if (!RenderProtocol::send(session.socket, RenderProtocol::MessageType::Hello, &hello, sizeof(hello))) {
+                return;
+            }
+        }
+
+        std::shared_ptr<const Frame> frame;
+        RenderProtocol::MessageType type;
+        std::vector<uint8_t> payload;
+
+        while (!session.closed.load() && RenderProtocol::receive(session.socket, type, payload)) {
+            if (type == RenderProtocol::MessageType::Frame) {
+                auto next = readFrame(payload);
+                if (!next) {
+                    LOG_ERROR("Render worker received a malformed frame");
+                    break;
+                }
+                session.generation = next->generation;
+                frame = std::move(next);
+                LOG_DEBUG("Render worker frame {}: {}x{}", frame->generation, frame->view.width, frame->view.height);
+            } else if (type == RenderProtocol::MessageType::TileRequest) {
+                RenderProtocol::TileRequest request;
+                if (!frame || payload.size() != sizeof(request)) break;
+                std::memcpy(&request, payload.data(), sizeof(request));
+
+                if (!validRequest(*frame, request)) {
+                    LOG_WARN("Render worker dropped an invalid tile request");
+                    continue;
+                }
+                JobSystem::run([&session, frame, request] { traceTile(session, frame, request); }, &session.jobs);
+            } else {
+                LOG_ERROR("Render worker received unexpected message {}", static_cast<uint32_t>(type));
+                break;
+            }
+        }
+
+        session.closed = true;
+        session.socket.shutdown();
+        JobSystem::wait(session.jobs);
+    }
+}
+
+int RenderWorker::run(const std::string& address, uint16_t port, int threadCount) {
+    // The main thread only talks to the socket, so every core traces
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    JobSystem::init(threadCount);
+
+    Socket listener = Socket::listen(address, port);
+    if (!listener.isValid()) {
+        JobSystem::shutdown();
+        return -1;
+    }
+    LOG_INFO("Render worker listening on {}:{} with {} threads", address, listener.getLocalPort(),
+             JobSystem::getWorkerCount());
+
+    while (true) {
+        Session session;
+        session.socket = listener.accept();
+        if (!session.socket.isValid()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        LOG_INFO("Render worker: coordinator connected");
+        serve(session);
+        LOG_INFO("Render worker: coordinator disconnected after {} tiles", session.tilesTraced);
+    }
+}
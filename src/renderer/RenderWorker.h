@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Headless render-worker mode of the executable (--render-worker). Serves
+// one coordinator at a time: it receives the compiled scene and camera,
+// traces the tiles it is asked for as JobSystem jobs with the CPU path
+// tracer, and streams the float tiles back as they finish.
+class RenderWorker {
+public:
+    // Traces on threadCount threads, one per hardware thread when 0. Runs
+    // until listening fails; returns the process exit code.
+    static int run(const std::string& address, uint16_t port, int threadCount = 0);
+};
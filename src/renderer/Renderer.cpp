@@ -1,16 +1,41 @@
 #include "Renderer.h"
+#include "Framebuffer.h"
+#include "GBufferPass.h"
+#include "PreviewPass.h"
+#include "CpuPathTracer.h"
+#include "HybridRenderer.h"
+#include "DistributedRenderer.h"
+#include "RenderProtocol.h"
+#include "RenderCheckpoint.h"
 #include "scene/Scene.h"
 #include "scene/Camera.h"
 #include "scene/Object.h"
 #include "core/Logger.h"
 #include "core/Time.h"
 #include "utils/ResourceManager.h"
+#include "utils/Random.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <filesystem>
 #include <vector>
 #include <sstream>
 
+namespace {
+    // Radical inverse of index in base: a low-discrepancy sequence in [0, 1)
+    float halton(uint32_t index, uint32_t base) {
+        float result = 0.0f;
+        float scale = 1.0f;
+        while (index > 0) {
+            scale /= static_cast<float>(base);
+            result += scale * static_cast<float>(index % base);
+            index /= base;
+        }
+        return result;
+    }
+}
+
 Renderer::Renderer() {
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_MULTISAMPLE);
@@ -19,6 +44,7 @@ Renderer::Renderer() {
     
     createQuad();
     createGrid();
+    createTimerQueries();
     
     m_pathTracerShader = ResourceManager::instance().loadShader(
         "pathtracer", "shaders/pathtracer.vert", "shaders/pathtracer.frag");
@@ -28,12 +54,12 @@ Renderer::Renderer() {
         m_pathTracerShader = nullptr;
     }
     
-    m_wireframeShader = ResourceManager::instance().loadShader(
-        "wireframe", "shaders/wireframe.vert", "shaders/wireframe.frag");
+    m_outlineShader = ResourceManager::instance().loadShader(
+        "outline", "shaders/outline.vert", "shaders/outline.frag");
     
-    if (!m_wireframeShader || !m_wireframeShader->isValid()) {
-        LOG_WARN("Wireframe shader failed to load - selection outlines disabled");
-        m_wireframeShader = nullptr;
+    if (!m_outlineShader || !m_outlineShader->isValid()) {
+        LOG_WARN("Outline shader failed to load - selection outlines disabled");
+        m_outlineShader = nullptr;
     }
     
     m_gridShader = ResourceManager::instance().loadShader(
@@ -44,6 +70,17 @@ Renderer::Renderer() {
         m_gridShader = nullptr;
     }
     
+    m_upscaleShader = ResourceManager::instance().loadShader(
+        "upscale", "shaders/upscale.vert", "shaders/upscale.frag");
+        
+    if (!m_upscaleShader || !m_upscaleShader->isValid()) {
+        LOG_WARN("Upscale shader failed to load - rendering at full resolution only");
+        m_upscaleShader = nullptr;
+    }
+    
+    m_gbufferPass = std::make_unique<GBufferPass>();
+    m_previewPass = std::make_unique<PreviewPass>();
+    
     LOG_INFO("Renderer initialized");
 }
 
@@ -57,6 +94,12 @@ Renderer::~Renderer() {
         glDeleteBuffers(1, &m_gridVBO);
         glDeleteBuffers(1, &m_gridIBO);
     }
+    if (m_timerQueries[0]) {
+        glDeleteQueries(TIMER_QUERY_COUNT, m_timerQueries);
+    }
+    if (m_selectionMask) {
+        glDeleteTextures(1, &m_selectionMask);
+    }
 }
 
 void Renderer::createQuad() {
@@ -125,6 +168,10 @@ void Renderer::createGrid() {
     glBindVertexArray(0);
 }
 
+void Renderer::createTimerQueries() {
+    glGenQueries(TIMER_QUERY_COUNT, m_timerQueries);
+}
+
 void Renderer::clear() {
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -132,52 +179,372 @@ void Renderer::clear() {
 }
 
 void Renderer::render(const Scene& scene, const Camera& camera) {
+    // Every path below draws this frame's ids, and with them the pick
+    if (m_pickRequested) {
+        std::span<const ObjectHandle> handles = scene.getHandles();
+        m_pickHandles.assign(handles.begin(), handles.end());
+    }
+    
+    if (m_renderMode == RenderMode::Preview && m_previewPass && m_previewPass->isValid()) {
+        renderPreview(scene, camera);
+        updateStats();
+        return;
+    }
+    
+    // The hybrid's GPU share sees at most the shader's primitives of each
+    // kind while its CPU share traces them all, so larger scenes would
+    // show two different scenes tile by tile; the CPU backend traces the
+    // whole scene instead
+    if (m_renderBackend == RenderBackend::Hybrid) {
+        const CompiledScene& compiled = scene.getCompiledScene();
+        size_t largest = std::max({compiled.getSpheres().size(), compiled.getPlanes().size(),
+                                   compiled.getBoxes().size()});
+        if (largest >= MAX_PRIMITIVES) {
+            LOG_WARN("Scene has over {} primitives of one kind, more than the GPU share of hybrid rendering "
+                     "can trace; switching to the CPU backend", MAX_PRIMITIVES - 1);
+            setRenderBackend(RenderBackend::Cpu);
+        }
+    }
+    
+    if ((m_renderBackend == RenderBackend::Cpu && m_cpuTracer) ||
+        (m_renderBackend == RenderBackend::Distributed && m_distributedRenderer)) {
+        renderCpu(scene, camera);
+        updateStats();
+        return;
+    }
+    
     if (!m_pathTracerShader || !m_pathTracerShader->isValid()) {
         LOG_ERROR("PathTracer shader is null or invalid - skipping render");
         return;
     }
     
+    if (m_renderBackend == RenderBackend::Hybrid && m_hybridRenderer && m_hybridRenderer->isValid()) {
+        renderHybrid(scene, camera);
+        updateStats();
+        return;
+    }
+    
     renderGrid(camera);
     
+    collectPassTimings();
+    
+    if (scene.getObjectCount() > 0) {
+        gatherSceneData(scene);
+    } else {
+        LOG_WARN("Scene has no objects - rendering empty scene");
+        m_sphereData.clear();
+        m_planeData.clear();
+        m_cubeData.clear();
+    }
+    
     Vec2 viewportSize = m_viewportSize;
+    int viewportWidth = static_cast<int>(m_viewportSize.x);
+    int viewportHeight = static_cast<int>(m_viewportSize.y);
+    
+    // Passes render into their own targets and finish in whatever
+    // framebuffer the caller has bound
+    GLint targetFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+    
+    // Rasterized first hits at full resolution, needed for hybrid tracing and
+    // for object ids; also guides the upscaler
+    bool gbufferAvailable = m_gbufferPass && m_gbufferPass->isValid();
+    bool rasterPrimary = m_rasterPrimary && gbufferAvailable;
+    bool gbuffer = gbufferAvailable && (rasterPrimary || needsObjectIds());
+    if (gbuffer) {
+        // Paths starting at the G-buffer only sample the points it was
+        // rasterized through, so move them around the pixel frame by frame
+        // to keep accumulation anti-aliased
+        m_gbufferJitter = Vec2{0.0f, 0.0f};
+        if (rasterPrimary) {
+            ++m_gbufferFrame;
+            m_gbufferJitter = Vec2{halton(m_gbufferFrame, 2) - 0.5f, halton(m_gbufferFrame, 3) - 0.5f};
+        }
+        buildGBufferInstances();
+        renderGBuffer(camera, viewportWidth, viewportHeight, static_cast<unsigned int>(targetFramebuffer),
+                      m_gbufferJitter);
+        setUpscaleGuide(m_gbufferPass->getNormalDepthTexture(), viewportWidth, viewportHeight);
+    } else {
+        setUpscaleGuide(0, 0, 0);
+    }
+    
+    // Trace into the low-resolution target and upscale into the caller's target
+    bool upscaling = m_renderScale < 0.999f && m_upscaleShader;
+    if (upscaling) {
+        int traceWidth = std::max(1, static_cast<int>(m_viewportSize.x * m_renderScale));
+        int traceHeight = std::max(1, static_cast<int>(m_viewportSize.y * m_renderScale));
+        if (!m_traceTarget) {
+            m_traceTarget = std::make_unique<Framebuffer>(traceWidth, traceHeight);
+        } else {
+            m_traceTarget->resize(traceWidth, traceHeight);
+        }
+        
+        m_traceTarget->bind();
+        glViewport(0, 0, traceWidth, traceHeight);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        viewportSize = Vec2{static_cast<float>(traceWidth), static_cast<float>(traceHeight)};
+    }
     
     m_pathTracerShader->use();
+    setPathTracerUniforms(camera, viewportSize);
+    
+    m_pathTracerShader->setInt("u_useGBuffer", rasterPrimary ? 1 : 0);
+    if (rasterPrimary) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_gbufferPass->getPositionTexture());
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_gbufferPass->getNormalDepthTexture());
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, m_gbufferPass->getIdTexture());
+        glActiveTexture(GL_TEXTURE0);
+        
+        m_pathTracerShader->setInt("u_gbufferPosition", 0);
+        m_pathTracerShader->setInt("u_gbufferNormal", 1);
+        m_pathTracerShader->setInt("u_gbufferIds", 2);
+        m_pathTracerShader->setVec2("u_gbufferSize", Vec2{static_cast<float>(viewportWidth),
+                                                          static_cast<float>(viewportHeight)});
+        m_pathTracerShader->setVec2("u_gbufferJitter", m_gbufferJitter);
+    }
+    
+    // Draw the fullscreen quad
+    bool timed = beginPassTimer();
+    glBindVertexArray(m_quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+    if (timed) endPassTimer();
+    
+    if (rasterPrimary) {
+        for (int unit = 2; unit >= 0; --unit) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+    }
+    
+    m_pathTracerShader->unuse();
+    m_drawCalls++;
     
-    Vec3 pos = camera.getPosition();
-    Vec3 dir = camera.getDirection();
-    Vec3 up = camera.getUp();
-    Vec3 right = camera.getRight();
+    if (upscaling) {
+        upscale(static_cast<unsigned int>(targetFramebuffer), viewportWidth, viewportHeight);
+    }
+    
+    if (gbuffer) {
+        renderOutlines();
+    }
+    
+    updateStats();
+}
+
+void Renderer::setRenderBackend(RenderBackend backend) {
+    // CPU tracing is only started once a backend that needs it is selected
+    if (backend == RenderBackend::Cpu && !m_cpuTracer) {
+        m_cpuTracer = std::make_unique<CpuPathTracer>();
+    }
+    if (backend == RenderBackend::Hybrid && !m_hybridRenderer) {
+        m_hybridRenderer = std::make_unique<HybridRenderer>();
+    }
+    if (backend == RenderBackend::Distributed && !m_distributedRenderer) {
+        std::vector<std::string> endpoints = m_renderWorkers;
+        if (endpoints.empty()) {
+            endpoints.push_back("127.0.0.1:" + std::to_string(RenderProtocol::DEFAULT_PORT));
+        }
+        m_distributedRenderer = std::make_unique<DistributedRenderer>(endpoints);
+    }
+    
+    // Both share the job system, so the one left behind must not keep it busy
+    if (backend != RenderBackend::Hybrid) {
+        m_hybridRenderer.reset();
+    }
+    if (backend != RenderBackend::Cpu) {
+        m_cpuTracer.reset();
+    }
+    // Its workers would keep tracing a frame nobody shows
+    if (backend != RenderBackend::Distributed) {
+        m_distributedRenderer.reset();
+    }
+    m_renderBackend = backend;
+}
 
-    m_pathTracerShader->setVec3("u_cameraPos", pos);
-    m_pathTracerShader->setVec3("u_cameraDir", dir);
-    m_pathTracerShader->setVec3("u_cameraUp", up);
-    m_pathTracerShader->setVec3("u_cameraRight", right);
+void Renderer::setCheckpoint(const std::string& path, float intervalSeconds) {
+    m_checkpointPath = path;
+    m_checkpointInterval = std::max(intervalSeconds, 1.0f);
+    m_lastCheckpointTime = Time::getTime();
+
+    m_resumeWarned = false;
+    m_resumeCheckpoint.reset();
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) return;
+
+    m_resumeCheckpoint = std::make_unique<RenderCheckpoint>();
+    if (!m_resumeCheckpoint->load(path)) {
+        LOG_ERROR("Checkpoint '{}' cannot be read; not saving over it", path);
+        m_resumeCheckpoint.reset();
+        m_checkpointPath.clear();
+    }
+}
+
+void Renderer::updateCheckpoint() {
+    if (m_checkpointPath.empty()) return;
+
+    // Tried on every frame until one of its view comes up, e.g. once a
+    // scene has loaded; saving waits too, so other views never replace it
+    if (m_resumeCheckpoint) {
+        if (!m_cpuTracer->resume(*m_resumeCheckpoint)) {
+            if (!m_resumeWarned) {
+                LOG_WARN("Checkpoint '{}' is of another view or settings; it is kept, and resumed if that view "
+                         "comes up", m_checkpointPath);
+                m_resumeWarned = true;
+            }
+            return;
+        }
+        LOG_INFO("Resumed from checkpoint '{}'", m_checkpointPath);
+        m_resumeCheckpoint.reset();
+        m_lastCheckpointTime = Time::getTime();
+    }
+
+    if (Time::getTime() - m_lastCheckpointTime >= m_checkpointInterval) {
+        m_cpuTracer->saveCheckpoint(m_checkpointPath);
+        m_lastCheckpointTime = Time::getTime();
+    }
+}
+
+void Renderer::setPathTracerUniforms(const Camera& camera, const Vec2& resolution) {
+    m_pathTracerShader->setVec3("u_cameraPos", camera.getPosition());
+    m_pathTracerShader->setVec3("u_cameraDir", camera.getDirection());
+    m_pathTracerShader->setVec3("u_cameraUp", camera.getUp());
+    m_pathTracerShader->setVec3("u_cameraRight", camera.getRight());
     m_pathTracerShader->setFloat("u_fov", camera.getFov());
     
-    m_pathTracerShader->setVec2("u_resolution", viewportSize); 
-    m_pathTracerShader->setFloat("u_time", Time::getTime());
+    m_pathTracerShader->setVec2("u_resolution", resolution);
+    // Sample indices keep counting across frames so each frame draws fresh,
+    // reproducible streams
+    m_pathTracerShader->setUint("u_rngSeed", Random::getSeed());
+    m_pathTracerShader->setUint("u_sampleOffset", m_sampleIndex);
+    m_sampleIndex += static_cast<uint32_t>(m_samplesPerPixel);
     
     m_pathTracerShader->setInt("u_maxBounces", m_maxBounces);
     m_pathTracerShader->setInt("u_samplesPerPixel", m_samplesPerPixel);
     
-    if (!scene.getObjects().empty()) {
-        updateSceneDataForShader(scene);
+    uploadShaderData();
+}
+
+void Renderer::renderHybrid(const Scene& scene, const Camera& camera) {
+    renderGrid(camera);
+    
+    int width = static_cast<int>(m_viewportSize.x);
+    int height = static_cast<int>(m_viewportSize.y);
+    
+    GLint targetFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+    
+    // The GPU share needs the scene uniforms either way
+    gatherSceneData(scene);
+    bool gbuffer = needsObjectIds() && m_gbufferPass && m_gbufferPass->isValid();
+    if (gbuffer) {
+        buildGBufferInstances();
+        renderGBuffer(camera, width, height, static_cast<unsigned int>(targetFramebuffer));
+    }
+    
+    int traceWidth = std::max(1, static_cast<int>(m_viewportSize.x * m_renderScale));
+    int traceHeight = std::max(1, static_cast<int>(m_viewportSize.y * m_renderScale));
+    m_hybridRenderer->update(scene.getCompiledScene(), camera, m_maxBounces, traceWidth, traceHeight);
+    
+    m_pathTracerShader->use();
+    setPathTracerUniforms(camera, Vec2{static_cast<float>(traceWidth), static_cast<float>(traceHeight)});
+    m_hybridRenderer->render(*m_pathTracerShader, m_quadVAO, static_cast<unsigned int>(targetFramebuffer), width, height);
+    glViewport(0, 0, width, height);
+    m_drawCalls++;
+    
+    if (gbuffer) {
+        renderOutlines();
+    }
+}
+
+void Renderer::renderCpu(const Scene& scene, const Camera& camera) {
+    renderGrid(camera);
+    
+    int width = static_cast<int>(m_viewportSize.x);
+    int height = static_cast<int>(m_viewportSize.y);
+    
+    GLint targetFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+    
+    // Ids only, so from every object the tracer sees rather than the
+    // shader's share of them
+    bool gbuffer = needsObjectIds() && m_gbufferPass && m_gbufferPass->isValid();
+    if (gbuffer) {
+        gatherPreviewInstances(scene);
+        buildPreviewGBufferInstances();
+        renderGBuffer(camera, width, height, static_cast<unsigned int>(targetFramebuffer));
+    }
+    
+    // Render scale trades resolution for convergence speed; the blit filters
+    int traceWidth = std::max(1, static_cast<int>(m_viewportSize.x * m_renderScale));
+    int traceHeight = std::max(1, static_cast<int>(m_viewportSize.y * m_renderScale));
+    if (m_cpuTracer) {
+        m_cpuTracer->setRadianceCacheEnabled(m_radianceCache);
+        m_cpuTracer->setCausticsEnabled(m_caustics);
+        m_cpuTracer->setPathGuidingEnabled(m_pathGuiding);
+        m_cpuTracer->update(scene.getCompiledScene(), camera, m_maxBounces, traceWidth, traceHeight);
+        updateCheckpoint();
+        m_cpuTracer->present(static_cast<unsigned int>(targetFramebuffer), width, height);
     } else {
-        LOG_WARN("Scene has no objects - rendering empty scene");
-        m_pathTracerShader->setInt("u_numSpheres", 0);
-        m_pathTracerShader->setInt("u_numPlanes", 0);
-        m_pathTracerShader->setInt("u_numCubes", 0);
+        m_distributedRenderer->update(scene.getCompiledScene(), camera, m_maxBounces, traceWidth, traceHeight);
+        m_distributedRenderer->present(static_cast<unsigned int>(targetFramebuffer), width, height);
     }
+    glViewport(0, 0, width, height);
+    m_drawCalls++;
     
-    // Draw the fullscreen quad
+    if (gbuffer) {
+        renderOutlines();
+    }
+}
+
+void Renderer::setRenderScale(float scale) {
+    m_renderScale = std::clamp(scale, 0.25f, 1.0f);
+}
+
+void Renderer::setUpscaleGuide(unsigned int texture, int width, int height) {
+    m_upscaleGuide = texture;
+    m_upscaleGuideSize = Vec2{static_cast<float>(width), static_cast<float>(height)};
+}
+
+void Renderer::upscale(unsigned int targetFramebuffer, int targetWidth, int targetHeight) {
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glViewport(0, 0, targetWidth, targetHeight);
+    
+    m_upscaleShader->use();
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_traceTarget->getColorTexture());
+    m_upscaleShader->setInt("u_input", 0);
+    m_upscaleShader->setVec2("u_inputSize", Vec2{static_cast<float>(m_traceTarget->getWidth()),
+                                                  static_cast<float>(m_traceTarget->getHeight())});
+    m_upscaleShader->setVec2("u_outputSize", Vec2{static_cast<float>(targetWidth),
+                                                   static_cast<float>(targetHeight)});
+    m_upscaleShader->setFloat("u_sharpness", m_sharpness);
+    
+    bool useGuide = m_upscaleGuide != 0 && m_upscaleGuideSize.x > 0 && m_upscaleGuideSize.y > 0;
+    m_upscaleShader->setInt("u_useGuide", useGuide ? 1 : 0);
+    if (useGuide) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_upscaleGuide);
+        m_upscaleShader->setInt("u_guide", 1);
+        m_upscaleShader->setVec2("u_guideSize", m_upscaleGuideSize);
+    }
+    
+    glDisable(GL_DEPTH_TEST);
     glBindVertexArray(m_quadVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
     
-    m_pathTracerShader->unuse();
-    m_drawCalls++;
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
     
-    updateStats();
+    m_upscaleShader->unuse();
+    m_drawCalls++;
 }
 
 void Renderer::uploadShaderData() {
@@ -224,22 +591,226 @@ void Renderer::uploadShaderData() {
         m_pathTracerShader->setFloat(base + ".metalness", cube.metalness);
         m_pathTracerShader->setVec3(base + ".emission", cube.emission);
     }
+    
+    m_pathTracerShader->setInt("u_numSpheres", static_cast<int>(m_sphereData.size()));
+    m_pathTracerShader->setInt("u_numPlanes", static_cast<int>(m_planeData.size()));
+    m_pathTracerShader->setInt("u_numCubes", static_cast<int>(m_cubeData.size()));
+}
+
+namespace {
+    GBufferInstance makeGBufferInstance(const float center[3], const float size[3], const float normal[3],
+                                        ObjectType kind, int primitiveId, int objectId) {
+        GBufferInstance instance{};
+        std::copy(center, center + 3, instance.center);
+        std::copy(size, size + 3, instance.size);
+        std::copy(normal, normal + 3, instance.normal);
+        instance.kind = static_cast<float>(kind);
+        instance.primitiveId = static_cast<float>(primitiveId);
+        instance.objectId = static_cast<float>(objectId);
+        return instance;
+    }
+}
+
+void Renderer::buildGBufferInstances() {
+    // Primitive ids index the path tracer's uniform arrays: kind * MAX_PRIMITIVES + index
+    auto append = [](std::vector<GBufferInstance>& instances, const std::vector<IntersectionData>& data, ObjectType kind) {
+        for (size_t i = 0; i < data.size(); ++i) {
+            int primitiveId = static_cast<int>(static_cast<size_t>(kind) * MAX_PRIMITIVES + i);
+            instances.push_back(makeGBufferInstance(data[i].position.data(), data[i].scale.data(), data[i].normal.data(),
+                                                    kind, primitiveId, data[i].objectId));
+        }
+    };
+    
+    m_gbufferVolumes.clear();
+    m_gbufferPlanes.clear();
+    append(m_gbufferVolumes, m_sphereData, ObjectType::Sphere);
+    append(m_gbufferVolumes, m_cubeData, ObjectType::Cube);
+    append(m_gbufferPlanes, m_planeData, ObjectType::Plane);
 }
 
-void Renderer::updateSceneDataForShader(const Scene& scene) {
+void Renderer::buildPreviewGBufferInstances() {
+    // Preview has no primitive arrays; only the object ids matter here
+    auto append = [](std::vector<GBufferInstance>& instances, const std::vector<PreviewInstance>& preview, ObjectType kind) {
+        for (size_t i = 0; i < preview.size(); ++i) {
+            instances.push_back(makeGBufferInstance(preview[i].center, preview[i].size, preview[i].normal,
+                                                    kind, static_cast<int>(i), static_cast<int>(preview[i].objectId)));
+        }
+    };
+    
+    m_gbufferVolumes.clear();
+    m_gbufferPlanes.clear();
+    append(m_gbufferVolumes, m_previewSpheres, ObjectType::Sphere);
+    append(m_gbufferVolumes, m_previewCubes, ObjectType::Cube);
+    append(m_gbufferPlanes, m_previewPlanes, ObjectType::Plane);
+}
+
+void Renderer::renderGBuffer(const Camera& camera, int width, int height, unsigned int targetFramebuffer,
+                             const Vec2& jitter) {
+    m_gbufferPass->render(m_gbufferVolumes, m_gbufferPlanes, camera, width, height, jitter);
+    m_drawCalls += 2;
+    
+    if (m_pickRequested) {
+        m_gbufferPass->requestIdReadback(m_pickPixel[0], m_pickPixel[1]);
+        m_pickRequested = false;
+    }
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glViewport(0, 0, width, height);
+}
+
+bool Renderer::requestPick(const Vec2& viewportPos) {
+    if (!m_gbufferPass || !m_gbufferPass->isValid()) return false;
+    
+    // Viewport coordinates are top-down, GL rows bottom-up
+    m_pickPixel[0] = static_cast<int>(viewportPos.x);
+    m_pickPixel[1] = static_cast<int>(m_viewportSize.y) - 1 - static_cast<int>(viewportPos.y);
+    m_pickRequested = true;
+    return true;
+}
+
+bool Renderer::pollPick(ObjectHandle& object) {
+    int primitiveId = -1;
+    int objectId = -1;
+    if (!m_gbufferPass || !m_gbufferPass->pollIdReadback(primitiveId, objectId)) return false;
+    
+    object = objectId >= 0 && static_cast<size_t>(objectId) < m_pickHandles.size() ? m_pickHandles[objectId]
+                                                                                  : ObjectHandle{};
+    return true;
+}
+
+void Renderer::setOutlinedObjects(const std::vector<int>& selected, int hovered) {
+    if (selected == m_outlineSelected && hovered == m_outlineHovered) return;
+    
+    m_outlineSelected = selected;
+    m_outlineHovered = hovered;
+    
+    int maxId = hovered;
+    for (int id : selected) maxId = std::max(maxId, id);
+    if (maxId < 0) {
+        m_selectionMaskSize = 0;
+        return;
+    }
+    
+    // One byte per object, wrapped into rows of SELECTION_MASK_WIDTH
+    int rows = maxId / SELECTION_MASK_WIDTH + 1;
+    std::vector<unsigned char> mask(static_cast<size_t>(rows) * SELECTION_MASK_WIDTH, 0);
+    if (hovered >= 0) mask[hovered] = 1;
+    for (int id : selected) {
+        if (id >= 0) mask[id] = 2;
+    }
+    
+    if (!m_selectionMask) {
+        glGenTextures(1, &m_selectionMask);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_selectionMask);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, SELECTION_MASK_WIDTH, rows, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, mask.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    m_selectionMaskSize = static_cast<int>(mask.size());
+}
+
+void Renderer::renderOutlines() {
+    if (!m_outlineShader || m_selectionMaskSize == 0) return;
+    
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    
+    m_outlineShader->use();
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_gbufferPass->getIdTexture());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_selectionMask);
+    
+    m_outlineShader->setInt("u_ids", 0);
+    m_outlineShader->setInt("u_selectionMask", 1);
+    m_outlineShader->setInt("u_maskWidth", SELECTION_MASK_WIDTH);
+    m_outlineShader->setInt("u_maskSize", m_selectionMaskSize);
+    m_outlineShader->setVec3("u_selectedColor", Vec3{1.0f, 0.5f, 0.0f}); // Orange selection
+    m_outlineShader->setVec3("u_hoveredColor", Vec3{0.8f, 0.8f, 0.8f});  // Gray hover
+    
+    glBindVertexArray(m_quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+    
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    m_outlineShader->unuse();
+    
+    glEnable(GL_DEPTH_TEST);
+    m_drawCalls++;
+}
+
+void Renderer::gatherPreviewInstances(const Scene& scene) {
+    m_previewSpheres.clear();
+    m_previewCubes.clear();
+    m_previewPlanes.clear();
+    
+    // Unlike the path tracer there is no primitive limit here
+    for (int objectIndex = 0; objectIndex < scene.getObjectCount(); ++objectIndex) {
+        if (!scene.isVisible(objectIndex)) continue;
+        
+        IntersectionData data;
+        scene.getIntersectionData(objectIndex, data);
+        
+        PreviewInstance instance{};
+        std::copy(data.position.data(), data.position.data() + 3, instance.center);
+        std::copy(data.scale.data(), data.scale.data() + 3, instance.size);
+        std::copy(data.normal.data(), data.normal.data() + 3, instance.normal);
+        std::copy(data.color.data(), data.color.data() + 3, instance.color);
+        std::copy(data.emission.data(), data.emission.data() + 3, instance.emission);
+        instance.roughness = data.roughness;
+        instance.metalness = data.metalness;
+        instance.materialType = static_cast<float>(data.materialType);
+        instance.objectId = static_cast<float>(objectIndex);
+        
+        switch (data.type) {
+            case ObjectType::Sphere: m_previewSpheres.push_back(instance); break;
+            case ObjectType::Cube:   m_previewCubes.push_back(instance); break;
+            case ObjectType::Plane:  m_previewPlanes.push_back(instance); break;
+            default: break;
+        }
+    }
+}
+
+void Renderer::renderPreview(const Scene& scene, const Camera& camera) {
+    gatherPreviewInstances(scene);
+    
+    int width = static_cast<int>(m_viewportSize.x);
+    int height = static_cast<int>(m_viewportSize.y);
+    
+    m_previewPass->renderBackground(camera, width, height);
+    renderGrid(camera);
+    m_previewPass->render(m_previewSpheres, m_previewCubes, m_previewPlanes, camera, width, height);
+    m_drawCalls += 1 + m_previewPass->getDrawCalls();
+    
+    if (needsObjectIds() && m_gbufferPass && m_gbufferPass->isValid()) {
+        GLint targetFramebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFramebuffer);
+        
+        buildPreviewGBufferInstances();
+        renderGBuffer(camera, width, height, static_cast<unsigned int>(targetFramebuffer));
+        renderOutlines();
+    }
+}
+
+void Renderer::gatherSceneData(const Scene& scene) {
     // Clear previous data
     m_sphereData.clear();
     m_planeData.clear();
     m_cubeData.clear();
     
-    // Get objects reference
-    const auto& objects = scene.getObjects();
+    int objectCount = scene.getObjectCount();
+    std::span<const ObjectType> types = scene.getTypes();
     
-    if (objects.empty()) {
+    if (objectCount == 0) {
         LOG_DEBUG("No objects in scene");
-        m_pathTracerShader->setInt("u_numSpheres", 0);
-        m_pathTracerShader->setInt("u_numPlanes", 0);
-        m_pathTracerShader->setInt("u_numCubes", 0);
         return;
     }
     
@@ -248,16 +819,11 @@ void Renderer::updateSceneDataForShader(const Scene& scene) {
     size_t planeCount = 0;
     size_t cubeCount = 0;
     
-    // First pass: count objects by type with nullptr checks
-    for (const auto& obj : objects) {
-        if (!obj) { 
-            LOG_WARN("Found null object in scene");
-            continue;
-        }
-        
-        if (!obj->isVisible()) continue;
+    // First pass: count objects by type
+    for (int objectIndex = 0; objectIndex < objectCount; ++objectIndex) {
+        if (!scene.isVisible(objectIndex)) continue;
         
-        switch (obj->getType()) {
+        switch (types[objectIndex]) {
             case ObjectType::Sphere: 
                 if (sphereCount < MAX_PRIMITIVES) sphereCount++; 
                 break;
@@ -296,19 +862,14 @@ void Renderer::updateSceneDataForShader(const Scene& scene) {
     size_t planeIdx = 0;
     size_t cubeIdx = 0;
     
-    for (const auto& obj : objects) {
-        if (!obj || !obj->isVisible()) continue;
+    for (int objectIndex = 0; objectIndex < objectCount; ++objectIndex) {
+        if (!scene.isVisible(objectIndex)) continue;
         
-        // Get common data with error checking
         IntersectionData data;
-        try {
-            obj->getIntersectionData(data);
-        } catch (const std::exception& e) {
-            LOG_ERROR("Failed to get intersection data for object: {}", e.what());
-            continue;
-        }
+        scene.getIntersectionData(objectIndex, data);
+        data.objectId = objectIndex;
         
-        switch (obj->getType()) {
+        switch (types[objectIndex]) {
             case ObjectType::Sphere:
                 if (sphereIdx < m_sphereData.size()) {
                     m_sphereData[sphereIdx++] = data;
@@ -328,14 +889,6 @@ void Renderer::updateSceneDataForShader(const Scene& scene) {
                 break;
         }
     }
-    
-    // Upload data to shader with bounds checking
-    uploadShaderData();
-    
-    // Set counts
-    m_pathTracerShader->setInt("u_numSpheres", static_cast<int>(m_sphereData.size()));
-    m_pathTracerShader->setInt("u_numPlanes", static_cast<int>(m_planeData.size()));
-    m_pathTracerShader->setInt("u_numCubes", static_cast<int>(m_cubeData.size()));
 }
 
 void Renderer::renderGrid(const Camera& camera) {
@@ -367,202 +920,39 @@ void Renderer::renderGrid(const Camera& camera) {
     m_drawCalls++;
 }
 
-void Renderer::renderSelectionOutline(const Object& object, const Camera& camera) {
-    if (!m_wireframeShader->isValid()) return;
-    
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glLineWidth(2.0f);
-    
-    m_wireframeShader->use();
-    
-    Mat4 model = object.getTransform().getMatrix();
-    Mat4 view = camera.getViewMatrix();
-    Mat4 proj = camera.getProjectionMatrix(m_viewportSize.x / m_viewportSize.y);
-    Mat4 mvp = proj * view * model;
-    
-    m_wireframeShader->setMat4("u_mvp", mvp);
-    m_wireframeShader->setVec3("u_color", Vec3{1.0f, 0.5f, 0.0f}); // Orange selection
-    
-    renderObjectWireframe(object);
-    
-    m_wireframeShader->unuse();
-    
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glLineWidth(1.0f);
+void Renderer::updateStats() {
+    m_fps = Time::getFPS();
 }
 
-void Renderer::renderHoverOutline(const Object& object, const Camera& camera) {
-    if (!m_wireframeShader->isValid()) return;
-    
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glLineWidth(1.5f);
-    
-    m_wireframeShader->use();
-    
-    Mat4 model = object.getTransform().getMatrix();
-    Mat4 view = camera.getViewMatrix();
-    Mat4 proj = camera.getProjectionMatrix(m_viewportSize.x / m_viewportSize.y);
-    Mat4 mvp = proj * view * model;
+bool Renderer::beginPassTimer() {
+    // All queries still in flight - skip timing this pass rather than wait
+    if (!m_timerQueries[0] || m_timerPending >= TIMER_QUERY_COUNT) return false;
     
-    m_wireframeShader->setMat4("u_mvp", mvp);
-    m_wireframeShader->setVec3("u_color", Vec3{0.8f, 0.8f, 0.8f}); // Gray hover
-    
-    renderObjectWireframe(object);
-    
-    m_wireframeShader->unuse();
-    
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glLineWidth(1.0f);
-}
-
-void Renderer::renderObjectWireframe(const Object& object) {
-    switch (object.getType()) {
-        case ObjectType::Sphere:
-            renderSphereWireframe();
-            break;
-        case ObjectType::Cube:
-            renderCubeWireframe();
-            break;
-        case ObjectType::Plane:
-            renderPlaneWireframe();
-            break;
-        default:
-            break;
-    }
+    glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_timerWriteIndex]);
+    return true;
 }
 
-void Renderer::renderSphereWireframe() {
-    const int segments = 16;
-    const int rings = 12;
-    
-    std::vector<Vec3> vertices;
-    std::vector<unsigned int> indices;
-    
-    // Generate sphere vertices
-    for (int i = 0; i <= rings; ++i) {
-        float phi = M_PI * float(i) / float(rings);
-        for (int j = 0; j <= segments; ++j) {
-            float theta = 2.0f * M_PI * float(j) / float(segments);
-            
-            float x = std::sin(phi) * std::cos(theta);
-            float y = std::cos(phi);
-            float z = std::sin(phi) * std::sin(theta);
-            
-            vertices.push_back(Vec3{x, y, z});
-        }
-    }
-    
-    // Generate indices for wireframe
-    for (int i = 0; i < rings; ++i) {
-        for (int j = 0; j < segments; ++j) {
-            int curr = i * (segments + 1) + j;
-            int next = curr + segments + 1;
-            
-            indices.push_back(curr);
-            indices.push_back(curr + 1);
-            
-            indices.push_back(curr);
-            indices.push_back(next);
-        }
-    }
-    
-    // Render wireframe
-    unsigned int vao, vbo, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &ibo);
-    
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vec3), vertices.data(), GL_DYNAMIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_DYNAMIC_DRAW);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    glDrawElements(GL_LINES, indices.size(), GL_UNSIGNED_INT, 0);
-    
-    glBindVertexArray(0);
-    glDeleteBuffers(1, &ibo);
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-}
-
-void Renderer::renderCubeWireframe() {
-    // Cube wireframe vertices
-    Vec3 vertices[] = {
-        {-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f},
-        {0.5f,  0.5f, -0.5f}, {-0.5f,  0.5f, -0.5f},
-        {-0.5f, -0.5f,  0.5f}, {0.5f, -0.5f,  0.5f},
-        {0.5f,  0.5f,  0.5f}, {-0.5f,  0.5f,  0.5f}
-    };
-    
-    unsigned int indices[] = {
-        0,1, 1,2, 2,3, 3,0,  // Front face
-        4,5, 5,6, 6,7, 7,4,  // Back face
-        0,4, 1,5, 2,6, 3,7   // Connecting edges
-    };
-    
-    // Render cube wireframe
-    unsigned int vao, vbo, ibo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &ibo);
-    
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_DYNAMIC_DRAW);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    glDrawElements(GL_LINES, 24, GL_UNSIGNED_INT, 0);
-    
-    glBindVertexArray(0);
-    glDeleteBuffers(1, &ibo);
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
+void Renderer::endPassTimer() {
+    glEndQuery(GL_TIME_ELAPSED);
+    m_timerWriteIndex = (m_timerWriteIndex + 1) % TIMER_QUERY_COUNT;
+    m_timerPending++;
 }
 
-void Renderer::renderPlaneWireframe() {
-    // Plane wireframe (grid pattern)
-    const int gridSize = 5;
-    std::vector<Vec3> vertices;
-    
-    for (int i = -gridSize; i <= gridSize; ++i) {
-        float t = float(i) / float(gridSize);
-        vertices.push_back(Vec3{-0.5f, 0, t * 0.5f});
-        vertices.push_back(Vec3{0.5f, 0, t * 0.5f});
-        vertices.push_back(Vec3{t * 0.5f, 0, -0.5f});
-        vertices.push_back(Vec3{t * 0.5f, 0, 0.5f});
+void Renderer::collectPassTimings() {
+    while (m_timerPending > 0) {
+        int oldest = (m_timerWriteIndex - m_timerPending + TIMER_QUERY_COUNT) % TIMER_QUERY_COUNT;
+        
+        GLint available = 0;
+        glGetQueryObjectiv(m_timerQueries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+        
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(m_timerQueries[oldest], GL_QUERY_RESULT, &elapsedNs);
+        m_timerPending--;
+        
+        m_pathTraceTime = static_cast<float>(elapsedNs) / 1.0e6f;
+        m_governor.update(m_pathTraceTime, m_samplesPerPixel, m_maxBounces);
     }
-    
-    // Render plane wireframe
-    unsigned int vao, vbo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vec3), vertices.data(), GL_DYNAMIC_DRAW);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    glDrawArrays(GL_LINES, 0, vertices.size());
-    
-    glBindVertexArray(0);
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-}
-
-void Renderer::updateStats() {
-    m_fps = Time::getFPS();
 }
 
 void Renderer::reloadShaders() {
@@ -579,11 +969,12 @@ void Renderer::reloadShaders() {
         LOG_ERROR("Failed to reload path tracer shader");
     }
     
-    m_wireframeShader = rm.loadShader("wireframe", "shaders/wireframe.vert", "shaders/wireframe.frag");
-    if (m_wireframeShader && m_wireframeShader->isValid()) {
-        LOG_INFO("Wireframe shader reloaded successfully");
+    m_outlineShader = rm.loadShader("outline", "shaders/outline.vert", "shaders/outline.frag");
+    if (m_outlineShader && m_outlineShader->isValid()) {
+        LOG_INFO("Outline shader reloaded successfully");
     } else {
-        LOG_WARN("Failed to reload wireframe shader");
+        LOG_WARN("Failed to reload outline shader");
+        m_outlineShader = nullptr;
     }
     
     m_gridShader = rm.loadShader("grid", "shaders/grid.vert", "shaders/grid.frag");
@@ -592,4 +983,24 @@ void Renderer::reloadShaders() {
     } else {
         LOG_WARN("Failed to reload grid shader");
     }
+    
+    m_upscaleShader = rm.loadShader("upscale", "shaders/upscale.vert", "shaders/upscale.frag");
+    if (m_upscaleShader && m_upscaleShader->isValid()) {
+        LOG_INFO("Upscale shader reloaded successfully");
+    } else {
+        LOG_WARN("Failed to reload upscale shader");
+        m_upscaleShader = nullptr;
+    }
+    
+    if (m_gbufferPass) {
+        m_gbufferPass->reloadShader();
+    }
+    
+    if (m_previewPass) {
+        m_previewPass->reloadShaders();
+    }
+    
+    if (m_hybridRenderer) {
+        m_hybridRenderer->reloadShaders();
+    }
 }
\ No newline at end of file
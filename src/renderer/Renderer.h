@@ -1,8 +1,12 @@
 #pragma once
 
 #include "Shader.h"
+#include "FrameBudgetGovernor.h"
 #include "math/Vec2.h"
+#include "scene/ObjectHandle.h"
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 #ifndef M_PI
@@ -11,9 +15,32 @@
 
 class Scene;
 class Camera;
+class Framebuffer;
+class GBufferPass;
+struct GBufferInstance;
+class PreviewPass;
+struct PreviewInstance;
+class CpuPathTracer;
+struct RenderCheckpoint;
+class HybridRenderer;
+class DistributedRenderer;
 class Object;
 struct IntersectionData;
 
+enum class RenderMode {
+    PathTraced,
+    Preview     // Rasterized PBR for fast layout work
+};
+
+// Where path-traced frames are computed
+enum class RenderBackend {
+    Gpu,
+    Cpu,        // Multithreaded reference tracer, progressive
+    Hybrid,     // Tiles shared between GPU and CPU, progressive; scenes the
+                // shader cannot hold fall back to Cpu
+    Distributed // Tiles traced by render-worker processes, progressive
+};
+
 class Renderer {
 public:
     Renderer();
@@ -27,6 +54,21 @@ public:
     void setViewportSize(int width, int height) { m_viewportSize = Vec2{static_cast<float>(width), static_cast<float>(height)}; }
     Vec2 getViewportSize() const { return m_viewportSize; }
     
+    void setRenderMode(RenderMode mode) { m_renderMode = mode; }
+    RenderMode getRenderMode() const { return m_renderMode; }
+    
+    void setRenderBackend(RenderBackend backend);
+    RenderBackend getRenderBackend() const { return m_renderBackend; }
+    // Null unless the matching backend is selected
+    const CpuPathTracer* getCpuPathTracer() const { return m_cpuTracer.get(); }
+    const HybridRenderer* getHybridRenderer() const { return m_hybridRenderer.get(); }
+    const DistributedRenderer* getDistributedRenderer() const { return m_distributedRenderer.get(); }
+    
+    // "host:port" of the render workers the distributed backend connects to;
+    // takes effect the next time that backend is selected
+    void setRenderWorkers(const std::vector<std::string>& endpoints) { m_renderWorkers = endpoints; }
+    const std::vector<std::string>& getRenderWorkers() const { return m_renderWorkers; }
+    
     // Path tracer settings
     void setSamplesPerPixel(int spp) { m_samplesPerPixel = spp; }
     void setMaxBounces(int bounces) { m_maxBounces = bounces; }
@@ -34,36 +76,154 @@ public:
     int getSamplesPerPixel() const { return m_samplesPerPixel; }
     int getMaxBounces() const { return m_maxBounces; }
     
+    // Resolution scaling - traces at a fraction of the viewport size and
+    // reconstructs full resolution with the upscale pass
+    void setRenderScale(float scale);
+    float getRenderScale() const { return m_renderScale; }
+    void setSharpness(float sharpness) { m_sharpness = sharpness; }
+    float getSharpness() const { return m_sharpness; }
+    
+    // Hybrid mode: rasterize first hits into a G-buffer and start paths there.
+    // The G-buffer is jittered per frame for anti-aliasing, but its rays are
+    // pinhole ones, so depth of field is lost in this mode.
+    void setRasterPrimaryVisibility(bool enabled) { m_rasterPrimary = enabled; }
+    bool getRasterPrimaryVisibility() const { return m_rasterPrimary; }
+    
+    // CPU backend: end diffuse paths in the world-space radiance cache.
+    // Biased, so off by default to keep the CPU a reference for the GPU.
+    void setRadianceCache(bool enabled) { m_radianceCache = enabled; }
+    bool getRadianceCache() const { return m_radianceCache; }
+    
+    // CPU backend: photon-mapped caustics behind glass and metal; biased
+    // like the radiance cache and off by default for the same reason
+    void setCaustics(bool enabled) { m_caustics = enabled; }
+    bool getCaustics() const { return m_caustics; }
+    
+    // CPU backend: sample diffuse bounces from a learned SD-tree guide.
+    // Guided paths skip the shader's low-throughput cutoffs, so it is off
+    // by default, keeping the CPU image the GPU's reference.
+    void setPathGuiding(bool enabled) { m_pathGuiding = enabled; }
+    bool getPathGuiding() const { return m_pathGuiding; }
+    
+    // CPU backend: save the accumulated samples to path every interval
+    // seconds. A checkpoint already there is resumed once its view comes
+    // up, and never saved over by another view's samples.
+    void setCheckpoint(const std::string& path, float intervalSeconds = 60.0f);
+    
+    // Automatic SPP/bounce control
+    FrameBudgetGovernor& getGovernor() { return m_governor; }
+    const FrameBudgetGovernor& getGovernor() const { return m_governor; }
+    // Only the GPU path tracer's pass is timed, so only it can be governed;
+    // elsewhere an enabled governor holds still
+    bool isGovernable() const {
+        return m_renderMode == RenderMode::PathTraced && m_renderBackend == RenderBackend::Gpu;
+    }
+    
     // Statistics
     float getFPS() const { return m_fps; }
     int getDrawCalls() const { return m_drawCalls; }
+    float getPathTraceTime() const { return m_pathTraceTime; }
+    
+    // Object-id picking: the object under a viewport pixel is read back
+    // asynchronously; poll on the following frames for the result (null =
+    // none). It is the object drawn there at the time, even if objects
+    // were added or removed since; it may be stale by then.
+    bool requestPick(const Vec2& viewportPos);
+    bool pollPick(ObjectHandle& object);
     
-    // Selection rendering
-    void renderSelectionOutline(const Object& object, const Camera& camera);
-    void renderHoverOutline(const Object& object, const Camera& camera);
+    // Screen-space outlines for objects given by scene index
+    void setOutlinedObjects(const std::vector<int>& selected, int hovered);
 
 private:
     // Initialization
     void createQuad();
     void createGrid();
+    void createTimerQueries();
     
     // Rendering helpers
-    void updateSceneDataForShader(const Scene& scene);
+    void gatherSceneData(const Scene& scene);
+    void buildGBufferInstances();
+    void buildPreviewGBufferInstances();
+    // Preview instances of every visible object, with no primitive limit
+    void gatherPreviewInstances(const Scene& scene);
+    void renderGBuffer(const Camera& camera, int width, int height, unsigned int targetFramebuffer,
+                       const Vec2& jitter = Vec2{0.0f, 0.0f});
+    bool needsObjectIds() const { return m_pickRequested || m_selectionMaskSize > 0; }
+    void renderOutlines();
+    void renderPreview(const Scene& scene, const Camera& camera);
+    // CPU and distributed backends: present an image traced off the GPU
+    void renderCpu(const Scene& scene, const Camera& camera);
+    void updateCheckpoint();
+    void renderHybrid(const Scene& scene, const Camera& camera);
     void renderGrid(const Camera& camera);
     void updateStats();
+    
+    // GPU pass timing
+    bool beginPassTimer();
+    void endPassTimer();
+    void collectPassTimings();
 
+    // Camera, settings and scene uniforms; the shader must be bound
+    void setPathTracerUniforms(const Camera& camera, const Vec2& resolution);
     void uploadShaderData();
-    
-    // Wireframe rendering
-    void renderObjectWireframe(const Object& object);
-    void renderSphereWireframe();
-    void renderCubeWireframe();
-    void renderPlaneWireframe();
+    void upscale(unsigned int targetFramebuffer, int targetWidth, int targetHeight);
+    // Full-resolution normal (xyz) / linear depth (w) texture guiding the upscaler
+    void setUpscaleGuide(unsigned int texture, int width, int height);
     
     // Shaders
     std::shared_ptr<Shader> m_pathTracerShader;
-    std::shared_ptr<Shader> m_wireframeShader;
+    std::shared_ptr<Shader> m_outlineShader;
     std::shared_ptr<Shader> m_gridShader;
+    std::shared_ptr<Shader> m_upscaleShader;
+    
+    // Low-resolution target used when rendering below viewport resolution
+    std::unique_ptr<Framebuffer> m_traceTarget;
+    unsigned int m_upscaleGuide = 0;
+    Vec2 m_upscaleGuideSize{0, 0};
+    
+    // Rasterized primary visibility
+    std::unique_ptr<GBufferPass> m_gbufferPass;
+    std::vector<GBufferInstance> m_gbufferVolumes;
+    std::vector<GBufferInstance> m_gbufferPlanes;
+    bool m_rasterPrimary = false;
+    uint32_t m_gbufferFrame = 0;    // Indexes the per-frame sub-pixel jitter
+    Vec2 m_gbufferJitter{0, 0};
+    
+    // Picking and selection outlines
+    bool m_pickRequested = false;
+    int m_pickPixel[2] = {0, 0};
+    // Scene handles as of the frame the pending pick was drawn in, which
+    // the object ids read back index
+    std::vector<ObjectHandle> m_pickHandles;
+    std::vector<int> m_outlineSelected;
+    int m_outlineHovered = -1;
+    unsigned int m_selectionMask = 0;
+    int m_selectionMaskSize = 0;
+    static constexpr int SELECTION_MASK_WIDTH = 1024;
+    
+    // Preview mode
+    std::unique_ptr<PreviewPass> m_previewPass;
+    std::vector<PreviewInstance> m_previewSpheres;
+    std::vector<PreviewInstance> m_previewCubes;
+    std::vector<PreviewInstance> m_previewPlanes;
+    RenderMode m_renderMode = RenderMode::PathTraced;
+    
+    // CPU reference, hybrid and distributed backends
+    std::unique_ptr<CpuPathTracer> m_cpuTracer;
+    std::unique_ptr<HybridRenderer> m_hybridRenderer;
+    std::unique_ptr<DistributedRenderer> m_distributedRenderer;
+    std::vector<std::string> m_renderWorkers;
+    bool m_radianceCache = false;
+    bool m_caustics = false;
+    bool m_pathGuiding = false;
+    std::string m_checkpointPath;
+    // Pending until a frame of its view comes up; the file is not saved
+    // over meanwhile
+    std::unique_ptr<RenderCheckpoint> m_resumeCheckpoint;
+    bool m_resumeWarned = false;
+    float m_checkpointInterval = 60.0f;
+    float m_lastCheckpointTime = 0.0f;
+    RenderBackend m_renderBackend = RenderBackend::Gpu;
     
     // Scene data for shader
     std::vector<IntersectionData> m_sphereData;
@@ -76,16 +236,28 @@ private:
 
     static constexpr size_t MAX_PRIMITIVES = 64;
     
+    // Timer queries, ring-buffered so reading results never stalls
+    static constexpr int TIMER_QUERY_COUNT = 4;
+    unsigned int m_timerQueries[TIMER_QUERY_COUNT] = {};
+    int m_timerWriteIndex = 0;
+    int m_timerPending = 0;
+    
+    FrameBudgetGovernor m_governor;
+    
     // Viewport
     Vec2 m_viewportSize{1920, 1080};
     
     // Render settings
     int m_samplesPerPixel = 16;
     int m_maxBounces = 8;
+    uint32_t m_sampleIndex = 0;
+    float m_renderScale = 1.0f;
+    float m_sharpness = 0.25f;
     
     // Stats
     float m_fps = 0.0f;
     int m_drawCalls = 0;
     float m_frameTime = 0.0f;
+    float m_pathTraceTime = 0.0f;
     int m_frameCount = 0;
 };
\ No newline at end of file
@@ -139,6 +139,21 @@ void Shader::setInt(const std::string& name, int value) {
     glUniform1i(location, value);
 }
 
+void Shader::setUint(const std::string& name, unsigned int value) {
+    if (m_program == 0) {
+        LOG_WARN("Attempting to set uniform '{}' on invalid shader", name);
+        return;
+    }
+    
+    int location = getUniformLocation(name);
+    if (location == -1) {
+        LOG_DEBUG("Uniform '{}' not found in shader", name);
+        return;
+    }
+    
+    glUniform1ui(location, value);
+}
+
 void Shader::setFloat(const std::string& name, float value) {
     if (m_program == 0) {
         LOG_WARN("Attempting to set uniform '{}' on invalid shader", name);
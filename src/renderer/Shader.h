@@ -18,6 +18,7 @@ public:
     void unuse() const;
     
     void setInt(const std::string& name, int value);
+    void setUint(const std::string& name, unsigned int value);
     void setFloat(const std::string& name, float value);
     void setVec3(const std::string& name, const Vec3& value);
     void setMat4(const std::string& name, const Mat4& value);
@@ -0,0 +1,698 @@
+#include "CompiledScene.h"
+#include "Scene.h"
+#include "core/Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Unindexed primitives are tested one by one until they outnumber this
+    // plus a quarter of the indexed ones, so builds stay amortized over
+    // the additions that trigger them
+    constexpr size_t MIN_UNINDEXED = 64;
+
+    constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+
+    uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        // FNV-1a
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    float sign(float x) {
+        return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f);
+    }
+
+    AABB emptyBounds() {
+        return AABB{Vec3{INFINITY}, Vec3{-INFINITY}};
+    }
+
+    void grow(AABB& bounds, const AABB& other) {
+        bounds.min = Vec3{std::min(bounds.min.x, other.min.x), std::min(bounds.min.y, other.min.y),
+                          std::min(bounds.min.z, other.min.z)};
+        bounds.max = Vec3{std::max(bounds.max.x, other.max.x), std::max(bounds.max.y, other.max.y),
+                          std::max(bounds.max.z, other.max.z)};
+    }
+
+    // Padded by the intersection epsilon, so rounding never lets a node
+    // miss a ray that grazes a primitive inside
+    AABB paddedBounds(const Vec3& center, const Vec3& extent) {
+        Vec3 padded{std::abs(extent.x) + CompiledScene::EPSILON, std::abs(extent.y) + CompiledScene::EPSILON,
+                    std::abs(extent.z) + CompiledScene::EPSILON};
+        return AABB{center - padded, center + padded};
+    }
+
+    AABB sphereBounds(const CompiledScene::Spheres& spheres, size_t i) {
+        return paddedBounds(Vec3{spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]}, Vec3{spheres.radius[i]});
+    }
+
+    AABB boxBounds(const CompiledScene::Boxes& boxes, size_t i) {
+        return paddedBounds(Vec3{boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]},
+                            Vec3{boxes.halfExtentX[i], boxes.halfExtentY[i], boxes.halfExtentZ[i]});
+    }
+}
+
+uint64_t CompiledScene::nextRevision() {
+    static std::atomic<uint64_t> s_revision{0};
+    return ++s_revision;
+}
+
+bool CompiledScene::getSource(const Scene& scene, ObjectHandle handle, Source& source) {
+    int index = scene.getObjectIndex(handle);
+    if (index < 0 || !scene.isVisible(index)) return false;
+
+    ObjectType type = scene.getTypes()[index];
+    if (type != ObjectType::Sphere && type != ObjectType::Plane && type != ObjectType::Cube) return false;
+
+    IntersectionData data;
+    scene.getIntersectionData(index, data);
+    source = Source{data.type, data.position, data.scale, data.normal, data.color, data.emission,
+                    data.materialType, data.roughness, data.ior, data.metalness};
+    return true;
+}
+
+void CompiledScene::compile(const Scene& scene) {
+    m_records.clear();
+    m_recordOf.clear();
+    for (int i = 0; i < scene.getObjectCount(); ++i) {
+        Record record;
+        record.handle = scene.getHandle(i);
+        if (!getSource(scene, record.handle, record.source)) continue;
+
+        if (record.handle.slot >= m_recordOf.size()) {
+            m_recordOf.resize(record.handle.slot + 1, NO_RECORD);
+        }
+        m_recordOf[record.handle.slot] = static_cast<uint32_t>(m_records.size());
+        m_records.push_back(record);
+    }
+
+    rebuild();
+    m_revision = nextRevision();
+}
+
+bool CompiledScene::update(const Scene& scene, std::span<const ObjectHandle> changes) {
+    bool changed = false;
+    for (ObjectHandle handle : changes) {
+        uint32_t recordIndex = handle.slot < m_recordOf.size() ? m_recordOf[handle.slot] : NO_RECORD;
+        // A record of an earlier object in the slot, removed since
+        if (recordIndex != NO_RECORD && m_records[recordIndex].handle != handle) {
+            removeRecord(recordIndex);
+            recordIndex = NO_RECORD;
+            changed = true;
+        }
+
+        Source source;
+        if (!getSource(scene, handle, source)) {
+            if (recordIndex != NO_RECORD) {
+                removeRecord(recordIndex);
+                changed = true;
+            }
+        } else if (recordIndex == NO_RECORD) {
+            addRecord(handle, source);
+            changed = true;
+        } else if (std::memcmp(&source, &m_records[recordIndex].source, sizeof(Source)) != 0) {
+            if (source.type != m_records[recordIndex].source.type) {
+                removeRecord(recordIndex);
+                addRecord(handle, source);
+            } else {
+                m_records[recordIndex].source = source;
+                writeRecord(recordIndex);
+                refitPrimitive(source.type, static_cast<size_t>(m_records[recordIndex].slot));
+            }
+            changed = true;
+        }
+    }
+
+    size_t unindexed = m_spheres.size() - m_indexedSpheres + m_boxes.size() - m_indexedBoxes;
+    if (unindexed > MIN_UNINDEXED + (m_indexedSpheres + m_indexedBoxes) / 4) {
+        buildBvh();
+    }
+
+    if (changed) {
+        m_revision = nextRevision();
+    }
+    return changed;
+}
+
+void CompiledScene::addRecord(ObjectHandle handle, const Source& source) {
+    Record record;
+    record.handle = handle;
+    record.slot = static_cast<int>(getKindSize(source.type));
+    record.source = source;
+    resizeKind(source.type, static_cast<size_t>(record.slot) + 1);
+
+    if (handle.slot >= m_recordOf.size()) {
+        m_recordOf.resize(handle.slot + 1, NO_RECORD);
+    }
+    m_recordOf[handle.slot] = static_cast<uint32_t>(m_records.size());
+    m_records.push_back(record);
+    m_materials.emplace_back();
+    writeRecord(m_records.size() - 1);
+}
+
+void CompiledScene::removeRecord(uint32_t recordIndex) {
+    Record removed = m_records[recordIndex];
+    m_recordOf[removed.handle.slot] = NO_RECORD;
+
+    // The last primitive of the kind fills the gap
+    ObjectType type = removed.source.type;
+    size_t slot = static_cast<size_t>(removed.slot);
+    size_t lastSlot = getKindSize(type) - 1;
+    if (slot != lastSlot) {
+        int moved = getKindMaterial(type, lastSlot);
+        m_records[moved].slot = removed.slot;
+        writeRecord(static_cast<size_t>(moved));
+    }
+    resizeKind(type, lastSlot);
+
+    if (type == ObjectType::Sphere || type == ObjectType::Cube) {
+        bool box = type == ObjectType::Cube;
+        size_t& indexed = box ? m_indexedBoxes : m_indexedSpheres;
+        std::vector<uint32_t>& leafOf = box ? m_boxLeaf : m_sphereLeaf;
+        if (lastSlot >= indexed) {
+            // An unindexed primitive, or one the gap took in
+            if (slot < indexed) refit(leafOf[slot]);
+        } else {
+            // The last indexed primitive ends its leaf's run, which gives it up
+            uint32_t shrunk = leafOf[lastSlot];
+            --(box ? m_bvh[shrunk].boxEnd : m_bvh[shrunk].sphereEnd);
+            leafOf.pop_back();
+            --indexed;
+            refit(shrunk);
+            if (slot != lastSlot) refit(leafOf[slot]);
+        }
+    }
+
+    // And the last record fills the record's
+    size_t lastRecord = m_records.size() - 1;
+    if (recordIndex != lastRecord) {
+        m_records[recordIndex] = m_records[lastRecord];
+        m_recordOf[m_records[recordIndex].handle.slot] = recordIndex;
+        writeRecord(recordIndex);
+    }
+    m_records.pop_back();
+    m_materials.pop_back();
+}
+
+size_t CompiledScene::getKindSize(ObjectType type) const {
+    switch (type) {
+        case ObjectType::Sphere: return m_spheres.size();
+        case ObjectType::Cube:   return m_boxes.size();
+        default:                 return m_planes.size();
+    }
+}
+
+int CompiledScene::getKindMaterial(ObjectType type, size_t slot) const {
+    switch (type) {
+        case ObjectType::Sphere: return m_spheres.material[slot];
+        case ObjectType::Cube:   return m_boxes.material[slot];
+        default:                 return m_planes.material[slot];
+    }
+}
+
+void CompiledScene::resizeKind(ObjectType type, size_t count) {
+    switch (type) {
+        case ObjectType::Sphere:
+            m_spheres.centerX.resize(count);
+            m_spheres.centerY.resize(count);
+            m_spheres.centerZ.resize(count);
+            m_spheres.radius.resize(count);
+            m_spheres.material.resize(count);
+            break;
+
+        case ObjectType::Cube:
+            m_boxes.centerX.resize(count);
+            m_boxes.centerY.resize(count);
+            m_boxes.centerZ.resize(count);
+            m_boxes.halfExtentX.resize(count);
+            m_boxes.halfExtentY.resize(count);
+            m_boxes.halfExtentZ.resize(count);
+            m_boxes.material.resize(count);
+            break;
+
+        default:
+            m_planes.pointX.resize(count);
+            m_planes.pointY.resize(count);
+            m_planes.pointZ.resize(count);
+            m_planes.normalX.resize(count);
+            m_planes.normalY.resize(count);
+            m_planes.normalZ.resize(count);
+            m_planes.material.resize(count);
+            break;
+    }
+}
+
+void CompiledScene::serialize(std::vector<uint8_t>& out) const {
+    uint32_t count = static_cast<uint32_t>(m_records.size());
+    size_t offset = out.size();
+    out.resize(offset + sizeof(count) + count * RECORD_BYTES);
+
+    uint8_t* cursor = out.data() + offset;
+    std::memcpy(cursor, &count, sizeof(count));
+    cursor += sizeof(count);
+    for (const Record& record : m_records) {
+        std::memcpy(cursor, &record.handle, sizeof(ObjectHandle));
+        cursor += sizeof(ObjectHandle);
+        std::memcpy(cursor, &record.source, sizeof(Source));
+        cursor += sizeof(Source);
+    }
+}
+
+uint64_t CompiledScene::getContentHash() const {
+    // Records are hashed field by field and the hashes sorted, so neither
+    // their order nor padding bytes count
+    std::vector<uint64_t> hashes;
+    hashes.reserve(m_records.size());
+    for (const Record& record : m_records) {
+        const Source& source = record.source;
+        uint64_t hash = hashBytes(FNV_OFFSET, &source.type, sizeof(source.type));
+        for (const Vec3* v : {&source.position, &source.scale, &source.normal, &source.color, &source.emission}) {
+            hash = hashBytes(hash, &v->x, sizeof(float));
+            hash = hashBytes(hash, &v->y, sizeof(float));
+            hash = hashBytes(hash, &v->z, sizeof(float));
+        }
+        hash = hashBytes(hash, &source.materialType, sizeof(source.materialType));
+        hash = hashBytes(hash, &source.roughness, sizeof(source.roughness));
+        hash = hashBytes(hash, &source.ior, sizeof(source.ior));
+        hash = hashBytes(hash, &source.metalness, sizeof(source.metalness));
+        hashes.push_back(hash);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    return hashBytes(FNV_OFFSET, hashes.data(), hashes.size() * sizeof(uint64_t));
+}
+
+bool CompiledScene::deserialize(const uint8_t* data, size_t size) {
+    uint32_t count = 0;
+    if (size < sizeof(count)) return false;
+    std::memcpy(&count, data, sizeof(count));
+    if ((size - sizeof(count)) / RECORD_BYTES < count) return false;
+
+    std::vector<Record> records(count);
+    const uint8_t* cursor = data + sizeof(count);
+    for (Record& record : records) {
+        std::memcpy(&record.handle, cursor, sizeof(ObjectHandle));
+        cursor += sizeof(ObjectHandle);
+        std::memcpy(&record.source, cursor, sizeof(Source));
+        cursor += sizeof(Source);
+
+        ObjectType type = record.source.type;
+        if (type != ObjectType::Sphere && type != ObjectType::Plane && type != ObjectType::Cube) return false;
+    }
+
+    // Handles name objects of the sending process's scene, so they are
+    // only reported back, never looked up
+    m_records = std::move(records);
+    m_recordOf.clear();
+    rebuild();
+    m_revision = nextRevision();
+    return true;
+}
+
+bool CompiledScene::getBounds(const Source& source, AABB& bounds) {
+    Vec3 extent;
+    switch (source.type) {
+        case ObjectType::Sphere: extent = Vec3{source.scale.x}; break;
+        case ObjectType::Cube:   extent = source.scale * 0.5f; break;
+        default:                 return false;
+    }
+    bounds.min = source.position - extent;
+    bounds.max = source.position + extent;
+    return true;
+}
+
+const CompiledScene::Record* CompiledScene::findRecord(ObjectHandle handle) const {
+    if (handle.slot >= m_recordOf.size() || m_recordOf[handle.slot] == NO_RECORD) return nullptr;
+    const Record& record = m_records[m_recordOf[handle.slot]];
+    return record.handle == handle ? &record : nullptr;
+}
+
+bool CompiledScene::getChangedBounds(const CompiledScene& previous, std::vector<AABB>& bounds) const {
+    if ((m_recordOf.empty() && !m_records.empty()) ||
+        (previous.m_recordOf.empty() && !previous.m_records.empty())) {
+        return false;
+    }
+
+    // Records pair up by handle; either side may hold some alone
+    for (const Record& record : m_records) {
+        const Record* before = previous.findRecord(record.handle);
+        if (before && std::memcmp(&before->source, &record.source, sizeof(Source)) == 0) continue;
+
+        for (const Record* changed : {before, &record}) {
+            AABB box;
+            if (!changed) continue;
+            if (!getBounds(changed->source, box)) return false;
+            bounds.push_back(box);
+        }
+    }
+    for (const Record& record : previous.m_records) {
+        AABB box;
+        if (findRecord(record.handle)) continue;
+        if (!getBounds(record.source, box)) return false;
+        bounds.push_back(box);
+    }
+    return true;
+}
+
+void CompiledScene::rebuild() {
+    size_t sphereCount = 0, boxCount = 0, planeCount = 0;
+    for (Record& record : m_records) {
+        switch (record.source.type) {
+            case ObjectType::Sphere: record.slot = static_cast<int>(sphereCount++); break;
+            case ObjectType::Cube:   record.slot = static_cast<int>(boxCount++); break;
+            default:                 record.slot = static_cast<int>(planeCount++); break;
+        }
+    }
+
+    resizeKind(ObjectType::Sphere, sphereCount);
+    resizeKind(ObjectType::Cube, boxCount);
+    resizeKind(ObjectType::Plane, planeCount);
+    m_materials.resize(m_records.size());
+
+    for (size_t i = 0; i < m_records.size(); ++i) {
+        writeRecord(i);
+    }
+    buildBvh();
+}
+
+void CompiledScene::buildBvh() {
+    struct Reference {
+        AABB bounds;
+        Vec3 centroid;
+        uint32_t index;
+        bool box;
+    };
+
+    std::vector<Reference> references;
+    references.reserve(m_spheres.size() + m_boxes.size());
+    for (size_t i = 0; i < m_spheres.size(); ++i) {
+        AABB bounds = sphereBounds(m_spheres, i);
+        references.push_back({bounds, bounds.center(), static_cast<uint32_t>(i), false});
+    }
+    for (size_t i = 0; i < m_boxes.size(); ++i) {
+        AABB bounds = boxBounds(m_boxes, i);
+        references.push_back({bounds, bounds.center(), static_cast<uint32_t>(i), true});
+    }
+
+    // Median splits along the widest spread of centroids; each leaf's
+    // primitives are then laid out as runs, in the order leaves are made
+    struct Task {
+        uint32_t node;
+        size_t begin, end;
+    };
+    std::vector<uint32_t> sphereOrder, boxOrder;    // New index to old
+    sphereOrder.reserve(m_spheres.size());
+    boxOrder.reserve(m_boxes.size());
+    m_sphereLeaf.assign(m_spheres.size(), 0);
+    m_boxLeaf.assign(m_boxes.size(), 0);
+
+    m_bvh.assign(1, BvhNode{});
+    std::vector<Task> tasks{{0, 0, references.size()}};
+    while (!tasks.empty()) {
+        Task task = tasks.back();
+        tasks.pop_back();
+
+        AABB bounds = emptyBounds();
+        AABB centroids = emptyBounds();
+        for (size_t i = task.begin; i < task.end; ++i) {
+            grow(bounds, references[i].bounds);
+            grow(centroids, AABB{references[i].centroid, references[i].centroid});
+        }
+        m_bvh[task.node].bounds = bounds;
+
+        if (task.end - task.begin <= BVH_LEAF_SIZE) {
+            BvhNode& leaf = m_bvh[task.node];
+            leaf.sphereBegin = leaf.sphereEnd = static_cast<uint32_t>(sphereOrder.size());
+            leaf.boxBegin = leaf.boxEnd = static_cast<uint32_t>(boxOrder.size());
+            for (size_t i = task.begin; i < task.end; ++i) {
+                if (references[i].box) {
+                    m_boxLeaf[boxOrder.size()] = task.node;
+                    boxOrder.push_back(references[i].index);
+                    ++leaf.boxEnd;
+                } else {
+                    m_sphereLeaf[sphereOrder.size()] = task.node;
+                    sphereOrder.push_back(references[i].index);
+                    ++leaf.sphereEnd;
+                }
+            }
+            continue;
+        }
+
+        Vec3 spread = centroids.max - centroids.min;
+        int axis = spread.x > spread.y && spread.x > spread.z ? 0 : (spread.y > spread.z ? 1 : 2);
+        size_t middle = task.begin + (task.end - task.begin) / 2;
+        std::nth_element(references.begin() + task.begin, references.begin() + middle, references.begin() + task.end,
+                         [axis](const Reference& a, const Reference& b) { return a.centroid[axis] < b.centroid[axis]; });
+
+        uint32_t child = static_cast<uint32_t>(m_bvh.size());
+        m_bvh.resize(m_bvh.size() + 2);
+        m_bvh[task.node].child = child;
+        m_bvh[task.node].axis = axis;
+        m_bvh[child].parent = task.node;
+        m_bvh[child + 1].parent = task.node;
+        tasks.push_back({child + 1, middle, task.end});
+        tasks.push_back({child, task.begin, middle});
+    }
+
+    // Move every primitive to its place in the runs
+    std::vector<uint32_t> sphereSlot(sphereOrder.size()), boxSlot(boxOrder.size());
+    for (size_t i = 0; i < sphereOrder.size(); ++i) sphereSlot[sphereOrder[i]] = static_cast<uint32_t>(i);
+    for (size_t i = 0; i < boxOrder.size(); ++i) boxSlot[boxOrder[i]] = static_cast<uint32_t>(i);
+    for (size_t i = 0; i < m_records.size(); ++i) {
+        Record& record = m_records[i];
+        if (record.source.type == ObjectType::Sphere) {
+            record.slot = static_cast<int>(sphereSlot[record.slot]);
+        } else if (record.source.type == ObjectType::Cube) {
+            record.slot = static_cast<int>(boxSlot[record.slot]);
+        } else {
+            continue;
+        }
+        writeRecord(i);
+    }
+
+    m_indexedSpheres = m_spheres.size();
+    m_indexedBoxes = m_boxes.size();
+}
+
+void CompiledScene::refit(uint32_t nodeIndex) {
+    const BvhNode& leaf = m_bvh[nodeIndex];
+    AABB bounds = emptyBounds();
+    for (uint32_t i = leaf.sphereBegin; i < leaf.sphereEnd; ++i) grow(bounds, sphereBounds(m_spheres, i));
+    for (uint32_t i = leaf.boxBegin; i < leaf.boxEnd; ++i) grow(bounds, boxBounds(m_boxes, i));
+
+    // Ancestors above the first unchanged node are unchanged too
+    while (std::memcmp(&bounds, &m_bvh[nodeIndex].bounds, sizeof(AABB)) != 0) {
+        m_bvh[nodeIndex].bounds = bounds;
+        if (nodeIndex == 0) break;
+
+        nodeIndex = m_bvh[nodeIndex].parent;
+        uint32_t child = m_bvh[nodeIndex].child;
+        bounds = m_bvh[child].bounds;
+        grow(bounds, m_bvh[child + 1].bounds);
+    }
+}
+
+void CompiledScene::refitPrimitive(ObjectType type, size_t slot) {
+    if (type == ObjectType::Sphere && slot < m_indexedSpheres) {
+        refit(m_sphereLeaf[slot]);
+    } else if (type == ObjectType::Cube && slot < m_indexedBoxes) {
+        refit(m_boxLeaf[slot]);
+    }
+}
+
+PrimitiveRange CompiledScene::getUnindexedRange() const {
+    PrimitiveRange range;
+    range.sphereBegin = m_indexedSpheres;
+    range.sphereEnd = m_spheres.size();
+    range.planeEnd = m_planes.size();
+    range.boxBegin = m_indexedBoxes;
+    range.boxEnd = m_boxes.size();
+    return range;
+}
+
+PrimitiveRange CompiledScene::getLeafRange(const BvhNode& leaf) {
+    PrimitiveRange range;
+    range.sphereBegin = leaf.sphereBegin;
+    range.sphereEnd = leaf.sphereEnd;
+    range.boxBegin = leaf.boxBegin;
+    range.boxEnd = leaf.boxEnd;
+    return range;
+}
+
+void CompiledScene::writeRecord(size_t recordIndex) {
+    const Record& record = m_records[recordIndex];
+    const Source& source = record.source;
+    size_t slot = static_cast<size_t>(record.slot);
+    int material = static_cast<int>(recordIndex);
+
+    Material& mat = m_materials[recordIndex];
+    mat.color = source.color;
+    mat.emission = source.emission;
+    mat.type = source.materialType;
+    mat.roughness = source.roughness;
+    mat.ior = source.ior;
+    mat.metalness = source.metalness;
+
+    switch (source.type) {
+        case ObjectType::Sphere:
+            // scale.x is the radius
+            m_spheres.centerX[slot] = source.position.x;
+            m_spheres.centerY[slot] = source.position.y;
+            m_spheres.centerZ[slot] = source.position.z;
+            m_spheres.radius[slot] = source.scale.x;
+            m_spheres.material[slot] = material;
+            break;
+
+        case ObjectType::Cube: {
+            Vec3 halfExtent = source.scale * 0.5f;
+            m_boxes.centerX[slot] = source.position.x;
+            m_boxes.centerY[slot] = source.position.y;
+            m_boxes.centerZ[slot] = source.position.z;
+            m_boxes.halfExtentX[slot] = halfExtent.x;
+            m_boxes.halfExtentY[slot] = halfExtent.y;
+            m_boxes.halfExtentZ[slot] = halfExtent.z;
+            m_boxes.material[slot] = material;
+            break;
+        }
+
+        default:
+            m_planes.pointX[slot] = source.position.x;
+            m_planes.pointY[slot] = source.position.y;
+            m_planes.pointZ[slot] = source.position.z;
+            m_planes.normalX[slot] = source.normal.x;
+            m_planes.normalY[slot] = source.normal.y;
+            m_planes.normalZ[slot] = source.normal.z;
+            m_planes.material[slot] = material;
+            break;
+    }
+}
+
+const CompiledScene::Material& CompiledScene::getMaterial(const SceneHit& hit) const {
+    switch (hit.kind) {
+        case PrimitiveKind::Sphere: return m_materials[m_spheres.material[hit.index]];
+        case PrimitiveKind::Cube:   return m_materials[m_boxes.material[hit.index]];
+        default:                    return m_materials[m_planes.material[hit.index]];
+    }
+}
+
+ObjectHandle CompiledScene::getObjectHandle(const SceneHit& hit) const {
+    // Materials are stored per record, so their index finds the record
+    switch (hit.kind) {
+        case PrimitiveKind::Sphere: return m_records[m_spheres.material[hit.index]].handle;
+        case PrimitiveKind::Cube:   return m_records[m_boxes.material[hit.index]].handle;
+        case PrimitiveKind::Plane:  return m_records[m_planes.material[hit.index]].handle;
+        default:                    return ObjectHandle{};
+    }
+}
+
+Vec3 CompiledScene::getNormal(const SceneHit& hit, const Vec3& point) const {
+    size_t i = static_cast<size_t>(hit.index);
+
+    switch (hit.kind) {
+        case PrimitiveKind::Sphere: {
+            Vec3 center{m_spheres.centerX[i], m_spheres.centerY[i], m_spheres.centerZ[i]};
+            return (point - center).normalized();
+        }
+
+        case PrimitiveKind::Cube: {
+            // Face of the dominant axis, relative to the half extents so
+            // flat boxes get the face the point lies on
+            Vec3 d = point - Vec3{m_boxes.centerX[i], m_boxes.centerY[i], m_boxes.centerZ[i]};
+            Vec3 absD{std::abs(d.x) / m_boxes.halfExtentX[i], std::abs(d.y) / m_boxes.halfExtentY[i],
+                      std::abs(d.z) / m_boxes.halfExtentZ[i]};
+
+            if (absD.x > absD.y && absD.x > absD.z) return Vec3{sign(d.x), 0.0f, 0.0f};
+            if (absD.y > absD.x && absD.y > absD.z) return Vec3{0.0f, sign(d.y), 0.0f};
+            return Vec3{0.0f, 0.0f, sign(d.z)};
+        }
+
+        default:
+            return Vec3{m_planes.normalX[i], m_planes.normalY[i], m_planes.normalZ[i]};
+    }
+}
+
+bool CompiledScene::intersect(const Vec3& origin, const Vec3& direction, float tMax, SceneHit& hit) const {
+    hit.t = tMax;
+    hit.kind = PrimitiveKind::None;
+    hit.index = -1;
+
+    // In the order the packet kernels use, so both find the same hits
+    intersect(origin, direction, getUnindexedRange(), hit);
+
+    Vec3 invDir{1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+    traverse(direction,
+             [&](const AABB& bounds) { return entersBounds(bounds, origin, invDir, hit.t); },
+             [&](const BvhNode& leaf) {
+                 intersect(origin, direction, getLeafRange(leaf), hit);
+                 return true;
+             });
+
+    return hit.kind != PrimitiveKind::None;
+}
+
+void CompiledScene::intersect(const Vec3& origin, const Vec3& direction, const PrimitiveRange& range,
+                              SceneHit& hit) const {
+    float a = dot(direction, direction);
+
+    for (size_t i = range.sphereBegin; i < range.sphereEnd; ++i) {
+        Vec3 oc = origin - Vec3{m_spheres.centerX[i], m_spheres.centerY[i], m_spheres.centerZ[i]};
+        float b = 2.0f * dot(oc, direction);
+        float c = dot(oc, oc) - m_spheres.radius[i] * m_spheres.radius[i];
+        float discriminant = b * b - 4.0f * a * c;
+
+        if (discriminant < 0.0f) continue;
+
+        float sqrtD = std::sqrt(discriminant);
+        float t1 = (-b - sqrtD) / (2.0f * a);
+        float t2 = (-b + sqrtD) / (2.0f * a);
+        float t = t1 > EPSILON ? t1 : t2;
+
+        if (t > EPSILON && t < hit.t) {
+            hit.t = t;
+            hit.kind = PrimitiveKind::Sphere;
+            hit.index = static_cast<int>(i);
+        }
+    }
+
+    for (size_t i = range.planeBegin; i < range.planeEnd; ++i) {
+        Vec3 normal{m_planes.normalX[i], m_planes.normalY[i], m_planes.normalZ[i]};
+        float denom = dot(normal, direction);
+        if (std::abs(denom) < EPSILON) continue;
+
+        Vec3 point{m_planes.pointX[i], m_planes.pointY[i], m_planes.pointZ[i]};
+        float t = dot(point - origin, normal) / denom;
+
+        if (t > EPSILON && t < hit.t) {
+            hit.t = t;
+            hit.kind = PrimitiveKind::Plane;
+            hit.index = static_cast<int>(i);
+        }
+    }
+
+    Vec3 invDir{1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+
+    for (size_t i = range.boxBegin; i < range.boxEnd; ++i) {
+        Vec3 center{m_boxes.centerX[i], m_boxes.centerY[i], m_boxes.centerZ[i]};
+        Vec3 halfExtent{m_boxes.halfExtentX[i], m_boxes.halfExtentY[i], m_boxes.halfExtentZ[i]};
+
+        Vec3 t1 = (center - halfExtent - origin) * invDir;
+        Vec3 t2 = (center + halfExtent - origin) * invDir;
+
+        float tNear = std::max(std::max(std::min(t1.x, t2.x), std::min(t1.y, t2.y)), std::min(t1.z, t2.z));
+        float tFar = std::min(std::min(std::max(t1.x, t2.x), std::max(t1.y, t2.y)), std::max(t1.z, t2.z));
+
+        if (tNear > tFar || tFar < 0.0f) continue;
+
+        // As in the shader, a box the origin sits inside reports its exit
+        float t = tNear > EPSILON ? tNear : tFar;
+        if (t < hit.t) {
+            hit.t = t;
+            hit.kind = PrimitiveKind::Cube;
+            hit.index = static_cast<int>(i);
+        }
+    }
+}
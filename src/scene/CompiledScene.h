@@ -0,0 +1,247 @@
+#pragma once
+
+#include "Object.h"
+#include "ObjectHandle.h"
+#include "math/AABB.h"
+#include "math/Vec3.h"
+#include "utils/AlignedAllocator.h"
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class Scene;
+
+enum class PrimitiveKind {
+    None = -1,
+    Sphere,
+    Plane,
+    Cube
+};
+
+struct SceneHit {
+    float t = 0.0f;
+    PrimitiveKind kind = PrimitiveKind::None;
+    int index = -1;     // Into the arrays of that kind
+};
+
+// Runs of each kind's arrays that one intersection loop tests
+struct PrimitiveRange {
+    size_t sphereBegin = 0, sphereEnd = 0;
+    size_t planeBegin = 0, planeEnd = 0;
+    size_t boxBegin = 0, boxEnd = 0;
+};
+
+// Flat structure-of-arrays copy of the scene's visible spheres, cubes and
+// planes for CPU ray queries. Loops over one kind touch only the arrays
+// they need, contiguous and 32-byte aligned, instead of visiting every
+// object in the scene. Materials are stored once per object and
+// referenced by index.
+//
+// Spheres and cubes are indexed by a bounding volume hierarchy whose
+// leaves each own a run of both kinds' arrays, so a leaf is tested with
+// the same loops as a whole array. Planes are unbounded and always
+// tested. Primitives added since the hierarchy was built sit past the
+// indexed runs and are tested one by one until it is built again.
+class CompiledScene {
+public:
+    struct Material {
+        Vec3 color;
+        Vec3 emission;
+        int type = 0;
+        float roughness = 0.0f;
+        float ior = 1.5f;
+        float metalness = 0.0f;
+    };
+
+    struct Spheres {
+        AlignedVector<float> centerX, centerY, centerZ;
+        AlignedVector<float> radius;
+        std::vector<int> material;
+
+        size_t size() const { return radius.size(); }
+    };
+
+    // Axis-aligned cubes
+    struct Boxes {
+        AlignedVector<float> centerX, centerY, centerZ;
+        AlignedVector<float> halfExtentX, halfExtentY, halfExtentZ;
+        std::vector<int> material;
+
+        size_t size() const { return halfExtentX.size(); }
+    };
+
+    struct Planes {
+        AlignedVector<float> pointX, pointY, pointZ;
+        AlignedVector<float> normalX, normalY, normalZ;
+        std::vector<int> material;
+
+        size_t size() const { return normalX.size(); }
+    };
+
+    struct BvhNode {
+        AABB bounds;                // Inverted while the node holds nothing
+        uint32_t parent = 0;
+        uint32_t child = 0;         // First of two adjacent children; 0 for leaves
+        uint32_t sphereBegin = 0, sphereEnd = 0;
+        uint32_t boxBegin = 0, boxEnd = 0;
+        int axis = 0;               // Of the split, in inner nodes
+
+        bool isLeaf() const { return child == 0; }
+        bool isEmpty() const { return bounds.min.x > bounds.max.x; }
+    };
+
+    // Compiles every visible object of the scene afresh
+    void compile(const Scene& scene);
+    // Catches up on the listed objects alone, added, removed, edited or
+    // hidden since the last call: edits are patched in place, and a
+    // removal moves the last record and primitive of its kind into the gap.
+    // Returns true if anything changed.
+    bool update(const Scene& scene, std::span<const ObjectHandle> changes);
+
+    // Flat copy of the compiled objects for other processes on this machine;
+    // host byte order and layout, so both ends must run the same build.
+    // deserialize leaves the scene unchanged and returns false on malformed data.
+    void serialize(std::vector<uint8_t>& out) const;
+    bool deserialize(const uint8_t* data, size_t size);
+
+    // Bounds of the objects that differ from previous, at both their old and
+    // new placement. Returns false when a change has no finite bounds, as
+    // with an edited plane, or either side was deserialized.
+    bool getChangedBounds(const CompiledScene& previous, std::vector<AABB>& bounds) const;
+
+    // Changes on every modification; unique across instances
+    uint64_t getRevision() const { return m_revision; }
+    // Hash of the compiled objects' geometry and materials alone, in no
+    // particular order: scenes of equal content hash alike whatever their
+    // record order, handles or process
+    uint64_t getContentHash() const;
+
+    const Spheres& getSpheres() const { return m_spheres; }
+    // Spheres past this index are not in the hierarchy yet
+    size_t getIndexedSphereCount() const { return m_indexedSpheres; }
+    size_t getIndexedBoxCount() const { return m_indexedBoxes; }
+    const std::vector<BvhNode>& getBvh() const { return m_bvh; }
+    const Boxes& getBoxes() const { return m_boxes; }
+    const Planes& getPlanes() const { return m_planes; }
+    const std::vector<Material>& getMaterials() const { return m_materials; }
+    bool empty() const { return m_records.empty(); }
+
+    const Material& getMaterial(const SceneHit& hit) const;
+    ObjectHandle getObjectHandle(const SceneHit& hit) const;
+    Vec3 getNormal(const SceneHit& hit, const Vec3& point) const;
+
+    // Closest hit along a ray, with the same rules as pathtracer.frag
+    bool intersect(const Vec3& origin, const Vec3& direction, float tMax, SceneHit& hit) const;
+    // Tests range alone, replacing hit where a primitive is closer than hit.t
+    void intersect(const Vec3& origin, const Vec3& direction, const PrimitiveRange& range, SceneHit& hit) const;
+
+    // Whether a ray with the given inverse direction passes through bounds
+    // closer than tMax
+    static bool entersBounds(const AABB& bounds, const Vec3& origin, const Vec3& invDirection, float tMax) {
+        float tNear = 0.0f;
+        float tFar = tMax;
+        for (int axis = 0; axis < 3; ++axis) {
+            float t1 = (bounds.min[axis] - origin[axis]) * invDirection[axis];
+            float t2 = (bounds.max[axis] - origin[axis]) * invDirection[axis];
+            tNear = std::max(tNear, std::min(t1, t2));
+            tFar = std::min(tFar, std::max(t1, t2));
+        }
+        return tNear <= tFar;
+    }
+
+    // What lies outside the hierarchy: planes and unindexed primitives
+    PrimitiveRange getUnindexedRange() const;
+    static PrimitiveRange getLeafRange(const BvhNode& leaf);
+
+    // Depth first through the hierarchy, into the nearer child first along
+    // direction. Enters nodes whose bounds pass enters(bounds) and calls
+    // leaf(node) on each leaf reached, stopping once it returns false.
+    template <typename Enters, typename Leaf>
+    void traverse(const Vec3& direction, Enters&& enters, Leaf&& leaf) const {
+        if (m_bvh.empty()) return;
+
+        uint32_t stack[MAX_BVH_DEPTH];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const BvhNode& node = m_bvh[stack[--top]];
+            if (node.isEmpty() || !enters(node.bounds)) continue;
+
+            if (node.isLeaf()) {
+                if (!leaf(node)) return;
+                continue;
+            }
+            uint32_t nearer = direction[node.axis] < 0.0f ? 1u : 0u;
+            stack[top++] = node.child + (1u - nearer);
+            stack[top++] = node.child + nearer;
+        }
+    }
+
+    static constexpr float EPSILON = 0.0001f;
+    static constexpr uint32_t BVH_LEAF_SIZE = 4;
+    // Median splits halve every level, so no build comes near this
+    static constexpr int MAX_BVH_DEPTH = 64;
+
+private:
+    // Everything the arrays are built from; no padding, so memcmp compares it
+    struct Source {
+        ObjectType type;
+        Vec3 position;
+        Vec3 scale;
+        Vec3 normal;
+        Vec3 color;
+        Vec3 emission;
+        int materialType;
+        float roughness;
+        float ior;
+        float metalness;
+    };
+
+    // One per compiled object, in no particular order; its index is also
+    // that of its material
+    struct Record {
+        ObjectHandle handle;
+        int slot = -1;  // Index in the arrays of its kind
+        Source source;
+    };
+
+    static constexpr size_t RECORD_BYTES = sizeof(ObjectHandle) + sizeof(Source);
+    static constexpr uint32_t NO_RECORD = UINT32_MAX;
+
+    void rebuild();
+    void buildBvh();
+    // Recomputes a leaf's bounds and those of its ancestors that change
+    void refit(uint32_t node);
+    void refitPrimitive(ObjectType type, size_t slot);
+    void writeRecord(size_t recordIndex);
+    void addRecord(ObjectHandle handle, const Source& source);
+    void removeRecord(uint32_t recordIndex);
+    void resizeKind(ObjectType type, size_t count);
+    size_t getKindSize(ObjectType type) const;
+    int getKindMaterial(ObjectType type, size_t slot) const;
+    const Record* findRecord(ObjectHandle handle) const;
+    static bool getSource(const Scene& scene, ObjectHandle handle, Source& source);
+    static bool getBounds(const Source& source, AABB& bounds);
+
+    static uint64_t nextRevision();
+
+    std::vector<Record> m_records;
+    // Record of each handle slot; empty in deserialized scenes, whose
+    // handles are another process's
+    std::vector<uint32_t> m_recordOf;
+
+    Spheres m_spheres;
+    Boxes m_boxes;
+    Planes m_planes;
+    std::vector<Material> m_materials;
+
+    std::vector<BvhNode> m_bvh;
+    size_t m_indexedSpheres = 0;
+    size_t m_indexedBoxes = 0;
+    // Leaf of each indexed primitive
+    std::vector<uint32_t> m_sphereLeaf;
+    std::vector<uint32_t> m_boxLeaf;
+
+    uint64_t m_revision = nextRevision();
+};
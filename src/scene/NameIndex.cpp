@@ -0,0 +1,90 @@
+#include "NameIndex.h"
+
+uint32_t NameIndex::intern(std::string_view name) {
+    auto it = m_ids.find(name);
+    if (it != m_ids.end()) return it->second;
+
+    uint32_t id;
+    if (!m_freeEntries.empty()) {
+        id = m_freeEntries.back();
+        m_freeEntries.pop_back();
+        m_entries[id].text = name;
+    } else {
+        id = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back({std::string(name), {}});
+    }
+    m_ids.emplace(m_entries[id].text, id);
+    return id;
+}
+
+void NameIndex::insert(ObjectHandle handle, std::string_view name) {
+    if (handle.slot >= m_listings.size()) {
+        m_listings.resize(handle.slot + 1);
+    }
+
+    uint32_t id = intern(name);
+    Entry& entry = m_entries[id];
+    m_listings[handle.slot] = {id, static_cast<uint32_t>(entry.holders.size())};
+    entry.holders.push_back(handle);
+}
+
+void NameIndex::erase(ObjectHandle handle) {
+    Listing listing = m_listings[handle.slot];
+    Entry& entry = m_entries[listing.entry];
+
+    // Swap-remove, like the scene's own arrays
+    ObjectHandle moved = entry.holders.back();
+    entry.holders[listing.position] = moved;
+    m_listings[moved.slot].position = listing.position;
+    entry.holders.pop_back();
+    m_listings[handle.slot] = Listing{};
+
+    // Names nobody bears any more are dropped, so renaming through every
+    // keystroke of a text field does not pile them up
+    if (entry.holders.empty()) {
+        m_ids.erase(entry.text);
+        m_freeEntries.push_back(listing.entry);
+    }
+}
+
+void NameIndex::rename(ObjectHandle handle, std::string_view name) {
+    // Also keeps name valid if it views this object's own entry
+    if (getName(handle) == name) return;
+
+    erase(handle);
+    insert(handle, name);
+}
+
+void NameIndex::clear() {
+    m_entries.clear();
+    m_ids.clear();
+    m_freeEntries.clear();
+    m_listings.clear();
+    m_suffixes.clear();
+}
+
+void NameIndex::reserve(size_t count) {
+    m_ids.reserve(count);
+    m_listings.reserve(count);
+}
+
+const std::string& NameIndex::getName(ObjectHandle handle) const {
+    return m_entries[m_listings[handle.slot].entry].text;
+}
+
+std::span<const ObjectHandle> NameIndex::find(std::string_view name) const {
+    auto it = m_ids.find(name);
+    if (it == m_ids.end()) return {};
+    return m_entries[it->second].holders;
+}
+
+std::string NameIndex::makeUnique(std::string_view base) {
+    // The counter only rises, so each call probes about once however many
+    // names were made from base before
+    uint32_t& next = m_suffixes[std::string(base)];
+    std::string name;
+    do {
+        name = std::string(base) + "_" + std::to_string(++next);
+    } while (contains(name));
+    return name;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ObjectHandle.h"
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Object names, interned: each distinct name is stored and hashed once and
+// lists the objects that bear it. Objects are tracked by handle slot, so
+// lookups, renames and removals cost the same in any scene size. Names
+// need not be unique; makeUnique hands out ones that are.
+class NameIndex {
+public:
+    // The handle must not be in the index yet
+    void insert(ObjectHandle handle, std::string_view name);
+    // The handle must be in the index
+    void erase(ObjectHandle handle);
+    void rename(ObjectHandle handle, std::string_view name);
+    void clear();
+    void reserve(size_t count);
+
+    // The handle must be in the index
+    const std::string& getName(ObjectHandle handle) const;
+    // Every object called name, in no particular order; empty if none
+    std::span<const ObjectHandle> find(std::string_view name) const;
+    bool contains(std::string_view name) const { return m_ids.count(name) != 0; }
+
+    // base + "_<n>" for the next n no object is called, counting on from
+    // the last name made for base
+    std::string makeUnique(std::string_view base);
+
+private:
+    struct Entry {
+        std::string text;
+        std::vector<ObjectHandle> holders;
+    };
+
+    // Where a slot's object is listed
+    struct Listing {
+        uint32_t entry = NONE;
+        uint32_t position = 0;
+    };
+
+    uint32_t intern(std::string_view name);
+
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    std::deque<Entry> m_entries;    // Never moves, so the keys can view the text
+    std::unordered_map<std::string_view, uint32_t> m_ids;
+    std::vector<uint32_t> m_freeEntries;
+    std::vector<Listing> m_listings;    // By handle slot
+    std::unordered_map<std::string, uint32_t> m_suffixes;
+};
@@ -12,20 +12,18 @@ enum class ObjectType {
     Mesh  // For future expansion
 };
 
-// Forward declarations
-class ShaderProgram;
-class Renderer;
-
+// One object's components by value. The scene keeps each component in
+// its own dense array (see Scene); Object is how they are built, copied
+// and carried through the scene file formats.
 class Object {
 public:
+    Object() = default;
     Object(const std::string& name, ObjectType type);
-    virtual ~Object() = default;
-    
-    virtual void update(float dt);
-    virtual void render(Renderer& renderer) const;
     
     // Geometry data access for ray tracing
-    virtual void getIntersectionData(struct IntersectionData& data) const;
+    void getIntersectionData(struct IntersectionData& data) const;
+    static void getIntersectionData(ObjectType type, const Transform& transform, const Material& material,
+                                    struct IntersectionData& data);
     
     // Accessors
     const std::string& getName() const { return m_name; }
@@ -42,19 +40,15 @@ public:
     Vec3 getScale() const { return m_transform.scale; }
     void setScale(const Vec3& scale) { m_transform.scale = scale; }
     
-    bool isSelected() const { return m_selected; }
-    void setSelected(bool selected) { m_selected = selected; }
-    
     // For editor visibility
     bool isVisible() const { return m_visible; }
     void setVisible(bool visible) { m_visible = visible; }
 
 private:
     std::string m_name;
-    ObjectType m_type;
+    ObjectType m_type = ObjectType::Sphere;
     Transform m_transform;
     Material m_material;
-    bool m_selected = false;
     bool m_visible = true;
 };
 
@@ -70,6 +64,7 @@ struct IntersectionData {
     float metalness;
     Vec3 emission;
     Vec3 normal; // For planes
+    int objectId = -1; // Index of the owning object in the scene
     
     // For meshes
     unsigned int vertexCount = 0;
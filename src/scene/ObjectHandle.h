@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// Names a scene object independently of where its components sit in the
+// dense arrays. The slot is reused after the object is removed, but with
+// a new generation, so handles kept past a removal are detected as stale
+// instead of silently naming another object.
+struct ObjectHandle {
+    uint32_t slot = INVALID_SLOT;
+    uint32_t generation = 0;
+
+    // Only says the handle was issued; the scene decides if it is current
+    bool isNull() const { return slot == INVALID_SLOT; }
+
+    bool operator==(const ObjectHandle& other) const = default;
+
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+};
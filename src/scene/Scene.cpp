@@ -1,5 +1,8 @@
 #include "Scene.h"
 #include "Material.h"
+#include "SceneFile.h"
+#include "SceneJson.h"
+#include "SceneLoader.h"
 #include "core/Logger.h"
 #include "utils/Random.h"
 
@@ -7,161 +10,360 @@ Scene::Scene() {
     LOG_INFO("Scene created");
 }
 
-void Scene::update(float dt) {
-    for (auto& object : m_objects) {
-        object->update(dt);
+Scene::~Scene() = default;
+
+void Scene::update(float /*dt*/) {
+    // Objects read since the last frame join the scene here, between
+    // frames, so nothing sees the object arrays change mid-frame
+    if (m_loader) {
+        std::vector<Object> arrived;
+        m_loader->takeObjects(arrived, MAX_LOADED_PER_FRAME);
+        for (Object& object : arrived) {
+            addObject(std::move(object));
+        }
+    }
+}
+
+void Scene::loadFromDiskAsync(const std::string& filePath) {
+    clear();
+    m_loader = std::make_unique<SceneLoader>(filePath);
+}
+
+void Scene::cancelLoad() {
+    if (m_loader) {
+        m_loader->cancel();
+    }
+}
+
+bool Scene::isLoading() const {
+    return m_loader && (!m_loader->isDone() || m_loader->getReadyCount() > 0);
+}
+
+const CompiledScene& Scene::getCompiledScene() const {
+    if (m_recompile) {
+        m_compiled.compile(*this);
+        m_recompile = false;
+    } else if (!m_changes.empty()) {
+        m_compiled.update(*this, m_changes);
+    }
+    
+    for (ObjectHandle handle : m_changes) {
+        m_changeLogged[handle.slot] = 0;
+    }
+    m_changes.clear();
+    return m_compiled;
+}
+
+void Scene::markChanged(ObjectHandle handle) {
+    if (handle.slot >= m_changeLogged.size()) {
+        m_changeLogged.resize(m_slots.size());
+    }
+    if (!m_changeLogged[handle.slot]) {
+        m_changeLogged[handle.slot] = 1;
+        m_changes.push_back(handle);
     }
 }
 
+std::shared_ptr<const CompiledScene> Scene::getSnapshot() const {
+    const CompiledScene& compiled = getCompiledScene();
+    if (!m_snapshot || m_snapshot->getRevision() != compiled.getRevision()) {
+        m_snapshot = std::make_shared<const CompiledScene>(compiled);
+    }
+    return m_snapshot;
+}
+
+void Scene::intersect(std::span<const Ray> rays, std::span<RayHit> hits, float maxDistance) const {
+    SceneQuery::intersect(getCompiledScene(), rays, hits, maxDistance);
+}
+
+void Scene::occluded(std::span<const Ray> rays, std::span<const float> distances, std::span<uint8_t> occluded) const {
+    SceneQuery::occluded(getCompiledScene(), rays, distances, occluded);
+}
+
 void Scene::createDefaultScene() {
     LOG_INFO("Creating default scene...");
     
     // Center sphere - metallic with some roughness
-    auto centerSphere = std::make_unique<Object>("Metal Sphere", ObjectType::Sphere);
-    centerSphere->getTransform().position = {0, 1, 0};
-    centerSphere->getTransform().scale = {1, 1, 1};
-    centerSphere->getMaterial().color = {0.7f, 0.6f, 0.5f};
-    centerSphere->getMaterial().type = MaterialType::Metal;
-    centerSphere->getMaterial().roughness = 0.1f;
-    centerSphere->getMaterial().metalness = 1.0f;
+    Object centerSphere("Metal Sphere", ObjectType::Sphere);
+    centerSphere.getTransform().position = {0, 1, 0};
+    centerSphere.getTransform().scale = {1, 1, 1};
+    centerSphere.getMaterial().color = {0.7f, 0.6f, 0.5f};
+    centerSphere.getMaterial().type = MaterialType::Metal;
+    centerSphere.getMaterial().roughness = 0.1f;
+    centerSphere.getMaterial().metalness = 1.0f;
     addObject(std::move(centerSphere));
     
     // Left sphere - diffuse
-    auto leftSphere = std::make_unique<Object>("Diffuse Sphere", ObjectType::Sphere);
-    leftSphere->getTransform().position = {-2, 1, 0};
-    leftSphere->getTransform().scale = {1, 1, 1};
-    leftSphere->getMaterial().color = {0.1f, 0.2f, 0.5f};
-    leftSphere->getMaterial().type = MaterialType::Diffuse;
-    leftSphere->getMaterial().roughness = 1.0f;
+    Object leftSphere("Diffuse Sphere", ObjectType::Sphere);
+    leftSphere.getTransform().position = {-2, 1, 0};
+    leftSphere.getTransform().scale = {1, 1, 1};
+    leftSphere.getMaterial().color = {0.1f, 0.2f, 0.5f};
+    leftSphere.getMaterial().type = MaterialType::Diffuse;
+    leftSphere.getMaterial().roughness = 1.0f;
     addObject(std::move(leftSphere));
     
     // Right sphere - glass
-    auto rightSphere = std::make_unique<Object>("Glass Sphere", ObjectType::Sphere);
-    rightSphere->getTransform().position = {2, 1, 0};
-    rightSphere->getTransform().scale = {1, 1, 1};
-    rightSphere->getMaterial().color = {1.0f, 1.0f, 1.0f};
-    rightSphere->getMaterial().type = MaterialType::Dielectric;
-    rightSphere->getMaterial().ior = 1.5f;
+    Object rightSphere("Glass Sphere", ObjectType::Sphere);
+    rightSphere.getTransform().position = {2, 1, 0};
+    rightSphere.getTransform().scale = {1, 1, 1};
+    rightSphere.getMaterial().color = {1.0f, 1.0f, 1.0f};
+    rightSphere.getMaterial().type = MaterialType::Dielectric;
+    rightSphere.getMaterial().ior = 1.5f;
     addObject(std::move(rightSphere));
     
     // Cube
-    auto cube = std::make_unique<Object>("Cube", ObjectType::Cube);
-    cube->getTransform().position = {0, 1.5f, 3.0f};
-    cube->getTransform().scale = {1.5f, 1.5f, 1.5f};
-    cube->getMaterial().color = {0.3f, 0.5f, 0.7f};
-    cube->getMaterial().type = MaterialType::Diffuse;
+    Object cube("Cube", ObjectType::Cube);
+    cube.getTransform().position = {0, 1.5f, 3.0f};
+    cube.getTransform().scale = {1.5f, 1.5f, 1.5f};
+    cube.getMaterial().color = {0.3f, 0.5f, 0.7f};
+    cube.getMaterial().type = MaterialType::Diffuse;
     addObject(std::move(cube));
     
     // Floor plane
-    auto plane = std::make_unique<Object>("Floor", ObjectType::Plane);
-    plane->getTransform().position = {0, 0, 0};
-    plane->getTransform().scale = {20, 1, 20};
-    plane->getMaterial().color = {0.8f, 0.8f, 0.8f};
-    plane->getMaterial().type = MaterialType::Diffuse;
+    Object plane("Floor", ObjectType::Plane);
+    plane.getTransform().position = {0, 0, 0};
+    plane.getTransform().scale = {20, 1, 20};
+    plane.getMaterial().color = {0.8f, 0.8f, 0.8f};
+    plane.getMaterial().type = MaterialType::Diffuse;
     addObject(std::move(plane));
     
     // Small sphere - emissive light source
-    auto lightSphere = std::make_unique<Object>("Light Sphere", ObjectType::Sphere);
-    lightSphere->getTransform().position = {0, 4, 1};
-    lightSphere->getTransform().scale = {0.5f, 0.5f, 0.5f};
-    lightSphere->getMaterial().color = {1.0f, 1.0f, 1.0f};
-    lightSphere->getMaterial().type = MaterialType::Diffuse;
-    lightSphere->getMaterial().emission = {5.0f, 4.5f, 4.0f}; // Bright white-yellowish light
+    Object lightSphere("Light Sphere", ObjectType::Sphere);
+    lightSphere.getTransform().position = {0, 4, 1};
+    lightSphere.getTransform().scale = {0.5f, 0.5f, 0.5f};
+    lightSphere.getMaterial().color = {1.0f, 1.0f, 1.0f};
+    lightSphere.getMaterial().type = MaterialType::Diffuse;
+    lightSphere.getMaterial().emission = {5.0f, 4.5f, 4.0f}; // Bright white-yellowish light
     addObject(std::move(lightSphere));
     
     // Small blue emissive sphere
-    auto blueLightSphere = std::make_unique<Object>("Blue Light", ObjectType::Sphere);
-    blueLightSphere->getTransform().position = {-3, 0.5f, 2};
-    blueLightSphere->getTransform().scale = {0.3f, 0.3f, 0.3f};
-    blueLightSphere->getMaterial().color = {0.2f, 0.3f, 1.0f};
-    blueLightSphere->getMaterial().type = MaterialType::Diffuse;
-    blueLightSphere->getMaterial().emission = {0.0f, 1.0f, 5.0f}; // Blue light
+    Object blueLightSphere("Blue Light", ObjectType::Sphere);
+    blueLightSphere.getTransform().position = {-3, 0.5f, 2};
+    blueLightSphere.getTransform().scale = {0.3f, 0.3f, 0.3f};
+    blueLightSphere.getMaterial().color = {0.2f, 0.3f, 1.0f};
+    blueLightSphere.getMaterial().type = MaterialType::Diffuse;
+    blueLightSphere.getMaterial().emission = {0.0f, 1.0f, 5.0f}; // Blue light
     addObject(std::move(blueLightSphere));
     
-    LOG_INFO("Default scene created with {} objects", m_objects.size());
+    LOG_INFO("Default scene created with {} objects", m_handles.size());
 }
 
-void Scene::addObject(std::unique_ptr<Object> object) {
-    m_objects.push_back(std::move(object));
-}
-
-void Scene::removeObject(int index) {
-    if (index >= 0 && index < static_cast<int>(m_objects.size())) {
-        if (m_objects[index].get() == m_selectedObject) {
-            m_selectedObject = nullptr;
-        }
-        m_objects.erase(m_objects.begin() + index);
-        LOG_DEBUG("Object at index {} removed", index);
+ObjectHandle Scene::addObject(Object object) {
+    uint32_t index = static_cast<uint32_t>(m_handles.size());
+    ObjectHandle handle;
+    if (!m_freeSlots.empty()) {
+        handle.slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
     } else {
-        LOG_WARN("Attempted to remove object with invalid index: {}", index);
+        handle.slot = static_cast<uint32_t>(m_slots.size());
+        m_slots.emplace_back();
     }
+    Slot& slot = m_slots[handle.slot];
+    slot.index = index;
+    handle.generation = slot.generation;
+    
+    m_names.insert(handle, object.getName());
+    m_types.push_back(object.getType());
+    m_transforms.push_back(object.getTransform());
+    m_materials.push_back(object.getMaterial());
+    m_flags.push_back(object.isVisible() ? FLAG_VISIBLE : 0);
+    m_handles.push_back(handle);
+    markChanged(handle);
+    return handle;
 }
 
-int Scene::getSelectedIndex() const {
-    if (!m_selectedObject) return -1;
+bool Scene::removeObject(ObjectHandle handle) {
+    int index = getObjectIndex(handle);
+    if (index < 0) {
+        LOG_WARN("Attempted to remove an object that is no longer in the scene");
+        return false;
+    }
     
-    for (int i = 0; i < static_cast<int>(m_objects.size()); ++i) {
-        if (m_objects[i].get() == m_selectedObject) {
-            return i;
-        }
+    // The last object moves into the gap, so nothing else shifts
+    size_t last = m_handles.size() - 1;
+    if (static_cast<size_t>(index) != last) {
+        m_types[index] = m_types[last];
+        m_transforms[index] = m_transforms[last];
+        m_materials[index] = m_materials[last];
+        m_flags[index] = m_flags[last];
+        m_handles[index] = m_handles[last];
+        m_slots[m_handles[index].slot].index = static_cast<uint32_t>(index);
+    }
+    m_types.pop_back();
+    m_transforms.pop_back();
+    m_materials.pop_back();
+    m_flags.pop_back();
+    m_handles.pop_back();
+    
+    m_names.erase(handle);
+    markChanged(handle);
+    ++m_slots[handle.slot].generation;
+    m_freeSlots.push_back(handle.slot);
+    // The removal stays logged; whatever reuses the slot logs itself
+    m_changeLogged[handle.slot] = 0;
+    if (handle == m_selectedObject) {
+        m_selectedObject = ObjectHandle{};
     }
-    return -1;
+    LOG_DEBUG("Object at index {} removed", index);
+    return true;
 }
 
-int Scene::getObjectIndex(const Object* object) const {
-    if (!object) return -1;
+int Scene::getObjectIndex(ObjectHandle handle) const {
+    if (handle.slot >= m_slots.size()) return -1;
     
-    for (int i = 0; i < static_cast<int>(m_objects.size()); ++i) {
-        if (m_objects[i].get() == object) {
-            return i;
-        }
+    const Slot& slot = m_slots[handle.slot];
+    return slot.generation == handle.generation ? static_cast<int>(slot.index) : -1;
+}
+
+ObjectHandle Scene::getObjectByName(std::string_view name) const {
+    std::span<const ObjectHandle> objects = m_names.find(name);
+    return objects.empty() ? ObjectHandle{} : objects.front();
+}
+
+Transform* Scene::getTransform(ObjectHandle handle) {
+    int index = getObjectIndex(handle);
+    if (index < 0) return nullptr;
+    markChanged(handle);
+    return &m_transforms[index];
+}
+
+Material* Scene::getMaterial(ObjectHandle handle) {
+    int index = getObjectIndex(handle);
+    if (index < 0) return nullptr;
+    markChanged(handle);
+    return &m_materials[index];
+}
+
+const std::string* Scene::getName(ObjectHandle handle) const {
+    return isValid(handle) ? &m_names.getName(handle) : nullptr;
+}
+
+void Scene::setName(ObjectHandle handle, const std::string& name) {
+    if (isValid(handle)) {
+        m_names.rename(handle, name);
     }
-    return -1;
 }
 
-Object* Scene::getObjectByName(const std::string& name) {
-    for (auto& object : m_objects) {
-        if (object->getName() == name) {
-            return object.get();
-        }
+void Scene::setVisible(ObjectHandle handle, bool visible) {
+    setFlag(handle, FLAG_VISIBLE, visible);
+    if (isValid(handle)) {
+        markChanged(handle);
+    }
+}
+
+void Scene::setSelected(ObjectHandle handle, bool selected) {
+    setFlag(handle, FLAG_SELECTED, selected);
+}
+
+void Scene::setFlag(ObjectHandle handle, uint8_t flag, bool enabled) {
+    int index = getObjectIndex(handle);
+    if (index < 0) return;
+    
+    if (enabled) {
+        m_flags[index] |= flag;
+    } else {
+        m_flags[index] &= static_cast<uint8_t>(~flag);
     }
-    return nullptr;
+}
+
+Object Scene::getObject(int index) const {
+    Object object(getName(index), m_types[index]);
+    object.getTransform() = m_transforms[index];
+    object.getMaterial() = m_materials[index];
+    object.setVisible(isVisible(index));
+    return object;
+}
+
+void Scene::getIntersectionData(int index, IntersectionData& data) const {
+    Object::getIntersectionData(m_types[index], m_transforms[index], m_materials[index], data);
 }
 
 void Scene::clear() {
-    m_objects.clear();
-    m_selectedObject = nullptr;
+    m_loader.reset();
+    // Every slot is retired rather than dropped, so no handle issued
+    // before the clear can match an object added after it
+    for (ObjectHandle handle : m_handles) {
+        ++m_slots[handle.slot].generation;
+        m_freeSlots.push_back(handle.slot);
+    }
+    for (ObjectHandle handle : m_changes) {
+        m_changeLogged[handle.slot] = 0;
+    }
+    m_changes.clear();
+    m_recompile = true;
+    m_names.clear();
+    m_types.clear();
+    m_transforms.clear();
+    m_materials.clear();
+    m_flags.clear();
+    m_handles.clear();
+    m_selectedObject = ObjectHandle{};
     LOG_INFO("Scene cleared");
 }
 
-void Scene::saveToDisk(const std::string& filePath) {
-    // TODO: Implement scene serialization to JSON or binary format
+bool Scene::saveToDisk(const std::string& filePath) const {
+    bool saved = SceneJson::isJsonPath(filePath) ? SceneJson::write(filePath, *this) : SceneFile::write(filePath, *this);
+    if (!saved) return false;
     LOG_INFO("Scene saved to '{}'", filePath);
+    return true;
 }
 
 bool Scene::loadFromDisk(const std::string& filePath) {
-    // TODO: Implement scene loading from file
-    LOG_INFO("Scene loaded from '{}'", filePath);
+    std::vector<Object> objects;
+    if (SceneJson::isJsonPath(filePath)) {
+        if (!SceneJson::read(filePath, objects)) return false;
+    } else {
+        SceneFile file;
+        if (!file.open(filePath)) {
+            LOG_ERROR("Cannot load scene '{}'", filePath);
+            return false;
+        }
+        
+        objects.resize(file.getObjectCount());
+        for (size_t i = 0; i < objects.size(); ++i) {
+            if (!file.readObject(i, objects[i])) {
+                LOG_ERROR("Scene '{}' has an object of unknown type at index {}", filePath, i);
+                return false;
+            }
+        }
+    }
+    
+    clear();
+    reserve(objects.size());
+    for (Object& object : objects) {
+        addObject(std::move(object));
+    }
+    LOG_INFO("Scene loaded from '{}' with {} objects", filePath, m_handles.size());
     return true;
 }
 
+void Scene::reserve(size_t count) {
+    m_names.reserve(count);
+    m_types.reserve(count);
+    m_transforms.reserve(count);
+    m_materials.reserve(count);
+    m_flags.reserve(count);
+    m_handles.reserve(count);
+    m_slots.reserve(count);
+}
+
 std::unique_ptr<Scene> Scene::createEmptyScene() {
     auto scene = std::make_unique<Scene>();
     
     // Add a default floor plane
-    auto plane = std::make_unique<Object>("Floor", ObjectType::Plane);
-    plane->getTransform().position = {0, 0, 0};
-    plane->getTransform().scale = {20, 1, 20};
-    plane->getMaterial().color = {0.8f, 0.8f, 0.8f};
-    plane->getMaterial().type = MaterialType::Diffuse;
+    Object plane("Floor", ObjectType::Plane);
+    plane.getTransform().position = {0, 0, 0};
+    plane.getTransform().scale = {20, 1, 20};
+    plane.getMaterial().color = {0.8f, 0.8f, 0.8f};
+    plane.getMaterial().type = MaterialType::Diffuse;
     scene->addObject(std::move(plane));
     
     // Add a light source
-    auto light = std::make_unique<Object>("Light", ObjectType::Sphere);
-    light->getTransform().position = {0, 5, 0};
-    light->getTransform().scale = {0.5f, 0.5f, 0.5f};
-    light->getMaterial().color = {1.0f, 1.0f, 1.0f};
-    light->getMaterial().emission = {5.0f, 5.0f, 5.0f};
+    Object light("Light", ObjectType::Sphere);
+    light.getTransform().position = {0, 5, 0};
+    light.getTransform().scale = {0.5f, 0.5f, 0.5f};
+    light.getMaterial().color = {1.0f, 1.0f, 1.0f};
+    light.getMaterial().emission = {5.0f, 5.0f, 5.0f};
     scene->addObject(std::move(light));
     
     LOG_INFO("Empty scene created with default floor and light");
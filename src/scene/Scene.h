@@ -1,14 +1,30 @@
 #pragma once
 
 #include "Object.h"
+#include "ObjectHandle.h"
+#include "NameIndex.h"
+#include "CompiledScene.h"
+#include "SceneQuery.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 
+class SceneLoader;
+
+// Objects are stored as parallel component arrays (types, transforms,
+// materials, flags), dense and in no particular order: a
+// removal moves the last object into the gap. Dense indices are what the
+// renderers and ray queries see and are only stable between removals;
+// anything kept longer holds an ObjectHandle. Names live in a NameIndex,
+// so finding objects by name takes constant time. Mutators log the objects
+// they touch, so the compiled scene catches up on those alone.
 class Scene {
 public:
     Scene();
-    ~Scene() = default;
+    ~Scene();
     
     void update(float dt);
     
@@ -17,30 +33,122 @@ public:
     void clear();
     
     // Object management
-    void addObject(std::unique_ptr<Object> object);
-    void removeObject(int index);
+    ObjectHandle addObject(Object object);
+    // Swap-remove; false if the handle is stale
+    bool removeObject(ObjectHandle handle);
+    // Room for count objects in every component array
+    void reserve(size_t count);
     
     // Object access
-    const std::vector<std::unique_ptr<Object>>& getObjects() const { return m_objects; }
-    std::vector<std::unique_ptr<Object>>& getObjects() { return m_objects; }
+    int getObjectCount() const { return static_cast<int>(m_handles.size()); }
+    // Dense index of the object, -1 for a stale or null handle
+    int getObjectIndex(ObjectHandle handle) const;
+    ObjectHandle getHandle(int index) const { return m_handles[index]; }
+    // Handle of each dense index
+    std::span<const ObjectHandle> getHandles() const { return m_handles; }
+    bool isValid(ObjectHandle handle) const { return getObjectIndex(handle) >= 0; }
+    // Any one object called name; a null handle if there is none
+    ObjectHandle getObjectByName(std::string_view name) const;
+    // Every object called name, in no particular order
+    std::span<const ObjectHandle> findObjects(std::string_view name) const { return m_names.find(name); }
+    // base + "_<n>", not yet used by any object
+    std::string makeUniqueName(std::string_view base) { return m_names.makeUnique(base); }
+    
+    // The component arrays, indexed alike and read-only; edits go through
+    // a handle. Adds and removes invalidate spans and pointers into them.
+    const std::string& getName(int index) const { return m_names.getName(m_handles[index]); }
+    std::span<const ObjectType> getTypes() const { return m_types; }
+    std::span<const Transform> getTransforms() const { return m_transforms; }
+    std::span<const Material> getMaterials() const { return m_materials; }
+    bool isVisible(int index) const { return (m_flags[index] & FLAG_VISIBLE) != 0; }
+    bool isSelected(int index) const { return (m_flags[index] & FLAG_SELECTED) != 0; }
+    
+    // Per-object access through a handle; null or no-op if it is stale.
+    // Handing out a transform or material counts as changing the object.
+    Transform* getTransform(ObjectHandle handle);
+    Material* getMaterial(ObjectHandle handle);
+    const std::string* getName(ObjectHandle handle) const;
+    void setName(ObjectHandle handle, const std::string& name);
+    void setVisible(ObjectHandle handle, bool visible);
+    void setSelected(ObjectHandle handle, bool selected);
     
-    int getObjectCount() const { return static_cast<int>(m_objects.size()); }
-    int getObjectIndex(const Object* object) const;
-    Object* getObjectByName(const std::string& name);
+    // Copy of one object's components, e.g. to duplicate or save it
+    Object getObject(int index) const;
+    void getIntersectionData(int index, IntersectionData& data) const;
+    
+    // Flat geometry for CPU ray queries, brought up to date on each call
+    const CompiledScene& getCompiledScene() const;
+    // Immutable copy of the compiled scene that worker threads can query
+    // while the scene changes; copied again only after a modification
+    std::shared_ptr<const CompiledScene> getSnapshot() const;
+    
+    // Batched ray queries against the current geometry, see SceneQuery.
+    // Main thread only; workers query a snapshot instead.
+    void intersect(std::span<const Ray> rays, std::span<RayHit> hits,
+                   float maxDistance = SceneQuery::MAX_DISTANCE) const;
+    void occluded(std::span<const Ray> rays, std::span<const float> distances, std::span<uint8_t> occluded) const;
     
     // Selection management
-    Object* getSelectedObject() const { return m_selectedObject; }
-    void setSelectedObject(Object* object) { m_selectedObject = object; }
-    int getSelectedIndex() const;
+    ObjectHandle getSelectedObject() const { return m_selectedObject; }
+    void setSelectedObject(ObjectHandle handle) { m_selectedObject = handle; }
+    int getSelectedIndex() const { return getObjectIndex(m_selectedObject); }
     
-    // Serialization
-    void saveToDisk(const std::string& filePath);
+    // Serialization: SceneJson text for paths ending in ".json", the binary
+    // SceneFile format otherwise. A failed load leaves the scene unchanged.
+    bool saveToDisk(const std::string& filePath) const;
     bool loadFromDisk(const std::string& filePath);
     
+    // Clears the scene and loads filePath on a worker; objects join at
+    // each update() as they are read, at most MAX_LOADED_PER_FRAME at a
+    // time. Cancelling keeps what has been read.
+    void loadFromDiskAsync(const std::string& filePath);
+    void cancelLoad();
+    // True until the last object read has joined
+    bool isLoading() const;
+    // The latest background load, finished or not; null if none started
+    const SceneLoader* getLoader() const { return m_loader.get(); }
+    
     // Factory methods
     static std::unique_ptr<Scene> createEmptyScene();
+    
+    // Objects a background load adds per update(), so the compiled scene
+    // and renderers catch up on a bounded amount each frame
+    static constexpr size_t MAX_LOADED_PER_FRAME = 16384;
 
 private:
-    std::vector<std::unique_ptr<Object>> m_objects;
-    Object* m_selectedObject = nullptr;
+    enum : uint8_t {
+        FLAG_VISIBLE = 1 << 0,
+        FLAG_SELECTED = 1 << 1
+    };
+    
+    // Where a handle's object currently sits; the generation is raised
+    // on removal so older handles stop matching
+    struct Slot {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+    };
+    
+    void setFlag(ObjectHandle handle, uint8_t flag, bool enabled);
+    // Logs the object for the compiled scene, once until it next catches up
+    void markChanged(ObjectHandle handle);
+    
+    std::vector<ObjectType> m_types;
+    std::vector<Transform> m_transforms;
+    std::vector<Material> m_materials;
+    std::vector<uint8_t> m_flags;
+    std::vector<ObjectHandle> m_handles;    // Dense index to handle
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    NameIndex m_names;
+    
+    ObjectHandle m_selectedObject;
+    
+    // Objects added, removed, edited or hidden since the compiled scene
+    // last caught up; after a clear it compiles everything instead
+    mutable std::vector<ObjectHandle> m_changes;
+    mutable std::vector<uint8_t> m_changeLogged;    // By slot
+    mutable bool m_recompile = true;
+    mutable CompiledScene m_compiled;
+    mutable std::shared_ptr<const CompiledScene> m_snapshot;
+    std::unique_ptr<SceneLoader> m_loader;
 };
\ No newline at end of file
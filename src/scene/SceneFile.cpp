@@ -0,0 +1,191 @@
+#include "SceneFile.h"
+#include "Scene.h"
+#include "core/Logger.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    constexpr size_t SECTION_ALIGNMENT = 16;
+
+    static_assert(sizeof(SceneFile::TransformRecord) == 9 * sizeof(float), "transforms are stored packed");
+    static_assert(sizeof(SceneFile::MaterialRecord) == 10 * sizeof(float), "materials are stored packed");
+
+    size_t alignUp(size_t value) {
+        return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+}
+
+template <typename T>
+bool SceneFile::getSection(const SectionEntry* entries, uint32_t entryCount, Section section, size_t count,
+                           std::span<const T>& out) const {
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        const SectionEntry& entry = entries[i];
+        if (entry.id != static_cast<uint32_t>(section)) continue;
+
+        // Sized exactly, aligned, and inside the file
+        if (entry.size != count * sizeof(T) || entry.offset % SECTION_ALIGNMENT != 0 ||
+            entry.offset > m_file.size() || entry.size > m_file.size() - entry.offset) {
+            return false;
+        }
+        out = {reinterpret_cast<const T*>(m_file.data() + entry.offset), count};
+        return true;
+    }
+    return false;
+}
+
+bool SceneFile::open(const std::string& path) {
+    close();
+    if (!m_file.open(path)) return false;
+
+    const Header* header = reinterpret_cast<const Header*>(m_file.data());
+    if (m_file.size() < sizeof(Header) || header->magic != MAGIC || header->version != VERSION ||
+        header->sectionCount > (m_file.size() - sizeof(Header)) / sizeof(SectionEntry)) {
+        LOG_WARN("'{}' is not a scene file of this version", path);
+        close();
+        return false;
+    }
+
+    // The names blob is the only section sized by its contents; the last
+    // offset gives its length
+    size_t count = static_cast<size_t>(header->objectCount);
+    const SectionEntry* entries = reinterpret_cast<const SectionEntry*>(header + 1);
+    if (count > m_file.size() ||
+        !getSection(entries, header->sectionCount, Section::Types, count, m_types) ||
+        !getSection(entries, header->sectionCount, Section::Transforms, count, m_transforms) ||
+        !getSection(entries, header->sectionCount, Section::Materials, count, m_materials) ||
+        !getSection(entries, header->sectionCount, Section::NameOffsets, count + 1, m_nameOffsets) ||
+        !getSection(entries, header->sectionCount, Section::Names, m_nameOffsets[count], m_names)) {
+        LOG_WARN("Scene file '{}' is truncated or malformed", path);
+        close();
+        return false;
+    }
+
+    m_objectCount = count;
+    return true;
+}
+
+void SceneFile::close() {
+    m_file.close();
+    m_objectCount = 0;
+    m_types = {};
+    m_transforms = {};
+    m_materials = {};
+    m_nameOffsets = {};
+    m_names = {};
+}
+
+std::string_view SceneFile::getName(size_t index) const {
+    if (index >= m_objectCount) return {};
+    uint32_t begin = m_nameOffsets[index];
+    uint32_t end = m_nameOffsets[index + 1];
+    if (begin > end || end > m_names.size()) return {};
+    return {m_names.data() + begin, end - begin};
+}
+
+bool SceneFile::readObject(size_t index, Object& object) const {
+    if (index >= m_objectCount || m_types[index] > static_cast<uint8_t>(ObjectType::Cube) ||
+        m_materials[index].type > static_cast<uint32_t>(MaterialType::Dielectric)) {
+        return false;
+    }
+
+    object = Object(std::string(getName(index)), static_cast<ObjectType>(m_types[index]));
+    Transform& transform = object.getTransform();
+    transform.position = m_transforms[index].position;
+    transform.rotation = m_transforms[index].rotation;
+    transform.scale = m_transforms[index].scale;
+
+    const MaterialRecord& record = m_materials[index];
+    Material& material = object.getMaterial();
+    material.color = record.color;
+    material.type = static_cast<MaterialType>(record.type);
+    material.roughness = record.roughness;
+    material.metalness = record.metalness;
+    material.ior = record.ior;
+    material.emission = record.emission;
+    return true;
+}
+
+bool SceneFile::write(const std::string& path, const Scene& scene) {
+    size_t count = static_cast<size_t>(scene.getObjectCount());
+    std::span<const ObjectType> sceneTypes = scene.getTypes();
+    std::span<const Transform> sceneTransforms = scene.getTransforms();
+    std::span<const Material> sceneMaterials = scene.getMaterials();
+
+    std::vector<uint8_t> types(count);
+    std::vector<TransformRecord> transforms(count);
+    std::vector<MaterialRecord> materials(count);
+    std::vector<uint32_t> nameOffsets(count + 1);
+    std::string names;
+
+    for (size_t i = 0; i < count; ++i) {
+        types[i] = static_cast<uint8_t>(sceneTypes[i]);
+        const Transform& transform = sceneTransforms[i];
+        transforms[i] = {transform.position, transform.rotation, transform.scale};
+        const Material& material = sceneMaterials[i];
+        materials[i] = {material.color, static_cast<uint32_t>(material.type), material.roughness,
+                        material.metalness, material.ior, material.emission};
+        nameOffsets[i] = static_cast<uint32_t>(names.size());
+        names += scene.getName(static_cast<int>(i));
+    }
+    nameOffsets[count] = static_cast<uint32_t>(names.size());
+    if (names.size() > UINT32_MAX) {
+        LOG_ERROR("Object names too long for a scene file");
+        return false;
+    }
+
+    struct Payload {
+        Section section;
+        const void* data;
+        size_t size;
+    };
+    const Payload payloads[] = {
+        {Section::Types, types.data(), types.size()},
+        {Section::Transforms, transforms.data(), transforms.size() * sizeof(TransformRecord)},
+        {Section::Materials, materials.data(), materials.size() * sizeof(MaterialRecord)},
+        {Section::NameOffsets, nameOffsets.data(), nameOffsets.size() * sizeof(uint32_t)},
+        {Section::Names, names.data(), names.size()},
+    };
+    static_assert(std::size(payloads) == static_cast<size_t>(Section::Count));
+
+    Header header{MAGIC, VERSION, count, static_cast<uint32_t>(std::size(payloads)), 0};
+    std::vector<SectionEntry> entries;
+    size_t offset = alignUp(sizeof(Header) + std::size(payloads) * sizeof(SectionEntry));
+    for (const Payload& payload : payloads) {
+        entries.push_back({static_cast<uint32_t>(payload.section), 0, offset, payload.size});
+        offset = alignUp(offset + payload.size);
+    }
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            LOG_ERROR("Cannot write scene file '{}'", temporary);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()),
+                   static_cast<std::streamsize>(entries.size() * sizeof(SectionEntry)));
+        const char padding[SECTION_ALIGNMENT] = {};
+        for (size_t i = 0; i < std::size(payloads); ++i) {
+            size_t position = static_cast<size_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(entries[i].offset - position));
+            file.write(static_cast<const char*>(payloads[i].data), static_cast<std::streamsize>(payloads[i].size));
+        }
+        // An empty last section still starts inside the file
+        file.write(padding, static_cast<std::streamsize>(offset - static_cast<size_t>(file.tellp())));
+        if (!file.flush()) {
+            LOG_ERROR("Failed writing scene file '{}'", temporary);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        LOG_ERROR("Cannot replace scene file '{}': {}", path, error.message());
+        return false;
+    }
+    return true;
+}
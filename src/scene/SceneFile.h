@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Object.h"
+#include "utils/MappedFile.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Scene;
+
+// Binary scene file: a header, a table of contents, then one fixed-layout
+// array per section, each 16-byte aligned. Opening maps the file and only
+// checks the header and section bounds; the accessors point straight into
+// the mapping, so a section nobody reads is never paged in. Host byte
+// order, like the other binary formats here; saved as ".scene" by the
+// editor's convention.
+class SceneFile {
+public:
+    struct TransformRecord {
+        Vec3 position;
+        Vec3 rotation;
+        Vec3 scale;
+    };
+
+    struct MaterialRecord {
+        Vec3 color;
+        uint32_t type;
+        float roughness;
+        float metalness;
+        float ior;
+        Vec3 emission;
+    };
+
+    // False, leaving this closed, unless path holds a scene file of this
+    // version with every section inside it
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    size_t getObjectCount() const { return m_objectCount; }
+    // ObjectType values, unchecked
+    std::span<const uint8_t> getTypes() const { return m_types; }
+    std::span<const TransformRecord> getTransforms() const { return m_transforms; }
+    // MaterialType values in type are unchecked
+    std::span<const MaterialRecord> getMaterials() const { return m_materials; }
+    // Empty when the name table entry is out of bounds
+    std::string_view getName(size_t index) const;
+    // False, leaving object unchanged, when the entry's object or material
+    // type is unknown
+    bool readObject(size_t index, Object& object) const;
+
+    // Written to a temporary file and renamed over path
+    static bool write(const std::string& path, const Scene& scene);
+
+    static constexpr uint32_t MAGIC = 0x4353474D;   // "MGSC"
+    // Raised when a section changes layout; new sections get new ids and
+    // are skipped by older readers
+    static constexpr uint32_t VERSION = 1;
+
+private:
+    enum class Section : uint32_t {
+        Types,
+        Transforms,
+        Materials,
+        NameOffsets,    // objectCount + 1 offsets into Names
+        Names,
+        Count
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t objectCount;
+        uint32_t sectionCount;
+        uint32_t reserved;
+    };
+
+    struct SectionEntry {
+        uint32_t id;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    template <typename T>
+    bool getSection(const SectionEntry* entries, uint32_t entryCount, Section section, size_t count,
+                    std::span<const T>& out) const;
+
+    MappedFile m_file;
+    size_t m_objectCount = 0;
+    std::span<const uint8_t> m_types;
+    std::span<const TransformRecord> m_transforms;
+    std::span<const MaterialRecord> m_materials;
+    std::span<const uint32_t> m_nameOffsets;
+    std::span<const char> m_names;
+};
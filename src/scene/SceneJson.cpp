@@ -0,0 +1,387 @@
+#include "SceneJson.h"
+#include "Scene.h"
+#include "core/Logger.h"
+#include "utils/JsonReader.h"
+#include "utils/JsonWriter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+namespace {
+    const char* const OBJECT_TYPES[] = {"Sphere", "Plane", "Cube"};
+    const char* const MATERIAL_TYPES[] = {"Diffuse", "Metal", "Dielectric"};
+
+    template <size_t N>
+    int findName(const char* const (&names)[N], std::string_view name) {
+        for (size_t i = 0; i < N; ++i) {
+            if (name == names[i]) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    void writeVec3(JsonWriter& writer, const char* name, const Vec3& value) {
+        writer.key(name);
+        writer.beginArray(true);
+        writer.value(value.x);
+        writer.value(value.y);
+        writer.value(value.z);
+        writer.endArray();
+    }
+
+    // Builds objects from parser events. The context stack follows the
+    // containers entered; field is what the next value fills in.
+    class SceneHandler : public JsonHandler {
+    public:
+        SceneHandler(const JsonReader& reader, size_t batchSize, const SceneJson::BatchSink& sink,
+                     std::atomic<uint64_t>* bytesRead)
+            : m_reader(reader), m_batchSize(batchSize), m_sink(sink), m_bytesRead(bytesRead) {}
+
+        bool isComplete() const { return m_complete; }
+        bool isStopped() const { return m_stopped; }
+
+        // The last batch, once the document is complete
+        bool finish() {
+            if (m_objects.empty()) return true;
+            return m_sink(m_objects) || stop();
+        }
+
+        bool beginObject() override {
+            if (skipContainer()) return true;
+            Context context = m_contexts.empty() ? Context::Root : m_contexts.back();
+            if (context == Context::Root && m_field == Field::None) return enter(Context::Document);
+            if (context == Context::Objects) {
+                m_object = Pending{};
+                return enter(Context::Object);
+            }
+            if (take(Field::Transform)) return enter(Context::Transform);
+            if (take(Field::Material)) return enter(Context::Material);
+            return error("unexpected object");
+        }
+
+        bool endObject() override {
+            if (skipEnd()) return true;
+            Context context = m_contexts.back();
+            m_contexts.pop_back();
+            if (context == Context::Object) return addObject();
+            if (context == Context::Document) {
+                if (!m_formatSeen || !m_versionSeen) return error("missing format or version");
+                m_complete = true;
+            }
+            return true;
+        }
+
+        bool beginArray() override {
+            if (skipContainer()) return true;
+            if (take(Field::Objects)) return enter(Context::Objects);
+            if (m_field == Field::Position || m_field == Field::Rotation || m_field == Field::Scale ||
+                m_field == Field::Color || m_field == Field::Emission) {
+                m_vector = getVector(m_field);
+                m_vectorSize = 0;
+                m_field = Field::None;
+                return enter(Context::Vector);
+            }
+            return error("unexpected array");
+        }
+
+        bool endArray() override {
+            if (skipEnd()) return true;
+            Context context = m_contexts.back();
+            m_contexts.pop_back();
+            if (context == Context::Vector && m_vectorSize != 3) return error("vectors need 3 components");
+            return true;
+        }
+
+        bool key(std::string_view name) override {
+            m_field = Field::Skip;
+            switch (m_contexts.back()) {
+                case Context::Document:
+                    if (name == "format") m_field = Field::Format;
+                    else if (name == "version") m_field = Field::Version;
+                    else if (name == "objects") m_field = Field::Objects;
+                    break;
+                case Context::Object:
+                    if (name == "name") m_field = Field::Name;
+                    else if (name == "type") m_field = Field::Type;
+                    else if (name == "transform") m_field = Field::Transform;
+                    else if (name == "material") m_field = Field::Material;
+                    break;
+                case Context::Transform:
+                    if (name == "position") m_field = Field::Position;
+                    else if (name == "rotation") m_field = Field::Rotation;
+                    else if (name == "scale") m_field = Field::Scale;
+                    break;
+                case Context::Material:
+                    if (name == "type") m_field = Field::MaterialType;
+                    else if (name == "color") m_field = Field::Color;
+                    else if (name == "emission") m_field = Field::Emission;
+                    else if (name == "roughness") m_field = Field::Roughness;
+                    else if (name == "metalness") m_field = Field::Metalness;
+                    else if (name == "ior") m_field = Field::Ior;
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        }
+
+        bool string(std::string_view value) override {
+            if (skipScalar()) return true;
+            if (take(Field::Format)) {
+                m_formatSeen = true;
+                return value == SceneJson::FORMAT || error("not a scene file");
+            }
+            if (take(Field::Name)) {
+                m_object.name = value;
+                return true;
+            }
+            if (take(Field::Type)) {
+                m_object.type = findName(OBJECT_TYPES, value);
+                return m_object.type >= 0 || error("unknown object type");
+            }
+            if (take(Field::MaterialType)) {
+                int type = findName(MATERIAL_TYPES, value);
+                m_object.material.type = static_cast<::MaterialType>(type);
+                return type >= 0 || error("unknown material type");
+            }
+            return error("unexpected string");
+        }
+
+        bool number(double value) override {
+            if (skipScalar()) return true;
+            float number = static_cast<float>(value);
+            if (!m_contexts.empty() && m_contexts.back() == Context::Vector) {
+                if (m_vectorSize == 3) return error("vectors need 3 components");
+                (&m_vector->x)[m_vectorSize++] = number;
+                return true;
+            }
+            if (take(Field::Version)) {
+                m_versionSeen = true;
+                return value <= SceneJson::VERSION || error("scene file from a newer version");
+            }
+            if (take(Field::Roughness)) return store(m_object.material.roughness, number);
+            if (take(Field::Metalness)) return store(m_object.material.metalness, number);
+            if (take(Field::Ior)) return store(m_object.material.ior, number);
+            return error("unexpected number");
+        }
+
+        bool boolean(bool) override {
+            return skipScalar() || error("unexpected boolean");
+        }
+
+        bool null() override {
+            return skipScalar() || error("unexpected null");
+        }
+
+        std::string getError() const override { return m_error; }
+
+    private:
+        enum class Context { Root, Document, Objects, Object, Transform, Material, Vector };
+
+        enum class Field {
+            None, Skip,
+            Format, Version, Objects,
+            Name, Type, Transform, Material,
+            Position, Rotation, Scale,
+            MaterialType, Color, Emission, Roughness, Metalness, Ior
+        };
+
+        struct Pending {
+            std::string name = "Object";
+            int type = -1;
+            Transform transform;
+            ::Material material;
+        };
+
+        bool enter(Context context) {
+            m_contexts.push_back(context);
+            return true;
+        }
+
+        bool take(Field field) {
+            if (m_field != field) return false;
+            m_field = Field::None;
+            return true;
+        }
+
+        bool store(float& target, float value) {
+            target = value;
+            return true;
+        }
+
+        bool error(const char* message) {
+            m_error = message;
+            return false;
+        }
+
+        // Values under unknown keys are skipped whole
+        bool skipContainer() {
+            if (m_skipDepth > 0 || take(Field::Skip)) {
+                ++m_skipDepth;
+                return true;
+            }
+            return false;
+        }
+        bool skipEnd() {
+            if (m_skipDepth == 0) return false;
+            --m_skipDepth;
+            return true;
+        }
+        bool skipScalar() {
+            return m_skipDepth > 0 || take(Field::Skip);
+        }
+
+        Vec3* getVector(Field field) {
+            switch (field) {
+                case Field::Position: return &m_object.transform.position;
+                case Field::Rotation: return &m_object.transform.rotation;
+                case Field::Scale: return &m_object.transform.scale;
+                case Field::Color: return &m_object.material.color;
+                default: return &m_object.material.emission;
+            }
+        }
+
+        bool addObject() {
+            if (m_object.type < 0) return error("object without a type");
+            Object& object = m_objects.emplace_back(m_object.name, static_cast<ObjectType>(m_object.type));
+            object.getTransform() = m_object.transform;
+            object.getMaterial() = m_object.material;
+            if (m_objects.size() < m_batchSize) return true;
+
+            if (m_bytesRead) *m_bytesRead = m_reader.getBytesRead();
+            if (!m_sink(m_objects)) return stop();
+            m_objects.clear();
+            return true;
+        }
+
+        bool stop() {
+            m_stopped = true;
+            return error("stopped");
+        }
+
+        const JsonReader& m_reader;
+        size_t m_batchSize;
+        const SceneJson::BatchSink& m_sink;
+        std::atomic<uint64_t>* m_bytesRead;
+        std::vector<Object> m_objects;
+        std::vector<Context> m_contexts;
+        Field m_field = Field::None;
+        int m_skipDepth = 0;
+        Pending m_object;
+        Vec3* m_vector = nullptr;
+        int m_vectorSize = 0;
+        bool m_formatSeen = false;
+        bool m_versionSeen = false;
+        bool m_complete = false;
+        bool m_stopped = false;
+        std::string m_error;
+    };
+}
+
+bool SceneJson::isJsonPath(const std::string& path) {
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+}
+
+bool SceneJson::write(const std::string& path, const Scene& scene) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            LOG_ERROR("Cannot write scene file '{}'", temporary);
+            return false;
+        }
+
+        JsonWriter writer(file);
+        writer.beginObject();
+        writer.key("format");
+        writer.value(FORMAT);
+        writer.key("version");
+        writer.value(VERSION);
+        writer.key("objects");
+        writer.beginArray();
+        for (int i = 0; i < scene.getObjectCount(); ++i) {
+            const Transform& transform = scene.getTransforms()[i];
+            const Material& material = scene.getMaterials()[i];
+
+            writer.beginObject();
+            writer.key("name");
+            writer.value(scene.getName(i));
+            writer.key("type");
+            writer.value(OBJECT_TYPES[static_cast<int>(scene.getTypes()[i])]);
+
+            writer.key("transform");
+            writer.beginObject();
+            writeVec3(writer, "position", transform.position);
+            writeVec3(writer, "rotation", transform.rotation);
+            writeVec3(writer, "scale", transform.scale);
+            writer.endObject();
+
+            writer.key("material");
+            writer.beginObject();
+            writer.key("type");
+            writer.value(MATERIAL_TYPES[static_cast<int>(material.type)]);
+            writeVec3(writer, "color", material.color);
+            writer.key("roughness");
+            writer.value(material.roughness);
+            writer.key("metalness");
+            writer.value(material.metalness);
+            writer.key("ior");
+            writer.value(material.ior);
+            writeVec3(writer, "emission", material.emission);
+            writer.endObject();
+
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+        if (!writer.flush()) {
+            LOG_ERROR("Failed writing scene file '{}'", temporary);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        LOG_ERROR("Cannot replace scene file '{}': {}", path, error.message());
+        return false;
+    }
+    return true;
+}
+
+bool SceneJson::read(const std::string& path, std::vector<Object>& objects) {
+    std::vector<Object> loaded;
+    bool read = SceneJson::read(path, SIZE_MAX, [&](std::vector<Object>& batch) {
+        loaded = std::move(batch);
+        return true;
+    });
+    if (!read) return false;
+
+    objects = std::move(loaded);
+    return true;
+}
+
+bool SceneJson::read(const std::string& path, size_t batchSize, const BatchSink& sink,
+                     std::atomic<uint64_t>* bytesRead) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("Cannot open scene file '{}'", path);
+        return false;
+    }
+
+    JsonReader reader(file);
+    SceneHandler handler(reader, std::max<size_t>(batchSize, 1), sink, bytesRead);
+    if (!reader.parse(handler)) {
+        if (!handler.isStopped()) {
+            LOG_ERROR("Scene file '{}': {} at byte {}", path, reader.getError(), reader.getErrorOffset());
+        }
+        return false;
+    }
+    if (!handler.isComplete()) {
+        LOG_ERROR("Scene file '{}' is not a scene object", path);
+        return false;
+    }
+    if (bytesRead) *bytesRead = reader.getBytesRead();
+    return handler.finish();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Object.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class Scene;
+
+// Text scene format for version control: one JSON object per scene object
+// with its name, type, transform and material. Read by a streaming parser,
+// so loading needs no memory beyond the objects it produces. Unknown keys
+// are skipped, so later versions may add fields.
+class SceneJson {
+public:
+    // Written to a temporary file and renamed over path
+    static bool write(const std::string& path, const Scene& scene);
+    // Replaces objects only on success; errors name the byte offset
+    static bool read(const std::string& path, std::vector<Object>& objects);
+
+    // Takes each batch of objects in file order; returning false stops
+    // the read, which then fails without logging
+    using BatchSink = std::function<bool(std::vector<Object>& batch)>;
+    // Hands objects to sink batchSize at a time as they are parsed. The
+    // final batch may be short and follows only a complete document.
+    static bool read(const std::string& path, size_t batchSize, const BatchSink& sink,
+                     std::atomic<uint64_t>* bytesRead = nullptr);
+
+    // Paths ending in ".json"
+    static bool isJsonPath(const std::string& path);
+
+    static constexpr const char* FORMAT = "minigpu-scene";
+    static constexpr int VERSION = 1;
+};
@@ -0,0 +1,99 @@
+#include "SceneLoader.h"
+#include "SceneFile.h"
+#include "SceneJson.h"
+#include "core/Logger.h"
+
+#include <algorithm>
+#include <filesystem>
+
+SceneLoader::SceneLoader(const std::string& path) : m_path(path) {
+    JobSystem::run([this] { run(); }, &m_job);
+}
+
+SceneLoader::~SceneLoader() {
+    cancel();
+    JobSystem::wait(m_job);
+}
+
+void SceneLoader::cancel() {
+    m_cancel = true;
+}
+
+void SceneLoader::takeObjects(std::vector<Object>& objects, size_t maxCount) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = std::min(maxCount, m_ready.size());
+    objects.reserve(objects.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        objects.push_back(std::move(m_ready.front()));
+        m_ready.pop_front();
+    }
+}
+
+size_t SceneLoader::getReadyCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ready.size();
+}
+
+float SceneLoader::getProgress() const {
+    if (isDone()) return 1.0f;
+    uint64_t total = m_totalBytes.load();
+    return total > 0 ? std::min(1.0f, static_cast<float>(m_bytesRead.load()) / static_cast<float>(total)) : 0.0f;
+}
+
+bool SceneLoader::publish(std::vector<Object>& batch) {
+    if (m_cancel.load()) return false;
+
+    m_loadedCount += batch.size();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& object : batch) {
+        m_ready.push_back(std::move(object));
+    }
+    return true;
+}
+
+void SceneLoader::run() {
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(m_path, error);
+    m_totalBytes = error ? 0 : size;
+
+    bool loaded = SceneJson::isJsonPath(m_path) ? loadJson() : loadBinary();
+    if (loaded) {
+        LOG_INFO("Scene loaded from '{}' with {} objects", m_path, m_loadedCount.load());
+        m_state = State::Finished;
+    } else if (m_cancel.load()) {
+        LOG_INFO("Loading '{}' cancelled after {} objects", m_path, m_loadedCount.load());
+        m_state = State::Cancelled;
+    } else {
+        LOG_ERROR("Cannot load scene '{}'", m_path);
+        m_state = State::Failed;
+    }
+}
+
+bool SceneLoader::loadBinary() {
+    SceneFile file;
+    if (!file.open(m_path)) return false;
+
+    // The mapping pages in as the records are read, so progress goes by
+    // the share of objects built
+    size_t count = file.getObjectCount();
+    std::vector<Object> batch;
+    for (size_t begin = 0; begin < count; begin += BATCH_SIZE) {
+        size_t end = std::min(count, begin + BATCH_SIZE);
+        batch.resize(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            if (!file.readObject(i, batch[i - begin])) {
+                LOG_ERROR("Scene '{}' has an object of unknown type at index {}", m_path, i);
+                return false;
+            }
+        }
+        if (!publish(batch)) return false;
+        m_bytesRead = m_totalBytes.load() * end / count;
+    }
+    return true;
+}
+
+bool SceneLoader::loadJson() {
+    return SceneJson::read(m_path, BATCH_SIZE, [this](std::vector<Object>& batch) {
+        return publish(batch);
+    }, &m_bytesRead);
+}
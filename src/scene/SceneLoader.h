@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Object.h"
+#include "core/JobSystem.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Reads a scene file on a job-system worker and hands its objects over in
+// batches as they are built, so the first ones can be shown long before
+// the last are read. The owner takes finished batches at frame
+// boundaries with takeObjects.
+class SceneLoader {
+public:
+    enum class State {
+        Loading,
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    explicit SceneLoader(const std::string& path);
+    // Cancels and waits for the worker
+    ~SceneLoader();
+
+    SceneLoader(const SceneLoader&) = delete;
+    SceneLoader& operator=(const SceneLoader&) = delete;
+
+    // Stops at the next batch; objects already taken stay with the owner
+    void cancel();
+
+    // Appends up to maxCount of the objects finished since the last call to
+    // objects, oldest first; the rest wait for the next call
+    void takeObjects(std::vector<Object>& objects, size_t maxCount = std::numeric_limits<size_t>::max());
+    // Objects read but not yet taken
+    size_t getReadyCount() const;
+
+    State getState() const { return m_state.load(); }
+    bool isDone() const { return getState() != State::Loading; }
+    // Fraction of the file read, 0 to 1
+    float getProgress() const;
+    size_t getLoadedCount() const { return m_loadedCount.load(); }
+    const std::string& getPath() const { return m_path; }
+
+    static constexpr size_t BATCH_SIZE = 4096;
+
+private:
+    void run();
+    bool publish(std::vector<Object>& batch);
+    bool loadBinary();
+    bool loadJson();
+
+    std::string m_path;
+    mutable std::mutex m_mutex;
+    std::deque<Object> m_ready;
+    std::atomic<State> m_state{State::Loading};
+    std::atomic<bool> m_cancel{false};
+    std::atomic<uint64_t> m_bytesRead{0};
+    std::atomic<uint64_t> m_totalBytes{0};
+    std::atomic<size_t> m_loadedCount{0};
+    JobCounter m_job;
+};
@@ -0,0 +1,71 @@
+#include "SceneQuery.h"
+#include "renderer/PacketIntersector.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+    // Fills a packet from rays[first..], repeating the last ray in unused
+    // lanes so they never trace garbage
+    int fillPacket(RayPacket& packet, std::span<const Ray> rays, size_t first,
+                   std::span<const float> distances, float maxDistance) {
+        int count = static_cast<int>(std::min<size_t>(RayPacket::MAX_WIDTH, rays.size() - first));
+        for (int lane = 0; lane < RayPacket::MAX_WIDTH; ++lane) {
+            size_t i = first + static_cast<size_t>(std::min(lane, count - 1));
+            float distance = distances.empty() ? maxDistance : distances[i];
+            packet.set(lane, rays[i].origin, rays[i].direction, distance);
+        }
+        packet.count = count;
+        return count;
+    }
+}
+
+void SceneQuery::intersect(const CompiledScene& scene, std::span<const Ray> rays, std::span<RayHit> hits,
+                           float maxDistance) {
+    assert(hits.size() >= rays.size());
+
+    PacketIntersector intersector;
+    RayPacket packet;
+    PacketHits packetHits;
+
+    for (size_t first = 0; first < rays.size(); first += RayPacket::MAX_WIDTH) {
+        int count = fillPacket(packet, rays, first, {}, maxDistance);
+        intersector.intersect(packet, scene, packetHits);
+
+        for (int lane = 0; lane < count; ++lane) {
+            RayHit& out = hits[first + lane];
+            if (packetHits.kind[lane] == PrimitiveKind::None) {
+                out = RayHit{};
+                continue;
+            }
+
+            SceneHit hit;
+            hit.t = packetHits.t[lane];
+            hit.kind = packetHits.kind[lane];
+            hit.index = packetHits.index[lane];
+
+            const Ray& ray = rays[first + lane];
+            out.object = scene.getObjectHandle(hit);
+            out.t = hit.t;
+            out.normal = scene.getNormal(hit, ray.at(hit.t));
+        }
+    }
+}
+
+void SceneQuery::occluded(const CompiledScene& scene, std::span<const Ray> rays,
+                          std::span<const float> distances, std::span<uint8_t> occluded) {
+    assert(distances.size() >= rays.size() && occluded.size() >= rays.size());
+
+    PacketIntersector intersector;
+    RayPacket packet;
+    bool blocked[RayPacket::MAX_WIDTH];
+
+    for (size_t first = 0; first < rays.size(); first += RayPacket::MAX_WIDTH) {
+        int count = fillPacket(packet, rays, first, distances, MAX_DISTANCE);
+        intersector.occluded(packet, scene, blocked);
+
+        for (int lane = 0; lane < count; ++lane) {
+            occluded[first + lane] = blocked[lane] ? 1 : 0;
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CompiledScene.h"
+#include "ObjectHandle.h"
+#include "math/Ray.h"
+#include "math/Vec3.h"
+#include <cstdint>
+#include <span>
+
+struct RayHit {
+    // Stays valid while the scene changes, unlike a dense index, so hits
+    // from a snapshot can be resolved later; null for a miss
+    ObjectHandle object;
+    float t = 0.0f;
+    Vec3 normal;
+
+    bool isHit() const { return !object.isNull(); }
+};
+
+// Batched ray queries against a compiled scene, for picking, snapping,
+// framing, baking and the CPU tracers alike. Rays go through the packet
+// kernels eight at a time through the scene's BVH, so batches of coherent
+// rays run fastest.
+// Only reads the scene; any number of threads may query one snapshot.
+class SceneQuery {
+public:
+    // Closest hit per ray within maxDistance; hits must be as long as rays
+    static void intersect(const CompiledScene& scene, std::span<const Ray> rays, std::span<RayHit> hits,
+                          float maxDistance = MAX_DISTANCE);
+
+    // 1 where anything lies within that ray's distance, else 0; distances
+    // and occluded must be as long as rays
+    static void occluded(const CompiledScene& scene, std::span<const Ray> rays,
+                         std::span<const float> distances, std::span<uint8_t> occluded);
+
+    static constexpr float MAX_DISTANCE = 1e20f;
+};
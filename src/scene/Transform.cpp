@@ -11,7 +11,7 @@ Mat4 Transform::getMatrix() const {
 
 Mat4 Transform::getInverseMatrix() const {
     Mat4 invScale = Mat4::scale(Vec3{1.0f/scale.x, 1.0f/scale.y, 1.0f/scale.z});
-    Mat4 invRotation = getRotationMatrix().inverse();
+    Mat4 invRotation = getRotationMatrix().affineInverse();
     Mat4 invTranslation = Mat4::translate(-position);
     
     return invScale * invRotation * invTranslation;
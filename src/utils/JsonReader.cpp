@@ -0,0 +1,313 @@
+#include "JsonReader.h"
+
+#include <charconv>
+#include <cstdint>
+
+namespace {
+    bool isDigit(int c) { return c >= '0' && c <= '9'; }
+
+    // Characters a number may contain, before checking their order
+    bool isNumberChar(int c) {
+        return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    int hexValue(int c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    // Longer numbers than any double needs are rejected rather than buffered
+    constexpr size_t MAX_NUMBER_LENGTH = 512;
+}
+
+JsonReader::JsonReader(std::istream& input) : m_input(input), m_buffer(BUFFER_SIZE) {}
+
+bool JsonReader::refill() {
+    m_consumed += m_end;
+    m_position = 0;
+    m_end = 0;
+    if (!m_input) return false;
+
+    m_input.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_end = static_cast<size_t>(m_input.gcount());
+    return m_end > 0;
+}
+
+bool JsonReader::fail(const std::string& message) {
+    if (m_error.empty()) {
+        m_error = message;
+        m_errorOffset = m_tokenOffset;
+    }
+    return false;
+}
+
+void JsonReader::skipWhitespace() {
+    // Indentation is much of a pretty-printed file, so scan the buffer directly
+    while (m_position < m_end || refill()) {
+        const char* p = m_buffer.data() + m_position;
+        const char* end = m_buffer.data() + m_end;
+        while (p != end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')) {
+            ++p;
+        }
+        m_position = static_cast<size_t>(p - m_buffer.data());
+        if (p != end) return;
+    }
+}
+
+bool JsonReader::parse(JsonHandler& handler) {
+    m_error.clear();
+    m_errorOffset = 0;
+
+    skipWhitespace();
+    if (!parseValue(handler, 0)) return false;
+
+    skipWhitespace();
+    m_tokenOffset = getOffset();
+    if (peek() >= 0) return fail("unexpected data after the document");
+    if (m_input.bad()) return fail("read error");
+    return true;
+}
+
+bool JsonReader::parseValue(JsonHandler& handler, int depth) {
+    m_tokenOffset = getOffset();
+    int c = peek();
+    switch (c) {
+        case '{':
+            return parseObject(handler, depth + 1);
+        case '[':
+            return parseArray(handler, depth + 1);
+        case '"':
+            if (!parseString(m_string)) return false;
+            return handler.string(m_string) || fail(handler.getError());
+        case 't':
+            if (!parseLiteral("true")) return false;
+            return handler.boolean(true) || fail(handler.getError());
+        case 'f':
+            if (!parseLiteral("false")) return false;
+            return handler.boolean(false) || fail(handler.getError());
+        case 'n':
+            if (!parseLiteral("null")) return false;
+            return handler.null() || fail(handler.getError());
+        case -1:
+            return fail("unexpected end of input");
+        default: {
+            if (c != '-' && !isDigit(c)) return fail("unexpected character");
+            double value = 0.0;
+            if (!parseNumber(value)) return false;
+            return handler.number(value) || fail(handler.getError());
+        }
+    }
+}
+
+bool JsonReader::parseObject(JsonHandler& handler, int depth) {
+    if (depth > MAX_DEPTH) return fail("nested too deeply");
+    next();
+    if (!handler.beginObject()) return fail(handler.getError());
+
+    skipWhitespace();
+    if (peek() == '}') {
+        next();
+        m_tokenOffset = getOffset() - 1;
+        return handler.endObject() || fail(handler.getError());
+    }
+
+    while (true) {
+        skipWhitespace();
+        m_tokenOffset = getOffset();
+        if (peek() != '"') return fail("expected a key");
+        if (!parseString(m_string)) return false;
+        if (!handler.key(m_string)) return fail(handler.getError());
+
+        skipWhitespace();
+        m_tokenOffset = getOffset();
+        if (next() != ':') return fail("expected ':'");
+        skipWhitespace();
+        if (!parseValue(handler, depth)) return false;
+
+        skipWhitespace();
+        m_tokenOffset = getOffset();
+        int c = next();
+        if (c == '}') return handler.endObject() || fail(handler.getError());
+        if (c != ',') return fail("expected ',' or '}'");
+    }
+}
+
+bool JsonReader::parseArray(JsonHandler& handler, int depth) {
+    if (depth > MAX_DEPTH) return fail("nested too deeply");
+    next();
+    if (!handler.beginArray()) return fail(handler.getError());
+
+    skipWhitespace();
+    if (peek() == ']') {
+        next();
+        m_tokenOffset = getOffset() - 1;
+        return handler.endArray() || fail(handler.getError());
+    }
+
+    while (true) {
+        skipWhitespace();
+        if (!parseValue(handler, depth)) return false;
+
+        skipWhitespace();
+        m_tokenOffset = getOffset();
+        int c = next();
+        if (c == ']') return handler.endArray() || fail(handler.getError());
+        if (c != ',') return fail("expected ',' or ']'");
+    }
+}
+
+bool JsonReader::parseString(std::string& out) {
+    out.clear();
+    next();
+
+    while (true) {
+        if (m_position == m_end && !refill()) return fail("unterminated string");
+
+        // Copy the run up to the next quote, escape or control character
+        const char* begin = m_buffer.data() + m_position;
+        const char* end = m_buffer.data() + m_end;
+        const char* p = begin;
+        while (p != end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20) {
+            ++p;
+        }
+        out.append(begin, p);
+        m_position += static_cast<size_t>(p - begin);
+        if (p == end) continue;
+
+        if (*p == '"') {
+            ++m_position;
+            return true;
+        }
+        if (*p != '\\') {
+            m_tokenOffset = getOffset();
+            return fail("control character in string");
+        }
+        ++m_position;
+        if (!parseEscape(out)) return false;
+    }
+}
+
+bool JsonReader::parseEscape(std::string& out) {
+    m_tokenOffset = getOffset() - 1;
+    int c = next();
+    switch (c) {
+        case '"': out += '"'; return true;
+        case '\\': out += '\\'; return true;
+        case '/': out += '/'; return true;
+        case 'b': out += '\b'; return true;
+        case 'f': out += '\f'; return true;
+        case 'n': out += '\n'; return true;
+        case 'r': out += '\r'; return true;
+        case 't': out += '\t'; return true;
+        case 'u': break;
+        default: return fail("invalid escape");
+    }
+
+    auto readHex = [this](uint32_t& code) {
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            int digit = hexValue(next());
+            if (digit < 0) return false;
+            code = code * 16 + static_cast<uint32_t>(digit);
+        }
+        return true;
+    };
+
+    uint32_t code = 0;
+    if (!readHex(code)) return fail("invalid \\u escape");
+
+    // Characters past the basic plane come as a surrogate pair
+    if (code >= 0xD800 && code < 0xDC00) {
+        uint32_t low = 0;
+        if (next() != '\\' || next() != 'u' || !readHex(low) || low < 0xDC00 || low >= 0xE000) {
+            return fail("unpaired surrogate");
+        }
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    } else if (code >= 0xDC00 && code < 0xE000) {
+        return fail("unpaired surrogate");
+    }
+    appendUtf8(out, code);
+    return true;
+}
+
+bool JsonReader::parseNumber(double& value) {
+    // Numbers wholly inside the buffer are converted in place; the rest are
+    // gathered first. Either way they are checked against the JSON grammar,
+    // since from_chars also takes forms JSON does not, such as "inf" or "1."
+    const char* begin = m_buffer.data() + m_position;
+    const char* end = m_buffer.data() + m_end;
+    const char* p = begin;
+    while (p != end && isNumberChar(*p)) {
+        ++p;
+    }
+    if (p != end) {
+        m_position += static_cast<size_t>(p - begin);
+        return convertNumber(begin, p, value);
+    }
+
+    m_number.clear();
+    while (isNumberChar(peek())) {
+        m_number += static_cast<char>(next());
+        if (m_number.size() > MAX_NUMBER_LENGTH) return fail("number too long");
+    }
+    return convertNumber(m_number.data(), m_number.data() + m_number.size(), value);
+}
+
+bool JsonReader::convertNumber(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+    auto skipDigits = [&] {
+        const char* start = p;
+        while (p != end && isDigit(*p)) ++p;
+        return p != start;
+    };
+
+    if (p != end && *p == '-') ++p;
+    if (p != end && *p == '0') {
+        ++p;
+        if (p != end && isDigit(*p)) return fail("leading zero in number");
+    } else if (!skipDigits()) {
+        return fail("invalid number");
+    }
+    if (p != end && *p == '.') {
+        ++p;
+        if (!skipDigits()) return fail("invalid number");
+    }
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p != end && (*p == '+' || *p == '-')) ++p;
+        if (!skipDigits()) return fail("invalid number");
+    }
+    if (p != end) return fail("invalid number");
+
+    auto result = std::from_chars(begin, end, value);
+    if (result.ec == std::errc::result_out_of_range) return fail("number out of range");
+    if (result.ec != std::errc() || result.ptr != end) return fail("invalid number");
+    return true;
+}
+
+bool JsonReader::parseLiteral(std::string_view word) {
+    for (char expected : word) {
+        if (next() != expected) return fail("invalid literal");
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Callbacks for JsonReader, in document order. Returning false stops the
+// parse; the reader then reports getError() at the offending value.
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+
+    virtual bool beginObject() = 0;
+    virtual bool endObject() = 0;
+    virtual bool beginArray() = 0;
+    virtual bool endArray() = 0;
+    // Views are only valid during the call
+    virtual bool key(std::string_view name) = 0;
+    virtual bool string(std::string_view value) = 0;
+    virtual bool number(double value) = 0;
+    virtual bool boolean(bool value) = 0;
+    virtual bool null() = 0;
+
+    // Why the last callback returned false
+    virtual std::string getError() const { return "unexpected value"; }
+};
+
+// Streaming (SAX-style) JSON parser: reads its input in fixed-size chunks
+// and hands each value to a handler without building a document, so
+// memory use is bounded by the longest string and the nesting depth, not
+// the file size. Numbers go through std::from_chars. Errors carry the
+// byte offset where the failing token starts.
+class JsonReader {
+public:
+    explicit JsonReader(std::istream& input);
+
+    // One complete document, followed only by whitespace
+    bool parse(JsonHandler& handler);
+
+    const std::string& getError() const { return m_error; }
+    size_t getErrorOffset() const { return m_errorOffset; }
+    // Input consumed so far; handlers may ask during a callback
+    size_t getBytesRead() const { return getOffset(); }
+
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+    static constexpr int MAX_DEPTH = 256;
+
+private:
+    // -1 at the end of the input
+    int peek() {
+        if (m_position == m_end && !refill()) return -1;
+        return static_cast<unsigned char>(m_buffer[m_position]);
+    }
+    int next() {
+        int c = peek();
+        if (c >= 0) ++m_position;
+        return c;
+    }
+    size_t getOffset() const { return m_consumed + m_position; }
+
+    bool refill();
+    void skipWhitespace();
+    bool parseValue(JsonHandler& handler, int depth);
+    bool parseObject(JsonHandler& handler, int depth);
+    bool parseArray(JsonHandler& handler, int depth);
+    bool parseString(std::string& out);
+    bool parseEscape(std::string& out);
+    bool parseNumber(double& value);
+    bool convertNumber(const char* begin, const char* end, double& value);
+    bool parseLiteral(std::string_view word);
+    bool fail(const std::string& message);
+
+    std::istream& m_input;
+    std::vector<char> m_buffer;
+    size_t m_position = 0;
+    size_t m_end = 0;
+    size_t m_consumed = 0;     // Input bytes before the buffer
+    size_t m_tokenOffset = 0;
+    std::string m_string;
+    std::string m_number;
+    std::string m_error;
+    size_t m_errorOffset = 0;
+};
@@ -0,0 +1,157 @@
+#include "JsonWriter.h"
+
+#include <charconv>
+#include <cmath>
+
+JsonWriter::JsonWriter(std::ostream& output) : m_output(output) {
+    m_buffer.reserve(BUFFER_SIZE);
+}
+
+JsonWriter::~JsonWriter() {
+    flush();
+}
+
+void JsonWriter::write(std::string_view text) {
+    if (m_buffer.size() + text.size() > BUFFER_SIZE) {
+        m_output.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_buffer.clear();
+    }
+    m_buffer.append(text);
+}
+
+bool JsonWriter::flush() {
+    if (!m_buffer.empty()) {
+        m_output.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_buffer.clear();
+    }
+    m_output.flush();
+    return static_cast<bool>(m_output);
+}
+
+void JsonWriter::newLine() {
+    write("\n");
+    for (size_t i = 0; i < m_scopes.size(); ++i) {
+        write("  ");
+    }
+}
+
+void JsonWriter::beginValue() {
+    // A keyed value follows its key on the same line
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_scopes.empty()) return;
+
+    Scope& scope = m_scopes.back();
+    if (!scope.empty) write(scope.singleLine ? ", " : ",");
+    if (!scope.singleLine) newLine();
+    scope.empty = false;
+}
+
+void JsonWriter::beginObject() {
+    beginValue();
+    write("{");
+    m_scopes.push_back({});
+}
+
+void JsonWriter::endObject() {
+    bool empty = m_scopes.back().empty;
+    m_scopes.pop_back();
+    if (!empty) newLine();
+    write("}");
+    if (m_scopes.empty()) write("\n");
+}
+
+void JsonWriter::beginArray(bool singleLine) {
+    beginValue();
+    write("[");
+    m_scopes.push_back({singleLine, true});
+}
+
+void JsonWriter::endArray() {
+    Scope scope = m_scopes.back();
+    m_scopes.pop_back();
+    if (!scope.empty && !scope.singleLine) newLine();
+    write("]");
+    if (m_scopes.empty()) write("\n");
+}
+
+void JsonWriter::key(std::string_view name) {
+    beginValue();
+    writeString(name);
+    write(": ");
+    m_afterKey = true;
+}
+
+void JsonWriter::value(std::string_view text) {
+    beginValue();
+    writeString(text);
+}
+
+void JsonWriter::value(float number) {
+    beginValue();
+    if (!std::isfinite(number)) {
+        write("null");
+        return;
+    }
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    write({text, static_cast<size_t>(result.ptr - text)});
+}
+
+void JsonWriter::value(double number) {
+    beginValue();
+    if (!std::isfinite(number)) {
+        write("null");
+        return;
+    }
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    write({text, static_cast<size_t>(result.ptr - text)});
+}
+
+void JsonWriter::value(int64_t number) {
+    beginValue();
+    char text[24];
+    auto result = std::to_chars(text, text + sizeof(text), number);
+    write({text, static_cast<size_t>(result.ptr - text)});
+}
+
+void JsonWriter::value(bool flag) {
+    beginValue();
+    write(flag ? "true" : "false");
+}
+
+void JsonWriter::null() {
+    beginValue();
+    write("null");
+}
+
+void JsonWriter::writeString(std::string_view text) {
+    static const char HEX[] = "0123456789abcdef";
+
+    write("\"");
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        write(text.substr(runStart, i - runStart));
+        runStart = i + 1;
+        switch (c) {
+            case '"': write("\\\""); break;
+            case '\\': write("\\\\"); break;
+            case '\n': write("\\n"); break;
+            case '\r': write("\\r"); break;
+            case '\t': write("\\t"); break;
+            default: {
+                char escape[] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+                write({escape, sizeof(escape)});
+                break;
+            }
+        }
+    }
+    write(text.substr(runStart));
+    write("\"");
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Streaming JSON writer: values go out as they are given, through a
+// fixed-size buffer. Indented one member per line for readable diffs;
+// arrays begun with singleLine stay on one line, for vectors. Floats are
+// written with std::to_chars in their shortest round-trip form;
+// infinities and NaNs, which JSON lacks, are written as null.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::ostream& output);
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void beginObject();
+    void endObject();
+    void beginArray(bool singleLine = false);
+    void endArray();
+    // Names the next value; objects only
+    void key(std::string_view name);
+
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(float number);
+    void value(double number);
+    void value(int64_t number);
+    void value(int number) { value(static_cast<int64_t>(number)); }
+    void value(bool flag);
+    void null();
+
+    // False if the stream failed at any point
+    bool flush();
+
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+private:
+    struct Scope {
+        bool singleLine = false;
+        bool empty = true;
+    };
+
+    void beginValue();
+    void newLine();
+    void write(std::string_view text);
+    void writeString(std::string_view text);
+
+    std::ostream& m_output;
+    std::string m_buffer;
+    std::vector<Scope> m_scopes;
+    bool m_afterKey = false;
+};
@@ -0,0 +1,95 @@
+#include "MappedFile.h"
+
+#include <fstream>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Stands in for the data of an empty file, which cannot be mapped
+    const uint8_t s_empty = 0;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_mapped(std::exchange(other.m_mapped, false)),
+      m_buffer(std::move(other.m_buffer)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_mapped, other.m_mapped);
+    std::swap(m_buffer, other.m_buffer);
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size == 0) {
+        ::close(fd);
+        m_data = &s_empty;
+        return true;
+    }
+
+    // The mapping keeps its own reference to the file
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = size;
+    m_mapped = true;
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    std::streamoff size = file.tellg();
+    if (size < 0) return false;
+    m_buffer.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(m_buffer.data()), size)) {
+        m_buffer.clear();
+        return false;
+    }
+
+    m_data = m_buffer.empty() ? &s_empty : m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (m_mapped) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/NumaTopology.h"
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+// Fixed-size array of trivially copyable values in memory from
+// NumaTopology::allocate, whose ranges can be placed on chosen nodes
+// before anything touches them. Starts out zeroed.
+template <typename T>
+class NumaBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "NumaBuffer holds raw zeroed memory");
+
+public:
+    NumaBuffer() = default;
+    ~NumaBuffer() { NumaTopology::deallocate(m_data, m_size * sizeof(T)); }
+
+    NumaBuffer(const NumaBuffer&) = delete;
+    NumaBuffer& operator=(const NumaBuffer&) = delete;
+    NumaBuffer(NumaBuffer&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+    NumaBuffer& operator=(NumaBuffer&& other) noexcept {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    // Fresh, untouched memory unless the size is unchanged, in which case
+    // the pages keep their placement and are only cleared
+    void reset(size_t count) {
+        if (count == m_size) {
+            if (m_data) std::memset(static_cast<void*>(m_data), 0, m_size * sizeof(T));
+            return;
+        }
+        NumaTopology::deallocate(m_data, m_size * sizeof(T));
+        m_data = static_cast<T*>(NumaTopology::allocate(count * sizeof(T)));
+        m_size = count;
+    }
+
+    void bindToNode(size_t first, size_t count, int node) {
+        NumaTopology::bindToNode(m_data + first, count * sizeof(T), node);
+    }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    T& operator[](size_t index) { return m_data[index]; }
+    const T& operator[](size_t index) const { return m_data[index]; }
+
+private:
+    T* m_data = nullptr;
+    size_t m_size = 0;
+};
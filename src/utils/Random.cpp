@@ -1,25 +1,49 @@
 #include "Random.h"
-#include <chrono>
+#include "core/JobSystem.h"
+#include <atomic>
 
-thread_local std::mt19937 Random::s_generator{
-    static_cast<unsigned int>(std::chrono::steady_clock::now().time_since_epoch().count())
-};
+namespace {
+    std::atomic<uint32_t> s_seed{0};
+    std::atomic<uint32_t> s_epoch{0};
+    
+    // Reseeding bumps the epoch so every thread restarts its stream on its
+    // next draw
+    thread_local uint32_t t_epoch = ~0u;
+    
+    // Workers are 1 and up by pool index, fixed for the pool's lifetime
+    uint32_t getThreadId() {
+        return static_cast<uint32_t>(JobSystem::getWorkerIndex() + 1);
+    }
+}
+
+thread_local RandomStream Random::s_stream;
+
+void Random::seed(uint32_t seed) {
+    s_seed.store(seed);
+    s_epoch.fetch_add(1);
+}
 
-thread_local std::uniform_real_distribution<float> Random::s_realDist{0.0f, 1.0f};
+uint32_t Random::getSeed() {
+    return s_seed.load(std::memory_order_relaxed);
+}
 
-void Random::seed(unsigned int seed) {
-    s_generator.seed(seed);
+RandomStream& Random::threadStream() {
+    uint32_t epoch = s_epoch.load(std::memory_order_relaxed);
+    if (t_epoch != epoch) {
+        s_stream = RandomStream(getThreadId(), RandomStream::THREAD_ROW, 0, getSeed());
+        t_epoch = epoch;
+    }
+    return s_stream;
 }
 
 float Random::uniform() {
-    return s_realDist(s_generator);
+    return threadStream().next();
 }
 
 float Random::uniform(float min, float max) {
-    return min + (max - min) * uniform();
+    return threadStream().next(min, max);
 }
 
 int Random::uniformInt(int min, int max) {
-    std::uniform_int_distribution<int> dist(min, max);
-    return dist(s_generator);
-}
\ No newline at end of file
+    return threadStream().nextInt(min, max);
+}
@@ -1,15 +1,92 @@
 #pragma once
 
-#include <random>
+#include <cstdint>
+#include <cstring>
 
+// Counter-based random stream. Every value is a pure function of
+// (pixel, sample, seed, counter) through the pcg4d hash (Jarzynski & Olano,
+// 2020), so any pixel/sample reproduces on its own, independent of thread
+// scheduling, with 32 bytes of state. Uses 32-bit integer math only and
+// mirrors random() in pathtracer.frag bit for bit.
+//
+// Each family of streams owns its own keys, so no two ever coincide:
+//   pixel samples   (x, y, sample index, seed), y below RESERVED_ROWS
+//   caustic photons (chunk, PHOTON_ROW, pass, seed)
+//   Random's thread streams (thread id, THREAD_ROW, 0, seed)
+class RandomStream {
+public:
+    // Rows at and above this are not image rows
+    static constexpr uint32_t RESERVED_ROWS = 0xFFF0u;
+    static constexpr uint32_t PHOTON_ROW = 0xFFFFu;
+    static constexpr uint32_t THREAD_ROW = 0xFFFEu;
+    
+    RandomStream() : RandomStream(0, 0, 0, 0) {}
+    RandomStream(uint32_t x, uint32_t y, uint32_t sample, uint32_t seed)
+        : m_pixel((y << 16) | (x & 0xFFFFu)), m_sample(sample), m_seed(seed) {}
+    
+    uint32_t nextUint() {
+        // One hash yields four values; the block index is the fourth key word
+        if ((m_counter & 3u) == 0u) {
+            m_block[0] = m_pixel;
+            m_block[1] = m_sample;
+            m_block[2] = m_seed;
+            m_block[3] = m_counter >> 2;
+            pcg4d(m_block);
+        }
+        return m_block[m_counter++ & 3u];
+    }
+    
+    // [0, 1) from the top 23 bits
+    float next() {
+        uint32_t bits = (nextUint() >> 9) | 0x3F800000u;
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f - 1.0f;
+    }
+    
+    float next(float min, float max) { return min + (max - min) * next(); }
+    
+    // Inclusive range
+    int nextInt(int min, int max) {
+        uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+        return static_cast<int>(min + static_cast<int64_t>((nextUint() * range) >> 32));
+    }
+    
+    static void pcg4d(uint32_t v[4]) {
+        for (int i = 0; i < 4; ++i) v[i] = v[i] * 1664525u + 1013904223u;
+        v[0] += v[1] * v[3]; v[1] += v[2] * v[0]; v[2] += v[0] * v[1]; v[3] += v[1] * v[2];
+        for (int i = 0; i < 4; ++i) v[i] ^= v[i] >> 16u;
+        v[0] += v[1] * v[3]; v[1] += v[2] * v[0]; v[2] += v[0] * v[1]; v[3] += v[1] * v[2];
+    }
+
+private:
+    uint32_t m_pixel;
+    uint32_t m_sample;
+    uint32_t m_seed;
+    uint32_t m_counter = 0;
+    uint32_t m_block[4] = {};
+};
+
+// General-purpose randomness for editor code. Each thread draws from its own
+// stream of the global seed, keyed by its job-system worker index (threads
+// outside the pool, the main thread among them, share id 0), so results
+// depend only on the seed and the order of calls on that thread, never on
+// which thread happened to draw first.
 class Random {
 public:
-    static void seed(unsigned int seed);
+    static void seed(uint32_t seed);
+    static uint32_t getSeed();
     static float uniform(); // 0.0 to 1.0
     static float uniform(float min, float max);
     static int uniformInt(int min, int max);
+    
+    // Stream for one pixel sample under the global seed
+    static RandomStream stream(uint32_t x, uint32_t y, uint32_t sample) {
+        return RandomStream(x, y, sample, getSeed());
+    }
 
 private:
-    static thread_local std::mt19937 s_generator;
-    static thread_local std::uniform_real_distribution<float> s_realDist;
-};
\ No newline at end of file
+    static RandomStream& threadStream();
+    
+    static thread_local RandomStream s_stream;
+};
@@ -0,0 +1,234 @@
+#include "Socket.h"
+#include "core/Logger.h"
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace {
+#ifdef _WIN32
+    using NativeHandle = SOCKET;
+    using IoSize = int;
+
+    void closeNative(NativeHandle handle) { closesocket(handle); }
+    constexpr int SHUTDOWN_BOTH = SD_BOTH;
+    constexpr int SEND_FLAGS = 0;
+#else
+    using NativeHandle = int;
+    using IoSize = size_t;
+
+    void closeNative(NativeHandle handle) { ::close(handle); }
+    constexpr int SHUTDOWN_BOTH = SHUT_RDWR;
+    #ifdef MSG_NOSIGNAL
+        constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+    #else
+        constexpr int SEND_FLAGS = 0;
+    #endif
+#endif
+
+    bool ensureStarted() {
+#ifdef _WIN32
+        static bool s_started = [] {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return s_started;
+#else
+        return true;
+#endif
+    }
+
+    NativeHandle native(intptr_t handle) {
+        return static_cast<NativeHandle>(handle);
+    }
+
+    // Small request messages must not wait on Nagle's algorithm
+    void configure(NativeHandle handle) {
+        int enable = 1;
+        setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&enable), sizeof(enable));
+#ifdef SO_NOSIGPIPE
+        setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+    }
+}
+
+Socket::~Socket() {
+    close();
+}
+
+Socket::Socket(Socket&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, INVALID_HANDLE)) {}
+
+Socket& Socket::operator=(Socket&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_handle = std::exchange(other.m_handle, INVALID_HANDLE);
+    }
+    return *this;
+}
+
+Socket Socket::connect(const std::string& host, uint16_t port) {
+    if (!ensureStarted()) return Socket();
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* results = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &results) != 0) {
+        LOG_WARN("Could not resolve {}", host);
+        return Socket();
+    }
+
+    Socket socket;
+    for (addrinfo* info = results; info; info = info->ai_next) {
+        NativeHandle handle = ::socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (static_cast<intptr_t>(handle) == INVALID_HANDLE) continue;
+
+        if (::connect(handle, info->ai_addr, static_cast<int>(info->ai_addrlen)) == 0) {
+            configure(handle);
+            socket = Socket(static_cast<Handle>(handle));
+            break;
+        }
+        closeNative(handle);
+    }
+    freeaddrinfo(results);
+    return socket;
+}
+
+Socket Socket::listen(const std::string& address, uint16_t port) {
+    if (!ensureStarted()) return Socket();
+
+    sockaddr_in bindAddress{};
+    bindAddress.sin_family = AF_INET;
+    bindAddress.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &bindAddress.sin_addr) != 1) {
+        LOG_ERROR("Invalid listen address: {}", address);
+        return Socket();
+    }
+
+    NativeHandle handle = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (static_cast<intptr_t>(handle) == INVALID_HANDLE) return Socket();
+    Socket socket(static_cast<Handle>(handle));
+
+    int enable = 1;
+    setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&enable), sizeof(enable));
+
+    if (::bind(handle, reinterpret_cast<sockaddr*>(&bindAddress), sizeof(bindAddress)) != 0 ||
+        ::listen(handle, SOMAXCONN) != 0) {
+        LOG_ERROR("Could not listen on {}:{}", address, port);
+        return Socket();
+    }
+    return socket;
+}
+
+Socket Socket::accept() const {
+    if (!isValid()) return Socket();
+
+    NativeHandle handle = ::accept(native(m_handle), nullptr, nullptr);
+    if (static_cast<intptr_t>(handle) == INVALID_HANDLE) return Socket();
+
+    configure(handle);
+    return Socket(static_cast<Handle>(handle));
+}
+
+bool Socket::parseEndpoint(const std::string& endpoint, std::string& host, uint16_t& port) {
+    size_t colon = endpoint.rfind(':');
+    std::string portText = colon == std::string::npos ? endpoint : endpoint.substr(colon + 1);
+    if (portText.empty() || portText.size() > 5 ||
+        portText.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+
+    unsigned long value = std::stoul(portText);
+    if (value > 65535) return false;
+
+    if (colon != std::string::npos) {
+        host = endpoint.substr(0, colon);
+    }
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+bool Socket::sendAll(const void* data, size_t size) {
+    const char* cursor = static_cast<const char*>(data);
+    while (size > 0) {
+        auto sent = ::send(native(m_handle), cursor, static_cast<IoSize>(size), SEND_FLAGS);
+        if (sent <= 0) return false;
+        cursor += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool Socket::receiveAll(void* data, size_t size) {
+    char* cursor = static_cast<char*>(data);
+    while (size > 0) {
+        auto received = ::recv(native(m_handle), cursor, static_cast<IoSize>(size), 0);
+        if (received <= 0) return false;
+        cursor += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+bool Socket::waitReadable(int milliseconds) const {
+    if (!isValid()) return false;
+
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(native(m_handle), &readable);
+
+    timeval timeout{};
+    timeout.tv_sec = milliseconds / 1000;
+    timeout.tv_usec = (milliseconds % 1000) * 1000;
+    return select(static_cast<int>(native(m_handle)) + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+void Socket::setReceiveTimeout(int milliseconds) {
+    if (!isValid()) return;
+#ifdef _WIN32
+    DWORD timeout = static_cast<DWORD>(milliseconds);
+    setsockopt(native(m_handle), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#else
+    timeval timeout{};
+    timeout.tv_sec = milliseconds / 1000;
+    timeout.tv_usec = (milliseconds % 1000) * 1000;
+    setsockopt(native(m_handle), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+}
+
+void Socket::shutdown() {
+    if (isValid()) {
+        ::shutdown(native(m_handle), SHUTDOWN_BOTH);
+    }
+}
+
+void Socket::close() {
+    if (isValid()) {
+        closeNative(native(m_handle));
+        m_handle = INVALID_HANDLE;
+    }
+}
+
+uint16_t Socket::getLocalPort() const {
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    if (!isValid() || getsockname(native(m_handle), reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        return 0;
+    }
+    return ntohs(address.sin_port);
+}
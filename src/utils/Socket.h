@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Blocking TCP stream over BSD sockets or Winsock. Move-only; closes on
+// destruction. Calls report failure by return value and never throw.
+class Socket {
+public:
+    Socket() = default;
+    ~Socket();
+    Socket(Socket&& other) noexcept;
+    Socket& operator=(Socket&& other) noexcept;
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    // Invalid on failure
+    static Socket connect(const std::string& host, uint16_t port);
+    // Listens on an IPv4 address, "0.0.0.0" for every interface; port 0
+    // picks a free one
+    static Socket listen(const std::string& address, uint16_t port);
+    Socket accept() const;
+
+    // Splits "host:port" or a bare "port"; host is left unchanged when absent
+    static bool parseEndpoint(const std::string& endpoint, std::string& host, uint16_t& port);
+
+    bool sendAll(const void* data, size_t size);
+    // False on error, timeout or when the peer closed the connection
+    bool receiveAll(void* data, size_t size);
+
+    // True when data or a disconnect is ready to receive
+    bool waitReadable(int milliseconds) const;
+
+    // 0 waits forever
+    void setReceiveTimeout(int milliseconds);
+    // Wakes any thread blocked on this socket without releasing the handle
+    void shutdown();
+    void close();
+
+    bool isValid() const { return m_handle != INVALID_HANDLE; }
+    uint16_t getLocalPort() const;
+
+private:
+    using Handle = intptr_t;
+    static constexpr Handle INVALID_HANDLE = -1;
+
+    explicit Socket(Handle handle) : m_handle(handle) {}
+
+    Handle m_handle = INVALID_HANDLE;
+};